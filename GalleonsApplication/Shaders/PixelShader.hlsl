@@ -60,7 +60,8 @@ cbuffer INSTANCE_DATA : register(b2)
 {
     uint transformStart;
     uint materialStart;
-    uint pad1[2];
+    float segmentOffset;
+    uint pad1;
 };
 
 cbuffer SCENE_DATA : register(b1)
@@ -76,6 +77,10 @@ cbuffer SCENE_DATA : register(b1)
     float fogStartDistance;
     float contrast;
     float saturation;
+    uint lightTileSize;
+    uint lightTilesX;
+    uint lightTilesY;
+    uint pad0;
 };
 
 cbuffer MESH_DATA : register(b0)
@@ -89,6 +94,8 @@ cbuffer MESH_DATA : register(b0)
 
 
 StructuredBuffer<LIGHT> sceneLights : register(t1);
+// per screen tile the offset and count of its light indices, then the indices, see Utils/LightBinning.h
+StructuredBuffer<uint> lightBins : register(t5);
 
 float4 main(RASTER_IN inputVertex) : SV_TARGET
 {
@@ -125,7 +132,8 @@ float4 main(RASTER_IN inputVertex) : SV_TARGET
     float lightType;
     float distance; 
     uint lightCount;
-    uint lightSize;
+    uint firstLight;
+    uint lightNdx;
     
     texColor = GetTexture(vertUV);  
       
@@ -139,17 +147,22 @@ float4 main(RASTER_IN inputVertex) : SV_TARGET
     
     colorOut = directLight + reflectLight;
      
-    sceneLights.GetDimensions(lightCount, lightSize);
+    // only the lights the CPU binned to this pixel's tile can reach it
+    uint2 tile = min(uint2(inputVertex.posHomog.xy) / max(lightTileSize, 1), uint2(lightTilesX - 1, lightTilesY - 1));
+    uint tileNdx = tile.y * lightTilesX + tile.x;
+    firstLight = lightBins[tileNdx * 2];
+    lightCount = lightBins[tileNdx * 2 + 1];
     
-    for (int i = 0; i < lightCount; i++)
+    for (uint i = 0; i < lightCount; i++)
     {
-        lightType = sceneLights[i].lightPos.w;
-        lightColor = sceneLights[i].lightColor;
-        lightPos = sceneLights[i].lightPos.xyz;
-        coneDir = sceneLights[i].lightDir.xyz;
-        innerCone = sceneLights[i].innerCone;
-        outerCone = sceneLights[i].outerCone;        
-        radius = sceneLights[i].lightRad;
+        lightNdx = lightBins[firstLight + i];
+        lightType = sceneLights[lightNdx].lightPos.w;
+        lightColor = sceneLights[lightNdx].lightColor;
+        lightPos = sceneLights[lightNdx].lightPos.xyz;
+        coneDir = sceneLights[lightNdx].lightDir.xyz;
+        innerCone = sceneLights[lightNdx].innerCone;
+        outerCone = sceneLights[lightNdx].outerCone;        
+        radius = sceneLights[lightNdx].lightRad;
         
         distance = sqrt(pow(lightPos.x - vertPos.x, 2) + pow(lightPos.y - vertPos.y, 2) + pow(lightPos.z - vertPos.z, 2));
                
@@ -38,7 +38,8 @@ cbuffer INSTANCE_DATA : register(b2)
 {
     uint transformStart;
     uint materialStart;
-    uint pad1[2];
+    float segmentOffset;
+    uint pad1;
 };
 
 cbuffer SCENE_DATA : register(b1)
@@ -81,7 +82,7 @@ RASTER_OUT main(VERT_IN inputVertex, uint id : SV_InstanceID)
     output.normWorld = normalize(output.normWorld);
     
     output.posHomog = mul(output.posHomog, curTransform);
-    output.posHomog.x += offset;
+    output.posHomog.x += segmentOffset;
     output.posWorld = output.posHomog;
     output.posHomog = mul(output.posHomog, view);
     output.posHomog = mul(output.posHomog, projection);
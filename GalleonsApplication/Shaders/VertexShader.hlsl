@@ -40,7 +40,8 @@ cbuffer INSTANCE_DATA : register(b2)
 {
     uint transformStart;
     uint materialStart;
-    uint pad1[2];
+    float segmentOffset;
+    uint pad1;
 };
 
 cbuffer SCENE_DATA : register(b1)
@@ -1,5 +1,7 @@
 #include "Application.h"
 
+#include <random>
+
 // open some Gateware namespaces for conveinence 
 // NEVER do this in a header file!
 using namespace GW;
@@ -9,13 +11,26 @@ using namespace GRAPHICS;
 
 bool Application::Init() 
 {
-	eventPusher.Create();
-
 	// load all game settigns
 	gameConfig = std::make_shared<GameConfig>(); 
 	// create the ECS system
 	flecsWorld = std::make_shared<flecs::world>();
 	uiWorld = std::make_shared<flecs::world>();
+	// every random stream in the game derives from this one seed, 0 means pick a fresh one
+	unsigned long long worldSeed = gameConfig->at("Game").at("seed").as<unsigned int>();
+	if (worldSeed == 0)
+	{
+		std::random_device seedDevice;
+		worldSeed = (static_cast<unsigned long long>(seedDevice()) << 32) | seedDevice();
+	}
+	flecsWorld->set<GOG::WorldSeed>({ worldSeed });
+	gameCommands.Create(flecsWorld, "MergeCommandBuffers");
+	frameArena.Create(gameConfig->at("Memory").at("frameArenaKB").as<unsigned int>() * 1024);
+	flecsWorld->set<GOG::FrameScratch>({ &frameArena });
+	// a trace of startup and the first frames, otherwise captures are started with F11
+	if (gameConfig->at("Profiler").at("captureOnStart").as<int>() != 0)
+		GOG::Profiler::Get().StartCapture(gameConfig->at("Profiler").at("captureFrames").as<unsigned int>(),
+			gameConfig->at("Profiler").at("captureFile").as<std::string>());
 
 	//GW::SYSTEM::GLog log;
 	actorData = std::make_unique<ActorData>();
@@ -80,12 +95,29 @@ bool Application::Run()
 			+d3d11.GetSwapchain((void**)&swapChain))
 		{
 
-			gameLogic.CheckInput();
-			if (GameLoop() == false)
-				return false;
-			d3d11RenderingSystem.UpdateMiniMap();
-			//d3d11RenderingSystem.UpdateCamera();
-			swapChain->Present(1, 0);
+			{
+				PROFILE_ZONE("Frame");
+				frameClock.Tick();
+				flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+
+				gameLogic.CheckInput();
+				if (GameLoop() == false)
+					return false;
+				// deliver the gameplay events raised this frame
+				eventBus.Dispatch();
+				gameLogic.RecordTick();
+				// apply every sound request gameplay made this frame
+				audioData.ProcessCommands();
+				d3d11RenderingSystem.UpdateMiniMap();
+				frameArena.EndFrame();
+				d3d11RenderingSystem.GetPerfHud().EndFrame(frameClock.DeltaTime() * 1000.0f,
+					d3d11RenderingSystem.GetRenderCounters(), eventBus.GetFrameStats(), gameCommands.GetMergeStats(),
+					frameArena.GetStats());
+				//d3d11RenderingSystem.UpdateCamera();
+				PROFILE_ZONE("Present");
+				swapChain->Present(1, 0);
+			}
+			PROFILE_FRAME();
 			// release incremented COM reference counts
 			if (swapChain != nullptr)			
 				swapChain->Release();			
@@ -159,6 +191,7 @@ bool Application::InitGraphics(ActorData* _actorData, LevelData* _levelData)
 
 bool Application::InitActorPrefabs(ActorData* _actorData)
 {
+	PROFILE_ZONE("InitActorPrefabs");
 	unsigned int playerPrefabCount	= 0;
 	unsigned int enemyPrefabCount = 0;
 	unsigned int projectilePrefabCount = 0;
@@ -206,11 +239,13 @@ bool Application::InitAudio(GW::SYSTEM::GLog _log)
 		return false;
 
 	audioData.Init("../SoundFX", "../Music", &audioEngine);
+	flecsWorld->set<GOG::AudioQueue>({ audioData.GetCommandQueue() });
 	return true;
 }
 
 bool Application::InitSystems()
 {
+	PROFILE_ZONE("InitSystems");
 	if (d3d11RenderingSystem.Init(	window,
 									d3d11,
 									flecsWorld,
@@ -218,7 +253,7 @@ bool Application::InitSystems()
 									gameConfig,
 									levelData.get(),
 									actorData.get(),
-									eventPusher) == false)
+									&eventBus) == false)
 	{
 		return false;
 	}
@@ -228,19 +263,23 @@ bool Application::InitSystems()
 						gameConfig,
 						&audioEngine,
 						&audioData,
-						eventPusher) == false)
+						&eventBus,
+						&gameCommands,
+						&frameClock) == false)
 		return false;
 	return true;
 }
 
 bool Application::GameLoop()
 {
-	// compute delta time and pass to the ECS system
-	static auto startTime = std::chrono::steady_clock::now();
-	double elapsedTime = std::chrono::duration<double>(
-		std::chrono::steady_clock::now() - startTime).count();
-	startTime = std::chrono::steady_clock::now();
+	PROFILE_ZONE("GameLoop");
+	// delta time was sampled once by the frame clock at the top of the frame
+	float elapsedTime = frameClock.DeltaTime();
 	// let the ECS system run
-	uiWorld->progress(static_cast<float>(elapsedTime));
-	return flecsWorld->progress(static_cast<float>(elapsedTime)); 
+	{
+		PROFILE_ZONE("UIWorldProgress");
+		uiWorld->progress(elapsedTime);
+	}
+	PROFILE_ZONE("GameWorldProgress");
+	return flecsWorld->progress(elapsedTime); 
 }
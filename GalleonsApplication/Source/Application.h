@@ -3,12 +3,17 @@
 
 // include events
 #include "Events/Playevents.h"
+#include "Events/EventBus.h"
 // Contains our global game settings
 #include "GameConfig.h"
 
 #include "Utils/AudioData.h"
 #include "Utils/ActorData.h"
 #include "Utils/LevelData.h"
+#include "Utils/FrameClock.h"
+#include "Utils/CommandBuffers.h"
+#include "Utils/FrameArena.h"
+#include "Utils/Profiler.h"
 
 // Load all entities+prefabs used by the game 
 
@@ -45,9 +50,15 @@ class Application
 	// specific ECS systems used to run the game
 	GOG::DirectX11Renderer d3d11RenderingSystem;
 	GOG::GameLogic gameLogic;
-
-	// EventGenerator for Game Events
-	GW::CORE::GEventGenerator eventPusher;
+	// sampled once per frame, drives both the ECS delta and simulation timers
+	GOG::FrameClock frameClock;
+
+	// Buffered gameplay events, delivered once per frame
+	GOG::EventBus eventBus;
+	// Deferred gameplay world changes from other threads, merged at the start of each frame
+	GOG::CommandBuffers gameCommands;
+	// Scratch memory for the current and the previous frame, swapped at the end of each frame
+	GOG::FrameArena frameArena;
 	GW::AUDIO::GAudio audioEngine; // can create music & sound effects
 	AudioData audioData;
 
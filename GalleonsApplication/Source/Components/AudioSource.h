@@ -1,19 +1,64 @@
 #ifndef AUDIO_SOURCE_H
 #define AUDIO_SOURCE_H
 
+#include "../Utils/CommandQueue.h"
+
 namespace GOG
 {
-	struct SoundClips { std::map<std::string, GW::AUDIO::GSound*> sounds; };
+	// Index into the AudioData sound bank, resolved once when prefabs are loaded
+	typedef unsigned short SoundId;
+	const SoundId INVALID_SOUND = 0xFFFF;
+
+	// Which one-shot clip of an actor to play
+	enum SOUND_SLOT
+	{
+		SHOOT_FX = 0,
+		DEATH_FX,
+		PICKUP_FX,
+		SMART_BOMB_FX,
+		SOUND_SLOT_COUNT
+	};
+
+	// Which looping clip of an actor to control
+	enum LOOP_SLOT
+	{
+		ACCEL_FX = 0,
+		LOOP_SLOT_COUNT
+	};
+
+	// Slots an actor doesn't use stay INVALID_SOUND and are ignored when queued
+	struct SoundClips { SoundId sounds[SOUND_SLOT_COUNT] = { INVALID_SOUND, INVALID_SOUND, INVALID_SOUND, INVALID_SOUND }; };
 
 	struct LoopingClip {
-		GW::AUDIO::GMusic* clip;
-		float volume;
+		SoundId clip = INVALID_SOUND;
+		float volume = 0;
 	};
 
-	struct LoopingClips { 
-		std::map<std::string, LoopingClip> sounds; 
+	struct LoopingClips {
+		LoopingClip sounds[LOOP_SLOT_COUNT];
 	};
 
+	enum AUDIO_COMMAND
+	{
+		PLAY_SOUND,
+		// starts a looping clip at the given volume unless it is already playing
+		PLAY_LOOP,
+		STOP_LOOP,
+		SET_LOOP_VOLUME
+	};
+
+	struct AudioCommand
+	{
+		AUDIO_COMMAND type;
+		SoundId sound;
+		float volume;
+	};
+
+	typedef CommandQueue<AudioCommand, 256> AudioCommandQueue;
+
+	// World singleton, gameplay pushes into it and the application drains it once per frame
+	struct AudioQueue { AudioCommandQueue* commands; };
+
 }
 
 #endif
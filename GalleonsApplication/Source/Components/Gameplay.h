@@ -5,6 +5,40 @@
 // example space game (avoid name collisions)
 namespace GOG
 {
+	// One tick is one millisecond of simulation time. Simulation time only advances
+	// while gameplay is running, so timers built on it pause with the game.
+	typedef long long SimTicks;
+
+	// World singleton refreshed once per frame by the application's frame clock
+	struct SimClock
+	{
+		unsigned long long frame;
+		SimTicks now;
+		float deltaTime;
+	};
+
+	// World singleton holding the seed every random stream is derived from
+	struct WorldSeed { unsigned long long value; };
+
+	// Menu buttons of an InputFrame, one bit each
+	enum INPUT_BUTTON
+	{
+		PAUSE_BUTTON = 1 << 0,
+		BACK_BUTTON = 1 << 1,
+		CONFIRM_BUTTON = 1 << 2,
+		CREDITS_BUTTON = 1 << 3
+	};
+
+	// World singleton holding controller 0 for this tick, keyboard and gamepad already combined.
+	// Sampled once per frame from the devices, or read back from a recorded input log.
+	struct InputFrame
+	{
+		float moveX;
+		float moveY;
+		float fire;
+		float smartBomb;
+		unsigned int buttons;
+	};
 
 	// gameplay tags (states)
 	struct Firing {};
@@ -59,7 +93,7 @@ namespace GOG
 		unsigned int dirChangIntervalMin;
 		unsigned int dirChangIntervalMax;
 		std::chrono::milliseconds curDirChangeInterval;
-		std::chrono::high_resolution_clock::time_point lastDirChange;
+		SimTicks lastDirChange;
 	};
 
 	struct SpeedBoost
@@ -73,7 +107,7 @@ namespace GOG
 		std::chrono::milliseconds durationMin;
 		std::chrono::milliseconds durationMax;
 		std::chrono::milliseconds curDuration;
-		std::chrono::high_resolution_clock::time_point lastBoost;
+		SimTicks lastBoost;
 	};
 
 	struct FlipInfo
@@ -95,8 +129,8 @@ namespace GOG
 	{
 		//float chargedDamage;
 		std::chrono::milliseconds timeTillFullyCharged;
-		std::chrono::high_resolution_clock::time_point chargeStart;
-		std::chrono::high_resolution_clock::time_point chargeEnd;
+		SimTicks chargeStart;
+		SimTicks chargeEnd;
 	};
 
 	struct NukeDispenser 
@@ -111,7 +145,7 @@ namespace GOG
 		float offset;
 		float aimLeadScaler;
 		std::chrono::milliseconds fireRate;
-		std::chrono::high_resolution_clock::time_point prevFireTime;
+		SimTicks prevFireTime;
 	};
 
 	struct PeaShooter
@@ -119,14 +153,14 @@ namespace GOG
 		float offset;
 		float range;
 		std::chrono::milliseconds fireRate;
-		std::chrono::high_resolution_clock::time_point prevFireTime;
+		SimTicks prevFireTime;
 	};
 
 	struct BomberTrap
 	{
 		float offset;
 		std::chrono::milliseconds fireRate;
-		std::chrono::high_resolution_clock::time_point prevFireTime;
+		SimTicks prevFireTime;
 	};
 
 #pragma endregion
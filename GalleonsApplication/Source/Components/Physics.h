@@ -7,7 +7,13 @@ namespace GOG
 {
 	// ECS component types should be *strongly* typed for proper queries
 	// typedef is tempting but it does not help templates/functions resolve type
+	// The camera's placement, moved directly by the camera system
 	struct Transform { GW::MATH::GMATRIXF value; };
+	// Where an actor is, how it is turned and how big it is, the only placement gameplay reads and
+	// writes. Angles are radians, the actor is scaled, then turned about x, y and z in that order.
+	struct Pose2D { float x, y, z; float pitch, yaw, roll; float scaleX, scaleY, scaleZ; bool dirty; };
+	// The actor's world matrix, only for drawing. Rebuilt from the pose by the transform sync while dirty.
+	struct WorldMatrix { GW::MATH::GMATRIXF value; };
 	struct Offset { float value; };
 	struct BoundBox { GW::MATH::GOBBF collider; };
 	struct Velocity { GW::MATH::GVECTORF value; };
@@ -17,6 +23,9 @@ namespace GOG
 	// Individual TAGs
 	struct Collidable {};
 	
+	// Singleton the collision system fills in every frame, for the performance HUD
+	struct CollisionStats { unsigned int colliders; unsigned int pairsTested; unsigned int pairsHit; };
+
 	// ECS Relationship tags
 	struct CollidedWith {};
 };
@@ -6,6 +6,8 @@
 #include "../Components/Physics.h"
 #include "../Components/visuals.h"
 
+#include "../Utils/SharedActorMethods.h"
+
 using namespace GOG;
 using namespace flecs;
 using namespace GW;
@@ -37,18 +39,16 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 
 		// Scale the enemy's transform
 
-		GMATRIXF transform = GIdentityMatrixF;
 		GVECTORF scale{	readCfg->at(prefabType).at("xScale").as<float>(),
 						readCfg->at(prefabType).at("yScale").as<float>(),
 						readCfg->at(prefabType).at("zScale").as<float>(),
 						1};
-		GMatrix::ScaleLocalF(transform, scale, transform);
 		GVECTORF dir{	G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("xRot").as<float>()),
 						G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("yRot").as<float>()),
 						G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("zRot").as<float>()), };
-		GMatrix::RotateXLocalF(transform, dir.x, transform);
-		GMatrix::RotateYLocalF(transform, dir.y, transform);
-		GMatrix::RotateZLocalF(transform, dir.z, transform);
+		Pose2D pose = SharedActorMethods::PrefabPose(dir, scale);
+		GMATRIXF transform;
+		SharedActorMethods::PoseMatrix(pose, transform);
 
 		// Find the boundaries of the box collider for the prefab's model.
 
@@ -74,13 +74,15 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 
 		std::string deathFXName = (*readCfg).at(prefabType).at("deathFX").as<std::string>();
 		float deathFXVolume = (*readCfg).at(prefabType).at("deathVolume").as<float>();
-		GW::AUDIO::GSound* deathFXClip = _audioData.CreateSound(deathFXName, deathFXVolume);
+		SoundClips soundClips{};
+		soundClips.sounds[SOUND_SLOT::DEATH_FX] = _audioData.CreateSound(deathFXName, deathFXVolume);
 
 		auto newPrefab = _flecsWorld->prefab(prefabType.c_str())
 			.override<Enemy>()
 			.override<Alive>()
 			.override<Collidable>()
-			.set_override<Transform>({ transform })
+			.set_override<WorldMatrix>({ transform })
+			.set_override<Pose2D>(pose)
 			.set_override<BoundBox>({ boundBox })
 			.set<EnemyType>({ _prefabCount})
 			.set<Score>({ readCfg->at(prefabType).at("score").as<unsigned int>() })
@@ -93,7 +95,7 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 			// ------------------------------------------------------------------------------------------
 			.set_override<FlipInfo>({ true, readCfg->at(prefabType).at("flipTime").as<int>(), 0 })
 			.set<ModelIndex>({ _modelIndex })
-			.set<SoundClips>({ {{"Death", deathFXClip}} });
+			.set<SoundClips>(soundClips);
 
 		switch (newPrefab.get<EnemyType>()->type)
 		{
@@ -102,7 +104,7 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 			newPrefab.override<Bomber>()
 				.set_override<BomberTrap>({ readCfg->at("TrapEjector").at("launchOffset").as<float>(),
 											std::chrono::milliseconds(readCfg->at("TrapEjector").at("fireRate").as<int>()),
-											std::chrono::high_resolution_clock::now() })
+											0 })
 				.set<PlayerSpace>({ readCfg->at(prefabType).at("playerSpace").as<float>() });
 				break;
 			}
@@ -129,7 +131,7 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 				.set_override<Cannon>({	launchOffset,
 										aimLeadScaler,
 										std::chrono::milliseconds(fireRate),
-										std::chrono::high_resolution_clock::now() })
+										0 })
 				.set_override<SpeedBoost>({ false,
 											false,
 											boostSpeed,
@@ -139,7 +141,7 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 											std::chrono::milliseconds(boostDurationMin),
 											std::chrono::milliseconds(boostDurationMax),
 											std::chrono::milliseconds(0),
-											std::chrono::high_resolution_clock::now() });
+											0 });
 				break;
 			}
 			case ENEMY_TYPE::LANDER:
@@ -153,7 +155,7 @@ bool GOG::EnemyData::Load(	std::shared_ptr<world> _flecsWorld,
 					.set_override<PeaShooter>({ offset,
 												range,
 												std::chrono::milliseconds(fireRate),
-												std::chrono::high_resolution_clock::now() })
+												0 })
 					.set<PlayerSpace>({ playerSpace });
 				break;
 			}
@@ -7,6 +7,8 @@
 #include "../Components/Physics.h"
 #include "../Components/Visuals.h"
 
+#include "../Utils/SharedActorMethods.h"
+
 using namespace GOG;
 using namespace flecs;
 using namespace GW;
@@ -28,13 +30,9 @@ bool PickupData::Load(	std::shared_ptr<world> _flecsWorld,
 
 	// Rotation
 
-	GMATRIXF transform{ GIdentityMatrixF };
 	float x_rot = readCfg->at(prefabType).at("xRot").as<float>();
 	float y_rot = readCfg->at(prefabType).at("yRot").as<float>();
 	float z_rot = readCfg->at(prefabType).at("zRot").as<float>();
-	GMatrix::RotateXGlobalF(transform, x_rot, transform);
-	GMatrix::RotateYGlobalF(transform, y_rot, transform);
-	GMatrix::RotateZGlobalF(transform, z_rot, transform);
 
 	// Scale
 
@@ -42,13 +40,16 @@ bool PickupData::Load(	std::shared_ptr<world> _flecsWorld,
 							readCfg->at(prefabType).at("yScale").as<float>(),
 							readCfg->at(prefabType).at("zScale").as<float>(),
 							1 };
-	GMatrix::ScaleLocalF(transform, prefabScale, transform);
+	Pose2D pose = SharedActorMethods::PrefabPose({ x_rot, y_rot, z_rot }, prefabScale);
+	GMATRIXF transform;
+	SharedActorMethods::PoseMatrix(pose, transform);
 
 	// Audio
 
 	std::string pickupFXName = (*readCfg).at(prefabType).at("pickupFX").as<std::string>();
 	float pickupFXVolume = (*readCfg).at(prefabType).at("pickupVolume").as<float>();
-	GW::AUDIO::GSound* pickupFXClip = _audioData.CreateSound(pickupFXName, pickupFXVolume);
+	SoundClips soundClips{};
+	soundClips.sounds[SOUND_SLOT::PICKUP_FX] = _audioData.CreateSound(pickupFXName, pickupFXVolume);
 
 	// Find the boundaries of the box collider for the prefab's model.
 
@@ -73,13 +74,12 @@ bool PickupData::Load(	std::shared_ptr<world> _flecsWorld,
 		.override<Pickup>()
 		.override<Alive>()
 		.override<Collidable>()
-		.set_override<Transform>({ transform })
+		.set_override<WorldMatrix>({ transform })
+		.set_override<Pose2D>(pose)
 		.set_override<BoundBox>({ boxCollider })
 		.set<PickupType>({ _prefabCount })
 		.set<ModelIndex>({ _modelIndex })
-		.set<SoundClips>({
-			{{"Pickup", pickupFXClip}}
-			});
+		.set<SoundClips>(soundClips);
 	RegisterPrefab(prefabType.c_str(), newPrefab);
 
 	switch (newPrefab.get<PickupType>()->type)
@@ -100,7 +100,7 @@ bool PickupData::Load(	std::shared_ptr<world> _flecsWorld,
 						readCfg->at(prefabType).at("dirChangeIntervalMin").as<unsigned int>(),
 						readCfg->at(prefabType).at("dirChangeIntervalMax").as<unsigned int>(),
 						std::chrono::milliseconds(0),
-						std::chrono::high_resolution_clock::now() 
+						0
 					})
 				.set<Offset>({ readCfg->at(prefabType).at("hangOffset").as<float>() })
 				.set<Score>({ readCfg->at(prefabType).at("score").as<unsigned int>() });
@@ -6,6 +6,8 @@
 #include "../Components/Visuals.h"
 #include "../Components/AudioSource.h"
 
+#include "../Utils/SharedActorMethods.h"
+
 using namespace GW;
 using namespace MATH;
 using namespace MATH2D;
@@ -28,17 +30,15 @@ bool GOG::PlayerData::Load(std::shared_ptr<flecs::world> _flecsWorld,
 
 	// Transform
 
-	GMATRIXF transform = GIdentityMatrixF;
 	GVECTORF scale{ readCfg->at(prefabType.c_str()).at("xScale").as<float>(),
 					readCfg->at(prefabType.c_str()).at("yScale").as<float>(),
 					readCfg->at(prefabType.c_str()).at("zScale").as<float>(), };
-	GMatrix::ScaleLocalF(transform, scale, transform);
 	GVECTORF dir{	G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("xRot").as<float>()),
 					G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("yRot").as<float>()),
 					G_DEGREE_TO_RADIAN_F(readCfg->at(prefabType.c_str()).at("zRot").as<float>()), };
-	GMatrix::RotateXLocalF(transform, dir.x, transform);
-	GMatrix::RotateYLocalF(transform, dir.y, transform);
-	GMatrix::RotateZLocalF(transform, dir.z, transform);
+	Pose2D pose = SharedActorMethods::PrefabPose(dir, scale);
+	GMATRIXF transform;
+	SharedActorMethods::PoseMatrix(pose, transform);
 
 	// Find the boundaries of the box collider for the prefab's model.
 
@@ -66,15 +66,17 @@ bool GOG::PlayerData::Load(std::shared_ptr<flecs::world> _flecsWorld,
 
 	std::string deathFXName = (*readCfg).at(prefabType).at("deathFX").as<std::string>();
 	float deathFXVolume = (*readCfg).at(prefabType).at("deathVolume").as<float>();
-	GW::AUDIO::GSound* deathFXClip = _audioData.CreateSound(deathFXName, deathFXVolume);
+	SoundClips soundClips{};
+	soundClips.sounds[SOUND_SLOT::DEATH_FX] = _audioData.CreateSound(deathFXName, deathFXVolume);
 
 	std::string smartBombFX = (*readCfg).at("NukeDispenser").at("detonateFX").as<std::string>();
 	float smartBombFXVolume = (*readCfg).at("NukeDispenser").at("detonateVolume").as<float>();
-	GW::AUDIO::GSound* smartBombFXClip = _audioData.CreateSound(smartBombFX, smartBombFXVolume);
+	soundClips.sounds[SOUND_SLOT::SMART_BOMB_FX] = _audioData.CreateSound(smartBombFX, smartBombFXVolume);
 
 	std::string accelFXName = (*readCfg).at(prefabType).at("accelFX").as<std::string>();
 	float accelFXVolume = (*readCfg).at(prefabType).at("accelVolume").as<float>();
-	LoopingClip accelFXClip = { _audioData.CreateSoundLooping(accelFXName, accelFXVolume), accelFXVolume };
+	LoopingClips loopingClips{};
+	loopingClips.sounds[LOOP_SLOT::ACCEL_FX] = { _audioData.CreateSoundLooping(accelFXName, accelFXVolume), accelFXVolume };
 
 	// Make a player prefab for each different type of player model there is.
 	auto newPrefab = _flecsWorld->prefab(prefabType.c_str())
@@ -83,7 +85,8 @@ bool GOG::PlayerData::Load(std::shared_ptr<flecs::world> _flecsWorld,
 		.override<ControllerID>()
 		.override<Collidable>()
 		//.set<Health>({ readCfg->at(prefabType).at("health").as<float>() })
-		.set_override<Transform>({ transform })
+		.set_override<WorldMatrix>({ transform })
+		.set_override<Pose2D>(pose)
 		.set_override<BoundBox>({ boundBox })
 		.set_override<Velocity>({})
 		.set_override<Acceleration>({})
@@ -106,13 +109,8 @@ bool GOG::PlayerData::Load(std::shared_ptr<flecs::world> _flecsWorld,
 								readCfg->at("Haptics").at("playerDeathDuration").as<float>() / 1000,
 								readCfg->at("Haptics").at("playerDeathStength").as<float>() })
 		.set<ModelIndex>({ _modelIndex })
-		.set<SoundClips>({
-			{{"Death", deathFXClip},
-			{"SmartBomb", smartBombFXClip}}
-			})
-		.set<LoopingClips>({
-			{{"Accel", accelFXClip}}
-			});
+		.set<SoundClips>(soundClips)
+		.set<LoopingClips>(loopingClips);
 	RegisterPrefab(prefabType.c_str(), newPrefab);
 
 	_flecsWorld->entity("Persistent Player Stats")
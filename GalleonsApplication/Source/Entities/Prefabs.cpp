@@ -4,7 +4,8 @@
 // I prefer them to the singleton design pattern 
 namespace 
 {
-	std::map<std::string, flecs::entity> prefabMap;
+	// std::less<> finds a name without building a std::string from it
+	std::map<std::string, flecs::entity, std::less<>> prefabMap;
 }
 // functions defined in this file have access to the data in the nameless namespace above
 namespace GOG
@@ -24,7 +25,7 @@ namespace GOG
 	{
 		auto iter = prefabMap.find(prefabName);
 		if (iter != prefabMap.end()) {
-			outPrefab = prefabMap[std::string(prefabName)];
+			outPrefab = iter->second;
 			return true;
 		}
 		return false; // prefab not found
@@ -8,6 +8,8 @@
 #include "../Components/Visuals.h"
 #include "../Components/Lights.h"
 
+#include "../Utils/SharedActorMethods.h"
+
 using namespace GW;
 using namespace MATH;
 
@@ -28,13 +30,12 @@ bool GOG::ProjectileData::Load(	std::shared_ptr<flecs::world> _flecsWorld,
 	if (readCfg->find(prefabType) == readCfg->end())
 		return false;
 
-	GMATRIXF transform{ GIdentityMatrixF };
-
 	// Audio
 
 	std::string shootFXName = (*readCfg).at(prefabType).at("shootFX").as<std::string>();
 	float shootFXVolume = (*readCfg).at(prefabType).at("shootVolume").as<float>();
-	GW::AUDIO::GSound* shootFXClip = _audioData.CreateSound(shootFXName, shootFXVolume);
+	SoundClips soundClips{};
+	soundClips.sounds[SOUND_SLOT::SHOOT_FX] = _audioData.CreateSound(shootFXName, shootFXVolume);
 
 	// Lighting
 	float lightRadius = { (*readCfg).at(prefabType).at("lightRadius").as<float>() };
@@ -50,9 +51,6 @@ bool GOG::ProjectileData::Load(	std::shared_ptr<flecs::world> _flecsWorld,
 	float x_rot = readCfg->at(prefabType).at("xRot").as<float>();
 	float y_rot = readCfg->at(prefabType).at("yRot").as<float>();
 	float z_rot = readCfg->at(prefabType).at("zRot").as<float>();
-	GMatrix::RotateXGlobalF(transform, x_rot, transform);
-	GMatrix::RotateYGlobalF(transform, y_rot, transform);
-	GMatrix::RotateZGlobalF(transform, z_rot, transform);
 
 	// Scale
 
@@ -60,7 +58,9 @@ bool GOG::ProjectileData::Load(	std::shared_ptr<flecs::world> _flecsWorld,
 							readCfg->at(prefabType).at("yScale").as<float>(),
 							readCfg->at(prefabType).at("zScale").as<float>(),
 							1 };
-	GMatrix::ScaleLocalF(transform, prefabScale, transform);
+	Pose2D pose = SharedActorMethods::PrefabPose({ x_rot, y_rot, z_rot }, prefabScale);
+	GMATRIXF transform;
+	SharedActorMethods::PoseMatrix(pose, transform);
 
 	// Find the boundaries of the box collider for the prefab's model.
 
@@ -86,12 +86,13 @@ bool GOG::ProjectileData::Load(	std::shared_ptr<flecs::world> _flecsWorld,
 		.override<Alive>()
 		.override<Collidable>()
 		.override<Sender>()
-		.set_override<Transform>({ transform })
+		.set_override<WorldMatrix>({ transform })
+		.set_override<Pose2D>(pose)
 		.set_override<BoundBox>({ boxCollider })
 		.set<Speed>({ readCfg->at(prefabType).at("speed").as<float>() })
 		.set<ProjectileType>({ _prefabCount })
 		.set<ModelIndex>({ _modelIndex })
-		.set<SoundClips>({ {{"Shoot", shootFXClip}} })
+		.set<SoundClips>(soundClips)
 		.add<Light>()
 		.set<LightType>({ LIGHT_TYPE::point })
 		.set<LightColor>(lightColor)
@@ -0,0 +1,208 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Playevents.h"
+
+#include "../Utils/CommandQueue.h"
+#include "../Utils/Profiler.h"
+
+namespace GOG
+{
+	// Per-frame counters, read them after Dispatch for profiling
+	struct EventFrameStats
+	{
+		unsigned int pushed[PLAY_EVENT_COUNT];
+		unsigned int delivered[PLAY_EVENT_COUNT];
+		unsigned int coalesced;
+		unsigned int dropped;
+		unsigned int passes;
+		// most events one thread had waiting in its buffer, out of EventBus::BUFFER_CAPACITY
+		unsigned int bufferPeak;
+	};
+
+	// Gameplay events are appended to a buffer owned by the pushing thread and delivered
+	// later, once per frame, grouped by event type. Nothing runs inside Push, so handlers
+	// can never recurse into each other; events raised while dispatching go out in the
+	// next pass of the same Dispatch call.
+	class EventBus
+	{
+	public:
+		typedef std::function<void(PLAY_EVENT _event, PLAY_EVENT_DATA _data)> Handler;
+		static const unsigned int BUFFER_CAPACITY = 1024;
+
+	private:
+		struct EventRecord
+		{
+			PLAY_EVENT type;
+			PLAY_EVENT_DATA data;
+		};
+		typedef CommandQueue<EventRecord, BUFFER_CAPACITY> EventBuffer;
+		struct ThreadBuffer
+		{
+			std::thread::id thread;
+			std::unique_ptr<EventBuffer> events;
+		};
+
+		// a chain of events raising events is cut off after this many passes per frame
+		static const unsigned int MAX_PASSES = 8;
+		// The order types are delivered in every pass. The player's death goes first, so the wave it
+		// resets is settled before the kills of the same frame are counted against that wave.
+		static constexpr PLAY_EVENT DISPATCH_ORDER[] =
+		{
+			PLAYER_DESTROYED,
+			ENEMY_DESTROYED,
+			CIVILIAN_DESTROYED,
+			WAVE_CLEARED,
+			PLAYER_RESPAWNED,
+			UPDATE_SCORE,
+			EVENT_COUNT,
+			SMART_BOMB_ACTIVATED,
+			SMART_BOMB_GRABBED,
+			GAME_OVER,
+			HAPTICS_ACTIVATED,
+			STATE_CHANGED
+		};
+		static_assert(sizeof(DISPATCH_ORDER) / sizeof(DISPATCH_ORDER[0]) == PLAY_EVENT_COUNT,
+			"every event type needs a place in the dispatch order");
+
+		// the lock only guards the buffer list, taken the first time a thread pushes and once per Dispatch
+		std::mutex bufferListLock;
+		std::vector<ThreadBuffer> buffers;
+		// never reused, unlike the bus' address once it is destroyed
+		static inline std::atomic<unsigned int> nextId{ 1 };
+		const unsigned int id = nextId.fetch_add(1, std::memory_order_relaxed);
+
+		std::vector<Handler> subscribers[PLAY_EVENT_COUNT];
+		bool coalesce[PLAY_EVENT_COUNT] = {};
+		// reused between frames so dispatching doesn't allocate once warmed up
+		std::vector<PLAY_EVENT_DATA> pending[PLAY_EVENT_COUNT];
+
+		std::atomic<unsigned int> dropped{ 0 };
+		EventFrameStats frameStats = {};
+
+		// Each thread remembers the buffer of the last bus it pushed to. Switching buses finds the
+		// thread's existing buffer again instead of adding one per switch.
+		EventBuffer* GetThreadBuffer()
+		{
+			thread_local unsigned int ownerId = 0;
+			thread_local EventBuffer* buffer = nullptr;
+			if (ownerId != id)
+			{
+				std::lock_guard<std::mutex> guard(bufferListLock);
+				std::thread::id self = std::this_thread::get_id();
+				auto found = std::find_if(buffers.begin(), buffers.end(),
+					[self](const ThreadBuffer& _buffer) { return _buffer.thread == self; });
+				if (found == buffers.end())
+				{
+					buffers.push_back({ self, std::make_unique<EventBuffer>() });
+					found = buffers.end() - 1;
+				}
+				buffer = found->events.get();
+				ownerId = id;
+			}
+			return buffer;
+		}
+
+		// Moves everything buffered so far into the per-type lists, returns how many events were taken
+		unsigned int Gather()
+		{
+			unsigned int count = 0;
+			EventRecord record;
+			std::lock_guard<std::mutex> guard(bufferListLock);
+			for (ThreadBuffer& buffer : buffers)
+			{
+				unsigned int taken = 0;
+				while (buffer.events->Pop(record))
+				{
+					pending[record.type].push_back(record.data);
+					frameStats.pushed[record.type] += 1;
+					taken += 1;
+				}
+				if (taken > frameStats.bufferPeak)
+					frameStats.bufferPeak = taken;
+				count += taken;
+			}
+			return count;
+		}
+
+	public:
+		EventBus() = default;
+		EventBus(const EventBus&) = delete;
+		EventBus& operator=(const EventBus&) = delete;
+
+		// Safe from any thread, never blocks once the thread's buffer exists
+		void Push(PLAY_EVENT _event, const PLAY_EVENT_DATA& _data)
+		{
+			if (GetThreadBuffer()->Push({ _event, _data }) == false)
+				dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Subscribe during initialization only, from the thread that calls Dispatch
+		void Subscribe(PLAY_EVENT _event, Handler _handler)
+		{
+			subscribers[_event].push_back(_handler);
+		}
+
+		void Subscribe(std::initializer_list<PLAY_EVENT> _events, Handler _handler)
+		{
+			for (PLAY_EVENT event : _events)
+				subscribers[event].push_back(_handler);
+		}
+
+		// Only the newest event of this type per pass is delivered. For events carrying absolute
+		// values (a score total, a bomb count) where the intermediate ones are redundant.
+		void SetCoalescing(PLAY_EVENT _event, bool _coalesce)
+		{
+			coalesce[_event] = _coalesce;
+		}
+
+		// Delivers everything pushed since the last call, main thread once per frame
+		void Dispatch()
+		{
+			PROFILE_ZONE("DispatchEvents");
+			frameStats = {};
+			for (unsigned int pass = 0; pass < MAX_PASSES; pass++)
+			{
+				if (Gather() == 0)
+					break;
+				frameStats.passes += 1;
+
+				for (PLAY_EVENT type : DISPATCH_ORDER)
+				{
+					std::vector<PLAY_EVENT_DATA>& events = pending[type];
+					if (events.empty())
+						continue;
+
+					if (coalesce[type] && events.size() > 1)
+					{
+						frameStats.coalesced += static_cast<unsigned int>(events.size() - 1);
+						events.front() = events.back();
+						events.resize(1);
+					}
+
+					for (const Handler& handler : subscribers[type])
+					{
+						for (const PLAY_EVENT_DATA& data : events)
+							handler(type, data);
+					}
+					frameStats.delivered[type] += static_cast<unsigned int>(events.size());
+					events.clear();
+				}
+			}
+			frameStats.dropped = dropped.exchange(0, std::memory_order_relaxed);
+		}
+
+		const EventFrameStats& GetFrameStats() const { return frameStats; }
+	};
+}
+
+#endif
@@ -17,12 +17,16 @@ namespace GOG
 		SMART_BOMB_GRABBED,
 		GAME_OVER,
 		HAPTICS_ACTIVATED,
-		STATE_CHANGED
+		STATE_CHANGED,
+		// number of event types, keep last
+		PLAY_EVENT_COUNT
 	};
 
 	enum DIRECTIVES
 	{
-		UPDATE_SCORE_OK = 1
+		UPDATE_SCORE_OK = 1,
+		// the enemy died ramming the player, it goes with the wave the player's death clears
+		ENEMY_RAMMED_PLAYER = 2
 	};
 
 	struct PLAY_EVENT_DATA 
@@ -0,0 +1,98 @@
+#include "HeadlessCheck.h"
+#include "../Utils/Random.h"
+
+#include <chrono>
+
+namespace
+{
+	// Loads the level and culls it from random camera positions, once with its BVH and once
+	// instance by instance, for each of the three segment copies. Fails if the two ever disagree.
+	class CullCheck : public GOG::HeadlessCheck
+	{
+	public:
+		const char* Name() const override { return "cull-check"; }
+		const char* Arguments() const override { return "[cameras] [seed]"; }
+		GOG::CHECK_RESULT Run(const std::vector<std::string>& _args) override;
+	};
+}
+
+GOG::CHECK_RESULT CullCheck::Run(const std::vector<std::string>& _args)
+{
+	unsigned int cameras = static_cast<unsigned int>(Argument(_args, 0, 1000));
+	unsigned long long seed = Argument(_args, 1, 1);
+
+	GameConfig gameConfig;
+	GW::SYSTEM::GLog log;
+	std::unique_ptr<LevelData> levelData = std::make_unique<LevelData>();
+	if (LoadCheckLevel(*levelData, log) == false)
+		return GOG::CHECK_ERROR;
+	GOG::CheckCamera checkCamera = LoadCheckCamera(gameConfig);
+	float segmentWidth = gameConfig.at("Game").at("levelSegmentWidth").as<float>();
+
+	const GOG::InstanceBvh& bvh = levelData->instanceBvh;
+	unsigned int instanceCount = bvh.InstanceCount();
+	std::vector<GOG::CullRange> bvhRanges(instanceCount);
+	std::vector<GOG::CullRange> bruteRanges(instanceCount);
+	std::vector<unsigned int> scratch(instanceCount);
+
+	GOG::Pcg32 random(seed, 0);
+	unsigned int mismatches = 0;
+	unsigned long long visible = 0;
+	float bvhMs = 0;
+	float bruteMs = 0;
+	for (unsigned int camera = 0; camera < cameras; camera++)
+	{
+		// anywhere along the three segment copies, above and below where the player flies
+		GW::MATH::GMATRIXF world = checkCamera.rotation;
+		world.row4 = { random.NextFloat(-1.5f, 1.5f) * segmentWidth, checkCamera.y + random.NextFloat(-40.0f, 40.0f), checkCamera.z, 1.0f };
+		GW::MATH::GMATRIXF view, viewProjection;
+		GW::MATH::GMatrix::InverseF(world, view);
+		GW::MATH::GMatrix::MultiplyMatrixF(view, checkCamera.projection, viewProjection);
+		GOG::CullFrustum frustum = GOG::CullFrustumFromViewProjection(viewProjection.data);
+
+		float segmentOffset = (int)((world.row4.x + segmentWidth / 2) / segmentWidth);
+		for (int segment = 0; segment < 3; segment++)
+		{
+			GOG::CullFrustum segmentFrustum = GOG::OffsetCullFrustum(frustum, (segmentOffset + segment - 1) * segmentWidth);
+
+			auto start = std::chrono::steady_clock::now();
+			unsigned int bvhCount = levelData->instanceBvh.Cull(segmentFrustum, bvhRanges.data());
+			auto split = std::chrono::steady_clock::now();
+			unsigned int bruteCount = GOG::CullInstancesBruteForce(segmentFrustum, bvh.InstanceBounds(), bvh.Groups(),
+				instanceCount, scratch.data(), bruteRanges.data());
+			auto end = std::chrono::steady_clock::now();
+			bvhMs += std::chrono::duration<float, std::milli>(split - start).count();
+			bruteMs += std::chrono::duration<float, std::milli>(end - split).count();
+
+			bool same = bvhCount == bruteCount;
+			for (unsigned int i = 0; i < bvhCount; i++)
+			{
+				same = same && bvhRanges[i].group == bruteRanges[i].group && bvhRanges[i].transformStart == bruteRanges[i].transformStart &&
+					bvhRanges[i].count == bruteRanges[i].count;
+				visible += bvhRanges[i].count;
+			}
+			if (same == false)
+			{
+				if (mismatches == 0)
+					std::cout << "camera " << camera << " at x " << world.row4.x << ", segment " << segment << ": "
+						<< bvhCount << " ranges from the BVH, " << bruteCount << " from brute force" << std::endl;
+				mismatches += 1;
+			}
+		}
+	}
+
+	unsigned int culls = cameras * 3;
+	std::cout << "Culled " << instanceCount << " level instances (" << bvh.NodeCount() << " BVH nodes) for " << culls
+		<< " segment copies, " << (culls > 0 ? visible / culls : 0) << " visible on average" << std::endl;
+	std::cout << "BVH " << (culls > 0 ? bvhMs / culls : 0) << " ms, brute force " << (culls > 0 ? bruteMs / culls : 0)
+		<< " ms per copy" << std::endl;
+	levelData->UnloadLevel();
+	if (mismatches > 0)
+		return Fail(std::to_string(mismatches) + " culls differed");
+	return Pass();
+}
+
+std::unique_ptr<GOG::HeadlessCheck> GOG::CreateCullCheck()
+{
+	return std::make_unique<CullCheck>();
+}
@@ -0,0 +1,256 @@
+#include "HeadlessCheck.h"
+#include "../Utils/ActorData.h"
+#include "../Utils/ActorInstances.h"
+#include "../Utils/FrameDraws.h"
+#include "../Utils/LevelDrawStream.h"
+#include "../Utils/WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace
+{
+	// Records the renderer's 3D passes frame after frame, with a number of instances of every
+	// actor model and the camera sweeping along the level, the same way the renderer fills them
+	// but without a GPU. Each frame is submitted to a null and a recording backend, then recorded
+	// again with the passes in parallel on the pass threads and this one, each into its own
+	// recording backend. Prints fill, submit and per-pass times, upload sizes and command counts.
+	// Fails if a draw points at a record or transforms that don't exist, the command stream misses
+	// draws or rebinds what is bound, or the parallel streams in pipeline order differ from the
+	// serial one.
+	class DrawBench : public GOG::HeadlessCheck
+	{
+	public:
+		const char* Name() const override { return "draw-bench"; }
+		const char* Arguments() const override { return "[frames] [instances per model] [pass threads]"; }
+		GOG::CHECK_RESULT Run(const std::vector<std::string>& _args) override;
+	};
+}
+
+GOG::CHECK_RESULT DrawBench::Run(const std::vector<std::string>& _args)
+{
+	unsigned int frames = static_cast<unsigned int>(Argument(_args, 0, 1000));
+	unsigned int perModel = static_cast<unsigned int>(Argument(_args, 1, 16));
+	unsigned int threads = static_cast<unsigned int>(Argument(_args, 2, 2));
+
+	GameConfig gameConfig;
+	GW::SYSTEM::GLog log;
+	std::unique_ptr<ActorData> actorData = std::make_unique<ActorData>();
+	std::unique_ptr<LevelData> levelData = std::make_unique<LevelData>();
+	if (actorData->LoadActors("../GameModels/ActorModels/Models/", log) == false)
+	{
+		std::cout << "couldn't load the actor models" << std::endl;
+		return GOG::CHECK_ERROR;
+	}
+	if (LoadCheckLevel(*levelData, log) == false)
+		return GOG::CHECK_ERROR;
+	if (frames == 0 || actorData->models.empty())
+	{
+		std::cout << "nothing to record" << std::endl;
+		return GOG::CHECK_ERROR;
+	}
+
+	// perModel instances of every actor model, gathered every frame into instances that start
+	// and grow the way the renderer's do
+	std::vector<unsigned int> modelNdxs;
+	for (unsigned int copy = 0; copy < perModel; copy++)
+	{
+		for (unsigned int model = 0; model < actorData->models.size(); model++)
+			modelNdxs.push_back(model);
+	}
+	GOG::ActorInstances instances;
+	instances.Create(gameConfig.at("Memory").at("actorInstances").as<unsigned int>(),
+		gameConfig.at("Memory").at("actorInstancesMax").as<unsigned int>());
+	GOG::ActorRenderQueue queue;
+	queue.Create(static_cast<unsigned int>(actorData->models.size()), instances.Capacity());
+
+	GW::MATH::GMATRIXF projection = LoadCheckCamera(gameConfig).projection;
+	float segmentWidth = gameConfig.at("Game").at("levelSegmentWidth").as<float>();
+	float cameraZ = gameConfig.at("Camera").at("posZ").as<float>();
+	GOG::LevelDrawStream levelStream;
+	levelStream.Bake(*levelData, { gameConfig.at("Renderer").at("mergeStaticMeshes").as<int>() != 0,
+		gameConfig.at("Renderer").at("mergeMaxIndices").as<unsigned int>(), gameConfig.at("Renderer").at("mergeCellWidth").as<float>() });
+
+	// one frame recorded pass after pass on this thread, one the way the renderer does it with
+	// every pass on whichever thread of the pool picks it up
+	size_t uploadBytes = gameConfig.at("Memory").at("uploadRingKB").as<size_t>() * 1024;
+	GOG::FrameDraws frame;
+	GOG::FrameDraws parallelFrame;
+	frame.Create(uploadBytes, 4096);
+	parallelFrame.Create(uploadBytes, 4096);
+	std::vector<GOG::CullRange> ranges(levelData->instanceBvh.InstanceCount());
+	std::vector<GOG::CullRange> parallelRanges(levelData->instanceBvh.InstanceCount());
+	GOG::SceneData scene = {};
+	GOG::MeshData mesh = {};
+	mesh.worldMatrix = GW::MATH::GIdentityMatrixF;
+	GOG::PinLevelMaterials(frame, levelStream, mesh);
+	GOG::PinLevelMaterials(parallelFrame, levelStream, mesh);
+	// the backends never read them, the size is what the renderer uploads
+	std::vector<GW::MATH::GMATRIXF> transforms;
+	size_t transformBytes = 0;
+	GOG::NullRenderBackend nullBackend;
+	GOG::RecordingRenderBackend recorder;
+	GOG::RecordingRenderBackend passRecorders[GOG::PIPELINE_COUNT];
+	GOG::WorkerPool workers;
+	workers.Start(threads);
+
+	std::vector<float> fillMs(frames);
+	std::vector<float> submitMs(frames);
+	std::vector<float> parallelMs(frames);
+	double passMsTotal[GOG::PIPELINE_COUNT] = {};
+	float passMs[GOG::PIPELINE_COUNT] = {};
+	unsigned long long draws = 0;
+	unsigned long long binds = 0;
+	unsigned int invalidFrames = 0;
+	unsigned int badStreams = 0;
+	unsigned int mismatchedFrames = 0;
+	for (unsigned int f = 0; f < frames; f++)
+	{
+		// the camera sweeps across a whole segment and a half over the run
+		GW::MATH::GMATRIXF camera = GW::MATH::GIdentityMatrixF;
+		camera.row4 = { (f / static_cast<float>(frames) * 1.5f - 0.75f) * segmentWidth, 0.0f, cameraZ, 1.0f };
+		GW::MATH::GMATRIXF view, viewProjection;
+		GW::MATH::GMatrix::InverseF(camera, view);
+		GW::MATH::GMatrix::MultiplyMatrixF(view, projection, viewProjection);
+		float segmentOffset = (int)((camera.row4.x + segmentWidth / 2) / segmentWidth);
+		GOG::CullFrustum frustum = GOG::CullFrustumFromViewProjection(viewProjection.data);
+		scene.viewMatrix = view;
+		scene.projectionMatrix = projection;
+		scene.camPos = camera.row4;
+
+		auto start = std::chrono::steady_clock::now();
+		instances.Reset();
+		for (unsigned int model : modelNdxs)
+			instances.Add(GW::MATH::GIdentityMatrixF, GW::MATH::GIdentityMatrixF, model);
+		queue.Reserve(instances.Capacity());
+		queue.Build(instances.ModelNdxs(), instances.Count());
+		transforms.resize(instances.Capacity(), GW::MATH::GIdentityMatrixF);
+		transformBytes = sizeof(GW::MATH::GMATRIXF) * queue.InstanceCount();
+		frame.Reset();
+		GOG::RecordMinimapDraws(frame, *actorData, queue, scene, mesh);
+		GOG::RecordLevelDraws(frame, levelStream, levelData->instanceBvh, frustum,
+			(segmentOffset - 1) * segmentWidth, segmentWidth, scene, ranges.data());
+		GOG::RecordActorDraws(frame, *actorData, queue, scene, mesh);
+		fillMs[f] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		draws += frame.DrawCount();
+
+		// every record a draw points at was written this frame, and its transforms exist
+		bool valid = true;
+		for (unsigned int pipeline = 0; valid && pipeline < GOG::PIPELINE_COUNT; pipeline++)
+		{
+			const GOG::PassDraws& pass = frame.passes[pipeline];
+			size_t transformCount = pipeline == GOG::PIPELINE_LEVEL ? levelStream.Transforms().size() : queue.InstanceCount();
+			valid = pass.uploads.Contains(pass.scene) && ((pass.meshStages & GOG::STAGE_VERTEX) || pass.uploads.Contains(pass.vertexMesh));
+			for (unsigned int i = 0; valid && i < pass.draws.size(); i++)
+			{
+				const GOG::DrawRecord& draw = pass.draws[i];
+				valid = pass.uploads.Contains(draw.mesh) && pass.uploads.Contains(draw.instance) &&
+					pass.uploads.Read<GOG::PerInstanceData>(draw.instance).transformStart + draw.instanceCount <= transformCount;
+			}
+		}
+		if (valid == false)
+			invalidFrames += 1;
+
+		start = std::chrono::steady_clock::now();
+		GOG::SubmitFrameDraws(nullBackend, frame, transforms.data(), transforms.data(), transformBytes);
+		submitMs[f] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// the stream has every recorded draw once, and never binds what a slot already holds
+		recorder.Reset();
+		GOG::SubmitFrameDraws(recorder, frame, transforms.data(), transforms.data(), transformBytes);
+		const GOG::RenderCommandStats& commandStats = recorder.GetStats();
+		binds += commandStats.binds;
+		if (commandStats.draws != frame.DrawCount() || commandStats.pipelineChanges != GOG::PIPELINE_COUNT ||
+			commandStats.redundantBinds > 0)
+			badStreams += 1;
+
+		// the same frame with the passes recorded and submitted in parallel, each to its own backend
+		parallelFrame.Reset();
+		auto recordPass = [&](unsigned int _pass)
+			{
+				auto passStart = std::chrono::steady_clock::now();
+				GOG::RENDER_PIPELINE pipeline = static_cast<GOG::RENDER_PIPELINE>(_pass);
+				if (pipeline == GOG::PIPELINE_MINIMAP_MODELS)
+					GOG::RecordMinimapDraws(parallelFrame, *actorData, queue, scene, mesh);
+				else if (pipeline == GOG::PIPELINE_LEVEL)
+					GOG::RecordLevelDraws(parallelFrame, levelStream, levelData->instanceBvh, frustum,
+						(segmentOffset - 1) * segmentWidth, segmentWidth, scene, parallelRanges.data());
+				else
+					GOG::RecordActorDraws(parallelFrame, *actorData, queue, scene, mesh);
+				passRecorders[pipeline].Clear();
+				GOG::SubmitPassDraws(passRecorders[pipeline], parallelFrame, pipeline,
+					GOG::PassTransforms(pipeline, transforms.data(), transforms.data()), transformBytes);
+				passMs[pipeline] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+			};
+		start = std::chrono::steady_clock::now();
+		workers.Run(GOG::PIPELINE_COUNT, recordPass);
+		parallelMs[f] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// run in pipeline order the pass streams are the serial stream, whichever thread ran them
+		const std::vector<GOG::RenderCommand>& serialCommands = recorder.Commands();
+		size_t next = 0;
+		bool matches = true;
+		for (unsigned int pipeline = 0; pipeline < GOG::PIPELINE_COUNT; pipeline++)
+		{
+			passMsTotal[pipeline] += passMs[pipeline];
+			for (const GOG::RenderCommand& command : passRecorders[pipeline].Commands())
+			{
+				matches = matches && next < serialCommands.size() && command.type == serialCommands[next].type &&
+					std::equal(std::begin(command.args), std::end(command.args), std::begin(serialCommands[next].args));
+				next += 1;
+			}
+		}
+		if (matches == false || next != serialCommands.size())
+			mismatchedFrames += 1;
+	}
+	workers.Stop();
+
+	size_t peakBytes = 0;
+	size_t capacity = 0;
+	unsigned int growths = 0;
+	for (const GOG::PassDraws& pass : frame.passes)
+	{
+		peakBytes += pass.uploads.GetStats().peakBytes;
+		capacity += pass.uploads.GetStats().capacity;
+		growths += pass.uploads.GetStats().growths;
+	}
+	const GOG::RenderCommandStats& commandStats = recorder.GetStats();
+	std::sort(fillMs.begin(), fillMs.end());
+	std::sort(submitMs.begin(), submitMs.end());
+	std::sort(parallelMs.begin(), parallelMs.end());
+	float totalMs = 0;
+	float totalSubmitMs = 0;
+	float totalParallelMs = 0;
+	for (unsigned int f = 0; f < frames; f++)
+	{
+		totalMs += fillMs[f];
+		totalSubmitMs += submitMs[f];
+		totalParallelMs += parallelMs[f];
+	}
+	std::cout << "Recorded " << frames << " frames with " << instances.Count() << " actors, " << draws / frames << " draws per frame" << std::endl;
+	std::cout << "instances " << instances.Capacity() << " capacity after " << instances.GetStats().growths << " growths, "
+		<< instances.GetStats().overflows << " actors per frame over the limit" << std::endl;
+	std::cout << "fill ms  avg " << totalMs / frames << "  p99 " << fillMs[(frames - 1) * 99 / 100] << "  max " << fillMs.back() << std::endl;
+	std::cout << "submit ms  avg " << totalSubmitMs / frames << "  p99 " << submitMs[(frames - 1) * 99 / 100] << "  max " << submitMs.back() << std::endl;
+	std::cout << "parallel ms (" << workers.ThreadCount() << " + 1 threads)  avg " << totalParallelMs / frames
+		<< "  p99 " << parallelMs[(frames - 1) * 99 / 100] << "  max " << parallelMs.back() << std::endl;
+	std::cout << "pass ms avg  minimap " << passMsTotal[GOG::PIPELINE_MINIMAP_MODELS] / frames << "  level " << passMsTotal[GOG::PIPELINE_LEVEL] / frames
+		<< "  actors " << passMsTotal[GOG::PIPELINE_ACTORS] / frames << std::endl;
+	std::cout << "uploads peak " << peakBytes / 1024 << " KB of " << capacity / 1024 << " KB, " << growths << " growths" << std::endl;
+	std::cout << "commands " << binds / frames << " binds per frame, last frame " << commandStats.uploads << " uploads of "
+		<< commandStats.uploadedBytes / 1024 << " KB, " << commandStats.pipelineChanges << " pipeline changes" << std::endl;
+	levelData->UnloadLevel();
+	if (invalidFrames > 0)
+		return Fail(std::to_string(invalidFrames) + " frames recorded draws with bad records");
+	if (badStreams > 0)
+		return Fail(std::to_string(badStreams) + " frames submitted missing or redundant commands");
+	if (mismatchedFrames > 0)
+		return Fail(std::to_string(mismatchedFrames) + " frames recorded differently in parallel");
+	return Pass();
+}
+
+std::unique_ptr<GOG::HeadlessCheck> GOG::CreateDrawBench()
+{
+	return std::make_unique<DrawBench>();
+}
@@ -0,0 +1,61 @@
+#include "HeadlessCheck.h"
+
+#include <cstdlib>
+
+unsigned long long GOG::HeadlessCheck::Argument(const std::vector<std::string>& _args, unsigned int _index, unsigned long long _default)
+{
+	return _index < _args.size() ? std::strtoull(_args[_index].c_str(), nullptr, 10) : _default;
+}
+
+std::string GOG::HeadlessCheck::Argument(const std::vector<std::string>& _args, unsigned int _index, const std::string& _default)
+{
+	return _index < _args.size() ? _args[_index] : _default;
+}
+
+GOG::CheckCamera GOG::HeadlessCheck::LoadCheckCamera(const GameConfig& _config)
+{
+	// the camera the game follows the player with, and the renderer's projection
+	CheckCamera camera = {};
+	camera.rotation = GW::MATH::GIdentityMatrixF;
+	GW::MATH::GMatrix::RotateXLocalF(camera.rotation, G_DEGREE_TO_RADIAN_F(_config.at("Camera").at("rotX").as<float>()), camera.rotation);
+	GW::MATH::GMatrix::RotateYLocalF(camera.rotation, G_DEGREE_TO_RADIAN_F(_config.at("Camera").at("rotY").as<float>()), camera.rotation);
+	GW::MATH::GMatrix::RotateZLocalF(camera.rotation, G_DEGREE_TO_RADIAN_F(_config.at("Camera").at("rotZ").as<float>()), camera.rotation);
+	camera.y = _config.at("Camera").at("posY").as<float>();
+	camera.z = _config.at("Camera").at("posZ").as<float>();
+	camera.width = _config.at("Window").at("width").as<float>();
+	camera.height = _config.at("Window").at("height").as<float>();
+	camera.nearPlane = 0.1f;
+	GW::MATH::GMatrix::ProjectionDirectXLHF(65.0f * 3.14f / 180.0f, camera.width / camera.height, camera.nearPlane, 2000.0f, camera.projection);
+	return camera;
+}
+
+bool GOG::HeadlessCheck::LoadCheckLevel(LevelData& _level, GW::SYSTEM::GLog& _log)
+{
+	if (_level.LoadLevel("../GameModels/Levels/SpaceLevel/GameLevel.txt", "../GameModels/Levels/SpaceLevel/Models", _log))
+		return true;
+	std::cout << "couldn't load the level" << std::endl;
+	return false;
+}
+
+GOG::CHECK_RESULT GOG::HeadlessCheck::Fail(const std::string& _reason) const
+{
+	std::cout << _reason << ", " << Name() << " failed" << std::endl;
+	return CHECK_FAILED;
+}
+
+GOG::CHECK_RESULT GOG::HeadlessCheck::Pass() const
+{
+	std::cout << Name() << " passed" << std::endl;
+	return CHECK_PASSED;
+}
+
+std::vector<std::unique_ptr<GOG::HeadlessCheck>> GOG::CreateHeadlessChecks()
+{
+	std::vector<std::unique_ptr<HeadlessCheck>> checks;
+	checks.push_back(CreateCullCheck());
+	checks.push_back(CreateDrawBench());
+	checks.push_back(CreateShaderCacheCheck());
+	checks.push_back(CreateLightBinCheck());
+	checks.push_back(CreateLevelStreamCheck());
+	return checks;
+}
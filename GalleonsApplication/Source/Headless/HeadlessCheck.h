@@ -0,0 +1,70 @@
+#ifndef HEADLESS_CHECK_H
+#define HEADLESS_CHECK_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Utils/LevelData.h"
+// Contains our global game settings
+#include "../GameConfig.h"
+
+namespace GOG
+{
+	// The headless runner's exit code for a check
+	enum CHECK_RESULT
+	{
+		CHECK_PASSED = 0,
+		// it ran and what it checked was wrong
+		CHECK_FAILED,
+		// it couldn't run, the level, models or a scratch directory didn't load
+		CHECK_ERROR
+	};
+
+	// The game's camera and the renderer's projection, from the settings
+	struct CheckCamera
+	{
+		GW::MATH::GMATRIXF rotation;
+		GW::MATH::GMATRIXF projection;
+		float y;
+		float z;
+		float width;
+		float height;
+		float nearPlane;
+	};
+
+	// A check or benchmark of one engine piece that runs without a window, GPU or gameplay world.
+	// Each one lives in its own file under Headless/ and is picked by its switch on the command line.
+	class HeadlessCheck
+	{
+	public:
+		virtual ~HeadlessCheck() = default;
+
+		// the command line switch without its dashes, "cull-check" runs with --cull-check
+		virtual const char* Name() const = 0;
+		// what follows the switch in the usage text
+		virtual const char* Arguments() const = 0;
+		// _args are those after the switch, missing ones fall back to the check's defaults
+		virtual CHECK_RESULT Run(const std::vector<std::string>& _args) = 0;
+
+	protected:
+		static unsigned long long Argument(const std::vector<std::string>& _args, unsigned int _index, unsigned long long _default);
+		static std::string Argument(const std::vector<std::string>& _args, unsigned int _index, const std::string& _default);
+		static CheckCamera LoadCheckCamera(const GameConfig& _config);
+		// the game's level, says so if it doesn't load
+		static bool LoadCheckLevel(LevelData& _level, GW::SYSTEM::GLog& _log);
+		// print the outcome under the check's name and return it
+		CHECK_RESULT Fail(const std::string& _reason) const;
+		CHECK_RESULT Pass() const;
+	};
+
+	std::unique_ptr<HeadlessCheck> CreateCullCheck();
+	std::unique_ptr<HeadlessCheck> CreateDrawBench();
+	std::unique_ptr<HeadlessCheck> CreateShaderCacheCheck();
+	std::unique_ptr<HeadlessCheck> CreateLightBinCheck();
+	std::unique_ptr<HeadlessCheck> CreateLevelStreamCheck();
+	// every check, in the order the usage text lists them
+	std::vector<std::unique_ptr<HeadlessCheck>> CreateHeadlessChecks();
+}
+
+#endif
@@ -0,0 +1,250 @@
+#include "HeadlessCheck.h"
+#include "../Utils/FrameDraws.h"
+#include "../Utils/LevelDrawStream.h"
+#include "../Utils/Random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// Bakes the level's draw stream with and without [Renderer] mergeStaticMeshes and checks the
+	// merged one draws the same triangles per material. Then from random camera positions records
+	// the level pass walking its models and meshes every frame, the way it was before the stream,
+	// and from both streams. Prints draws, records and upload sizes per frame for the three. Fails
+	// if the unmerged replay ever differs from the walk or culls a merged instance the walk draws.
+	class LevelStreamCheck : public GOG::HeadlessCheck
+	{
+	public:
+		const char* Name() const override { return "level-stream-check"; }
+		const char* Arguments() const override { return "[cameras] [seed]"; }
+		GOG::CHECK_RESULT Run(const std::vector<std::string>& _args) override;
+	};
+}
+
+GOG::CHECK_RESULT LevelStreamCheck::Run(const std::vector<std::string>& _args)
+{
+	unsigned int cameras = static_cast<unsigned int>(Argument(_args, 0, 1000));
+	unsigned long long seed = Argument(_args, 1, 1);
+
+	GameConfig gameConfig;
+	GW::SYSTEM::GLog log;
+	std::unique_ptr<LevelData> levelData = std::make_unique<LevelData>();
+	if (LoadCheckLevel(*levelData, log) == false)
+		return GOG::CHECK_ERROR;
+	GOG::CheckCamera checkCamera = LoadCheckCamera(gameConfig);
+	float segmentWidth = gameConfig.at("Game").at("levelSegmentWidth").as<float>();
+
+	GOG::LevelStreamSettings settings = { false, gameConfig.at("Renderer").at("mergeMaxIndices").as<unsigned int>(),
+		gameConfig.at("Renderer").at("mergeCellWidth").as<float>() };
+	GOG::LevelDrawStream stream;
+	GOG::LevelDrawStream mergedStream;
+	auto bakeStart = std::chrono::steady_clock::now();
+	stream.Bake(*levelData, settings);
+	auto bakeSplit = std::chrono::steady_clock::now();
+	settings.merge = true;
+	mergedStream.Bake(*levelData, settings);
+	float bakeMs = std::chrono::duration<float, std::milli>(bakeSplit - bakeStart).count();
+	float mergedBakeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - bakeSplit).count();
+
+	// Every triangle either stream draws over the whole level, as a count and a sum of world
+	// positions per material of the unmerged stream. The merged batches were moved on the CPU,
+	// everything else is moved here by its instance's transform.
+	struct MaterialTotals
+	{
+		unsigned long long triangles;
+		double position[3];
+	};
+	auto totalGeometry = [&](const GOG::LevelDrawStream& _stream, std::vector<MaterialTotals>& _totals)
+		{
+			_totals.assign(stream.Materials().size(), MaterialTotals{});
+			std::vector<unsigned int> materialMap(_stream.Materials().size());
+			for (unsigned int m = 0; m < _stream.Materials().size(); m++)
+			{
+				const GOG::LevelDrawStream::Material& material = _stream.Materials()[m];
+				materialMap[m] = static_cast<unsigned int>(std::find_if(stream.Materials().begin(), stream.Materials().end(),
+					[&material](const GOG::LevelDrawStream::Material& _other)
+					{
+						return _other.texID == material.texID && std::memcmp(&_other.attribute, &material.attribute, sizeof(H2B::Attributes)) == 0;
+					}) - stream.Materials().begin());
+				if (materialMap[m] == stream.Materials().size())
+					return false;
+			}
+			auto addDraw = [&](const GOG::LevelDrawStream::Draw& _draw, const float* _matrix)
+				{
+					MaterialTotals& totals = _totals[materialMap[_draw.material]];
+					totals.triangles += _draw.indexCount / 3;
+					for (unsigned int i = 0; i < _draw.indexCount; i++)
+					{
+						const H2B::Vector& pos = _stream.Vertices()[_stream.Indices()[_draw.startIndex + i] + _draw.baseVertex].pos;
+						for (int column = 0; column < 3; column++)
+							totals.position[column] += _matrix[12 + column] + pos.x * _matrix[column] + pos.y * _matrix[4 + column] + pos.z * _matrix[8 + column];
+					}
+				};
+			for (unsigned int group = 0; group < levelData->levelInstances.size(); group++)
+			{
+				const LevelData::ModelInstances& instances = levelData->levelInstances[group];
+				const GOG::LevelDrawStream::DrawSpan& span = _stream.Groups()[group];
+				for (unsigned int t = instances.transformStart; t < instances.transformStart + instances.transformCount; t++)
+				{
+					for (unsigned int d = span.firstDraw; d < span.firstDraw + span.drawCount; d++)
+						addDraw(_stream.Draws()[d], _stream.Transforms()[t].data);
+				}
+			}
+			for (const GOG::LevelDrawStream::Batch& batch : _stream.Batches())
+				addDraw(_stream.Draws()[batch.draw], _stream.Transforms()[_stream.IdentityTransform()].data);
+			return true;
+		};
+	unsigned int failures = 0;
+	std::vector<MaterialTotals> totals;
+	std::vector<MaterialTotals> mergedTotals;
+	if (totalGeometry(stream, totals) == false || totalGeometry(mergedStream, mergedTotals) == false)
+		failures += 1;
+	for (unsigned int m = 0; failures == 0 && m < totals.size(); m++)
+	{
+		bool same = totals[m].triangles == mergedTotals[m].triangles;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			double tolerance = 1e-4 * (std::fabs(totals[m].position[axis]) + totals[m].triangles * 3.0);
+			same = same && std::fabs(totals[m].position[axis] - mergedTotals[m].position[axis]) <= tolerance;
+		}
+		if (same == false)
+		{
+			std::cout << "material " << m << " draws " << mergedTotals[m].triangles << " merged triangles, "
+				<< totals[m].triangles << " without merging" << std::endl;
+			failures += 1;
+		}
+	}
+
+	// each camera records the level the way it was before it was baked, one mesh record per draw
+	// walking the level's models and meshes, then from both streams
+	size_t uploadBytes = gameConfig.at("Memory").at("uploadRingKB").as<size_t>() * 1024;
+	GOG::FrameDraws walked;
+	GOG::FrameDraws baked;
+	GOG::FrameDraws merged;
+	for (GOG::FrameDraws* frame : { &walked, &baked, &merged })
+		frame->Create(uploadBytes, 4096);
+	GOG::SceneData scene = {};
+	GOG::MeshData mesh = {};
+	mesh.worldMatrix = GW::MATH::GIdentityMatrixF;
+	GOG::PinLevelMaterials(baked, stream, mesh);
+	GOG::PinLevelMaterials(merged, mergedStream, mesh);
+	std::vector<GOG::CullRange> ranges(levelData->instanceBvh.InstanceCount());
+
+	GOG::Pcg32 random(seed, 0);
+	unsigned int mismatches = 0;
+	unsigned int overCulled = 0;
+	unsigned long long records[3] = {};
+	unsigned long long bytes[3] = {};
+	unsigned long long draws[3] = {};
+	float recordMs[3] = {};
+	for (unsigned int camera = 0; camera < cameras; camera++)
+	{
+		GW::MATH::GMATRIXF world = checkCamera.rotation;
+		world.row4 = { random.NextFloat(-1.5f, 1.5f) * segmentWidth, checkCamera.y + random.NextFloat(-40.0f, 40.0f), checkCamera.z, 1.0f };
+		GW::MATH::GMATRIXF view, viewProjection;
+		GW::MATH::GMatrix::InverseF(world, view);
+		GW::MATH::GMatrix::MultiplyMatrixF(view, checkCamera.projection, viewProjection);
+		GOG::CullFrustum frustum = GOG::CullFrustumFromViewProjection(viewProjection.data);
+		float firstOffset = ((int)((world.row4.x + segmentWidth / 2) / segmentWidth) - 1) * segmentWidth;
+		scene.viewMatrix = view;
+		scene.projectionMatrix = checkCamera.projection;
+		scene.camPos = world.row4;
+
+		auto start = std::chrono::steady_clock::now();
+		walked.Reset();
+		GOG::PassDraws& pass = walked.passes[GOG::PIPELINE_LEVEL];
+		pass.scene = pass.uploads.Push(scene);
+		for (int segment = 0; segment < 3; segment++)
+		{
+			mesh.offset = firstOffset + segment * segmentWidth;
+			unsigned int rangeCount = levelData->instanceBvh.Cull(GOG::OffsetCullFrustum(frustum, mesh.offset), ranges.data());
+			for (unsigned int r = 0; r < rangeCount; r++)
+			{
+				const GOG::CullRange& range = ranges[r];
+				const LevelData::LevelModel& model = levelData->levelModels[levelData->levelInstances[range.group].modelIndex];
+				GOG::UploadWindow instance = pass.uploads.Push(GOG::PerInstanceData{ range.transformStart, 0, 0.0f, 0 });
+				walked.levelInstancesDrawn += range.count;
+				for (unsigned int msh = 0; msh < model.meshCount; msh++)
+				{
+					mesh.attribute = levelData->materials[msh + model.materialStart].attrib;
+					mesh.texID = levelData->textures[msh + model.materialStart].albedoIndex;
+					const H2B::Mesh& levelMesh = levelData->levelMeshes[msh + model.meshStart];
+					pass.draws.push_back({ pass.uploads.Push(mesh), instance, levelMesh.drawInfo.indexCount, range.count,
+						levelMesh.drawInfo.indexOffset + model.indexStart, static_cast<int>(model.vertexStart) });
+				}
+			}
+		}
+		auto split = std::chrono::steady_clock::now();
+		baked.Reset();
+		GOG::RecordLevelDraws(baked, stream, levelData->instanceBvh, frustum, firstOffset, segmentWidth, scene, ranges.data());
+		auto mergedStart = std::chrono::steady_clock::now();
+		merged.Reset();
+		GOG::RecordLevelDraws(merged, mergedStream, levelData->instanceBvh, frustum, firstOffset, segmentWidth, scene, ranges.data());
+		auto end = std::chrono::steady_clock::now();
+		recordMs[0] += std::chrono::duration<float, std::milli>(split - start).count();
+		recordMs[1] += std::chrono::duration<float, std::milli>(mergedStart - split).count();
+		recordMs[2] += std::chrono::duration<float, std::milli>(end - mergedStart).count();
+
+		// without merging the replay draws exactly what the walk did, with the same materials
+		const GOG::PassDraws& walkedPass = walked.passes[GOG::PIPELINE_LEVEL];
+		const GOG::PassDraws& bakedPass = baked.passes[GOG::PIPELINE_LEVEL];
+		bool same = walkedPass.draws.size() == bakedPass.draws.size() && walked.levelInstancesDrawn == baked.levelInstancesDrawn;
+		for (unsigned int i = 0; same && i < walkedPass.draws.size(); i++)
+		{
+			const GOG::DrawRecord& walkedDraw = walkedPass.draws[i];
+			const GOG::DrawRecord& bakedDraw = bakedPass.draws[i];
+			const GOG::MeshData& walkedMesh = walkedPass.uploads.Read<GOG::MeshData>(walkedDraw.mesh);
+			const GOG::MeshData& bakedMesh = bakedPass.uploads.Read<GOG::MeshData>(bakedDraw.mesh);
+			const GOG::PerInstanceData& bakedInstance = bakedPass.uploads.Read<GOG::PerInstanceData>(bakedDraw.instance);
+			same = walkedDraw.indexCount == bakedDraw.indexCount && walkedDraw.instanceCount == bakedDraw.instanceCount &&
+				walkedDraw.startIndex == bakedDraw.startIndex && walkedDraw.baseVertex == bakedDraw.baseVertex &&
+				walkedPass.uploads.Read<GOG::PerInstanceData>(walkedDraw.instance).transformStart == bakedInstance.transformStart &&
+				walkedMesh.offset == bakedInstance.segmentOffset && walkedMesh.texID == bakedMesh.texID &&
+				std::memcmp(&walkedMesh.attribute, &bakedMesh.attribute, sizeof(H2B::Attributes)) == 0;
+		}
+		if (same == false)
+			mismatches += 1;
+		// a batch is only culled when all of its instances are
+		if (merged.levelInstancesDrawn < walked.levelInstancesDrawn)
+			overCulled += 1;
+
+		const GOG::FrameDraws* frames[3] = { &walked, &baked, &merged };
+		for (int f = 0; f < 3; f++)
+		{
+			const GOG::PassDraws& framePass = frames[f]->passes[GOG::PIPELINE_LEVEL];
+			records[f] += framePass.uploads.GetStats().records;
+			bytes[f] += framePass.uploads.Used();
+			draws[f] += framePass.draws.size();
+		}
+	}
+
+	const GOG::LevelStreamStats& stats = stream.GetStats();
+	const GOG::LevelStreamStats& mergedStats = mergedStream.GetStats();
+	std::cout << "Baked " << stats.groups << " instance groups into " << stats.draws << " draws of " << stats.materials
+		<< " materials in " << bakeMs << " ms" << std::endl;
+	std::cout << "Merged " << mergedStats.mergedInstances << " instances into " << mergedStats.mergedBatches << " batches, "
+		<< mergedStats.mergedVertices << " more vertices, in " << mergedBakeMs << " ms" << std::endl;
+	if (cameras > 0)
+	{
+		const char* names[3] = { "walked", "baked", "merged" };
+		for (int f = 0; f < 3; f++)
+		{
+			std::cout << names[f] << "  " << draws[f] / cameras << " draws, " << records[f] / cameras << " records pushed, "
+				<< bytes[f] / cameras / 1024 << " KB uploaded, " << recordMs[f] / cameras << " ms per frame" << std::endl;
+		}
+	}
+	levelData->UnloadLevel();
+	if (failures > 0)
+		return Fail(std::to_string(failures) + " materials differed once merged");
+	if (mismatches > 0 || overCulled > 0)
+		return Fail(std::to_string(mismatches) + " cameras replayed differently, " + std::to_string(overCulled) + " culled merged instances in view");
+	return Pass();
+}
+
+std::unique_ptr<GOG::HeadlessCheck> GOG::CreateLevelStreamCheck()
+{
+	return std::make_unique<LevelStreamCheck>();
+}
@@ -0,0 +1,167 @@
+#include "HeadlessCheck.h"
+#include "../Utils/LightBinning.h"
+#include "../Utils/Random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	// Bins the level's lights plus random point and spot lights around the player's path from
+	// random camera positions, at the window size and [Renderer] lightTileSize, once with the SIMD
+	// binning and once testing every light's sphere against every tile's frustum. Also projects
+	// random points inside every point light's reach and checks their tile lists the light. Fails
+	// if a tile misses a light the frustum test puts in it or a point's tile misses its light.
+	class LightBinCheck : public GOG::HeadlessCheck
+	{
+	public:
+		const char* Name() const override { return "light-bin-check"; }
+		const char* Arguments() const override { return "[cameras] [lights] [seed]"; }
+		GOG::CHECK_RESULT Run(const std::vector<std::string>& _args) override;
+	};
+}
+
+GOG::CHECK_RESULT LightBinCheck::Run(const std::vector<std::string>& _args)
+{
+	unsigned int cameras = static_cast<unsigned int>(Argument(_args, 0, 200));
+	unsigned int lightCount = static_cast<unsigned int>(Argument(_args, 1, 512));
+	unsigned long long seed = Argument(_args, 2, 1);
+
+	GameConfig gameConfig;
+	GW::SYSTEM::GLog log;
+	std::unique_ptr<LevelData> levelData = std::make_unique<LevelData>();
+	if (LoadCheckLevel(*levelData, log) == false)
+		return GOG::CHECK_ERROR;
+	GOG::CheckCamera checkCamera = LoadCheckCamera(gameConfig);
+	float width = checkCamera.width;
+	float height = checkCamera.height;
+	const float nearPlane = checkCamera.nearPlane;
+	const GW::MATH::GMATRIXF& projection = checkCamera.projection;
+	unsigned int tileSize = gameConfig.at("Renderer").at("lightTileSize").as<unsigned int>();
+
+	// the level's own lights first, like the renderer, then the random ones along the player's path
+	GOG::Pcg32 random(seed, 0);
+	std::vector<H2B::Light> lights = levelData->sceneLights;
+	for (unsigned int i = 0; i < lightCount; i++)
+	{
+		H2B::Light light = {};
+		light.world = GW::MATH::GIdentityMatrixF;
+		light.worldPos = { random.NextFloat(-250.0f, 250.0f), checkCamera.y + random.NextFloat(-60.0f, 60.0f), random.NextFloat(checkCamera.z + 10.0f, 60.0f),
+			i % 10 == 9 ? static_cast<float>(GOG::LIGHT_BIN_SPOT) : static_cast<float>(GOG::LIGHT_BIN_POINT) };
+		light.color = { 1, 1, 1, 0 };
+		light.direction = { 0, -1, 0, 0 };
+		light.radius = random.NextFloat(2.0f, 20.0f);
+		lights.push_back(light);
+	}
+	GOG::LightBins bins;
+	bins.Create(tileSize);
+	bins.SetLights(static_cast<unsigned int>(lights.size()));
+	for (unsigned int i = 0; i < lights.size(); i++)
+		bins.SetLight(i, &lights[i].worldPos.x, lights[i].worldPos.w, lights[i].radius);
+
+	std::vector<unsigned int> bruteData;
+	unsigned int mismatches = 0;
+	unsigned int misses = 0;
+	unsigned long long samples = 0;
+	unsigned long long visible = 0;
+	unsigned long long indices = 0;
+	unsigned long long referenceIndices = 0;
+	unsigned int maxPerTile = 0;
+	float binMs = 0;
+	float bruteMs = 0;
+	for (unsigned int camera = 0; camera < cameras; camera++)
+	{
+		GW::MATH::GMATRIXF world = checkCamera.rotation;
+		world.row4 = { random.NextFloat(-200.0f, 200.0f), checkCamera.y + random.NextFloat(-40.0f, 40.0f), checkCamera.z, 1.0f };
+		GW::MATH::GMATRIXF view, viewProjection;
+		GW::MATH::GMatrix::InverseF(world, view);
+		GW::MATH::GMatrix::MultiplyMatrixF(view, projection, viewProjection);
+
+		GOG::LightBinCamera lightCamera{};
+		std::copy(view.data, view.data + 16, lightCamera.view);
+		lightCamera.scaleX = projection.data[0];
+		lightCamera.scaleY = projection.data[5];
+		lightCamera.nearZ = nearPlane;
+		lightCamera.width = width;
+		lightCamera.height = height;
+
+		auto start = std::chrono::steady_clock::now();
+		bins.Bin(lightCamera);
+		auto split = std::chrono::steady_clock::now();
+		bins.BinBruteForce(lightCamera, bruteData);
+		auto end = std::chrono::steady_clock::now();
+		binMs += std::chrono::duration<float, std::milli>(split - start).count();
+		bruteMs += std::chrono::duration<float, std::milli>(end - split).count();
+
+		// both list a tile's lights in the order they were set, so a sorted includes compares them
+		const unsigned int* data = bins.Data();
+		unsigned int tileCount = bins.TilesX() * bins.TilesY();
+		for (unsigned int tile = 0; tile < tileCount; tile++)
+		{
+			const unsigned int* binned = data + data[tile * 2];
+			const unsigned int* reference = bruteData.data() + bruteData[tile * 2];
+			if (std::includes(binned, binned + data[tile * 2 + 1], reference, reference + bruteData[tile * 2 + 1]) == false)
+			{
+				if (mismatches == 0)
+					std::cout << "camera " << camera << " at x " << world.row4.x << ": tile " << tile % bins.TilesX() << ", "
+						<< tile / bins.TilesX() << " misses a light its frustum touches" << std::endl;
+				mismatches += 1;
+			}
+		}
+		referenceIndices += bruteData.size() - tileCount * 2;
+		const GOG::LightBinStats& stats = bins.GetStats();
+		visible += stats.visible;
+		indices += stats.indices;
+		maxPerTile = std::max(maxPerTile, stats.maxPerTile);
+
+		// points the shader would light have to land in a tile listing the light
+		const float* m = viewProjection.data;
+		for (unsigned int i = 0; i < lights.size(); i++)
+		{
+			if (lights[i].worldPos.w != GOG::LIGHT_BIN_POINT)
+				continue;
+			float reach = (lights[i].radius + 1) * 0.999f;
+			for (unsigned int sample = 0; sample < 8; sample++)
+			{
+				float offset[3] = { random.NextFloat(-reach, reach), random.NextFloat(-reach, reach), random.NextFloat(-reach, reach) };
+				if (offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] > reach * reach)
+					continue;
+				float point[3] = { lights[i].worldPos.x + offset[0], lights[i].worldPos.y + offset[1], lights[i].worldPos.z + offset[2] };
+				float clip[4];
+				for (int column = 0; column < 4; column++)
+					clip[column] = point[0] * m[column] + point[1] * m[4 + column] + point[2] * m[8 + column] + m[12 + column];
+				// behind the near plane or off screen, nothing is drawn there
+				if (clip[3] <= nearPlane || clip[2] < 0 || std::fabs(clip[0]) > clip[3] || std::fabs(clip[1]) > clip[3])
+					continue;
+				unsigned int tileX = std::min(static_cast<unsigned int>((clip[0] / clip[3] * 0.5f + 0.5f) * width) / tileSize, bins.TilesX() - 1);
+				unsigned int tileY = std::min(static_cast<unsigned int>((0.5f - clip[1] / clip[3] * 0.5f) * height) / tileSize, bins.TilesY() - 1);
+				unsigned int tile = tileY * bins.TilesX() + tileX;
+				samples += 1;
+				if (std::find(data + data[tile * 2], data + data[tile * 2] + data[tile * 2 + 1], i) == data + data[tile * 2] + data[tile * 2 + 1])
+				{
+					if (misses == 0)
+						std::cout << "camera " << camera << ": light " << i << " missing from tile " << tileX << ", " << tileY << std::endl;
+					misses += 1;
+				}
+			}
+		}
+	}
+
+	std::cout << "Binned " << bins.LightCount() << " lights (" << levelData->sceneLights.size() << " from the level) into "
+		<< bins.TilesX() << "x" << bins.TilesY() << " tiles of " << bins.TileSize() << " pixels, "
+		<< (cameras > 0 ? visible / cameras : 0) << " in view and " << (cameras > 0 ? indices / cameras : 0)
+		<< " tile indices on average (" << (cameras > 0 ? referenceIndices / cameras : 0) << " from the frustum test), at most "
+		<< maxPerTile << " in a tile" << std::endl;
+	std::cout << "binning " << (cameras > 0 ? binMs / cameras : 0) << " ms, brute force " << (cameras > 0 ? bruteMs / cameras : 0)
+		<< " ms per camera, " << samples << " lit points checked" << std::endl;
+	levelData->UnloadLevel();
+	if (mismatches > 0 || misses > 0)
+		return Fail(std::to_string(mismatches) + " tiles missed a light, " + std::to_string(misses) + " lit points missed their light");
+	return Pass();
+}
+
+std::unique_ptr<GOG::HeadlessCheck> GOG::CreateLightBinCheck()
+{
+	return std::make_unique<LightBinCheck>();
+}
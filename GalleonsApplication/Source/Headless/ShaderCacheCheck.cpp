@@ -0,0 +1,107 @@
+#include "HeadlessCheck.h"
+#include "../Utils/ShaderCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	// Checks the shader cache's keys and files without a device or a compiler: every shader's key
+	// is the same twice over and changes with its source, flags and target, a stored blob loads
+	// back byte for byte, an edited source misses and storing it removes the stale blob. Works in
+	// a scratch directory under the one given, which is removed afterwards.
+	class ShaderCacheCheck : public GOG::HeadlessCheck
+	{
+	public:
+		const char* Name() const override { return "shader-cache-check"; }
+		const char* Arguments() const override { return "[scratch directory]"; }
+		GOG::CHECK_RESULT Run(const std::vector<std::string>& _args) override;
+	};
+}
+
+GOG::CHECK_RESULT ShaderCacheCheck::Run(const std::vector<std::string>& _args)
+{
+	std::string directory = Argument(_args, 0, std::filesystem::temp_directory_path().string());
+
+	// the shaders and profiles DirectX11Renderer::LoadShaders asks the cache for
+	const char* const shaders[][2] = { { "VertexShader", "vs_5_0" }, { "VSMap", "vs_5_0" }, { "VSLevelShader", "vs_5_0" },
+		{ "PixelShader", "ps_5_0" }, { "PSMap", "ps_5_0" }, { "PSColorMapModels", "ps_5_0" } };
+	// D3DCOMPILE_ENABLE_STRICTNESS and D3DCOMPILE_DEBUG, without the d3dcompiler header
+	const unsigned int strictFlags = 1u << 11;
+	const unsigned int debugFlags = strictFlags | 1u;
+
+	std::string scratch = (std::filesystem::path(directory) / "ShaderCacheCheck").string();
+	std::error_code error;
+	std::filesystem::remove_all(scratch, error);
+	GOG::ShaderCache cache;
+	if (cache.Create(scratch) == false)
+	{
+		std::cout << "can't create " << scratch << std::endl;
+		return GOG::CHECK_ERROR;
+	}
+
+	unsigned int failures = 0;
+	auto check = [&failures](bool _passed, const char* _shader, const char* _what)
+		{
+			if (_passed == false)
+			{
+				std::cout << _shader << ": " << _what << std::endl;
+				failures += 1;
+			}
+		};
+
+	for (const auto& shader : shaders)
+	{
+		std::ifstream file(std::string("../Shaders/") + shader[0] + ".hlsl", std::ios::binary);
+		if (!file.is_open())
+		{
+			check(false, shader[0], "can't read the source");
+			continue;
+		}
+		std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		const char* otherTarget = shader[1][0] == 'v' ? "ps_5_0" : "vs_5_0";
+
+		unsigned long long key = GOG::ShaderCacheKey(source, shader[1], "main", strictFlags);
+		check(key == GOG::ShaderCacheKey(source, shader[1], "main", strictFlags), shader[0], "key isn't deterministic");
+		check(key != GOG::ShaderCacheKey(source + " ", shader[1], "main", strictFlags), shader[0], "key ignores the source");
+		check(key != GOG::ShaderCacheKey(source, shader[1], "main", debugFlags), shader[0], "key ignores the flags");
+		check(key != GOG::ShaderCacheKey(source, otherTarget, "main", strictFlags), shader[0], "key ignores the target");
+
+		// the source stands in for bytecode, the cache only moves bytes around
+		std::vector<unsigned char> loaded;
+		check(cache.Load(shader[0], key, loaded) == false, shader[0], "hit before anything was stored");
+		check(cache.Store(shader[0], key, source.data(), source.size()), shader[0], "can't store");
+		check(cache.Load(shader[0], key, loaded) && loaded.size() == source.size() &&
+			std::equal(loaded.begin(), loaded.end(), source.begin(), [](unsigned char _a, char _b) { return _a == static_cast<unsigned char>(_b); }),
+			shader[0], "blob didn't load back as stored");
+
+		// an edited shader misses, and compiling it again replaces the stale blob
+		std::string edited = source + "\n// edited\n";
+		unsigned long long editedKey = GOG::ShaderCacheKey(edited, shader[1], "main", strictFlags);
+		check(cache.Load(shader[0], editedKey, loaded) == false, shader[0], "edited source hit the old blob");
+		check(cache.Store(shader[0], editedKey, edited.data(), edited.size()), shader[0], "can't store the edited blob");
+		check(std::filesystem::exists(cache.BlobPath(shader[0], key)) == false, shader[0], "stale blob wasn't removed");
+		check(cache.Load(shader[0], editedKey, loaded) && loaded.size() == edited.size(), shader[0], "edited blob didn't load back");
+	}
+
+	// every shader still has its own blob, storing one never pruned another
+	unsigned int blobs = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(scratch, error))
+		blobs += entry.path().extension() == ".cso";
+	check(blobs == sizeof(shaders) / sizeof(shaders[0]), "cache", "a shader's blob was removed by another shader");
+
+	const GOG::ShaderCacheStats& stats = cache.GetStats();
+	std::cout << "Shader cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.stores << " stores, "
+		<< stats.pruned << " pruned" << std::endl;
+	std::filesystem::remove_all(scratch, error);
+	if (failures > 0)
+		return Fail(std::to_string(failures) + " checks failed");
+	return Pass();
+}
+
+std::unique_ptr<GOG::HeadlessCheck> GOG::CreateShaderCacheCheck()
+{
+	return std::make_unique<ShaderCacheCheck>();
+}
@@ -0,0 +1,769 @@
+#include "HeadlessApplication.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <thread>
+
+bool HeadlessApplication::Init(unsigned long long _seed)
+{
+	// load all game settigns
+	gameConfig = std::make_shared<GameConfig>();
+	// create the ECS system
+	flecsWorld = std::make_shared<flecs::world>();
+	// the command line seed wins over the config, 0 in both means pick a fresh one
+	unsigned long long worldSeed = _seed;
+	if (worldSeed == 0)
+		worldSeed = gameConfig->at("Game").at("seed").as<unsigned int>();
+	if (worldSeed == 0)
+	{
+		std::random_device seedDevice;
+		worldSeed = (static_cast<unsigned long long>(seedDevice()) << 32) | seedDevice();
+	}
+	flecsWorld->set<GOG::WorldSeed>({ worldSeed });
+	gameCommands.Create(flecsWorld, "MergeCommandBuffers");
+	frameArena.Create(gameConfig->at("Memory").at("frameArenaKB").as<unsigned int>() * 1024);
+	flecsWorld->set<GOG::FrameScratch>({ &frameArena });
+	std::cout << "Headless seed " << worldSeed << std::endl;
+	if (gameConfig->at("Profiler").at("captureOnStart").as<int>() != 0)
+		GOG::Profiler::Get().StartCapture(gameConfig->at("Profiler").at("captureFrames").as<unsigned int>(),
+			gameConfig->at("Profiler").at("captureFile").as<std::string>());
+
+	actorData = std::make_unique<ActorData>();
+	if (actorData->LoadActors("../GameModels/ActorModels/Models/", log) == false)
+		return false;
+
+	// no sound device, clips are never loaded and queued commands are dropped
+	audioData.Init("../SoundFX", "../Music", nullptr);
+	flecsWorld->set<GOG::AudioQueue>({ audioData.GetCommandQueue() });
+
+	if (InitActorPrefabs(actorData.get()) == false)
+		return false;
+
+	// nothing is pressed unless a replay says so, the empty pad proxy never vibrates
+	if (simulation.Init(flecsWorld,
+		gameConfig,
+		GW::INPUT::GController(),
+		GW::AUDIO::GAudio(),
+		&audioData,
+		&eventBus,
+		&gameCommands,
+		&frameClock) == false)
+		return false;
+	if (recorder.Init(&simulation, &eventBus, gameConfig) == false)
+		return false;
+
+	eventBus.Subscribe(GOG::PLAY_EVENT::GAME_OVER, [this](GOG::PLAY_EVENT _event, GOG::PLAY_EVENT_DATA _data)
+		{
+			gameOver = true;
+		});
+
+	return true;
+}
+
+bool HeadlessApplication::Run(unsigned int _ticks, const GOG::WorldSnapshot* _from)
+{
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	if (simulation.Start() == false)
+		return false;
+	if (_from != nullptr && simulation.Restore(*_from) == false)
+	{
+		std::cout << "couldn't restore the snapshot" << std::endl;
+		return false;
+	}
+	sessions = 1;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int tick = 0; tick < _ticks; tick++)
+	{
+		PROFILE_ZONE("Tick");
+		float elapsedTime = frameClock.TickFixed(TICK_SECONDS);
+		flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+
+		if (flecsWorld->progress(elapsedTime) == false)
+			return false;
+		eventBus.Dispatch();
+		audioData.ProcessCommands();
+		frameArena.EndFrame();
+		PROFILE_FRAME();
+
+		// nobody is steering, so keep the world busy by starting over like the game over screen would
+		if (gameOver)
+		{
+			gameOver = false;
+			simulation.Stop();
+			if (simulation.Start() == false)
+				return false;
+			sessions += 1;
+		}
+	}
+	float wallMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Headless ran " << _ticks << " ticks (" << frameClock.SimNow() << " ms simulated) in "
+		<< wallMs << " ms, " << (_ticks > 0 ? wallMs / _ticks : 0) << " ms per tick, "
+		<< sessions << " sessions" << std::endl;
+
+	return true;
+}
+
+bool HeadlessApplication::Replay(const GOG::InputLog& _log, bool _realTime, const std::string& _timingFile)
+{
+	const std::vector<GOG::InputLogTick>& ticks = _log.Ticks();
+
+	// the session starts on the recorded simulation time, timers are relative to it
+	GOG::SimClock clock = { 0, _log.StartNow(), 0 };
+	flecsWorld->set<GOG::SimClock>(clock);
+	if (simulation.Start() == false)
+		return false;
+
+	std::vector<float> tickMs(ticks.size());
+	long long divergedAt = -1;
+
+	auto start = std::chrono::steady_clock::now();
+	double recordedMs = 0;
+	for (size_t i = 0; i < ticks.size(); i++)
+	{
+		const GOG::InputLogTick& tick = ticks[i];
+		clock.frame = i;
+		clock.now += tick.simStep;
+		clock.deltaTime = tick.deltaTime;
+		flecsWorld->set<GOG::SimClock>(clock);
+		flecsWorld->set<GOG::InputFrame>(tick.input);
+
+		auto tickStart = std::chrono::steady_clock::now();
+		{
+			PROFILE_ZONE("Tick");
+			if (flecsWorld->progress(tick.deltaTime) == false)
+				return false;
+			eventBus.Dispatch();
+			audioData.ProcessCommands();
+			frameArena.EndFrame();
+		}
+		PROFILE_FRAME();
+		tickMs[i] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
+
+		if (divergedAt < 0 && simulation.Checksum() != tick.checksum)
+		{
+			divergedAt = static_cast<long long>(i);
+			std::cout << "Replay diverged from the recording on tick " << i << std::endl;
+		}
+
+		if (_realTime)
+		{
+			recordedMs += tick.deltaTime * 1000.0;
+			std::this_thread::sleep_until(start + std::chrono::duration<double, std::milli>(recordedMs));
+		}
+	}
+
+	std::ofstream timing(_timingFile, std::ios::trunc);
+	timing << "tick,ms,matches\n";
+	for (size_t i = 0; i < tickMs.size(); i++)
+		timing << i << "," << tickMs[i] << "," << (divergedAt < 0 || static_cast<long long>(i) < divergedAt) << "\n";
+
+	if (!tickMs.empty())
+	{
+		std::vector<float> sorted = tickMs;
+		std::sort(sorted.begin(), sorted.end());
+		float total = 0;
+		for (float ms : sorted)
+			total += ms;
+		size_t worst = std::max_element(tickMs.begin(), tickMs.end()) - tickMs.begin();
+		std::cout << "Replayed " << ticks.size() << " ticks, avg " << total / sorted.size() << " ms, p99 "
+			<< sorted[(sorted.size() - 1) * 99 / 100] << " ms, worst " << sorted.back() << " ms on tick "
+			<< worst << ", timings in " << _timingFile << std::endl;
+	}
+	if (divergedAt >= 0)
+		return false;
+
+	std::cout << "Replay matched the recording on every tick" << std::endl;
+	return true;
+}
+
+bool HeadlessApplication::Bench(unsigned int _perType, unsigned int _samples, const std::string& _resultsFile)
+{
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	if (_samples == 0 || simulation.Start() == false)
+		return false;
+	// one tick so the session's own setup has merged before the bench actors join it
+	frameClock.TickFixed(TICK_SECONDS);
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	if (flecsWorld->progress(TICK_SECONDS) == false)
+		return false;
+	eventBus.Dispatch();
+	SpawnBenchActors(_perType);
+
+	// every sample starts from this world, so they all do the same work
+	GOG::WorldSnapshot layout;
+	simulation.Capture(layout);
+	auto startSample = [this, &layout]()
+		{
+			if (simulation.Restore(layout) == false)
+				return false;
+			frameClock.TickFixed(TICK_SECONDS);
+			flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+			return true;
+		};
+
+	// every system that is switched on, in the order they were created
+	std::vector<flecs::entity> systems;
+	flecs::query<> systemQuery = flecsWorld->query_builder<>().term(flecs::System).build();
+	systemQuery.each([&systems](flecs::entity _system)
+		{
+			if (_system.has(flecs::Disabled) == false)
+				systems.push_back(_system);
+		});
+	systemQuery.destruct();
+
+	std::vector<std::vector<float>> systemUs(systems.size(), std::vector<float>(_samples));
+	std::vector<float> tickUs(_samples);
+
+	for (unsigned int sample = 0; sample < _samples; sample++)
+	{
+		if (startSample() == false)
+			return false;
+		for (size_t i = 0; i < systems.size(); i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			ecs_run(flecsWorld->c_ptr(), systems[i].id(), TICK_SECONDS, nullptr);
+			systemUs[i][sample] = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+		}
+		eventBus.Dispatch();
+		audioData.ProcessCommands();
+		frameArena.EndFrame();
+	}
+
+	for (unsigned int sample = 0; sample < _samples; sample++)
+	{
+		if (startSample() == false)
+			return false;
+		auto start = std::chrono::steady_clock::now();
+		if (flecsWorld->progress(TICK_SECONDS) == false)
+			return false;
+		eventBus.Dispatch();
+		audioData.ProcessCommands();
+		frameArena.EndFrame();
+		tickUs[sample] = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+	gameOver = false;
+
+	bool newFile = std::ifstream(_resultsFile).good() == false;
+	std::ofstream results(_resultsFile, std::ios::app);
+	if (newFile)
+		results << "perType,samples,system,avgUs,p50Us,p99Us,maxUs\n";
+	auto report = [&](const std::string& _name, std::vector<float>& _us)
+		{
+			std::sort(_us.begin(), _us.end());
+			float total = 0;
+			for (float us : _us)
+				total += us;
+			results << _perType << "," << _samples << "," << _name << "," << total / _us.size() << ","
+				<< _us[(_us.size() - 1) / 2] << "," << _us[(_us.size() - 1) * 99 / 100] << "," << _us.back() << "\n";
+			std::cout << _name << ": avg " << total / _us.size() << " us, p99 " << _us[(_us.size() - 1) * 99 / 100] << " us" << std::endl;
+		};
+	for (size_t i = 0; i < systems.size(); i++)
+		report(systems[i].name().size() > 0 ? systems[i].name().c_str() : "#" + std::to_string(systems[i].id()), systemUs[i]);
+	report("tick", tickUs);
+
+	std::cout << "Benched " << _perType << " actors per type over " << _samples << " samples, results in "
+		<< _resultsFile << std::endl;
+	return results.good();
+}
+
+bool HeadlessApplication::LoadBench(unsigned int _warmRuns, const std::string& _resultsFile)
+{
+	const char* levelFile = "../GameModels/Levels/SpaceLevel/GameLevel.txt";
+	const char* levelModels = "../GameModels/Levels/SpaceLevel/Models";
+
+	gameConfig = std::make_shared<GameConfig>();
+	// prefabs look their sounds up, without a device that is all they need
+	audioData.Init("../SoundFX", "../Music", nullptr);
+
+	// bigger levels made from the real one, not part of any measurement
+	float spacing = gameConfig->at("Game").at("levelSegmentWidth").as<float>();
+	std::filesystem::path tempFolder = std::filesystem::temp_directory_path();
+	std::string level10x = (tempFolder / "GalleonsLevel_10x.txt").string();
+	std::string level100x = (tempFolder / "GalleonsLevel_100x.txt").string();
+	if (WriteScaledLevel(levelFile, level10x, 10, spacing) == false ||
+		WriteScaledLevel(levelFile, level100x, 100, spacing) == false)
+	{
+		std::cout << "couldn't write the scaled levels to " << tempFolder.string() << std::endl;
+		return false;
+	}
+
+	bool newFile = std::ifstream(_resultsFile).good() == false;
+	std::ofstream results(_resultsFile, std::ios::app);
+	if (newFile)
+		results << "stage,pass,run,ms,allocations,allocatedBytes,peakResidentBytes\n";
+
+	auto measure = [&results](const char* _stage, unsigned int _run, const std::function<bool()>& _load)
+		{
+			GOG::AllocationCounters before = GOG::GetAllocationCounters();
+			auto start = std::chrono::steady_clock::now();
+			bool loaded = _load();
+			float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			GOG::AllocationCounters after = GOG::GetAllocationCounters();
+			size_t peakBytes = GOG::GetPeakResidentBytes();
+
+			const char* pass = (_run == 0) ? "cold" : "warm";
+			results << _stage << "," << pass << "," << _run << "," << ms << "," << after.count - before.count << ","
+				<< after.bytes - before.bytes << "," << peakBytes << "\n";
+			std::cout << _stage << " (" << pass << "): " << ms << " ms, " << after.count - before.count << " allocations, "
+				<< (after.bytes - before.bytes) / 1024 << " KB, peak resident " << peakBytes / (1024 * 1024) << " MB" << std::endl;
+			return loaded;
+		};
+
+	// the first run of each stage is the first time this process reads those files
+	for (unsigned int run = 0; run <= _warmRuns; run++)
+	{
+		if (measure("LoadActors", run, [this]()
+			{
+				actorData = std::make_unique<ActorData>();
+				return actorData->LoadActors("../GameModels/ActorModels/Models/", log);
+			}) == false)
+			return false;
+
+		const std::pair<const char*, std::string> levels[] =
+		{
+			{ "LoadLevel", levelFile },
+			{ "LoadLevel10x", level10x },
+			{ "LoadLevel100x", level100x }
+		};
+		for (const auto& level : levels)
+		{
+			if (measure(level.first, run, [this, &level, levelModels]()
+				{
+					std::unique_ptr<LevelData> levelData = std::make_unique<LevelData>();
+					return levelData->LoadLevel(level.second.c_str(), levelModels, log);
+				}) == false)
+				return false;
+		}
+
+		if (measure("InitActorPrefabs", run, [this]()
+			{
+				flecsWorld = std::make_shared<flecs::world>();
+				return InitActorPrefabs(actorData.get());
+			}) == false)
+			return false;
+		playerData.Unload(flecsWorld);
+		enemyData.Unload(flecsWorld);
+		projectileData.Unload(flecsWorld);
+		pickupData.Unload(flecsWorld);
+		flecsWorld.reset();
+	}
+
+	std::filesystem::remove(level10x);
+	std::filesystem::remove(level100x);
+	std::cout << "Load timings appended to " << _resultsFile << std::endl;
+	return results.good();
+}
+
+bool HeadlessApplication::AllocCheck(unsigned int _warmupTicks, unsigned int _ticks)
+{
+	// the input log has room for the whole check, the game makes room for [Replay] reserveTicks
+	recorder.RecordEverything(ALLOCATION_RING_SIZE, _warmupTicks + _ticks);
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	recorder.Begin(flecsWorld->get<GOG::WorldSeed>()->value, frameClock.SimNow());
+	if (simulation.Start() == false)
+		return false;
+	sessions = 1;
+
+	// filled in place while checking, anything that allocates here would be charged to the next tick
+	struct AllocatingTick
+	{
+		unsigned int tick;
+		GOG::AllocationCounters total;
+		const char* worstScope;
+	};
+	AllocatingTick reportedTicks[MAX_REPORTED_TICKS];
+	GOG::AllocationScopeCounters scopeTotals[GOG::MAX_ALLOCATION_SCOPES];
+	unsigned int scopeTotalCount = 0;
+	unsigned int allocatingTicks = 0;
+	unsigned int checkedTicks = 0;
+	GOG::AllocationCounters checkedTotal = {};
+	GOG::FrameAllocations allocations;
+
+	unsigned int measureFrom = _warmupTicks;
+	for (unsigned int tick = 0; tick < _warmupTicks + _ticks; tick++)
+	{
+		if (tick == measureFrom)
+		{
+			allocations.Reset();
+			GOG::StartAllocationSampling(ALLOCATION_SAMPLE_INTERVAL);
+		}
+
+		{
+			PROFILE_ZONE("Tick");
+			float elapsedTime = frameClock.TickFixed(TICK_SECONDS);
+			flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+
+			if (flecsWorld->progress(elapsedTime) == false)
+				return false;
+			eventBus.Dispatch();
+			recorder.Tick(*flecsWorld->get<GOG::InputFrame>(), frameClock.DeltaTime(), frameClock.SimNow());
+			audioData.ProcessCommands();
+			frameArena.EndFrame();
+		}
+		PROFILE_FRAME();
+
+		if (tick >= measureFrom)
+		{
+			allocations.EndFrame();
+			checkedTicks += 1;
+			const GOG::AllocationCounters& total = allocations.Total();
+			if (total.count > 0)
+			{
+				if (allocatingTicks < MAX_REPORTED_TICKS)
+					reportedTicks[allocatingTicks] = { tick, total, allocations.Scope(0).name };
+				allocatingTicks += 1;
+				checkedTotal.count += total.count;
+				checkedTotal.bytes += total.bytes;
+
+				for (unsigned int i = 0; i < allocations.ScopeCount(); i++)
+				{
+					const GOG::AllocationScopeCounters& scope = allocations.Scope(i);
+					unsigned int slot = 0;
+					while (slot < scopeTotalCount && scopeTotals[slot].name != scope.name)
+						slot++;
+					if (slot == scopeTotalCount)
+						scopeTotals[scopeTotalCount++] = { scope.name, 0, 0 };
+					scopeTotals[slot].count += scope.count;
+					scopeTotals[slot].bytes += scope.bytes;
+				}
+			}
+		}
+
+		// a new session loads its wave from scratch, that is not a steady state frame
+		if (gameOver)
+		{
+			GOG::StopAllocationSampling();
+			gameOver = false;
+			simulation.Stop();
+			recorder.Begin(flecsWorld->get<GOG::WorldSeed>()->value, frameClock.SimNow());
+			if (simulation.Start() == false)
+				return false;
+			sessions += 1;
+			// the stop is merged on the next tick
+			measureFrom = tick + 2;
+		}
+	}
+	GOG::StopAllocationSampling();
+
+	std::cout << "Checked " << checkedTicks << " ticks after " << _warmupTicks << " warmup ticks over "
+		<< sessions << " sessions, " << allocatingTicks << " allocated" << std::endl;
+	std::cout << "Frame arena high water " << frameArena.GetStats().highWaterBytes << " bytes, "
+		<< frameArena.GetStats().overflows << " overflows" << std::endl;
+	if (allocatingTicks == 0)
+	{
+		std::cout << "Allocation check passed" << std::endl;
+		return true;
+	}
+
+	std::cout << checkedTotal.count << " allocations, " << checkedTotal.bytes << " bytes" << std::endl;
+	std::sort(scopeTotals, scopeTotals + scopeTotalCount, [](const GOG::AllocationScopeCounters& _a, const GOG::AllocationScopeCounters& _b)
+		{
+			return _a.count > _b.count;
+		});
+	for (unsigned int i = 0; i < scopeTotalCount; i++)
+		std::cout << "    " << scopeTotals[i].name << ": " << scopeTotals[i].count << " allocations, " << scopeTotals[i].bytes << " bytes" << std::endl;
+	for (unsigned int i = 0; i < std::min(allocatingTicks, MAX_REPORTED_TICKS); i++)
+		std::cout << "tick " << reportedTicks[i].tick << ": " << reportedTicks[i].total.count << " allocations, "
+			<< reportedTicks[i].total.bytes << " bytes, mostly in " << reportedTicks[i].worstScope << std::endl;
+	GOG::WriteAllocationSamples(std::cout);
+	std::cout << "Allocation check failed" << std::endl;
+	return false;
+}
+
+bool HeadlessApplication::RamCheck(unsigned int _maxTicks)
+{
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	if (simulation.Start() == false)
+		return false;
+
+	flecs::query<const GOG::Player, const GOG::Pose2D> playerQuery = flecsWorld->query<const GOG::Player, const GOG::Pose2D>();
+	flecs::query<const GOG::Lives> livesQuery = flecsWorld->query<const GOG::Lives>();
+	flecs::query<const GOG::Enemy, const GOG::Score> enemyQuery = flecsWorld->query<const GOG::Enemy, const GOG::Score>();
+	flecs::query<const GOG::Projectile> projectileQuery = flecsWorld->query<const GOG::Projectile>();
+	flecs::query<const GOG::Lazer> lazerQuery = flecsWorld->query<const GOG::Lazer>();
+	auto lives = [&livesQuery]()
+		{
+			return livesQuery.first().is_alive() ? livesQuery.first().get<GOG::Lives>()->count : 0;
+		};
+
+	// a wave with every batch merged in, while the player is alive with a life to spare
+	unsigned int tick = 0;
+	for (; tick < _maxTicks; tick++)
+	{
+		if (Tick() == false)
+			return false;
+		if (gameOver)
+		{
+			gameOver = false;
+			simulation.Stop();
+			if (simulation.Start() == false)
+				return false;
+			continue;
+		}
+		GOG::WaveProgress progress = simulation.GetWaveProgress();
+		if (progress.batchesPending == false && progress.living > 0 && progress.living == enemyQuery.count() &&
+			playerQuery.first().is_alive() && lives() > 1)
+			break;
+	}
+	if (tick == _maxTicks)
+	{
+		std::cout << "No wave was fully spawned within " << _maxTicks << " ticks" << std::endl;
+		return false;
+	}
+
+	// every enemy but one dies the way a shot kills it, nothing else in flight can get in the way
+	bool kept = false;
+	flecs::entity last;
+	flecsWorld->defer_begin();
+	enemyQuery.each([this, &kept, &last](flecs::entity _enemy, const GOG::Enemy&, const GOG::Score& _score)
+		{
+			if (kept == false)
+			{
+				kept = true;
+				last = _enemy;
+				return;
+			}
+			GOG::PLAY_EVENT_DATA data{};
+			data.value = _score.value;
+			data.directive = GOG::DIRECTIVES::UPDATE_SCORE_OK;
+			eventBus.Push(GOG::PLAY_EVENT::ENEMY_DESTROYED, data);
+			_enemy.destruct();
+		});
+	projectileQuery.each([](flecs::entity _projectile, const GOG::Projectile&) { _projectile.destruct(); });
+	lazerQuery.each([](flecs::entity _lazer, const GOG::Lazer&) { _lazer.destruct(); });
+	flecsWorld->defer_end();
+	eventBus.Dispatch();
+
+	GOG::WaveProgress before = simulation.GetWaveProgress();
+	unsigned int livesBefore = lives();
+	if (before.living != 1)
+	{
+		std::cout << "Ram check: " << before.living << " enemies counted alive with one left" << std::endl;
+		return false;
+	}
+
+	// the last enemy lands on the player, the collision happens on the next tick
+	const GOG::Pose2D* playerPose = playerQuery.first().get<GOG::Pose2D>();
+	GOG::Pose2D* enemyPose = last.get_mut<GOG::Pose2D>();
+	enemyPose->x = playerPose->x;
+	enemyPose->y = playerPose->y;
+	enemyPose->z = playerPose->z;
+	enemyPose->dirty = true;
+	if (Tick() == false)
+		return false;
+
+	GOG::WaveProgress after = simulation.GetWaveProgress();
+	std::cout << "Ram on wave " << before.wave << ": lives " << livesBefore << " -> " << lives()
+		<< ", wave " << before.wave << " -> " << after.wave << ", spawned " << before.spawned << " -> "
+		<< after.spawned << ", living " << before.living << " -> " << after.living << std::endl;
+	bool passed = lives() + 1 == livesBefore && after.wave == before.wave &&
+		after.spawned + 1 == before.spawned && after.living == 0 && after.batchesPending;
+	std::cout << (passed ? "Ram check passed" : "Ram check failed") << std::endl;
+	return passed;
+}
+
+bool HeadlessApplication::Tick()
+{
+	PROFILE_ZONE("Tick");
+	float elapsedTime = frameClock.TickFixed(TICK_SECONDS);
+	flecsWorld->set<GOG::SimClock>(frameClock.GetSimClock());
+	if (flecsWorld->progress(elapsedTime) == false)
+		return false;
+	eventBus.Dispatch();
+	audioData.ProcessCommands();
+	frameArena.EndFrame();
+	return true;
+}
+
+bool HeadlessApplication::WriteScaledLevel(const char* _source, const std::string& _target, unsigned int _copies, float _spacing)
+{
+	std::ifstream source(_source);
+	std::ofstream target(_target, std::ios::trunc);
+	if (!source.is_open() || !target.is_open())
+		return false;
+
+	// a MESH block is its name, four matrix rows and the bounds, the fourth row holds the position
+	std::vector<std::string> block;
+	auto flush = [&target, &block, _copies, _spacing]()
+		{
+			bool isMesh = block.size() > 5 && block[0] == "MESH";
+			GW::MATH::GVECTORF position = {};
+			if (isMesh == false || std::sscanf(block[5].c_str() + 13, "%f, %f, %f", &position.x, &position.y, &position.z) != 3)
+			{
+				for (const std::string& line : block)
+					target << line << "\n";
+				block.clear();
+				return;
+			}
+
+			char row[128];
+			for (unsigned int copy = 0; copy < _copies; copy++)
+			{
+				std::snprintf(row, sizeof(row), "            (%.4f, %.4f, %.4f, 1.0000)>", position.x + copy * _spacing, position.y, position.z);
+				for (size_t i = 0; i < block.size(); i++)
+					target << (i == 5 ? std::string(row) : block[i]) << "\n";
+			}
+			block.clear();
+		};
+
+	std::string line;
+	while (std::getline(source, line))
+	{
+		if (line == "MESH" || line == "LIGHT")
+			flush();
+		block.push_back(line);
+	}
+	flush();
+	return target.good();
+}
+
+bool HeadlessApplication::Shutdown()
+{
+	if (simulation.Shutdown() == false)
+		return false;
+
+	actorData.reset();
+
+	return true;
+}
+
+bool HeadlessApplication::InitActorPrefabs(ActorData* _actorData)
+{
+	unsigned int playerPrefabCount = 0;
+	unsigned int enemyPrefabCount = 0;
+	unsigned int projectilePrefabCount = 0;
+	unsigned int pickupPrefabCount = 0;
+	unsigned int modelIndex = 0;
+
+	// same prefab numbering as Application::InitActorPrefabs, gameplay looks prefabs up by name
+	for (auto& i : _actorData->models)
+	{
+		std::string fileName(i.fileName);
+
+		if (fileName.find("Player") != std::string::npos)
+		{
+			playerPrefabCount += 1;
+			playerData.Load(flecsWorld, gameConfig, playerPrefabCount, modelIndex, _actorData, i, audioData);
+		}
+		else if (fileName.find("Enemy") != std::string::npos)
+		{
+			enemyPrefabCount += 1;
+			enemyData.Load(flecsWorld, gameConfig, audioData, enemyPrefabCount, modelIndex, _actorData, i);
+		}
+		else if (fileName.find("Projectile") != std::string::npos)
+		{
+			projectilePrefabCount += 1;
+			projectileData.Load(flecsWorld, gameConfig, audioData, projectilePrefabCount, modelIndex, _actorData, i);
+		}
+		else if (fileName.find("Pickup") != std::string::npos)
+		{
+			pickupPrefabCount += 1;
+			pickupData.Load(flecsWorld, gameConfig, audioData, pickupPrefabCount, modelIndex, _actorData, i);
+		}
+
+		modelIndex += 1;
+	}
+
+	return true;
+}
+
+void HeadlessApplication::SpawnBenchActors(unsigned int _perType)
+{
+	float worldTop = gameConfig->at("Game").at("worldTopBoundry").as<float>();
+	float worldBottom = gameConfig->at("Game").at("worldBottomBoundry").as<float>();
+	float worldWidth = gameConfig->at("Game").at("worldWidth").as<float>();
+	GOG::SimTicks now = flecsWorld->get<GOG::SimClock>()->now;
+
+	// a layout of its own, so it is the same for a seed whatever the session spawned
+	GOG::Pcg32 layoutRandom;
+	layoutRandom.Seed(flecsWorld->get<GOG::WorldSeed>()->value, GOG::RANDOM_STREAM::BENCH_LAYOUT);
+
+	// the same components the spawners give each kind of actor, anywhere in the world
+	auto spawn = [&](flecs::entity _prefab)
+		{
+			GW::MATH::GVECTORF position = { layoutRandom.NextFloat(-worldWidth, worldWidth), layoutRandom.NextFloat(worldBottom, worldTop), 0, 1 };
+			return flecsWorld->entity().is_a(_prefab)
+				.add<GOG::Alive>()
+				.add<GOG::Collidable>()
+				.set<GOG::Pose2D>(GOG::SharedActorMethods::PoseAt(*_prefab.get<GOG::Pose2D>(), position));
+		};
+	auto randomVelocity = [&layoutRandom](float _speed)
+		{
+			GW::MATH::GVECTORF velocity = { layoutRandom.NextFloat(-1, 1), layoutRandom.NextFloat(-1, 1), 0, 0 };
+			GW::MATH::GVector::NormalizeF(velocity, velocity);
+			GW::MATH::GVector::ScaleF(velocity, _speed, velocity);
+			return GOG::Velocity{ velocity };
+		};
+
+	flecs::entity prefab;
+	if (flecsWorld->count<GOG::Player>() == 0 && GOG::RetreivePrefab("PlayerPrefab_1", prefab))
+		spawn(prefab).add<GOG::Player>().set<GOG::ControllerID>({ 0 });
+
+	// one enemy prefab per enemy type
+	for (unsigned int level = 1; GOG::RetreivePrefab(("EnemyPrefab_" + std::to_string(level)).c_str(), prefab); level++)
+	{
+		for (unsigned int i = 0; i < _perType; i++)
+		{
+			switch (prefab.get<GOG::EnemyType>()->type)
+			{
+			case GOG::ENEMY_TYPE::BOMBER:
+				spawn(prefab).add<GOG::Enemy>().add<GOG::Bomber>().set<GOG::Velocity>(randomVelocity(prefab.get<GOG::Speed>()->value));
+				break;
+			case GOG::ENEMY_TYPE::BAITER:
+			{
+				GOG::Cannon cannon = *prefab.get<GOG::Cannon>();
+				cannon.prevFireTime = now;
+				spawn(prefab).add<GOG::Enemy>().add<GOG::Baiter>().set<GOG::Cannon>(cannon);
+				break;
+			}
+			case GOG::ENEMY_TYPE::LANDER:
+			{
+				GOG::PeaShooter peaShooter = *prefab.get<GOG::PeaShooter>();
+				peaShooter.prevFireTime = now;
+				spawn(prefab).add<GOG::Enemy>().add<GOG::Lander>().set<GOG::PeaShooter>(peaShooter);
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+
+	if (GOG::RetreivePrefab(("PickupPrefab_" + std::to_string(GOG::PICKUP_TYPE::CIVILIAN)).c_str(), prefab))
+	{
+		for (unsigned int i = 0; i < _perType; i++)
+			spawn(prefab).add<GOG::Pickup>().add<GOG::Civilian>();
+	}
+
+	// projectiles are split evenly between the four kinds
+	for (unsigned int i = 0; i < _perType; i++)
+	{
+		unsigned int type = GOG::PROJECTILE_TYPE::CANNONBALL + i % 4;
+		if (GOG::RetreivePrefab(("ProjectilePrefab_" + std::to_string(type)).c_str(), prefab) == false)
+			continue;
+		switch (type)
+		{
+		case GOG::PROJECTILE_TYPE::CANNONBALL:
+			spawn(prefab).add<GOG::Projectile>().add<GOG::Cannonball>().set<GOG::Sender>({ GOG::SENDER::ENEMY });
+			break;
+		case GOG::PROJECTILE_TYPE::LAZER:
+			// the player's lazers aren't tagged as projectiles
+			spawn(prefab).add<GOG::Lazer>().set<GOG::Sender>({ GOG::SENDER::PLAYER });
+			break;
+		case GOG::PROJECTILE_TYPE::PEA:
+			spawn(prefab).add<GOG::Projectile>().add<GOG::Pea>().set<GOG::Sender>({ GOG::SENDER::ENEMY });
+			break;
+		case GOG::PROJECTILE_TYPE::TRAP:
+			spawn(prefab).add<GOG::Projectile>().add<GOG::Trap>().set<GOG::Sender>({ GOG::SENDER::ENEMY })
+				.set_override<GOG::Velocity>(randomVelocity(prefab.get<GOG::Speed>()->value));
+			break;
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#ifndef HEADLESS_APPLICATION_H
+#define HEADLESS_APPLICATION_H
+
+// include events
+#include "Events/Playevents.h"
+#include "Events/EventBus.h"
+// Contains our global game settings
+#include "GameConfig.h"
+#include "MemoryTracking.h"
+
+#include "Utils/AudioData.h"
+#include "Utils/ActorData.h"
+#include "Utils/LevelData.h"
+#include "Utils/FrameClock.h"
+#include "Utils/CommandBuffers.h"
+#include "Utils/FrameArena.h"
+#include "Utils/InputLog.h"
+#include "Utils/WorldSnapshot.h"
+#include "Utils/Profiler.h"
+
+// Load all entities+prefabs used by the game
+
+#include "Entities/PlayerData.h"
+#include "Entities/EnemyData.h"
+#include "Entities/ProjectileData.h"
+#include "Entities/PickupData.h"
+
+// Only the gameplay systems, nothing here needs a window, GPU or sound device
+#include "Systems/Simulation.h"
+#include "Systems/SessionRecorder.h"
+
+// Runs the gameplay world for a fixed number of ticks as fast as possible, with null renderer,
+// audio and input backends. The basis for profiling the simulation on machines without a GPU.
+class HeadlessApplication
+{
+	// fixed simulation step, the same rate the game is tuned for
+	static constexpr float TICK_SECONDS = 1.0f / 60.0f;
+	// one in this many allocations made during a checked tick keeps its call stack (debug builds)
+	static constexpr unsigned int ALLOCATION_SAMPLE_INTERVAL = 16;
+	// ticks that allocated, listed one by one after the allocation check
+	static constexpr unsigned int MAX_REPORTED_TICKS = 16;
+	// frames the allocation check keeps snapshots of, whatever [Snapshots] ringSize says
+	static constexpr unsigned int ALLOCATION_RING_SIZE = 8;
+
+	std::shared_ptr<flecs::world> flecsWorld; // ECS database for gameplay
+	std::shared_ptr<GameConfig> gameConfig; // .ini file game settings
+	GW::SYSTEM::GLog log;
+	// ECS Entities and Prefabs that need to be loaded
+
+	GOG::EnemyData	enemyData;
+	GOG::PlayerData playerData;
+	GOG::ProjectileData projectileData;
+	GOG::PickupData pickupData;
+
+	GOG::Simulation simulation;
+	// what the game records every frame, only ticked by the allocation check
+	GOG::SessionRecorder recorder;
+	// advanced by a fixed step per tick instead of the OS clock
+	GOG::FrameClock frameClock;
+
+	GOG::EventBus eventBus;
+	GOG::CommandBuffers gameCommands;
+	// swapped after every tick, like the game does every frame
+	GOG::FrameArena frameArena;
+	// created without a sound device, every clip resolves to INVALID_SOUND
+	AudioData audioData;
+
+	std::unique_ptr<ActorData>	actorData;
+
+	unsigned int sessions = 0;
+	bool gameOver = false;
+
+public:
+	// _seed of 0 falls back to the [Game] seed setting, like the game does
+	bool Init(unsigned long long _seed);
+	// _from starts the first session from a snapshot instead of a fresh wave
+	bool Run(unsigned int _ticks, const GOG::WorldSnapshot* _from = nullptr);
+	// Plays a recorded session back with its input and deltas, checking the state every tick.
+	// _realTime paces ticks by their recorded deltas, otherwise they run back to back.
+	// Per-tick timings are written to _timingFile as csv. Returns false if the state diverged
+	// from the recording, the timings are still written.
+	bool Replay(const GOG::InputLog& _log, bool _realTime, const std::string& _timingFile);
+	// Fills a world with _perType landers, bombers, baiters, civilians and projectiles, then times
+	// every system on its own and the whole tick over _samples ticks, each starting from that same
+	// world. One csv row per system is appended to _resultsFile.
+	bool Bench(unsigned int _perType, unsigned int _samples, const std::string& _resultsFile);
+	// Times the startup loaders (actors, the level at 1x, 10x and 100x its instances, prefabs)
+	// once cold and then _warmRuns more times. Use instead of Init. Appends one csv row per stage
+	// and run with the time, allocations and peak resident memory to _resultsFile.
+	bool LoadBench(unsigned int _warmRuns, const std::string& _resultsFile);
+	// Runs _warmupTicks, then checks that none of the next _ticks allocates. Every tick is recorded
+	// and snapshotted like the game does. Ticks around a session restart are skipped. Reports what allocated per scope, with sampled call stacks in debug
+	// builds, and returns false if any checked tick allocated.
+	bool AllocCheck(unsigned int _warmupTicks, unsigned int _ticks);
+	// Waits up to _maxTicks for a fully spawned wave, kills all of it but one enemy and rams the player
+	// into that last one. Returns false unless the wave stayed the same and the enemy is to be spawned again.
+	bool RamCheck(unsigned int _maxTicks);
+	bool Shutdown();
+
+private:
+	// one fixed step of the world, its events, sounds and frame scratch
+	bool Tick();
+	bool InitActorPrefabs(ActorData* _actorData);
+	void SpawnBenchActors(unsigned int _perType);
+	// Writes _source with every mesh instance repeated _copies times, each copy _spacing further along x
+	static bool WriteScaledLevel(const char* _source, const std::string& _target, unsigned int _copies, float _spacing);
+};
+
+#endif
@@ -0,0 +1,165 @@
+// Entry point of the headless runner. Build it from the same sources as the game with
+// GALLEONS_HEADLESS defined, swapping Main.cpp for this file, adding Headless/*.cpp and leaving
+// out Application.cpp, Systems/Renderer.cpp, Systems/D3D11RenderBackend.cpp and Tests/. The
+// checks in Headless/ exit with 0 when they pass, 1 when they fail and 2 when they can't run.
+//
+// usage: GalleonsHeadless <ticks> [seed]
+//        GalleonsHeadless --replay <input log> [--realtime]
+//        GalleonsHeadless --restore <snapshot ring> <ticks> [index]
+//        GalleonsHeadless --bench <actors per type> [samples] [results csv]
+//        GalleonsHeadless --load-bench [warm runs] [results csv]
+//        GalleonsHeadless --alloc-check <ticks> [warmup ticks] [seed]
+//        GalleonsHeadless --ram-check [seed] [max ticks]
+//        GalleonsHeadless --<check> [arguments], one of the checks in Headless/
+#include "HeadlessApplication.h"
+#include "Headless/HeadlessCheck.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	std::vector<std::unique_ptr<GOG::HeadlessCheck>> checks = GOG::CreateHeadlessChecks();
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <ticks> [seed]" << std::endl;
+		std::cout << "       " << argv[0] << " --replay <input log> [--realtime]" << std::endl;
+		std::cout << "       " << argv[0] << " --restore <snapshot ring> <ticks> [index]" << std::endl;
+		std::cout << "       " << argv[0] << " --bench <actors per type> [samples] [results csv]" << std::endl;
+		std::cout << "       " << argv[0] << " --load-bench [warm runs] [results csv]" << std::endl;
+		std::cout << "       " << argv[0] << " --alloc-check <ticks> [warmup ticks] [seed]" << std::endl;
+		std::cout << "       " << argv[0] << " --ram-check [seed] [max ticks]" << std::endl;
+		for (const std::unique_ptr<GOG::HeadlessCheck>& check : checks)
+			std::cout << "       " << argv[0] << " --" << check->Name() << " " << check->Arguments() << std::endl;
+		return 1;
+	}
+
+	// before any world exists, so flecs' allocations are counted from the start
+	GOG::TrackEcsAllocations();
+	HeadlessApplication simulation;
+
+	// times the startup loaders on their own, nothing is simulated
+	if (std::strcmp(argv[1], "--load-bench") == 0)
+	{
+		unsigned int warmRuns = (argc > 2) ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 3;
+		std::string resultsFile = (argc > 3) ? argv[3] : "../loadBench.csv";
+		return simulation.LoadBench(warmRuns, resultsFile) ? 0 : 1;
+	}
+
+	// checks that need no gameplay world, each one in its own file
+	for (const std::unique_ptr<GOG::HeadlessCheck>& check : checks)
+	{
+		if (std::strncmp(argv[1], "--", 2) == 0 && std::strcmp(argv[1] + 2, check->Name()) == 0)
+			return check->Run(std::vector<std::string>(argv + 2, argv + argc));
+	}
+
+	// replays a session recorded by the game with [Replay] record=1
+	if (std::strcmp(argv[1], "--replay") == 0)
+	{
+		GOG::InputLog log;
+		if (argc < 3 || log.Load(argv[2]) == false)
+		{
+			std::cout << "couldn't read the input log" << std::endl;
+			return 1;
+		}
+		bool realTime = argc > 3 && std::strcmp(argv[3], "--realtime") == 0;
+
+		if (simulation.Init(log.Seed())) {
+			if (simulation.Replay(log, realTime, std::string(argv[2]) + ".timing.csv")) {
+				return simulation.Shutdown() ? 0 : 1;
+			}
+		}
+		return 1;
+	}
+
+	// runs on from a frame the game wrote out when it hit a frame time spike, oldest frame by default
+	if (std::strcmp(argv[1], "--restore") == 0)
+	{
+		GOG::SnapshotRing ring;
+		if (argc < 4 || ring.Load(argv[2]) == false || ring.Count() == 0)
+		{
+			std::cout << "couldn't read the snapshot ring" << std::endl;
+			return 1;
+		}
+		unsigned int ticks = static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10));
+		unsigned int index = (argc > 4) ? static_cast<unsigned int>(std::strtoul(argv[4], nullptr, 10)) : 0;
+		if (index >= ring.Count())
+			index = ring.Count() - 1;
+		std::cout << "Restoring frame " << ring.At(index).frame << " (" << ring.At(index).frameMs << " ms)" << std::endl;
+
+		if (simulation.Init(0)) {
+			if (simulation.Run(ticks, &ring.At(index))) {
+				return simulation.Shutdown() ? 0 : 1;
+			}
+		}
+		return 1;
+	}
+
+	// times each gameplay system against a synthetic world, rows are appended so runs from
+	// different commits can be compared
+	if (std::strcmp(argv[1], "--bench") == 0)
+	{
+		if (argc < 3)
+		{
+			std::cout << "how many actors of each type?" << std::endl;
+			return 1;
+		}
+		unsigned int perType = static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10));
+		unsigned int samples = (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 300;
+		std::string resultsFile = (argc > 4) ? argv[4] : "../simBench.csv";
+
+		// a fixed seed, so every run lays out the same world
+		if (simulation.Init(1)) {
+			if (simulation.Bench(perType, samples, resultsFile)) {
+				return simulation.Shutdown() ? 0 : 1;
+			}
+		}
+		return 1;
+	}
+
+	// fails if gameplay still allocates once the session has settled
+	if (std::strcmp(argv[1], "--alloc-check") == 0)
+	{
+		if (argc < 3)
+		{
+			std::cout << "how many ticks should be checked?" << std::endl;
+			return 1;
+		}
+		unsigned int ticks = static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10));
+		unsigned int warmupTicks = (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 600;
+		unsigned long long seed = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 0;
+
+		if (simulation.Init(seed)) {
+			bool passed = simulation.AllocCheck(warmupTicks, ticks);
+			if (simulation.Shutdown() && passed) {
+				return 0;
+			}
+		}
+		return 1;
+	}
+
+	// rams the player into the last enemy of a wave and checks the wave is not counted as cleared
+	if (std::strcmp(argv[1], "--ram-check") == 0)
+	{
+		unsigned long long seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1;
+		unsigned int maxTicks = (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 36000;
+
+		if (simulation.Init(seed)) {
+			bool passed = simulation.RamCheck(maxTicks);
+			if (simulation.Shutdown() && passed) {
+				return 0;
+			}
+		}
+		return 1;
+	}
+
+	unsigned int ticks = static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10));
+	unsigned long long seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 0;
+
+	if (simulation.Init(seed)) {
+		if (simulation.Run(ticks)) {
+			return simulation.Shutdown() ? 0 : 1;
+		}
+	}
+	return 1;
+}
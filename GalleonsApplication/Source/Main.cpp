@@ -1,8 +1,11 @@
 // handles everything
 #include "Application.h"
+#include "MemoryTracking.h"
 // program entry point
 int main()
 {
+	// before any world exists, so flecs' allocations are counted from the start
+	GOG::TrackEcsAllocations();
 	Application galleonsOfTheGalaxy;
 	if (galleonsOfTheGalaxy.Init()) {
 		if (galleonsOfTheGalaxy.Run()) {
@@ -0,0 +1,351 @@
+#include "MemoryTracking.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <dbghelp.h>
+#pragma comment(lib, "psapi.lib")
+#pragma comment(lib, "dbghelp.lib")
+#else
+#include <sys/resource.h>
+#include <execinfo.h>
+#endif
+
+thread_local unsigned int GOG::currentAllocationScope = 0;
+
+namespace
+{
+	std::atomic<unsigned long long> allocationCount{ 0 };
+	std::atomic<unsigned long long> allocatedBytes{ 0 };
+
+	// slots are handed out once per scope name and never given back
+	std::mutex scopeRegistryLock;
+	const char* scopeNames[GOG::MAX_ALLOCATION_SCOPES] = { "untracked" };
+	std::atomic<unsigned int> scopesRegistered{ 1 };
+	std::atomic<unsigned long long> scopeCounts[GOG::MAX_ALLOCATION_SCOPES];
+	std::atomic<unsigned long long> scopeBytes[GOG::MAX_ALLOCATION_SCOPES];
+
+#ifndef NDEBUG
+	constexpr unsigned int MAX_ALLOCATION_SAMPLES = 256;
+	constexpr unsigned int MAX_SAMPLE_DEPTH = 24;
+
+	struct AllocationSample
+	{
+		unsigned int scope;
+		std::size_t size;
+		unsigned int depth;
+		void* frames[MAX_SAMPLE_DEPTH];
+		// set once the stack is in, a sample still being taken is skipped when writing
+		std::atomic<bool> ready;
+	};
+	AllocationSample allocationSamples[MAX_ALLOCATION_SAMPLES];
+	std::atomic<unsigned int> sampleInterval{ 0 };
+	std::atomic<unsigned long long> sampleTicket{ 0 };
+	std::atomic<unsigned int> samplesTaken{ 0 };
+	// walking the stack must not count as an allocation to sample
+	thread_local bool takingSample = false;
+
+	void SampleStack(unsigned int _scope, std::size_t _size)
+	{
+		unsigned int interval = sampleInterval.load(std::memory_order_relaxed);
+		if (interval == 0 || takingSample || sampleTicket.fetch_add(1, std::memory_order_relaxed) % interval != 0)
+			return;
+		unsigned int index = samplesTaken.fetch_add(1, std::memory_order_relaxed);
+		if (index >= MAX_ALLOCATION_SAMPLES)
+			return;
+
+		takingSample = true;
+		AllocationSample& sample = allocationSamples[index];
+		sample.scope = _scope;
+		sample.size = _size;
+#ifdef _WIN32
+		// skips this function and CountAllocation
+		sample.depth = CaptureStackBackTrace(2, MAX_SAMPLE_DEPTH, sample.frames, nullptr);
+#else
+		sample.depth = static_cast<unsigned int>(std::max(backtrace(sample.frames, MAX_SAMPLE_DEPTH), 0));
+#endif
+		sample.ready.store(true, std::memory_order_release);
+		takingSample = false;
+	}
+#endif
+
+	void CountAllocation(std::size_t _size)
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(_size, std::memory_order_relaxed);
+		unsigned int scope = GOG::currentAllocationScope;
+		scopeCounts[scope].fetch_add(1, std::memory_order_relaxed);
+		scopeBytes[scope].fetch_add(_size, std::memory_order_relaxed);
+#ifndef NDEBUG
+		SampleStack(scope, _size);
+#endif
+	}
+
+	void* CountedMalloc(std::size_t _size)
+	{
+		CountAllocation(_size);
+		return std::malloc(_size > 0 ? _size : 1);
+	}
+
+	void* CountedAlignedMalloc(std::size_t _size, std::size_t _alignment)
+	{
+		CountAllocation(_size);
+#ifdef _WIN32
+		return _aligned_malloc(_size > 0 ? _size : 1, _alignment);
+#else
+		void* memory = nullptr;
+		if (posix_memalign(&memory, _alignment < sizeof(void*) ? sizeof(void*) : _alignment, _size > 0 ? _size : 1) != 0)
+			return nullptr;
+		return memory;
+#endif
+	}
+
+	void AlignedFree(void* _memory)
+	{
+#ifdef _WIN32
+		_aligned_free(_memory);
+#else
+		std::free(_memory);
+#endif
+	}
+
+	// flecs' own allocations, its default OS api calls straight into the C runtime
+	void* EcsMalloc(ecs_size_t _size)
+	{
+		CountAllocation(static_cast<std::size_t>(_size));
+		return std::malloc(static_cast<std::size_t>(_size));
+	}
+
+	void* EcsCalloc(ecs_size_t _size)
+	{
+		CountAllocation(static_cast<std::size_t>(_size));
+		return std::calloc(1, static_cast<std::size_t>(_size));
+	}
+
+	// a resize is only a new allocation when there was no block yet or it had to move to a new one
+	void* EcsRealloc(void* _memory, ecs_size_t _size)
+	{
+		std::uintptr_t previous = reinterpret_cast<std::uintptr_t>(_memory);
+		void* memory = std::realloc(_memory, static_cast<std::size_t>(_size));
+		if (memory != nullptr && reinterpret_cast<std::uintptr_t>(memory) != previous)
+			CountAllocation(static_cast<std::size_t>(_size));
+		return memory;
+	}
+}
+
+GOG::AllocationCounters GOG::GetAllocationCounters()
+{
+	return { allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed) };
+}
+
+void GOG::TrackEcsAllocations()
+{
+	ecs_os_set_api_defaults();
+	ecs_os_api_t api = ecs_os_api;
+	api.malloc_ = EcsMalloc;
+	api.calloc_ = EcsCalloc;
+	api.realloc_ = EcsRealloc;
+	ecs_os_set_api(&api);
+}
+
+unsigned int GOG::RegisterAllocationScope(const char* _name)
+{
+	std::lock_guard<std::mutex> guard(scopeRegistryLock);
+	unsigned int registered = scopesRegistered.load(std::memory_order_relaxed);
+	for (unsigned int slot = 1; slot < registered; slot++)
+	{
+		if (std::strcmp(scopeNames[slot], _name) == 0)
+			return slot;
+	}
+	if (registered == MAX_ALLOCATION_SCOPES)
+		return 0;
+	scopeNames[registered] = _name;
+	scopesRegistered.store(registered + 1, std::memory_order_release);
+	return registered;
+}
+
+unsigned int GOG::GetAllocationScopes(AllocationScopeCounters* _scopes, unsigned int _capacity)
+{
+	unsigned int count = std::min(scopesRegistered.load(std::memory_order_acquire), _capacity);
+	for (unsigned int slot = 0; slot < count; slot++)
+		_scopes[slot] = { scopeNames[slot], scopeCounts[slot].load(std::memory_order_relaxed), scopeBytes[slot].load(std::memory_order_relaxed) };
+	return count;
+}
+
+void GOG::FrameAllocations::Reset()
+{
+	EndFrame();
+	frameTotal = {};
+	scopeCount = 0;
+}
+
+void GOG::FrameAllocations::EndFrame()
+{
+	AllocationCounters total = GetAllocationCounters();
+	frameTotal = { total.count - lastTotal.count, total.bytes - lastTotal.bytes };
+	lastTotal = total;
+
+	// straight from the counters, a frame with nothing to report must not allocate either
+	scopeCount = 0;
+	unsigned int registered = scopesRegistered.load(std::memory_order_acquire);
+	for (unsigned int slot = 0; slot < registered; slot++)
+	{
+		AllocationScopeCounters now = { scopeNames[slot], scopeCounts[slot].load(std::memory_order_relaxed), scopeBytes[slot].load(std::memory_order_relaxed) };
+		if (now.count != lastScopes[slot].count)
+			frameScopes[scopeCount++] = { now.name, now.count - lastScopes[slot].count, now.bytes - lastScopes[slot].bytes };
+		lastScopes[slot] = now;
+	}
+	std::sort(frameScopes, frameScopes + scopeCount, [](const AllocationScopeCounters& _a, const AllocationScopeCounters& _b)
+		{
+			return _a.count > _b.count;
+		});
+}
+
+void GOG::StartAllocationSampling(unsigned int _interval)
+{
+#ifndef NDEBUG
+	// a new run of samples, the stacks of an earlier one aren't written again
+	for (AllocationSample& sample : allocationSamples)
+		sample.ready.store(false, std::memory_order_relaxed);
+	samplesTaken.store(0, std::memory_order_relaxed);
+	sampleTicket.store(0, std::memory_order_relaxed);
+	sampleInterval.store(std::max(_interval, 1u), std::memory_order_relaxed);
+#endif
+}
+
+void GOG::StopAllocationSampling()
+{
+#ifndef NDEBUG
+	sampleInterval.store(0, std::memory_order_relaxed);
+#endif
+}
+
+void GOG::WriteAllocationSamples(std::ostream& _out)
+{
+#ifndef NDEBUG
+	StopAllocationSampling();
+	unsigned int count = std::min(samplesTaken.load(std::memory_order_relaxed), MAX_ALLOCATION_SAMPLES);
+#ifdef _WIN32
+	HANDLE process = GetCurrentProcess();
+	SymInitialize(process, nullptr, TRUE);
+	char symbolBuffer[sizeof(SYMBOL_INFO) + 256];
+	SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+#endif
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const AllocationSample& sample = allocationSamples[i];
+		if (sample.ready.load(std::memory_order_acquire) == false)
+			continue;
+		_out << "allocation of " << sample.size << " bytes in " << scopeNames[sample.scope] << "\n";
+#ifdef _WIN32
+		for (unsigned int frame = 0; frame < sample.depth; frame++)
+		{
+			DWORD64 address = reinterpret_cast<DWORD64>(sample.frames[frame]);
+			std::memset(symbolBuffer, 0, sizeof(symbolBuffer));
+			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+			symbol->MaxNameLen = 255;
+			IMAGEHLP_LINE64 line = {};
+			line.SizeOfStruct = sizeof(line);
+			DWORD lineDisplacement = 0;
+			_out << "    " << (SymFromAddr(process, address, nullptr, symbol) ? symbol->Name : "?");
+			if (SymGetLineFromAddr64(process, address, &lineDisplacement, &line))
+				_out << "  " << line.FileName << ":" << line.LineNumber;
+			_out << "\n";
+		}
+#else
+		char** symbols = backtrace_symbols(sample.frames, static_cast<int>(sample.depth));
+		for (unsigned int frame = 0; symbols != nullptr && frame < sample.depth; frame++)
+			_out << "    " << symbols[frame] << "\n";
+		std::free(symbols);
+#endif
+	}
+#ifdef _WIN32
+	SymCleanup(process);
+#endif
+	_out << count << " allocation stacks sampled" << std::endl;
+#else
+	_out << "allocation stacks are only sampled in debug builds" << std::endl;
+#endif
+}
+
+size_t GOG::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == FALSE)
+		return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss); // already in bytes
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Replacements for the global allocation functions, the whole program allocates through these
+
+void* operator new(std::size_t _size)
+{
+	void* memory = CountedMalloc(_size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t _size)
+{
+	void* memory = CountedMalloc(_size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t _size, const std::nothrow_t&) noexcept { return CountedMalloc(_size); }
+void* operator new[](std::size_t _size, const std::nothrow_t&) noexcept { return CountedMalloc(_size); }
+
+void* operator new(std::size_t _size, std::align_val_t _alignment)
+{
+	void* memory = CountedAlignedMalloc(_size, static_cast<std::size_t>(_alignment));
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t _size, std::align_val_t _alignment)
+{
+	void* memory = CountedAlignedMalloc(_size, static_cast<std::size_t>(_alignment));
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept { return CountedAlignedMalloc(_size, static_cast<std::size_t>(_alignment)); }
+void* operator new[](std::size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept { return CountedAlignedMalloc(_size, static_cast<std::size_t>(_alignment)); }
+
+void operator delete(void* _memory) noexcept { std::free(_memory); }
+void operator delete[](void* _memory) noexcept { std::free(_memory); }
+void operator delete(void* _memory, std::size_t) noexcept { std::free(_memory); }
+void operator delete[](void* _memory, std::size_t) noexcept { std::free(_memory); }
+void operator delete(void* _memory, const std::nothrow_t&) noexcept { std::free(_memory); }
+void operator delete[](void* _memory, const std::nothrow_t&) noexcept { std::free(_memory); }
+void operator delete(void* _memory, std::align_val_t) noexcept { AlignedFree(_memory); }
+void operator delete[](void* _memory, std::align_val_t) noexcept { AlignedFree(_memory); }
+void operator delete(void* _memory, std::size_t, std::align_val_t) noexcept { AlignedFree(_memory); }
+void operator delete[](void* _memory, std::size_t, std::align_val_t) noexcept { AlignedFree(_memory); }
+void operator delete(void* _memory, std::align_val_t, const std::nothrow_t&) noexcept { AlignedFree(_memory); }
+void operator delete[](void* _memory, std::align_val_t, const std::nothrow_t&) noexcept { AlignedFree(_memory); }
@@ -0,0 +1,82 @@
+#ifndef MEMORYTRACKING_H
+#define MEMORYTRACKING_H
+
+#include <cstddef>
+#include <iosfwd>
+
+// Counts every heap allocation the program makes. The global operator new/delete are replaced in
+// MemoryTracking.cpp, and flecs is pointed at the same counters through its OS api.
+namespace GOG
+{
+	struct AllocationCounters
+	{
+		unsigned long long count;
+		unsigned long long bytes;
+	};
+
+	// Totals since startup, from every thread
+	AllocationCounters GetAllocationCounters();
+	// Routes flecs' malloc/calloc/realloc through the counters, call before the first world is made
+	void TrackEcsAllocations();
+	// The most memory the process has had resident at once, in bytes
+	size_t GetPeakResidentBytes();
+
+	// Allocations are also charged to the innermost open scope on the thread that made them.
+	// Slot 0 collects everything made outside of a scope, or once every slot is taken.
+	static constexpr unsigned int MAX_ALLOCATION_SCOPES = 128;
+	extern thread_local unsigned int currentAllocationScope;
+
+	struct AllocationScopeCounters
+	{
+		const char* name;
+		unsigned long long count;
+		unsigned long long bytes;
+	};
+
+	// Returns the slot for _name, scopes with the same name share one. _name must outlive the program.
+	unsigned int RegisterAllocationScope(const char* _name);
+	// Copies the totals since startup of every scope registered so far, returns how many
+	unsigned int GetAllocationScopes(AllocationScopeCounters* _scopes, unsigned int _capacity);
+
+	// Charges the enclosing block's allocations to a slot, see ALLOCATION_SCOPE in Utils/Profiler.h
+	class AllocationScope
+	{
+		unsigned int previous;
+
+	public:
+		explicit AllocationScope(unsigned int _slot) : previous(currentAllocationScope) { currentAllocationScope = _slot; }
+		~AllocationScope() { currentAllocationScope = previous; }
+
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+	};
+
+	// What was allocated between two calls to EndFrame, in total and per scope
+	class FrameAllocations
+	{
+		AllocationCounters lastTotal = {};
+		AllocationScopeCounters lastScopes[MAX_ALLOCATION_SCOPES] = {};
+		AllocationCounters frameTotal = {};
+		AllocationScopeCounters frameScopes[MAX_ALLOCATION_SCOPES] = {};
+		unsigned int scopeCount = 0;
+
+	public:
+		// Starts the next frame now, dropping whatever was allocated since the last one
+		void Reset();
+		void EndFrame();
+
+		const AllocationCounters& Total() const { return frameTotal; }
+		// Only the scopes that allocated last frame, most allocations first
+		unsigned int ScopeCount() const { return scopeCount; }
+		const AllocationScopeCounters& Scope(unsigned int _index) const { return frameScopes[_index]; }
+	};
+
+	// Debug builds record the call stack of every _interval-th allocation from here on, from any
+	// thread, until the sample buffer is full. Release builds record nothing.
+	void StartAllocationSampling(unsigned int _interval);
+	void StopAllocationSampling();
+	// Stops sampling and writes every recorded stack, symbolized where the platform can
+	void WriteAllocationSamples(std::ostream& _out);
+}
+
+#endif
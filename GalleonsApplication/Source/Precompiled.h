@@ -1,7 +1,9 @@
 // Include access to the Gateware middleware API. (O.S. Abstraction Layer)
 #define GATEWARE_ENABLE_CORE // All libraries need this
 #define GATEWARE_ENABLE_SYSTEM // Many libs require system level libraries
+#ifndef GALLEONS_HEADLESS // the headless runner has no window or GPU to draw with
 #define GATEWARE_ENABLE_GRAPHICS // Enables all Graphics Libraries
+#endif
 #define GATEWARE_ENABLE_MATH // Enables all 3D Math Libraries
 #define GATEWARE_ENABLE_MATH2D // Enables all 2D Math Libraries
 #define GATEWARE_ENABLE_INPUT // Enables all Input Libraries
@@ -18,8 +20,10 @@
 #include "../flecs-3.1.4/flecs.h"
 // Library for processing .ini files
 #include "../inifile-cpp-master/include/inicpp.h"
+#ifndef GALLEONS_HEADLESS
 // used to compile shaders for Vulkan
 #include "shaderc/shaderc.h" // needed for compiling shaders at runtime
 #ifdef _WIN32 // must use MT platform DLL libraries on windows
 	#pragma comment(lib, "shaderc_combined.lib")
+#endif
 #endif
\ No newline at end of file
@@ -1,16 +1,17 @@
 #include "CameraLogic.h"
 #include "../Utils/Macros.h"
+#include "../Utils/Profiler.h"
 
 bool GOG::CameraLogic::Init(std::shared_ptr<flecs::world> _flecsWorld,
-	std::weak_ptr<const GameConfig> _gameConfig, DirectX11Renderer* _renderer)
+	std::weak_ptr<const GameConfig> _gameConfig)
 {
 	flecsWorld = _flecsWorld;
-	renderer = _renderer;
 
 	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
 
 	// Camera entity creation
 	isFacingRight = true;
+	isSwitchingDir = false;
 	smoothing = readCfg->at("Camera").at("smoothing").as<float>();
 	leadDistance = readCfg->at("Camera").at("leadDistance").as<float>();
 	switchDirTime = readCfg->at("Camera").at("switchDirTime").as<int>();
@@ -36,18 +37,19 @@ bool GOG::CameraLogic::Init(std::shared_ptr<flecs::world> _flecsWorld,
 		.set_override<Transform>({ defaultPosition });
 
 	// Camera movement system creation
-	queryCache = flecsWorld->query<Player, Transform, FlipInfo>();
+	queryCache = flecsWorld->query<Player, Pose2D, FlipInfo>();
 
 	movementSystem = flecsWorld->system<Camera, Transform>("CameraMovementSystem").each([this](
 		flecs::entity _entity, Camera, Transform& _transform)
 		{
+			PROFILE_SYSTEM("CameraMovementSystem");
 
 			unsigned int test = queryCache.count();
 			if (queryCache.count() > 0) // lead the player
 			{
-				Transform targetTransform = *queryCache.first().get<Transform>();
+				const Pose2D* targetPose = queryCache.first().get<Pose2D>();
 				FlipInfo targetFlipInfo = *queryCache.first().get<FlipInfo>();
-				GW::MATH::GVECTORF targetPosition = targetTransform.value.row4;
+				GW::MATH::GVECTORF targetPosition = { targetPose->x, targetPose->y, targetPose->z, 1 };
 				targetPosition.z += zOffset;
 				
 
@@ -56,8 +58,7 @@ bool GOG::CameraLogic::Init(std::shared_ptr<flecs::world> _flecsWorld,
 
 				if (isFacingRight != targetFlipInfo.isFacingRight)
 				{
-					auto systemTime = std::chrono::system_clock::now().time_since_epoch();
-					int now = std::chrono::duration_cast<std::chrono::milliseconds>(systemTime).count();
+					SimTicks now = _entity.world().get<SimClock>()->now;
 
 					if (!isSwitchingDir)
 					{
@@ -89,8 +90,7 @@ bool GOG::CameraLogic::Init(std::shared_ptr<flecs::world> _flecsWorld,
 					targetPosition,
 					smoothing * _entity.delta_time(),
 					_transform.value.row4);
-
-				renderer->UpdateCamera(_transform.value);
+				// the renderer picks the camera transform up from the entity
 			}
 
 		});
@@ -100,10 +100,26 @@ bool GOG::CameraLogic::Init(std::shared_ptr<flecs::world> _flecsWorld,
 
 void GOG::CameraLogic::Reset()
 {
+	isFacingRight = true;
+	isSwitchingDir = false;
 	flecsWorld->entity("Camera")
 		.set<Transform>({ defaultPosition });
 }
 
+void GOG::CameraLogic::SaveState(SnapshotWriter& _writer) const
+{
+	_writer.Write(isFacingRight);
+	_writer.Write(isSwitchingDir);
+	_writer.Write(switchDirStart);
+}
+
+bool GOG::CameraLogic::LoadState(SnapshotReader& _reader)
+{
+	_reader.Read(isFacingRight);
+	_reader.Read(isSwitchingDir);
+	return _reader.Read(switchDirStart);
+}
+
 bool GOG::CameraLogic::Activate(bool runSystem)
 {
 	if (movementSystem.is_alive()) {
@@ -3,8 +3,8 @@
 #include "../GameConfig.h"
 #include "../Components/Identification.h"
 #include "../Components/Physics.h"
-#include "../Systems/Renderer.h"
 #include "../Components/Gameplay.h"
+#include "../Utils/WorldSnapshot.h"
 
 namespace GOG
 {
@@ -14,11 +14,9 @@ namespace GOG
 
 		std::weak_ptr<const GameConfig> gameConfig;
 
-		DirectX11Renderer* renderer;
-
 		flecs::system movementSystem;
 
-		flecs::query<Player, Transform, FlipInfo> queryCache;
+		flecs::query<Player, Pose2D, FlipInfo> queryCache;
 
 		float smoothing;
 		float zOffset;
@@ -28,14 +26,17 @@ namespace GOG
 		bool isSwitchingDir;
 
 		int switchDirTime;
-		int switchDirStart;
+		SimTicks switchDirStart;
 
 		GW::MATH::GMATRIXF defaultPosition;
 
 	public:
 		bool Init(std::shared_ptr<flecs::world> _flecsWorld,
-			std::weak_ptr<const GameConfig> _gameConfig, DirectX11Renderer* _renderer);
+			std::weak_ptr<const GameConfig> _gameConfig);
 		void Reset();
+		// lead direction state, the camera transform itself is part of the world snapshot
+		void SaveState(SnapshotWriter& _writer) const;
+		bool LoadState(SnapshotReader& _reader);
 		bool Activate(bool runSystem);
 		bool Shutdown();
 	};
@@ -0,0 +1,153 @@
+#include "D3D11RenderBackend.h"
+
+#include <algorithm>
+
+void GOG::D3D11RenderBackend::Create(ID3D11Device* _device)
+{
+	device = _device;
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	offsetsSupported = SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+		options.ConstantBufferOffsetting;
+}
+
+void GOG::D3D11RenderBackend::SetPipelineState(RENDER_PIPELINE _pipeline, const D3D11Pipeline& _state)
+{
+	pipelines[_pipeline] = _state;
+}
+
+void GOG::D3D11RenderBackend::SetActorTransformBuffer(ID3D11Buffer* _buffer)
+{
+	actorTransformBuffer = _buffer;
+}
+
+void GOG::D3D11RenderBackend::SetLightBinBuffer(ID3D11Buffer* _buffer)
+{
+	lightBinBuffer = _buffer;
+}
+
+void GOG::D3D11RenderBackend::BeginFrame(ID3D11DeviceContext* _context, ID3D11RenderTargetView* _target,
+	ID3D11DepthStencilView* _depthStencil, const D3D11_VIEWPORT& _viewport)
+{
+	if (_context != context)
+	{
+		context = _context;
+		context1.Reset();
+		if (offsetsSupported)
+			context->QueryInterface(IID_PPV_ARGS(context1.GetAddressOf()));
+	}
+	frameTarget = _target;
+	frameDepthStencil = _depthStencil;
+	frameViewport = _viewport;
+	pipeline = nullptr;
+}
+
+void GOG::D3D11RenderBackend::FlushCounters(RenderCounters& _counters)
+{
+	_counters.drawCalls += counters.drawCalls;
+	_counters.mapCalls += counters.mapCalls;
+	_counters.instances += counters.instances;
+	counters = {};
+}
+
+void GOG::D3D11RenderBackend::MapDiscard(ID3D11Buffer* _buffer, const void* _data, size_t _bytes)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	context->Map(_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	memcpy(mapped.pData, _data, _bytes);
+	context->Unmap(_buffer, 0);
+	counters.mapCalls += 1;
+}
+
+void GOG::D3D11RenderBackend::SetPipeline(RENDER_PIPELINE _pipeline)
+{
+	pipeline = &pipelines[_pipeline];
+
+	ID3D11RenderTargetView* const targetViews[]{ pipeline->target ? pipeline->target : frameTarget };
+	ID3D11DepthStencilView* depthStencil = pipeline->target ? pipeline->depthStencil : frameDepthStencil;
+	context->OMSetRenderTargets(1, targetViews, depthStencil);
+	context->RSSetViewports(1, pipeline->target ? &pipeline->viewport : &frameViewport);
+	context->RSSetState(pipeline->rasterizerState);
+	if (pipeline->clearDepth)
+		context->ClearDepthStencilView(depthStencil, D3D11_CLEAR_DEPTH, 1, 0);
+
+	const UINT offsets[]{ 0 };
+	ID3D11Buffer* const vertexBuffs[]{ pipeline->vertexBuffer };
+	context->VSSetShader(pipeline->vertexShader, nullptr, 0);
+	context->PSSetShader(pipeline->pixelShader, nullptr, 0);
+	context->IASetInputLayout(pipeline->inputLayout);
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context->IASetVertexBuffers(0, 1, vertexBuffs, &pipeline->vertexStride, offsets);
+	context->IASetIndexBuffer(pipeline->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	context->VSSetShaderResources(0, 1, &pipeline->vertexView);
+	if (pipeline->pixelViewCount > 0)
+		context->PSSetShaderResources(1, pipeline->pixelViewCount, pipeline->pixelViews);
+	context->PSSetSamplers(0, 1, &pipeline->sampler);
+}
+
+void GOG::D3D11RenderBackend::Upload(UPLOAD_TARGET _target, const void* _data, size_t _bytes)
+{
+	// only the frame's instances are copied, nothing reads past them
+	if (_target == UPLOAD_ACTOR_TRANSFORMS)
+	{
+		if (_bytes > 0)
+			MapDiscard(actorTransformBuffer, _data, _bytes);
+		return;
+	}
+	if (_target == UPLOAD_LIGHT_BINS)
+	{
+		MapDiscard(lightBinBuffer, _data, _bytes);
+		return;
+	}
+
+	uploadData = static_cast<const unsigned char*>(_data);
+	if (context1 == nullptr || _bytes == 0)
+		return;
+
+	// grows to fit the biggest frame yet, the staging memory only grows too
+	if (uploadBufferBytes < _bytes)
+	{
+		uploadBufferBytes = std::max(_bytes, uploadBufferBytes * 2);
+		CD3D11_BUFFER_DESC uploadDesc(static_cast<UINT>(uploadBufferBytes), D3D11_BIND_CONSTANT_BUFFER,
+			D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+		uploadBuffer.Reset();
+		device->CreateBuffer(&uploadDesc, nullptr, uploadBuffer.GetAddressOf());
+	}
+	MapDiscard(uploadBuffer.Get(), _data, _bytes);
+}
+
+void GOG::D3D11RenderBackend::BindConstants(CONSTANT_SLOT _slot, unsigned int _stages, const UploadWindow& _window)
+{
+	if (context1 != nullptr)
+	{
+		ID3D11Buffer* const uploadBuffs[]{ uploadBuffer.Get() };
+		if (_stages & STAGE_VERTEX)
+			context1->VSSetConstantBuffers1(_slot, 1, uploadBuffs, &_window.firstConstant, &_window.constantCount);
+		if (_stages & STAGE_PIXEL)
+			context1->PSSetConstantBuffers1(_slot, 1, uploadBuffs, &_window.firstConstant, &_window.constantCount);
+		return;
+	}
+
+	const unsigned char* record = uploadData + _window.firstConstant * UploadRing::CONSTANT_BYTES;
+	if (_stages & STAGE_VERTEX)
+	{
+		const D3D11ConstantFallback& fallback = pipeline->vertexFallbacks[_slot];
+		MapDiscard(fallback.buffer, record, fallback.bytes);
+		context->VSSetConstantBuffers(_slot, 1, &fallback.buffer);
+	}
+	if (_stages & STAGE_PIXEL)
+	{
+		const D3D11ConstantFallback& fallback = pipeline->pixelFallbacks[_slot];
+		// the vertex shader's copy already holds it
+		if ((_stages & STAGE_VERTEX) == 0 || fallback.buffer != pipeline->vertexFallbacks[_slot].buffer)
+			MapDiscard(fallback.buffer, record, fallback.bytes);
+		context->PSSetConstantBuffers(_slot, 1, &fallback.buffer);
+	}
+}
+
+void GOG::D3D11RenderBackend::DrawIndexedInstanced(unsigned int _indexCount, unsigned int _instanceCount, unsigned int _startIndex, int _baseVertex)
+{
+	context->DrawIndexedInstanced(_indexCount, _instanceCount, _startIndex, _baseVertex, 0);
+	counters.drawCalls += 1;
+	counters.instances += _instanceCount;
+}
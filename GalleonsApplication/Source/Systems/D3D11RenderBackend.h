@@ -0,0 +1,97 @@
+#ifndef D3D11_RENDER_BACKEND_H
+#define D3D11_RENDER_BACKEND_H
+
+#include <d3d11_1.h> // constant buffer offsets
+#include "../Utils/RenderCommands.h"
+#include "../Utils/PerfHud.h"
+
+namespace GOG
+{
+	// A small constant buffer a record is copied into when the driver can't bind windows of the
+	// upload buffer
+	struct D3D11ConstantFallback
+	{
+		ID3D11Buffer* buffer;
+		UINT bytes;
+	};
+
+	// The state SetPipeline puts on the context. The renderer owns everything it points at.
+	// Command lists recorded on deferred contexts start from the default state, so this is all
+	// of the state a pass draws with.
+	struct D3D11Pipeline
+	{
+		ID3D11VertexShader* vertexShader;
+		ID3D11PixelShader* pixelShader;
+		ID3D11InputLayout* inputLayout;
+		ID3D11RasterizerState* rasterizerState;
+		// s0 of the pixel shader
+		ID3D11SamplerState* sampler;
+		ID3D11Buffer* vertexBuffer;
+		UINT vertexStride;
+		ID3D11Buffer* indexBuffer;
+		// t0 of the vertex shader
+		ID3D11ShaderResourceView* vertexView;
+		// t1 onwards of the pixel shader, left alone when there are none
+		ID3D11ShaderResourceView* pixelViews[5];
+		UINT pixelViewCount;
+		// null draws to the frame's target and viewport
+		ID3D11RenderTargetView* target;
+		ID3D11DepthStencilView* depthStencil;
+		D3D11_VIEWPORT viewport;
+		// clears the depth of the target before drawing
+		bool clearDepth;
+		D3D11ConstantFallback vertexFallbacks[CONSTANT_SLOT_COUNT];
+		D3D11ConstantFallback pixelFallbacks[CONSTANT_SLOT_COUNT];
+	};
+
+	// Runs the command stream on a D3D11 context, immediate or deferred. Constants are one buffer
+	// a pass's records are uploaded to, bound a window at a time with D3D11.1 constant buffer
+	// offsets; drivers without them get each record copied to the pipeline's fallback buffer as it
+	// is bound. A backend is used by one thread at a time, passes recorded in parallel get one each.
+	class D3D11RenderBackend : public RenderBackend
+	{
+		Microsoft::WRL::ComPtr<ID3D11Device> device;
+		ID3D11DeviceContext* context = nullptr;
+		// null without constant buffer offsets
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1;
+		bool offsetsSupported = false;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer> uploadBuffer;
+		size_t uploadBufferBytes = 0;
+		// the records behind the windows, for fallback copies
+		const unsigned char* uploadData = nullptr;
+		ID3D11Buffer* actorTransformBuffer = nullptr;
+		ID3D11Buffer* lightBinBuffer = nullptr;
+
+		D3D11Pipeline pipelines[PIPELINE_COUNT] = {};
+		const D3D11Pipeline* pipeline = nullptr;
+		ID3D11RenderTargetView* frameTarget = nullptr;
+		ID3D11DepthStencilView* frameDepthStencil = nullptr;
+		D3D11_VIEWPORT frameViewport = {};
+
+		// drawCalls, mapCalls and instances since the last FlushCounters
+		RenderCounters counters = {};
+
+		void MapDiscard(ID3D11Buffer* _buffer, const void* _data, size_t _bytes);
+
+	public:
+		void Create(ID3D11Device* _device);
+		void SetPipelineState(RENDER_PIPELINE _pipeline, const D3D11Pipeline& _state);
+		void SetActorTransformBuffer(ID3D11Buffer* _buffer);
+		// The renderer keeps it big enough for every frame's bins
+		void SetLightBinBuffer(ID3D11Buffer* _buffer);
+		// Commands go to _context until the next BeginFrame
+		void BeginFrame(ID3D11DeviceContext* _context, ID3D11RenderTargetView* _target, ID3D11DepthStencilView* _depthStencil,
+			const D3D11_VIEWPORT& _viewport);
+		bool UsesConstantOffsets() const { return context1 != nullptr; }
+		// Adds the draws, maps and instances submitted since the last call to _counters
+		void FlushCounters(RenderCounters& _counters);
+
+		void SetPipeline(RENDER_PIPELINE _pipeline) override;
+		void Upload(UPLOAD_TARGET _target, const void* _data, size_t _bytes) override;
+		void BindConstants(CONSTANT_SLOT _slot, unsigned int _stages, const UploadWindow& _window) override;
+		void DrawIndexedInstanced(unsigned int _indexCount, unsigned int _instanceCount, unsigned int _startIndex, int _baseVertex) override;
+	};
+}
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "../Utils/Macros.h"
 #include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
 
 using namespace GOG;
 using namespace flecs;
@@ -18,45 +19,44 @@ using namespace MATH2D;
 // Connects logic to traverse any players and allow a controller to manipulate them
 bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 							std::weak_ptr<const GameConfig> _gameConfig,
-							CORE::GEventGenerator _eventPusher)
+							EventBus* _eventBus)
 {
 	// save a handle to the ECS & game settings
 	flecsWorld = _flecsWorld;
 	gameConfig = _gameConfig;
-	eventPusher = _eventPusher;
-	playerMovementQuery = flecsWorld->query<const Player, const Transform, const Velocity>();
-	baiterQuery = flecsWorld->query<const Baiter, const BaiterMovementStats, SpeedBoost, Transform, FlipInfo, Cannon>();
-	civiQuery = flecsWorld->query<const Civilian, CaptureInfo, const Transform>();
+	eventBus = _eventBus;
+	playerMovementQuery = flecsWorld->query<const Player, const Pose2D, const Velocity>();
+	baiterQuery = flecsWorld->query<const Baiter, const BaiterMovementStats, SpeedBoost, Pose2D, FlipInfo, Cannon>();
+	civiQuery = flecsWorld->query<const Civilian, CaptureInfo, const Pose2D>();
 
 #pragma region SharedEntityValues
 
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
-	std::uniform_real_distribution<float> dirDist(-1, 1);
+	baiterRandom.Seed(flecsWorld->get<WorldSeed>()->value, RANDOM_STREAM::BAITER_MOVEMENT);
 
 #pragma endregion
 
 #pragma region Bomber
 	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
 
-	bomberQuery = flecsWorld->query<const Bomber, Transform, Velocity, FlipInfo, BomberTrap>();
+	bomberQuery = flecsWorld->query<const Bomber, Pose2D, Velocity, FlipInfo, BomberTrap>();
 	float speedBomber = readCfg->at("EnemyPrefab_1").at("speed").as<float>();
 	float topBound = readCfg->at("Game").at("worldTopBoundry").as<float>();
 	float bottomBound = readCfg->at("Game").at("worldBottomBoundry").as<float>();
 
 	struct BomberSystem {};
 	flecsWorld->entity("BomberSystem").add<BomberSystem>();
-	flecsWorld->system<BomberSystem>().each([this, gen, dirDist, speedBomber, bottomBound, topBound](BomberSystem& _b)
+	flecsWorld->system<BomberSystem>("Bomber System").each([this, speedBomber, bottomBound, topBound](BomberSystem& _b)
 		{
+			PROFILE_SYSTEM("BomberSystem");
+			simNow = flecsWorld->get<SimClock>()->now;
 
 			bomberQuery.each(
-				[this, gen, dirDist, speedBomber, bottomBound, topBound]
-				(entity _entity, const Bomber& _bomber, Transform& _transform, 
+				[this, speedBomber, bottomBound, topBound]
+				(entity _entity, const Bomber& _bomber, Pose2D& _pose,
 				Velocity& _velocity, FlipInfo& _flipInfo, BomberTrap& _bomberTrap)
 				{
-					BomberMovement(_entity.delta_time(), speedBomber, _entity, _transform, _velocity, _flipInfo, bottomBound, topBound);
-					SpawnBomberTrap(_transform, _velocity, _bomberTrap);
+					BomberMovement(_entity.delta_time(), speedBomber, _entity, _pose, _velocity, _flipInfo, bottomBound, topBound);
+					SpawnBomberTrap(_pose, _velocity, _bomberTrap);
 				});
 		});
 
@@ -66,13 +66,15 @@ bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 
 	struct BaiterSystem {};
 	flecsWorld->entity("BaiterSystem").add<BaiterSystem>();
-	flecsWorld->system<BaiterSystem>().each(
+	flecsWorld->system<BaiterSystem>("Baiter System").each(
 		[this](BaiterSystem& _s)
 		{
+			PROFILE_SYSTEM("BaiterSystem");
+			simNow = flecsWorld->get<SimClock>()->now;
 			if (playerMovementQuery.first().is_alive())
 			{
-				playerPos_x = playerMovementQuery.first().get<Transform>()->value.row4.x;
-				playerPos_y = playerMovementQuery.first().get<Transform>()->value.row4.y;
+				playerPos_x = playerMovementQuery.first().get<Pose2D>()->x;
+				playerPos_y = playerMovementQuery.first().get<Pose2D>()->y;
 				playerVelocity_x = playerMovementQuery.first().get<Velocity>()->value.x;
 				playerVelocity_y = playerMovementQuery.first().get<Velocity>()->value.y;
 			}
@@ -82,10 +84,10 @@ bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 			baiterQuery.each(
 				[this]
 				(entity _entity, const Baiter& _baiter, const BaiterMovementStats& _movementStats, SpeedBoost& _speedBoost,
-				Transform& _transform, FlipInfo& _flipInfo, Cannon& _missileLauncher)
+				Pose2D& _pose, FlipInfo& _flipInfo, Cannon& _missileLauncher)
 				{
-					BaiterMovement(_entity.delta_time(), _movementStats, _speedBoost, _transform, _flipInfo);
-					FireCannon(_transform, _missileLauncher);
+					BaiterMovement(_entity.delta_time(), _movementStats, _speedBoost, _pose, _flipInfo);
+					FireCannon(_pose, _missileLauncher);
 				});
 		});
 
@@ -94,53 +96,52 @@ bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 
 #pragma region Lander
 
-	landerSystem = flecsWorld->system<const Lander, Transform, const Speed, PeaShooter>().each(
+	landerSystem = flecsWorld->system<const Lander, Pose2D, const Speed, PeaShooter>("LanderSystem").each(
 		[this]
-		(entity _lander, const Lander&, Transform& _landerTransform, const Speed& _speed, PeaShooter& _peaShooter)
+		(entity _lander, const Lander&, Pose2D& _landerPose, const Speed& _speed, PeaShooter& _peaShooter)
 		{
+			PROFILE_SYSTEM("LanderSystem");
 			if (playerMovementQuery.first().is_alive())
 			{
-				playerPos_x = playerMovementQuery.first().get<Transform>()->value.row4.x;
-				playerPos_y = playerMovementQuery.first().get<Transform>()->value.row4.y;
+				playerPos_x = playerMovementQuery.first().get<Pose2D>()->x;
+				playerPos_y = playerMovementQuery.first().get<Pose2D>()->y;
 				playerVelocity_x = playerMovementQuery.first().get<Velocity>()->value.x;
 				playerVelocity_y = playerMovementQuery.first().get<Velocity>()->value.y;
 			}
 
-			LanderMovement(_lander, _landerTransform, _speed);
+			LanderMovement(_lander, _landerPose, _speed);
+			simNow = _lander.world().get<SimClock>()->now;
 
-			float landerPos_x = _landerTransform.value.row4.x, landerPos_y = _landerTransform.value.row4.y;
+			float landerPos_x = _landerPose.x, landerPos_y = _landerPose.y;
 			float distToPlayer = DISTANCE_2D(landerPos_x, landerPos_y, playerPos_x, playerPos_y);
 			if (distToPlayer < _peaShooter.range)
 			{
-				std::chrono::milliseconds timeSinceLastPea;
-				timeSinceLastPea = std::chrono::duration_cast<std::chrono::milliseconds>(
-					std::chrono::high_resolution_clock::now() - _peaShooter.prevFireTime);
-				if (timeSinceLastPea < _peaShooter.fireRate)
+				SimTicks timeSinceLastPea = simNow - _peaShooter.prevFireTime;
+				if (timeSinceLastPea < _peaShooter.fireRate.count())
 					return;
-				_peaShooter.prevFireTime = std::chrono::high_resolution_clock::now();
+				_peaShooter.prevFireTime = simNow;
 
 				entity pea{};
-				std::string peaPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::PEA);
+				static const std::string peaPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::PEA);
 				if (RetreivePrefab(peaPrefab.c_str(), pea))
 				{
-					float delta_x = playerPos_x - _landerTransform.value.row4.x;
-					float delta_y = playerPos_y - _landerTransform.value.row4.y;
+					float delta_x = playerPos_x - _landerPose.x;
+					float delta_y = playerPos_y - _landerPose.y;
 
 					// Rotate the projectile towards target.
 
 					float targetAngleRad = atan2(delta_y, delta_x);
-					GMATRIXF transform{ pea.get<Transform>()->value };
-					transform.row4 = _landerTransform.value.row4;
-					GMatrix::RotateZGlobalF(transform,
-											targetAngleRad,
-											transform);
+					Pose2D pose = SharedActorMethods::PoseAt(*pea.get<Pose2D>(), { _landerPose.x, _landerPose.y, _landerPose.z, 1 });
+					pose.roll += targetAngleRad;
 
 					// Offset the missile spawn in the target direction.
 
 					GVECTORF startOffset{ delta_x, delta_y, 0, 1 };
 					GVector::NormalizeF(startOffset, startOffset);
 					GVector::ScaleF(startOffset, _peaShooter.offset, startOffset);
-					GMatrix::TranslateGlobalF(transform, startOffset, transform);
+					pose.x += startOffset.x;
+					pose.y += startOffset.y;
+					pose.z += startOffset.z;
 
 					flecsWorld->entity().is_a(pea)
 						.add<Projectile>()
@@ -148,7 +149,7 @@ bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 						.add<Alive>()
 						.add<Collidable>()
 						.set<Sender>({ SENDER::ENEMY })
-						.set<Transform>({ transform });
+						.set<Pose2D>(pose);
 				}
 			}
 		});
@@ -161,11 +162,9 @@ bool EnemyLogic::Init(	std::shared_ptr<world> _flecsWorld,
 void EnemyLogic::BaiterMovement(float _deltaTime,
 								const BaiterMovementStats& _movementStats,
 								SpeedBoost& _speedBoost,
-								Transform& _transform,
+								Pose2D& _pose,
 								FlipInfo& _flipInfo)
 {
-	std::random_device rd;
-	std::mt19937 gen(rd());
 	float dirMoving = 0;
 
 	if (_speedBoost.isBoosting)
@@ -174,35 +173,33 @@ void EnemyLogic::BaiterMovement(float _deltaTime,
 		{
 			case false:
 			{
-				_transform.value.row4.x -= (_speedBoost.speed * _deltaTime);
+				_pose.x -= (_speedBoost.speed * _deltaTime);
 				break;
 			}
 			case true:
 			{
-				_transform.value.row4.x += (_speedBoost.speed * _deltaTime);
+				_pose.x += (_speedBoost.speed * _deltaTime);
 				break;
 			}
 		}
+		_pose.dirty = true;
 
-		dirMoving = (playerPos_x < _transform.value.row4.x ? -1 : 1);
-		SharedActorMethods::FlipEntity(_deltaTime, dirMoving, _transform, _flipInfo);
+		dirMoving = (playerPos_x < _pose.x ? -1 : 1);
+		SharedActorMethods::FlipEntity(_deltaTime, dirMoving, _pose, _flipInfo);
 
 		/* Check if the baiter has been boosting for its alloted duration, and if it has, then generate new
 		boost stats, and stop the boost. */
 
-		std::chrono::nanoseconds timeSinceLastBoostNano;
-		timeSinceLastBoostNano = std::chrono::high_resolution_clock::now() - _speedBoost.lastBoost;
-		std::chrono::milliseconds timeSinceLastBoostMilli;
-		timeSinceLastBoostMilli = std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceLastBoostNano);
-		if (timeSinceLastBoostMilli > _speedBoost.curDuration)
+		SimTicks timeSinceLastBoost = simNow - _speedBoost.lastBoost;
+		if (timeSinceLastBoost > _speedBoost.curDuration.count())
 		{
-			_speedBoost.lastBoost = std::chrono::high_resolution_clock::now();
-			std::uniform_int_distribution<int> intervalRange(_speedBoost.intervalMin.count(),
-				_speedBoost.intervalMax.count());
-			_speedBoost.curInterval = std::chrono::milliseconds(intervalRange(gen));
-			std::uniform_int_distribution<int> boostDurationRange(_speedBoost.durationMin.count(),
-				_speedBoost.durationMax.count());
-			_speedBoost.curDuration = std::chrono::milliseconds(boostDurationRange(gen));
+			_speedBoost.lastBoost = simNow;
+			_speedBoost.curInterval = std::chrono::milliseconds(baiterRandom.NextRange(
+				static_cast<unsigned int>(_speedBoost.intervalMin.count()),
+				static_cast<unsigned int>(_speedBoost.intervalMax.count())));
+			_speedBoost.curDuration = std::chrono::milliseconds(baiterRandom.NextRange(
+				static_cast<unsigned int>(_speedBoost.durationMin.count()),
+				static_cast<unsigned int>(_speedBoost.durationMax.count())));
 			_speedBoost.isBoosting = false;
 		}
 
@@ -211,44 +208,42 @@ void EnemyLogic::BaiterMovement(float _deltaTime,
 
 	/* Check how long it has been since the baiter's last boost. If enough time has passed, initiate a boost. */
 
-	std::chrono::nanoseconds timeSinceLastBoostNano;
-	timeSinceLastBoostNano = std::chrono::high_resolution_clock::now() - _speedBoost.lastBoost;
-	std::chrono::milliseconds timeSinceLastBoostMilli;
-	timeSinceLastBoostMilli = std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceLastBoostNano);
-	if (timeSinceLastBoostMilli > _speedBoost.curInterval)
+	SimTicks timeSinceLastBoost = simNow - _speedBoost.lastBoost;
+	if (timeSinceLastBoost > _speedBoost.curInterval.count())
 	{
 		_speedBoost.isBoosting = true;
-		std::uniform_int_distribution<int> leftRight(0, 1);
-		_speedBoost.isMovingRight = leftRight(gen);
-		_speedBoost.lastBoost = std::chrono::high_resolution_clock::now();
+		_speedBoost.isMovingRight = baiterRandom.NextBool();
+		_speedBoost.lastBoost = simNow;
 		return;
 	}
 
 	/* Regular movement. If the baiter is not withing an acceptable range of the player, then move towards the player
 	on the x and y axis at a steady pace. */
 
-	float distFromPlayer_x = abs(playerPos_x) - abs(_transform.value.row4.x);
-	float distFromPlayer_y = abs(playerPos_y) - abs(_transform.value.row4.y);
+	float distFromPlayer_x = abs(playerPos_x) - abs(_pose.x);
+	float distFromPlayer_y = abs(playerPos_y) - abs(_pose.y);
 	if (abs(distFromPlayer_x) > _movementStats.followDistance)
 	{
-		if (playerPos_x < _transform.value.row4.x)
-			_transform.value.row4.x -= (_movementStats.speed * _deltaTime);
+		if (playerPos_x < _pose.x)
+			_pose.x -= (_movementStats.speed * _deltaTime);
 		else
-			_transform.value.row4.x += (_movementStats.speed * _deltaTime);
-		dirMoving = (playerPos_x < _transform.value.row4.x ? -1 : 1);
+			_pose.x += (_movementStats.speed * _deltaTime);
+		_pose.dirty = true;
+		dirMoving = (playerPos_x < _pose.x ? -1 : 1);
 	}
 	if (abs(distFromPlayer_y) > _movementStats.followDistance)
 	{
-		if (playerPos_y < _transform.value.row4.y)
-			_transform.value.row4.y -= (_movementStats.speed * _deltaTime);
+		if (playerPos_y < _pose.y)
+			_pose.y -= (_movementStats.speed * _deltaTime);
 		else
-			_transform.value.row4.y += (_movementStats.speed * _deltaTime);
+			_pose.y += (_movementStats.speed * _deltaTime);
+		_pose.dirty = true;
 	}
 	
-	SharedActorMethods::FlipEntity(_deltaTime, dirMoving, _transform, _flipInfo);
+	SharedActorMethods::FlipEntity(_deltaTime, dirMoving, _pose, _flipInfo);
 }
 
-void EnemyLogic::LanderMovement(entity _lander, Transform& _landerTransform, const Speed& _speed)
+void EnemyLogic::LanderMovement(entity _lander, Pose2D& _landerPose, const Speed& _speed)
 {
 	// Check if lander currently has a civilian captured.
 	switch (_lander.has<Capturing>())
@@ -259,7 +254,7 @@ void EnemyLogic::LanderMovement(entity _lander, Transform& _landerTransform, con
 			unsigned int civisCaptured = 0;
 			float closestCivi = FLT_MAX;
 			civiQuery.each(
-				[&](entity _civi, const Civilian&, CaptureInfo _captureInfo, const Transform& _civiTransform)
+				[&](entity _civi, const Civilian&, CaptureInfo _captureInfo, const Pose2D& _civiPose)
 				{
 					// Don't want to chase a civi that is already captured.
 					if (_captureInfo.captured == true)
@@ -268,8 +263,8 @@ void EnemyLogic::LanderMovement(entity _lander, Transform& _landerTransform, con
 						return;
 					}
 
-					GVECTOR2F landerPos{ _landerTransform.value.row4.x, _landerTransform.value.row4.y };
-					GVECTOR2F civiPos{ _civiTransform.value.row4.x, _civiTransform.value.row4.y };
+					GVECTOR2F landerPos{ _landerPose.x, _landerPose.y };
+					GVECTOR2F civiPos{ _civiPose.x, _civiPose.y };
 					float distFromCivi = DISTANCE_2D(landerPos.x, landerPos.y, civiPos.x, civiPos.y);
 					if (distFromCivi <= closestCivi)
 					{
@@ -280,17 +275,20 @@ void EnemyLogic::LanderMovement(entity _lander, Transform& _landerTransform, con
 						GVector::NormalizeF(towardsCivi, towardsCivi);
 						float magnitude = _lander.delta_time() * _speed.value;
 						GVector::ScaleF(towardsCivi, magnitude, towardsCivi);
-						GMatrix::TranslateGlobalF(_landerTransform.value, towardsCivi, _landerTransform.value);
+						_landerPose.x += towardsCivi.x;
+						_landerPose.y += towardsCivi.y;
+						_landerPose.dirty = true;
 					}
 				});
 
 			// If all the civis were taken, then fly towards the player instead.
 			if (civisCaptured == civiQuery.count())
 			{
-				if (playerPos_x < _landerTransform.value.row4.x)
-					_landerTransform.value.row4.x -= _lander.delta_time() * _speed.value;
+				if (playerPos_x < _landerPose.x)
+					_landerPose.x -= _lander.delta_time() * _speed.value;
 				else
-					_landerTransform.value.row4.x += _lander.delta_time() * _speed.value;
+					_landerPose.x += _lander.delta_time() * _speed.value;
+				_landerPose.dirty = true;
 			}
 
 			break;
@@ -302,14 +300,15 @@ void EnemyLogic::LanderMovement(entity _lander, Transform& _landerTransform, con
 			GVector::NormalizeF(up, up);
 			float magnitude = _lander.delta_time() * _speed.value;
 			GVector::ScaleF(up, magnitude, up);
-			GMatrix::TranslateGlobalF(_landerTransform.value, up, _landerTransform.value);
+			_landerPose.y += up.y;
+			_landerPose.dirty = true;
 			break;
 		}
 	}
 }
 
 void EnemyLogic::BomberMovement(float _deltaTime, float _speed,
-								flecs::entity _entity, Transform& _transform,
+								flecs::entity _entity, Pose2D& _pose,
 								Velocity& _velocity, FlipInfo& _flipInfo,
 								float _bottom, float _top)
 {
@@ -323,53 +322,50 @@ void EnemyLogic::BomberMovement(float _deltaTime, float _speed,
 		DirMoving = 1;
 	}
 
-	if (_transform.value.row4.y <= _bottom)
+	if (_pose.y <= _bottom)
 	{
 		_velocity.value.y = -_velocity.value.y;
 	}
 
-	if (_transform.value.row4.y >= _top)
+	if (_pose.y >= _top)
 	{
 		_velocity.value.y = -_velocity.value.y;
 	}
 
-	SharedActorMethods::FlipEntity(_deltaTime, DirMoving, _transform, _flipInfo);
+	SharedActorMethods::FlipEntity(_deltaTime, DirMoving, _pose, _flipInfo);
 }
 
-void EnemyLogic::FireCannon(Transform& _enemyTransform, Cannon& _cannon)
+void EnemyLogic::FireCannon(const Pose2D& _enemyPose, Cannon& _cannon)
 {
-	std::chrono::milliseconds timeSinceLastCannonball;
-	timeSinceLastCannonball = std::chrono::duration_cast<std::chrono::milliseconds>(
-		std::chrono::high_resolution_clock::now() - _cannon.prevFireTime);
-	if (timeSinceLastCannonball < _cannon.fireRate)
+	SimTicks timeSinceLastCannonball = simNow - _cannon.prevFireTime;
+	if (timeSinceLastCannonball < _cannon.fireRate.count())
 		return;
-	_cannon.prevFireTime = std::chrono::high_resolution_clock::now();
+	_cannon.prevFireTime = simNow;
 
 	entity cannonBall{};
-	std::string cannonballPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::CANNONBALL);
+	static const std::string cannonballPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::CANNONBALL);
 	if (RetreivePrefab(cannonballPrefab.c_str(), cannonBall))
 	{
 		/* Add an offset to how we're measuring the player's position based off its velocity, so that the
 		Baiter can lead the player with its shots. */
 
-		float delta_x = (playerPos_x + playerVelocity_x * _cannon.aimLeadScaler) - _enemyTransform.value.row4.x;
-		float delta_y = (playerPos_y + playerVelocity_y * _cannon.aimLeadScaler) - _enemyTransform.value.row4.y;
+		float delta_x = (playerPos_x + playerVelocity_x * _cannon.aimLeadScaler) - _enemyPose.x;
+		float delta_y = (playerPos_y + playerVelocity_y * _cannon.aimLeadScaler) - _enemyPose.y;
 
 		// Rotate the projectile towards target.
 
 		float targetAngleRad = atan2(delta_y, delta_x);
-		GMATRIXF transform{ cannonBall.get<Transform>()->value };
-		transform.row4 = _enemyTransform.value.row4;
-		GMatrix::RotateZGlobalF(transform,
-								targetAngleRad,
-								transform);
+		Pose2D pose = SharedActorMethods::PoseAt(*cannonBall.get<Pose2D>(), { _enemyPose.x, _enemyPose.y, _enemyPose.z, 1 });
+		pose.roll += targetAngleRad;
 
 		// Offset the missile spawn in the target direction.
 
 		GVECTORF startOffset{ delta_x, delta_y, 0, 1 };
 		GVector::NormalizeF(startOffset, startOffset);
 		GVector::ScaleF(startOffset, _cannon.offset, startOffset);
-		GMatrix::TranslateGlobalF(transform, startOffset, transform);
+		pose.x += startOffset.x;
+		pose.y += startOffset.y;
+		pose.z += startOffset.z;
 
 		flecsWorld->entity().is_a(cannonBall)
 			.add<Projectile>()
@@ -377,38 +373,44 @@ void EnemyLogic::FireCannon(Transform& _enemyTransform, Cannon& _cannon)
 			.add<Alive>()
 			.add<Collidable>()
 			.set<Sender>({ SENDER::ENEMY })
-			.set<Transform>({ transform });
+			.set<Pose2D>(pose);
 	}
 
-	SoundClips clips = *cannonBall.get<SoundClips>();
-	clips.sounds["Shoot"]->Play();
+	SharedActorMethods::PlaySound(*flecsWorld, *cannonBall.get<SoundClips>(), SOUND_SLOT::SHOOT_FX);
 }
 
-void GOG::EnemyLogic::SpawnBomberTrap(Transform& _transform, Velocity& _velocity, BomberTrap& _trap)
+void GOG::EnemyLogic::SpawnBomberTrap(const Pose2D& _pose, Velocity& _velocity, BomberTrap& _trap)
 {
-	std::chrono::milliseconds sinceLastTrap = std::chrono::duration_cast<std::chrono::milliseconds>(
-		std::chrono::high_resolution_clock::now() - _trap.prevFireTime);
-	if (sinceLastTrap < _trap.fireRate)
+	SimTicks sinceLastTrap = simNow - _trap.prevFireTime;
+	if (sinceLastTrap < _trap.fireRate.count())
 		return;
-	_trap.prevFireTime = std::chrono::high_resolution_clock::now();
+	_trap.prevFireTime = simNow;
 
 	entity trap{};
-	std::string trapPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::TRAP);
+	static const std::string trapPrefab = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::TRAP);
 
 	if (RetreivePrefab(trapPrefab.c_str(), trap))
 	{
+		// the trap leaves turned and sized like the bomber that laid it
+		Pose2D trapPose = _pose;
+		trapPose.dirty = true;
+
 		flecsWorld->entity().is_a(trap)
 			.add<Projectile>()
 			.add<Trap>()
 			.add<Alive>()
 			.add<Collidable>()
 			.set<Sender>({ SENDER::ENEMY })
-			.set<Transform>({ _transform })
+			.set<Pose2D>(trapPose)
 			.set_override<Velocity>({ -_velocity.value.x, -_velocity.value.y });
 	}
 
-	SoundClips clips = *trap.get<SoundClips>();
-	clips.sounds["Shoot"]->Play();
+	SharedActorMethods::PlaySound(*flecsWorld, *trap.get<SoundClips>(), SOUND_SLOT::SHOOT_FX);
+}
+
+void EnemyLogic::Reset()
+{
+	baiterRandom.Seed(flecsWorld->get<WorldSeed>()->value, RANDOM_STREAM::BAITER_MOVEMENT);
 }
 
 // Free any resources used to run this system
@@ -4,11 +4,14 @@
 
 #include "../GameConfig.h"
 
+#include "../Events/EventBus.h"
+
 #include "../Components/Identification.h"
 #include "../Components/Gameplay.h"
 #include "../Components/Physics.h"
 
-#include <random>
+#include "../Utils/Random.h"
+#include "../Utils/WorldSnapshot.h"
 
 namespace GOG
 {
@@ -17,47 +20,56 @@ namespace GOG
 		// non-ownership handle to configuration settings
 		std::weak_ptr<const GameConfig> gameConfig;
 		// handle to events
-		GW::CORE::GEventGenerator eventPusher;
+		EventBus* eventBus;
 		// shared connection to the main ECS engine
 		std::shared_ptr<flecs::world> flecsWorld;
 
-		flecs::query<const Player, const Transform, const Velocity> playerMovementQuery;
+		flecs::query<const Player, const Pose2D, const Velocity> playerMovementQuery;
 		float playerPos_x;
 		float playerPos_y;
 		float playerVelocity_x;
 		float playerVelocity_y;
-		flecs::query<const Baiter, const BaiterMovementStats, SpeedBoost, Transform, FlipInfo, Cannon> baiterQuery;
-		flecs::query<const Civilian, CaptureInfo, const Transform> civiQuery;
+		// simulation time sampled once at the start of each enemy system
+		SimTicks simNow = 0;
+		// baiter boost timing and direction
+		Pcg32 baiterRandom;
+		flecs::query<const Baiter, const BaiterMovementStats, SpeedBoost, Pose2D, FlipInfo, Cannon> baiterQuery;
+		flecs::query<const Civilian, CaptureInfo, const Pose2D> civiQuery;
 		flecs::system landerSystem;
 
 
 		void BaiterMovement(float _deltaTime, 
 							const BaiterMovementStats& _movementStats, 
 							SpeedBoost& _speedBoost, 
-							Transform& _transform,
+							Pose2D& _pose,
 							FlipInfo& _flipInfo);
-		void LanderMovement(flecs::entity _lander, Transform& _landerTransform, const Speed& _speed);
-		void FireCannon(Transform& _transform, Cannon& _cannon);
+		void LanderMovement(flecs::entity _lander, Pose2D& _landerPose, const Speed& _speed);
+		void FireCannon(const Pose2D& _pose, Cannon& _cannon);
 
 		flecs::query<const Bomber, 
-					Transform, 
+					Pose2D, 
 					Velocity, 
 					FlipInfo, BomberTrap> bomberQuery;
 		void BomberMovement(float _deltaTime, float _speed, 
 							/*float _topBound, float _bottomBound,*/
 							flecs::entity _entity,
-							Transform& _transform,
+							Pose2D& _pose,
 							Velocity& _velocity,
 							FlipInfo& _flipInfo, float _bottom, float _top);
 
-		void SpawnBomberTrap(Transform& _transform, Velocity& _velocity, BomberTrap& _trap);
+		void SpawnBomberTrap(const Pose2D& _pose, Velocity& _velocity, BomberTrap& _trap);
 
 	public:
 
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game,
 					std::weak_ptr<const GameConfig> _gameConfig,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus);
+		// restart the movement stream so a new session plays out the same for the same seed
+		void Reset();
+		// the movement stream, stored alongside the world in snapshots
+		void SaveState(SnapshotWriter& _writer) const { _writer.Write(baiterRandom); }
+		bool LoadState(SnapshotReader& _reader) { return _reader.Read(baiterRandom); }
 		// control if the system is actively running
 		bool Activate(bool _runSystem);
 		// release any resources allocated by the system
@@ -7,18 +7,19 @@ bool GOG::GameLogic::Init(
 	std::weak_ptr<GameConfig> _gameConfig,
 	GW::AUDIO::GAudio* _audioEngine,
 	AudioData* _audioData,
-	GW::CORE::GEventGenerator _eventPusher)
+	EventBus* _eventBus,
+	CommandBuffers* _gameCommands,
+	FrameClock* _frameClock)
 {
 	flecsWorld = _game;
-	flecsWorldAsync = flecsWorld->async_stage();
-	flecsWorldLock.Create();
 
 	d3d11RenderingSystem = _d3d11RenderingSystem;
 	window = _win;
 	audioEngine = _audioEngine;
 	audioData = _audioData;
 	gameConfig = _gameConfig;
-	eventPusher = _eventPusher;
+	eventBus = _eventBus;
+	frameClock = _frameClock;
 
 	wasEscapePressed = false;
 	wasPausePressed = false;
@@ -32,18 +33,9 @@ bool GOG::GameLogic::Init(
 
 	LoadHighScores(_gameConfig);
 
-	struct MergeAsyncStages {}; // local definition so we control iteration counts
-	flecsWorld->entity("MergeAsyncStages").add<MergeAsyncStages>();
-	// only happens once per frame at the very start of the frame
-	flecsWorld->system<MergeAsyncStages>()
-		.kind(flecs::OnLoad) // first defined phase
-		.each([this](flecs::entity _entity, MergeAsyncStages& _mergeAsyncChanges)
-			{
-				// merge any waiting changes from the last frame that happened on other threads
-				flecsWorldLock.LockSyncWrite();
-				flecsWorldAsync.merge();
-				flecsWorldLock.UnlockSyncWrite();
-			});
+	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
+	profileFrames = readCfg->at("Profiler").at("captureFrames").as<unsigned int>();
+	profileFile = readCfg->at("Profiler").at("captureFile").as<std::string>();
 
 	if (InitAudio() == false)
 		return false;
@@ -51,6 +43,15 @@ bool GOG::GameLogic::Init(
 		return false;
 	if (InitEvents() == false)
 		return false;
+	if (simulation.Init(flecsWorld,
+		gameConfig,
+		gamePads,
+		*audioEngine,
+		audioData,
+		eventBus,
+		_gameCommands,
+		frameClock) == false)
+		return false;
 
 	return true;
 }
@@ -68,23 +69,13 @@ bool GOG::GameLogic::InitInput()
 
 bool GOG::GameLogic::InitEvents()
 {
-	onEvent.Create([this](const GW::GEvent& _event)
+	eventBus->Subscribe(PLAY_EVENT::GAME_OVER, [this](PLAY_EVENT _event, PLAY_EVENT_DATA _data)
 		{
-			PLAY_EVENT eventTag;
-			PLAY_EVENT_DATA data;
-
-			if (+_event.Read(eventTag, data))
-			{
-				if (eventTag == PLAY_EVENT::GAME_OVER)
-				{
-					gameOverFX->Play();
-					PlayMusic(nullptr);
-					PauseSystems();
-					currState = GAME_STATES::GAME_OVER_SCREEN;
-				}
-			}
-		}); 
-	eventPusher.Register(onEvent);
+			audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, gameOverFX);
+			PlayMusic(nullptr);
+			simulation.Pause();
+			currState = GAME_STATES::GAME_OVER_SCREEN;
+		});
 
 	return true;
 }
@@ -133,12 +124,43 @@ void GOG::GameLogic::PlayMusic(GW::AUDIO::GMusic* _music)
 		_music->Play(true);
 }
 
-void GOG::GameLogic::CheckInput()
+GOG::InputFrame GOG::GameLogic::SampleInput()
 {
-	// Received input
+	InputFrame frame = {};
+	// Received inputs
+	float inputX = 0, inputY = 0, inputProjectile = 0, inputSmartBomb = 0;
 	float pauseInput = 0, escInput = 0, enterInput = 0, cInput = 0;
 	// Calculated input values.
 	float pauseValue = 0, escValue = 0, enterValue = 0, cValue = 0;
+
+	bool isControllerConnected = false;
+	gamePads.IsConnected(0, isControllerConnected);
+
+	// Movement controls.
+	if (isControllerConnected)
+	{
+		gamePads.GetState(0, G_LX_AXIS, inputX); frame.moveX += inputX;
+		gamePads.GetState(0, G_LY_AXIS, inputY); frame.moveY += inputY;
+	}
+	keyboardMouseInput.GetState(G_KEY_LEFT, inputX); frame.moveX -= inputX;
+	keyboardMouseInput.GetState(G_KEY_RIGHT, inputX); frame.moveX += inputX;
+	keyboardMouseInput.GetState(G_KEY_UP, inputY); frame.moveY += inputY;
+	keyboardMouseInput.GetState(G_KEY_DOWN, inputY); frame.moveY -= inputY;
+
+	// Attack controls.
+	if (isControllerConnected)
+	{
+		gamePads.GetState(0, G_RIGHT_TRIGGER_AXIS, inputProjectile);
+		gamePads.GetState(0, G_LEFT_TRIGGER_AXIS, inputSmartBomb);
+	}
+	frame.fire += inputProjectile;
+	frame.smartBomb += inputSmartBomb;
+	keyboardMouseInput.GetState(G_KEY_SPACE, inputProjectile);
+	keyboardMouseInput.GetState(G_KEY_B, inputSmartBomb);
+	frame.fire += inputProjectile;
+	frame.smartBomb += inputSmartBomb;
+
+	// Menu controls.
 	keyboardMouseInput.GetState(G_KEY_P, pauseInput); pauseValue += pauseInput;
 	keyboardMouseInput.GetState(G_KEY_ESCAPE, escInput); escValue += escInput;
 	keyboardMouseInput.GetState(G_KEY_ENTER, enterInput); enterValue += enterInput;
@@ -148,8 +170,43 @@ void GOG::GameLogic::CheckInput()
 	gamePads.GetState(0, G_SOUTH_BTN, enterInput); enterValue += enterInput;
 	gamePads.GetState(0, G_SELECT_BTN, cInput); cValue += cInput;
 
-	auto timer = std::chrono::system_clock::now().time_since_epoch();
-	unsigned int now = std::chrono::duration_cast<std::chrono::milliseconds>(timer).count();
+	frame.buttons =
+		(pauseValue ? INPUT_BUTTON::PAUSE_BUTTON : 0) |
+		(escValue ? INPUT_BUTTON::BACK_BUTTON : 0) |
+		(enterValue ? INPUT_BUTTON::CONFIRM_BUTTON : 0) |
+		(cValue ? INPUT_BUTTON::CREDITS_BUTTON : 0);
+
+	return frame;
+}
+
+void GOG::GameLogic::CheckInput()
+{
+	PROFILE_ZONE("CheckInput");
+	// the player systems read the same frame through the world
+	input = SampleInput();
+	flecsWorld->set<InputFrame>(input);
+
+	// a debug key, deliberately not part of the input frame so it never ends up in a recording
+	float profileInput = 0;
+	keyboardMouseInput.GetState(G_KEY_F11, profileInput);
+	if (profileInput && !wasProfilePressed)
+		Profiler::Get().StartCapture(profileFrames, profileFile);
+	wasProfilePressed = profileInput != 0;
+
+	// F3 shows the performance HUD, another debug key kept out of the input frame
+	float hudInput = 0;
+	keyboardMouseInput.GetState(G_KEY_F3, hudInput);
+	if (hudInput && !wasHudPressed)
+		d3d11RenderingSystem->GetPerfHud().Toggle();
+	wasHudPressed = hudInput != 0;
+
+	bool pauseValue = input.buttons & INPUT_BUTTON::PAUSE_BUTTON;
+	bool escValue = input.buttons & INPUT_BUTTON::BACK_BUTTON;
+	bool enterValue = input.buttons & INPUT_BUTTON::CONFIRM_BUTTON;
+	bool cValue = input.buttons & INPUT_BUTTON::CREDITS_BUTTON;
+
+	// real time keeps running through pauses, unlike the simulation clock
+	unsigned int now = static_cast<unsigned int>(frameClock->RealNow());
 
 	switch (currState)
 	{
@@ -161,7 +218,7 @@ void GOG::GameLogic::CheckInput()
 			if ((enterValue && !wasEnterPressed) || (now - splashScreenStart > splashScreenTime))
 			{
 				if (enterValue)
-					menuClickFX->Play();
+					audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				splashScreenStart = now;
 				FadeInEvent();
 				currState = GAME_STATES::DIRECTX_SCREEN;
@@ -174,7 +231,7 @@ void GOG::GameLogic::CheckInput()
 			if ((enterValue && !wasEnterPressed) || (now - splashScreenStart > splashScreenTime))
 			{
 				if (enterValue)
-					menuClickFX->Play();
+					audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				splashScreenStart = now;
 				FadeInEvent();
 				currState = GAME_STATES::GATEWARE_SCREEN;
@@ -187,7 +244,7 @@ void GOG::GameLogic::CheckInput()
 			if ((enterValue && !wasEnterPressed) || (now - splashScreenStart > splashScreenTime))
 			{
 				if (enterValue)
-					menuClickFX->Play();
+					audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				splashScreenStart = now;
 				FadeInEvent();
 				currState = GAME_STATES::FLECS_SCREEN;
@@ -200,7 +257,7 @@ void GOG::GameLogic::CheckInput()
 			if ((enterValue && !wasEnterPressed) || (now - splashScreenStart > splashScreenTime))
 			{
 				if (enterValue)
-					menuClickFX->Play();
+					audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				splashScreenStart = now;
 				FadeInEvent();
 				currState = GAME_STATES::TITLE_SCREEN;
@@ -213,7 +270,7 @@ void GOG::GameLogic::CheckInput()
 			if ((enterValue && !wasEnterPressed) || (now - splashScreenStart > splashScreenTime))
 			{
 				if (enterValue)
-					menuClickFX->Play();
+					audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&menuMusic);
 				FadeInEvent();
 				currState = GAME_STATES::MAIN_MENU;
@@ -225,7 +282,7 @@ void GOG::GameLogic::CheckInput()
 		{
 			if (enterValue && !wasEnterPressed)
 			{
-				menuClickFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&gameMusic);
 				FadeInEvent();
 				GameplayStart();
@@ -235,7 +292,7 @@ void GOG::GameLogic::CheckInput()
 
 			if (cValue && !wasCreditsPressed)
 			{
-				pauseFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, pauseFX);
 				PlayMusic(&creditsMusic);
 				FadeInEvent();
 				currState = GAME_STATES::CREDITS;
@@ -248,8 +305,8 @@ void GOG::GameLogic::CheckInput()
 		{
 			if (pauseValue && !wasPausePressed)
 			{
-				pauseFX->Play();
-				PauseSystems();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, pauseFX);
+				simulation.Pause();
 				currState = GAME_STATES::PAUSE_GAME;
 				d3d11RenderingSystem->UpdateGameState(GAME_STATES::PAUSE_GAME);
 			}
@@ -260,15 +317,15 @@ void GOG::GameLogic::CheckInput()
 		{
 			if ((enterValue && !wasEnterPressed) || (pauseValue && !wasPausePressed))
 			{
-				menuClickFX->Play();
-				PlaySystems();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
+				simulation.Play();
 				currState = GAME_STATES::PLAY_GAME;
 				d3d11RenderingSystem->UpdateGameState(GAME_STATES::PLAY_GAME);
 			}
 
 			if (escValue && !wasEscapePressed)
 			{
-				menuClickFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&menuMusic);
 				currState = GAME_STATES::MAIN_MENU;
 				d3d11RenderingSystem->UpdateGameState(GAME_STATES::MAIN_MENU);
@@ -281,7 +338,7 @@ void GOG::GameLogic::CheckInput()
 		{
 			if (enterValue && !wasEnterPressed)
 			{
-				menuClickFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&gameMusic);
 				GameplayStop();
 				FadeInEvent();
@@ -291,9 +348,18 @@ void GOG::GameLogic::CheckInput()
 				
 			}
 
+			if (cValue && !wasCreditsPressed && GameplayContinue())
+			{
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
+				PlayMusic(&gameMusic);
+				FadeInEvent();
+				currState = GAME_STATES::PLAY_GAME;
+				d3d11RenderingSystem->UpdateGameState(GAME_STATES::PLAY_GAME);
+			}
+
 			if (escValue && !wasEscapePressed)
 			{
-				menuClickFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&menuMusic);
 				currState = GAME_STATES::MAIN_MENU;
 				d3d11RenderingSystem->UpdateGameState(GAME_STATES::MAIN_MENU);
@@ -308,7 +374,7 @@ void GOG::GameLogic::CheckInput()
 		{
 			if (escValue && !wasEscapePressed)
 			{
-				menuClickFX->Play();
+				audioData->QueueCommand(AUDIO_COMMAND::PLAY_SOUND, menuClickFX);
 				PlayMusic(&menuMusic);
 				FadeInEvent();
 				currState = GAME_STATES::MAIN_MENU;
@@ -341,105 +407,49 @@ void GOG::GameLogic::CheckInput()
 		wasCreditsPressed = true;
 	else
 		wasCreditsPressed = false;
+
+	simulatedThisFrame = simulation.IsRunning();
+}
+
+void GOG::GameLogic::RecordTick()
+{
+	if (simulatedThisFrame)
+		recorder.Tick(input, frameClock->DeltaTime(), flecsWorld->get<SimClock>()->now);
 }
 
 bool::GOG::GameLogic::GameplayStart()
 {
-	if (systemsInitialized)
-	{
-		PlaySystems();
-		levelLogic.Reset();
-		cameraLogic.Reset();
-		return true;
-	}
+	// the session starts on this frame's simulation time, before the systems first run
+	recorder.Begin(flecsWorld->get<WorldSeed>()->value, flecsWorld->get<SimClock>()->now);
 
-	if (playerLogic.Init(flecsWorld,
-		gameConfig,
-		keyboardMouseInput,
-		gamePads,
-		*audioEngine,
-		*eventPusher) == false)
-		return false;
-	if (levelLogic.Init(flecsWorld, gameConfig, *audioData, *eventPusher) == false)
-		return false;
-	if (physicsLogic.Init(flecsWorld, gameConfig, *eventPusher) == false)
-		return false;
-	if (lazerLogic.Init(flecsWorld, gameConfig) == false)
-		return false;
-	if (missileLogic.Init(flecsWorld, gameConfig) == false)
-		return false;
-	if (trapLogic.Init(flecsWorld, gameConfig) == false)
-		return false;
-	if (enemyLogic.Init(flecsWorld, gameConfig, *eventPusher) == false)
-		return false;
-	if (pickupLogic.Init(flecsWorld, gameConfig, *eventPusher) == false)
-		return false;
-	if (cameraLogic.Init(flecsWorld, gameConfig, d3d11RenderingSystem) == false)
+	return simulation.Start();
+}
+
+bool GOG::GameLogic::GameplayContinue()
+{
+	if (recorder.Continue() == false)
 		return false;
 
-	systemsInitialized = true;
+	const Lives* lives = flecsWorld->entity("Persistent Player Stats").get<Lives>();
+	const Score* score = flecsWorld->entity("Persistent Player Stats").get<Score>();
+	const NukeDispenser* bombs = flecsWorld->entity("Persistent Player Stats").get<NukeDispenser>();
+	d3d11RenderingSystem->UpdateStats(lives->count, score->value, bombs->bombs, simulation.GetWave());
 
+	simulation.Play();
 	return true;
 }
 
 void GOG::GameLogic::GameplayStop()
 {
-	PauseSystems();
-
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
 
 	unsigned int defaultLives = readCfg->at("PlayerPrefab_1").at("lives").as<unsigned int>();
 	d3d11RenderingSystem->UpdateStats(defaultLives, 0, 0, 1);
 
-	flecsWorldLock.LockSyncWrite();
-
 	UpdateHighScores(gameConfig, flecsWorld->entity("Persistent Player Stats").get<Score>()->value);
 
-	flecsWorldAsync.entity("Persistent Player Stats")
-		.set<Lives>({ defaultLives })
-		.set<Score>({ 0 })
-		.set<NukeDispenser>(
-			{
-				0,
-				readCfg->at("NukeDispenser").at("range").as<float>(),
-				readCfg->at("NukeDispenser").at("maxCapacity").as<unsigned int>()
-			});
-
-
-	flecsWorldAsync.each([this](flecs::entity _entity, Transform&)
-		{
-			if (!_entity.has<Camera>())
-				_entity.destruct();
-		});
-
-	flecsWorldLock.UnlockSyncWrite();
-
-}
-
-void GOG::GameLogic::PauseSystems()
-{
-	playerLogic.Activate(false);	
-	levelLogic.Activate(false);
-	physicsLogic.Activate(false);	
-	lazerLogic.Activate(false);	
-	missileLogic.Activate(false);
-	trapLogic.Activate(false);
-	enemyLogic.Activate(false);
-	pickupLogic.Activate(false);
-	cameraLogic.Activate(false);
-}
-
-void GOG::GameLogic::PlaySystems()
-{
-	playerLogic.Activate(true);
-	levelLogic.Activate(true);
-	physicsLogic.Activate(true);
-	lazerLogic.Activate(true);
-	missileLogic.Activate(true);
-	trapLogic.Activate(true);
-	enemyLogic.Activate(true);
-	pickupLogic.Activate(true);
-	cameraLogic.Activate(true);
+	simulation.Stop();
+	recorder.End();
 }
 
 void GOG::GameLogic::LoadHighScores(std::weak_ptr<const GameConfig> _gameConfig)
@@ -483,35 +493,15 @@ void GOG::GameLogic::UpdateHighScores(std::weak_ptr<GameConfig> _gameConfig, uns
 
 void GOG::GameLogic::FadeInEvent()
 {
-	GW::GEvent stateChanged;
 	PLAY_EVENT_DATA data;
 	data.value = 0;
-	stateChanged.Write(PLAY_EVENT::STATE_CHANGED, data);
-	eventPusher.Push(stateChanged);
+	eventBus->Push(PLAY_EVENT::STATE_CHANGED, data);
 }
 
 bool GOG::GameLogic::Shutdown()
 {
-	if (playerLogic.Shutdown() == false)
-		return false;
-	if (levelLogic.Shutdown() == false)
-		return false;
-	if (physicsLogic.Shutdown() == false)
-		return false;	
-	if (lazerLogic.Shutdown() == false)
-		return false;
-	if (missileLogic.Shutdown() == false)
-		return false;
-	if (trapLogic.Shutdown() == false)
-		return false;
-	if (enemyLogic.Shutdown() == false)
-		return false;
-	if (pickupLogic.Shutdown() == false)
-		return false;
-	if (cameraLogic.Shutdown() == false)
-		return false;
+	// keep a session that was still running when the game closed
+	recorder.End();
 
-	flecsWorld->entity("MergeAsyncStages").destruct();
-
-	return true;
+	return simulation.Shutdown();
 }
\ No newline at end of file
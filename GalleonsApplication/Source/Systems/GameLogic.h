@@ -1,16 +1,13 @@
 #ifndef GAMELOGIC_H
 #define GAMELOGIC_H
 
-#include "../Systems/PlayerLogic.h"
-#include "../Systems/EnemyLogic.h"
-#include "../Systems/LazerLogic.h"
-#include "../Systems/LevelLogic.h"
-#include "../Systems/PhysicsLogic.h"
-#include "../Systems/CameraLogic.h"
-#include "../Systems/PickupLogic.h"
+#include "../Systems/Simulation.h"
+#include "../Systems/SessionRecorder.h"
 #include "../Systems/Renderer.h"
-#include "../Systems/MissileLogic.h"
-#include "../Systems/TrapLogic.h"
+
+#include "../Utils/FrameClock.h"
+#include "../Utils/CommandBuffers.h"
+#include "../Utils/Profiler.h"
 
 
 namespace GOG
@@ -24,27 +21,29 @@ namespace GOG
 		GW::AUDIO::GAudio* audioEngine; // can create music & sound effects
 		AudioData* audioData;
 		
-		GW::CORE::GEventResponder onEvent;
-		GW::CORE::GEventGenerator eventPusher;
+		EventBus* eventBus;
 		std::weak_ptr<GameConfig> gameConfig; // .ini file game settings
 
-		GOG::EnemyLogic enemyLogic;
-		GOG::LazerLogic lazerLogic;
-		GOG::MissileLogic missileLogic;
-		GOG::TrapLogic trapLogic;
-		GOG::PickupLogic pickupLogic;
-		GOG::LevelLogic levelLogic;
-		GOG::PhysicsLogic physicsLogic;
-		GOG::PlayerLogic playerLogic;
-		GOG::CameraLogic cameraLogic;
+		// every gameplay system, this class only adds menus, music and presentation on top
+		GOG::Simulation simulation;
 
 		std::shared_ptr<flecs::world> flecsWorld;
 		DirectX11Renderer* d3d11RenderingSystem;
-
-		flecs::world flecsWorldAsync;
-		GW::CORE::GThreadShared flecsWorldLock;
-
-		bool systemsInitialized = false;
+		// owned by the application, real time drives the splash screens
+		FrameClock* frameClock;
+
+		// this frame's input, sampled once at the top of CheckInput
+		InputFrame input = {};
+		// set when the gameplay systems run this frame, only those ticks are recorded
+		bool simulatedThisFrame = false;
+		// input log, checkpoint and recent frames of the session being played
+		SessionRecorder recorder;
+
+		// F11 traces the next profileFrames frames to profileFile (builds with GALLEONS_PROFILE)
+		unsigned int profileFrames = 0;
+		std::string profileFile;
+		bool wasProfilePressed = false;
+		bool wasHudPressed = false;
 
 		unsigned int splashScreenTime = 4000;
 		unsigned int splashScreenStart = -1;
@@ -56,9 +55,9 @@ namespace GOG
 		unsigned int currState;
 		GW::SYSTEM::GWindow window;
 
-		GW::AUDIO::GSound* pauseFX;
-		GW::AUDIO::GSound* menuClickFX;
-		GW::AUDIO::GSound* gameOverFX;
+		SoundId pauseFX;
+		SoundId menuClickFX;
+		SoundId gameOverFX;
 
 		GW::AUDIO::GMusic menuMusic;
 		GW::AUDIO::GMusic creditsMusic;
@@ -75,18 +74,24 @@ namespace GOG
 			std::weak_ptr<GameConfig> _gameConfig,
 			GW::AUDIO::GAudio* _audioEngine,
 			AudioData* _audioData,
-			GW::CORE::GEventGenerator _eventPusher);
+			EventBus* _eventBus,
+			CommandBuffers* _gameCommands,
+			FrameClock* _frameClock);
 
 		void LoadHighScores(std::weak_ptr<const GameConfig> _gameConfig);
 		void UpdateHighScores(std::weak_ptr<GameConfig> _gameConfig, unsigned int newScore);
 		void CheckInput();	
+		// Call after the frame's events were dispatched, logs the tick if the session is recorded
+		// and snapshots the frame
+		void RecordTick();
 		bool Shutdown();
 
 	private:
-		void PauseSystems();
-		void PlaySystems();
+		InputFrame SampleInput();
 		bool GameplayStart();
 		void GameplayStop();
+		// restores the last checkpoint after a game over
+		bool GameplayContinue();
 		bool InitInput();
 		bool InitEvents();
 		bool InitAudio();
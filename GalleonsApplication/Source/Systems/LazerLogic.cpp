@@ -3,6 +3,9 @@
 #include "../Components/Identification.h"
 #include "../Components/Physics.h"
 
+#include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
+
 using namespace GOG;
 using namespace flecs;
 using namespace GW;
@@ -18,24 +21,26 @@ bool LazerLogic::Init(	std::shared_ptr<flecs::world> _game,
 	flecsWorld = _game;
 	gameConfig = _gameConfig;
 
-	flecsWorld->system<Lazer, Transform, Speed>("LazerSystem")
-		.iter([](flecs::iter _it, Lazer*, Transform* _transform, Speed* _speed) 
+	flecsWorld->system<Lazer, Pose2D, Speed>("LazerSystem")
+		.iter([](flecs::iter _it, Lazer*, Pose2D* _pose, Speed* _speed) 
 		{
+			PROFILE_SYSTEM("LazerSystem");
 			for (auto i : _it)
 			{
 				if (_it.entity(i).is_alive())
 				{
 					GVECTORF translate{ _speed[i].value * _it.delta_time(), 0,  0, 0 };
-					GMatrix::TranslateLocalF(_transform[i].value, translate, _transform[i].value);
+					SharedActorMethods::TranslatePoseLocal(translate, _pose[i]);
 				}
 			}
 		});
 
-	peaSystem = flecsWorld->system<const Pea, Transform, const Speed>().each(
-		[](entity _pea, const Pea&, Transform& _transform, const Speed& _speed)
+	peaSystem = flecsWorld->system<const Pea, Pose2D, const Speed>("PeaSystem").each(
+		[](entity _pea, const Pea&, Pose2D& _pose, const Speed& _speed)
 		{
+			PROFILE_SYSTEM("PeaSystem");
 			GVECTORF translate{ _speed.value * _pea.delta_time(), 0,  0, 0 };
-			GMatrix::TranslateLocalF(_transform.value, translate, _transform.value);
+			SharedActorMethods::TranslatePoseLocal(translate, _pose);
 		});
 
 	return true;
@@ -1,4 +1,3 @@
-#include <random>
 #include "LevelLogic.h"
 
 #include "../Components/Gameplay.h"
@@ -7,6 +6,8 @@
 #include "../Entities/Prefabs.h"
 
 #include "../Utils/Macros.h"
+#include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
 
 #include "../Events/Playevents.h"
 
@@ -20,15 +21,15 @@ using namespace MATH;
 bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 	std::weak_ptr<const GameConfig> _gameConfig,
 	AudioData& _audioData,
-	GEventGenerator _eventPusher)
+	EventBus* _eventBus,
+	CommandBuffers* _gameCommands)
 {
 	flecsWorld = _flecsWorld;
-	// create an asynchronus version of the world
-	flecsWorldAsync = flecsWorld->async_stage(); // just used for adding stuff, don't try to read data
-	flecsWorldLock.Create();
+	// spawns are recorded here and merged at the start of the next frame, don't try to read data through it
+	gameCommands = _gameCommands;
 	gameConfig = _gameConfig;
-	eventPusher = _eventPusher;
-	playerQuery = flecsWorld->query<const Player, const Transform>();
+	eventBus = _eventBus;
+	playerQuery = flecsWorld->query<const Player, const Pose2D>();
 	civilianQuery = flecsWorld->query<const Civilian, const Score>();
 	smartBombQuery = flecsWorld->query<const SmartBomb>();
 	projectileQuery = flecsWorld->query<const Projectile>();
@@ -39,6 +40,7 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 	worldTop = readCfg->at("Game").at("worldTopBoundry").as<float>();
 	worldBottom = readCfg->at("Game").at("worldBottomBoundry").as<float>();
 	worldWidth = readCfg->at("Game").at("worldWidth").as<float>();
+	SeedRandomStreams();
 
 	spawnWaveDelay = readCfg->at("Waves").at("spawnWaveDelay").as<unsigned int>();
 	spawnBatchRate = readCfg->at("Waves").at("spawnBatchRate").as<unsigned int>();
@@ -59,20 +61,37 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 			.at("maxEnemiesPerWave_" + std::to_string(i)).as<float>());
 	}
 
-	SpawnPlayer();
-	SpawnWave();
+#pragma region Spawn Timers
 
-#pragma region Event Handler
+	struct LevelSpawnTimers {}; // local definition so we control iteration counts
+	flecsWorld->entity("Level System").add<LevelSpawnTimers>();
+	spawnSystem = flecsWorld->system<LevelSpawnTimers>("LevelSpawnSystem")
+		.each([this](flecs::entity _entity, LevelSpawnTimers&)
+			{
+				PROFILE_SYSTEM("LevelSpawnSystem");
+				SimTicks now = _entity.world().get<SimClock>()->now;
 
-	eventHandler.Create([this](const GW::GEvent& _event)
-		{
-			PLAY_EVENT event;
-			PLAY_EVENT_DATA data;
+				if (playerRespawnPending && now >= playerRespawnTime)
+				{
+					playerRespawnPending = false;
+					SpawnPlayer();
+				}
 
-			if (-_event.Read(event, data))
-				return;
+				if (batchesPending && now >= nextBatchTime)
+				{
+					nextBatchTime += spawnBatchRate;
+					SpawnBatch();
+				}
+			});
 
-			switch (event)
+#pragma endregion
+
+#pragma region Event Handler
+
+	eventBus->Subscribe({ PLAY_EVENT::PLAYER_DESTROYED, PLAY_EVENT::ENEMY_DESTROYED, PLAY_EVENT::WAVE_CLEARED },
+		[this](PLAY_EVENT _event, PLAY_EVENT_DATA data)
+		{
+			switch (_event)
 			{
 			case PLAY_EVENT::PLAYER_DESTROYED:
 			{
@@ -105,20 +124,15 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 				// If the player has lives left, then respawn.
 				if (data.value > 0)
 				{
-					playerSpawner.Create(1, [&]()
-						{
-							SpawnPlayer();
-							playerSpawner.Pause(0, false);
-						}, 1 * 1000);
+					playerRespawnTime = flecsWorld->get<SimClock>()->now + 1 * 1000;
+					playerRespawnPending = true;
 
 					SpawnWave();
 				}
 				else
 				{
-					GW::GEvent gameOver;
 					PLAY_EVENT_DATA data;
-					gameOver.Write(GOG::PLAY_EVENT::GAME_OVER, data);
-					eventPusher.Push(gameOver);
+					eventBus->Push(GOG::PLAY_EVENT::GAME_OVER, data);
 				}
 
 				break;
@@ -127,21 +141,26 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 			{
 				unsigned int waveSettingsIdx = min(waveNum, maxWaves - 1);
 
-				/* Edge Case: When the player dies by colliding with an enemy, this will cause the livingEnemies
-				count to reduce to 0, so by the time we get to this event handler, the usual subtraction
-				for destroying the enemy on collision will cause our count to become garbage. We are protecting
-				against this edge case with this if check. */
+				/* An enemy that rammed the player is counted like the ones the player's death destructed
+				(delivered just before this): it gets spawned again and can't clear the wave. */
+				if (data.directive & DIRECTIVES::ENEMY_RAMMED_PLAYER)
+				{
+					if (curEnemiesPerWave > 0)
+						curEnemiesPerWave -= 1;
+					if (livingEnemies > 0)
+						livingEnemies -= 1;
+					break;
+				}
+
 				if (livingEnemies > 0)
 					livingEnemies -= 1;
 
 				if (livingEnemies <= 0 && curEnemiesPerWave >= maxEnemiesPerWave[waveSettingsIdx -1])
 				{
-					GW::GEvent waveCleared;
 					PLAY_EVENT_DATA waveData;
 					waveNum += 1;
 					waveData.value = waveNum;
-					waveCleared.Write(GOG::PLAY_EVENT::WAVE_CLEARED, waveData);
-					eventPusher.Push(waveCleared);
+					eventBus->Push(GOG::PLAY_EVENT::WAVE_CLEARED, waveData);
 				}
 				break;
 
@@ -154,11 +173,9 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 				// Destruct any remaining civis and give the player the points for them.
 				civilianQuery.each([this](entity _entity, const Civilian&, const Score& _score)
 					{
-						GW::GEvent onCiviDestruct;
 						PLAY_EVENT_DATA civiDestructData;
 						civiDestructData.value = _score.value;
-						onCiviDestruct.Write(GOG::PLAY_EVENT::CIVILIAN_DESTROYED, civiDestructData);
-						eventPusher.Push(onCiviDestruct);
+						eventBus->Push(GOG::PLAY_EVENT::CIVILIAN_DESTROYED, civiDestructData);
 						_entity.destruct();
 					});
 				//  Destruct any remaining smart bombs from this wave.
@@ -183,25 +200,6 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 			}
 			}
 		});
-	eventPusher.Register(eventHandler);
-
-#pragma endregion
-
-#pragma region Merge Async Stages
-
-	// create a system the runs at the end of the frame only once to merge async changes
-	struct MergeAsyncStages {}; // local definition so we control iteration counts
-	_flecsWorld->entity("MergeAsyncStages").add<MergeAsyncStages>();
-	// only happens once per frame at the very start of the frame
-	flecsWorld->system<MergeAsyncStages>()
-		.kind(OnLoad) // first defined phase
-		.each([this](entity _entity, MergeAsyncStages& _mergeAsyncChanges)
-			{
-				// merge any waiting changes from the last frame that happened on other threads
-				flecsWorldLock.LockSyncWrite();
-				flecsWorldAsync.merge();
-				flecsWorldLock.UnlockSyncWrite();
-			});
 
 #pragma endregion
 
@@ -210,118 +208,120 @@ bool LevelLogic::Init(std::shared_ptr<world> _flecsWorld,
 
 void LevelLogic::SpawnPlayer()
 {
+	PROFILE_ZONE("SpawnPlayer");
 	entity newPlayer{};
 	if (RetreivePrefab("PlayerPrefab_1", newPlayer))
 	{
-		GMATRIXF transform = newPlayer.get<Transform>()->value;
+		GVECTORF spawnPos{ 0, 0, 0, 1 };
 		if (camQuery.first().is_alive())
-			transform.row4 = camQuery.first().get<Transform>()->value.row4;
-		transform.row4.z = 0;
-		flecsWorldLock.LockSyncWrite();
-		flecs::entity spawnedPlayer = flecsWorldAsync.entity().is_a(newPlayer)
-			.add<Player>()
-			.add<Alive>()
-			.add<Collidable>()
-			.set<Transform>({ transform })
-			.set<ControllerID>({ 0 });
-		flecsWorldLock.UnlockSyncWrite();
-
-		LoopingClips clips = *newPlayer.get<LoopingClips>();
-		clips.sounds["Accel"].clip->Play();
+			spawnPos = camQuery.first().get<Transform>()->value.row4;
+		spawnPos.z = 0;
+		Pose2D pose = SharedActorMethods::PoseAt(*newPlayer.get<Pose2D>(), spawnPos);
+		gameCommands->Record([&](flecs::world& _commands)
+			{
+				_commands.entity().is_a(newPlayer)
+					.add<Player>()
+					.add<Alive>()
+					.add<Collidable>()
+					.set<Pose2D>(pose)
+					.set<ControllerID>({ 0 });
+			});
+
+		SharedActorMethods::PlayLoop(*flecsWorld, *newPlayer.get<LoopingClips>(), LOOP_SLOT::ACCEL_FX);
 	}
 
 }
 
 void LevelLogic::SpawnWave()
 {
+	PROFILE_ZONE("SpawnWave");
 	unsigned int waveSettingsIdx = min(waveNum, maxWaves - 1);
-	// Generate random stats for enemies.
-	// Will be used to obtain a seed for the random number engine.
-	std::random_device waveSeed;
-	/* Standard mersenne_twister_engine seeded with rd() normal rand() doesn't work great
-	multi-threaded. */
-	std::mt19937 waveGen(waveSeed());
 
 #pragma region Spawn Smart Bomb
 
-	std::string smartBombPrefab = "PickupPrefab_" + std::to_string(PICKUP_TYPE::SMART_BOMB);
-	std::uniform_real_distribution<float> smartBombSpawn_x(-worldWidth, worldWidth);
-	std::uniform_real_distribution<float> smartBombSpawn_y(worldBottom, worldTop);
+	static const std::string smartBombPrefab = "PickupPrefab_" + std::to_string(PICKUP_TYPE::SMART_BOMB);
 
-	for (int i = 0; i < smartBombsPerWave[waveSettingsIdx -1]; i += 1)
-	{
-		entity smartBomb{};
-		if (RetreivePrefab(smartBombPrefab.c_str(), smartBomb))
+	gameCommands->Record([&](flecs::world& _commands)
 		{
-			GVECTORF spawnPos{ smartBombSpawn_x(waveGen), smartBombSpawn_y(waveGen), 0, 1 };
-			GMATRIXF transform = smartBomb.get<Transform>()->value;
-			transform.row4 = spawnPos;
-
-			flecsWorldLock.LockSyncWrite();
-			flecsWorldAsync.entity().is_a(smartBomb)
-				.add<Pickup>()
-				.add<Alive>()
-				.add<Collidable>()
-				.set<Transform>({ transform });
-			flecsWorldLock.UnlockSyncWrite();
-		}
-	}
+			for (int i = 0; i < smartBombsPerWave[waveSettingsIdx -1]; i += 1)
+			{
+				entity smartBomb{};
+				if (RetreivePrefab(smartBombPrefab.c_str(), smartBomb))
+				{
+					GVECTORF spawnPos{ waveRandom.NextFloat(-worldWidth, worldWidth),
+						waveRandom.NextFloat(worldBottom, worldTop), 0, 1 };
+
+					_commands.entity().is_a(smartBomb)
+						.add<Pickup>()
+						.add<Alive>()
+						.add<Collidable>()
+						.set<Pose2D>(SharedActorMethods::PoseAt(*smartBomb.get<Pose2D>(), spawnPos));
+				}
+			}
+		});
 
 #pragma endregion
 
 #pragma region Spawn Civilians
 
-	std::uniform_int_distribution<unsigned int> civisPerWaveDist(minCivisPerWave, maxCivisPerWave);
-	unsigned int civisPerWave = civisPerWaveDist(waveGen);
-	std::uniform_real_distribution<float> civiSpawn_x(-worldWidth, worldWidth);
+	unsigned int civisPerWave = waveRandom.NextRange(minCivisPerWave, maxCivisPerWave);
 
-	for (int i = 0; i < civisPerWave; i += 1)
-	{
-		entity civi{};
-		std::string civiPrefab = "PickupPrefab_" + std::to_string(PICKUP_TYPE::CIVILIAN);
-		if (RetreivePrefab(civiPrefab.c_str(), civi))
+	gameCommands->Record([&](flecs::world& _commands)
 		{
-			GVECTORF spawnPos{ civiSpawn_x(waveGen), worldBottom, 0, 1 };
-			GMATRIXF transform = civi.get<Transform>()->value;
-			transform.row4 = spawnPos;
-
-			flecsWorldLock.LockSyncWrite();
-			flecsWorldAsync.entity().is_a(civi)
-				.add<Pickup>()
-				.add<Civilian>()
-				.add<Alive>()
-				.add<Collidable>()
-				.set<Transform>({ transform });
-			flecsWorldLock.UnlockSyncWrite();
-		}
-	}
+			for (int i = 0; i < civisPerWave; i += 1)
+			{
+				entity civi{};
+				static const std::string civiPrefab = "PickupPrefab_" + std::to_string(PICKUP_TYPE::CIVILIAN);
+				if (RetreivePrefab(civiPrefab.c_str(), civi))
+				{
+					GVECTORF spawnPos{ waveRandom.NextFloat(-worldWidth, worldWidth), worldBottom, 0, 1 };
+
+					_commands.entity().is_a(civi)
+						.add<Pickup>()
+						.add<Civilian>()
+						.add<Alive>()
+						.add<Collidable>()
+						.set<Pose2D>(SharedActorMethods::PoseAt(*civi.get<Pose2D>(), spawnPos));
+				}
+			}
+		});
 
 #pragma endregion
 
-	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
+	// the first batch comes after the wave delay, then one every spawnBatchRate until the wave is full
+	batchWaveSettingsIdx = waveSettingsIdx;
+	nextBatchTime = flecsWorld->get<SimClock>()->now + spawnWaveDelay;
+	batchesPending = true;
+}
 
-	batchSpawner.Create(spawnBatchRate,
-		[this, readCfg, waveSettingsIdx]()
+void LevelLogic::SpawnBatch()
+{
+	PROFILE_ZONE("SpawnBatch");
+	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
+	unsigned int waveSettingsIdx = batchWaveSettingsIdx;
+
+	/* Here we decide which enemy type we will spawn for this batch, how many, and their individual stats. */
+	unsigned int enemyMinLevel = minEnemyLevelPerWave[waveSettingsIdx -1];
+	unsigned int enemyMaxLevel = maxEnemyLevelPerWave[waveSettingsIdx -1];
+	unsigned int enemyLevel = batchRandom.NextRange(enemyMinLevel, enemyMaxLevel);
+	std::string prefabName = "EnemyPrefab_" + std::to_string(enemyLevel);
+	unsigned int enemyBatchSizeMin = readCfg->at(prefabName).at("batchSizeMin").as<unsigned int>();
+	unsigned int enemyBatchSizeMax = readCfg->at(prefabName).at("batchSizeMax").as<unsigned int>();
+	float enemyMaxMultiplier = maxEnemyMultiplierPerBatch[waveSettingsIdx -1];
+	unsigned int enemyBatchSize = batchRandom.NextRange(enemyBatchSizeMin, 
+		(int)(enemyBatchSizeMax * enemyMaxMultiplier));
+	// Positions for the whole batch in one pass, only bombers and landers consume them.
+	FrameArena* scratch = flecsWorld->get<FrameScratch>()->arena;
+	float* batchSpawn_x = scratch->AllocateArray<float>(enemyBatchSize);
+	float* batchSpawn_y = scratch->AllocateArray<float>(enemyBatchSize);
+	batchPositionRandom.FillFloats(batchSpawn_x, enemyBatchSize, -worldWidth, worldWidth);
+	batchPositionRandom.FillFloats(batchSpawn_y, enemyBatchSize, worldBottom, worldTop);
+	// Weapons start their cooldown at the simulation time the batch was spawned
+	SimTicks spawnTime = flecsWorld->get<SimClock>()->now;
+
+	// The whole batch is recorded into one command buffer and merged together next frame.
+	gameCommands->Record([&](flecs::world& _commands)
 		{
-			// Generate random stats for enemies.
-			// Will be used to obtain a seed for the random number engine.
-			std::random_device batchSeed;
-			/* Standard mersenne_twister_engine seeded with rd() normal rand() doesn't work great
-			multi-threaded. */
-			std::mt19937 batchGen(batchSeed());
-			/* Here we decide which enemy type we will spawn for this batch, how many, and their individual stats. */
-			unsigned int enemyMinLevel = minEnemyLevelPerWave[waveSettingsIdx -1];
-			unsigned int enemyMaxLevel = maxEnemyLevelPerWave[waveSettingsIdx -1];
-			std::uniform_int_distribution<unsigned int> levelRangeDist(enemyMinLevel, enemyMaxLevel);
-			unsigned int enemyLevel = levelRangeDist(batchGen);
-			std::string prefabName = "EnemyPrefab_" + std::to_string(enemyLevel);
-			unsigned int enemyBatchSizeMin = readCfg->at(prefabName).at("batchSizeMin").as<unsigned int>();
-			unsigned int enemyBatchSizeMax = readCfg->at(prefabName).at("batchSizeMax").as<unsigned int>();
-			float enemyMaxMultiplier = maxEnemyMultiplierPerBatch[waveSettingsIdx -1];
-			std::uniform_int_distribution<unsigned int> enemyBatchSizeDist(enemyBatchSizeMin, 
-				(int)(enemyBatchSizeMax * enemyMaxMultiplier));
-			unsigned int enemyBatchSize = enemyBatchSizeDist(batchGen);
-
 			for (int i = 0; i < enemyBatchSize; i += 1)
 			{
 				entity newEnemy{};
@@ -332,32 +332,25 @@ void LevelLogic::SpawnWave()
 				{
 				case ENEMY_TYPE::BOMBER:
 				{
-					std::uniform_real_distribution<float> xDirDist(-15, 15);
-					std::uniform_real_distribution<float> yDirDist(-10, 10);
-
-					float xDir = xDirDist(batchGen);
-					float yDir = yDirDist(batchGen);
+					float xDir = batchRandom.NextFloat(-15, 15);
+					float yDir = batchRandom.NextFloat(-10, 10);
 
 					GVECTORF velocity = { xDir,yDir, 0 };
 					GVector::NormalizeF(velocity, velocity);
 					GVector::ScaleF(velocity, newEnemy.get<Speed>()->value, velocity);
 
-					std::uniform_real_distribution<float> spawn_x_dist(-worldWidth, worldWidth);
-					std::uniform_real_distribution<float> spawn_y_dist(worldBottom, worldTop);
-					GVECTORF spawnPos{ spawn_x_dist(batchGen), spawn_y_dist(batchGen), 0, 1 };
-					GMATRIXF transform = newEnemy.get<Transform>()->value;
-					transform.row4 = StopSpawningOnPlayer(spawnPos.x, spawnPos.y, newEnemy);
+					GVECTORF spawnPos{ batchSpawn_x[i], batchSpawn_y[i], 0, 1 };
+					Pose2D pose = SharedActorMethods::PoseAt(*newEnemy.get<Pose2D>(),
+						StopSpawningOnPlayer(spawnPos.x, spawnPos.y, newEnemy));
 
-					flecsWorldLock.LockSyncWrite();
-					flecsWorldAsync.entity().is_a(newEnemy)
+					_commands.entity().is_a(newEnemy)
 						.add<Enemy>()
 						.add<Bomber>()
 						.add<Alive>()
 						.add<Collidable>()
-						.set<Transform>({ transform })
+						.set<Pose2D>(pose)
 						.set<Velocity>({ velocity });
 					UpdateWaveCounts();
-					flecsWorldLock.UnlockSyncWrite();
 
 					break;
 				}
@@ -368,53 +361,45 @@ void LevelLogic::SpawnWave()
 					Cannon missileLauncher{ newEnemy.get<Cannon>()->offset,
 														newEnemy.get<Cannon>()->aimLeadScaler,
 														newEnemy.get<Cannon>()->fireRate,
-														std::chrono::high_resolution_clock::now() };
-					std::uniform_real_distribution<float> distFromPlayer(distFromPlayerMin, distFromPlayerMax);
-					float spawnDistFromPlayer = distFromPlayer(batchGen);
-					GMATRIXF transform = newEnemy.get<Transform>()->value;
-					transform.row4 = GenerateBaiterPos(spawnDistFromPlayer);
+														spawnTime };
+					float spawnDistFromPlayer = batchRandom.NextFloat(distFromPlayerMin, distFromPlayerMax);
+					GVECTORF spawnPos = GenerateBaiterPos(spawnDistFromPlayer);
 					// Check for function failure.
-					if (transform.row4.x == 0 &&
-						transform.row4.y == 0 &&
-						transform.row4.z == 0 &&
-						transform.row4.w == 0)
+					if (spawnPos.x == 0 &&
+						spawnPos.y == 0 &&
+						spawnPos.z == 0 &&
+						spawnPos.w == 0)
 						continue;
 
-					flecsWorldLock.LockSyncWrite();
-					flecsWorldAsync.entity().is_a(newEnemy)
+					_commands.entity().is_a(newEnemy)
 						.add<Enemy>()
 						.add<Baiter>()
 						.add<Alive>()
 						.add<Collidable>()
-						.set<Transform>({ transform })
+						.set<Pose2D>(SharedActorMethods::PoseAt(*newEnemy.get<Pose2D>(), spawnPos))
 						.set<Cannon>({ missileLauncher });
 					UpdateWaveCounts();
-					flecsWorldLock.UnlockSyncWrite();
 
 					break;
 				}
 				case ENEMY_TYPE::LANDER:
 				{
-					std::uniform_real_distribution<float> spawn_x_dist(-worldWidth, worldWidth);
-					std::uniform_real_distribution<float> spawn_y_dist(worldBottom, worldTop);
-					GVECTORF spawnPos{ spawn_x_dist(batchGen), spawn_y_dist(batchGen), 0, 1 };
-					GMATRIXF transform = newEnemy.get<Transform>()->value;
-					transform.row4 = StopSpawningOnPlayer(spawnPos.x, spawnPos.y, newEnemy);
+					GVECTORF spawnPos{ batchSpawn_x[i], batchSpawn_y[i], 0, 1 };
+					Pose2D pose = SharedActorMethods::PoseAt(*newEnemy.get<Pose2D>(),
+						StopSpawningOnPlayer(spawnPos.x, spawnPos.y, newEnemy));
 					PeaShooter peaShooter{ newEnemy.get<PeaShooter>()->offset,
 											newEnemy.get<PeaShooter>()->range,
 											newEnemy.get<PeaShooter>()->fireRate,
-											std::chrono::high_resolution_clock::now() };
+											spawnTime };
 
-					flecsWorldLock.LockSyncWrite();
-					flecsWorldAsync.entity().is_a(newEnemy)
+					_commands.entity().is_a(newEnemy)
 						.add<Enemy>()
 						.add<Lander>()
 						.add<Alive>()
 						.add<Collidable>()
-						.set<Transform>({ transform })
+						.set<Pose2D>(pose)
 						.set<PeaShooter>({ peaShooter });
 					UpdateWaveCounts();
-					flecsWorldLock.UnlockSyncWrite();
 
 					break;
 				}
@@ -425,12 +410,11 @@ void LevelLogic::SpawnWave()
 				}
 
 			}
+		});
 
-			// Check, if we need to end this wave and start the next one.
-			if (curEnemiesPerWave >= maxEnemiesPerWave[waveSettingsIdx -1])
-				batchSpawner = nullptr;
-
-		}, spawnWaveDelay);
+	// Check, if we need to end this wave and start the next one.
+	if (curEnemiesPerWave >= maxEnemiesPerWave[waveSettingsIdx -1])
+		batchesPending = false;
 }
 
 GVECTORF LevelLogic::StopSpawningOnPlayer(float _spawnPos_x, float _spawnPos_y, entity _enemy)
@@ -438,11 +422,11 @@ GVECTORF LevelLogic::StopSpawningOnPlayer(float _spawnPos_x, float _spawnPos_y,
 	if (playerQuery.count() <= 0)
 		return GIdentityVectorF;
 
-	GVECTORF playerPos = playerQuery.first().get<Transform>()->value.row4;
-	float distFromPlayer = DISTANCE_2D(_spawnPos_x, _spawnPos_y, playerPos.x, playerPos.y);
+	const Pose2D* playerPos = playerQuery.first().get<Pose2D>();
+	float distFromPlayer = DISTANCE_2D(_spawnPos_x, _spawnPos_y, playerPos->x, playerPos->y);
 	if (distFromPlayer < _enemy.get<PlayerSpace>()->offset)
 	{
-		bool playerToRight = playerPos.x > _spawnPos_x;
+		bool playerToRight = playerPos->x > _spawnPos_x;
 		switch (playerToRight)
 		{
 		case false:
@@ -471,39 +455,34 @@ unsigned int LevelLogic::GenerateBatchSize(entity _enemyType)
 {
 	unsigned int batchSizeMin = _enemyType.get<BatchSize>()->min;
 	unsigned int batchSizeMax = _enemyType.get<BatchSize>()->max;
-	std::uniform_int_distribution<unsigned int> batchSizeDist(batchSizeMin, batchSizeMax);
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	unsigned int batchSize = batchSizeDist(gen);
+	unsigned int batchSize = batchRandom.NextRange(batchSizeMin, batchSizeMax);
 	return batchSize;
 }
 
-void LevelLogic::PuaseWave()
+void LevelLogic::SeedRandomStreams()
 {
-	GReturn returnCode{};
-	returnCode = batchSpawner.Pause(false, 0);
-	if (returnCode == GReturn::SUCCESS)
-		batchSpawner.Resume();
-	else
-		std::cout << "levelLogic::PuaseWave FAILED" << std::endl;
+	unsigned long long seed = flecsWorld->get<WorldSeed>()->value;
+	waveRandom.Seed(seed, RANDOM_STREAM::WAVE_SPAWN);
+	batchRandom.Seed(seed, RANDOM_STREAM::BATCH_SPAWN);
+	batchPositionRandom.Seed(seed, RANDOM_STREAM::BATCH_POSITION);
 }
 
 GVECTORF LevelLogic::GenerateBaiterPos(float _distFromPlayer)
 {
 	GVECTORF baiterPos{};
 	if (playerQuery.first().is_alive())
-		baiterPos = playerQuery.first().get<Transform>()->value.row4;
+	{
+		const Pose2D* playerPose = playerQuery.first().get<Pose2D>();
+		baiterPos = { playerPose->x, playerPose->y, playerPose->z, 1 };
+	}
 	else
 	{
 		std::cout << "LevelLogic::GenerateBaiterPos FAILED" << std::endl;
 		return { 0, 0, 0, 0 };
 	}
 
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<int> direction(0, 1);
-	int leftRight = direction(gen);
-	int bottomTop = direction(gen);
+	int leftRight = batchRandom.NextBool();
+	int bottomTop = batchRandom.NextBool();
 
 	switch (leftRight)
 	{
@@ -537,17 +516,50 @@ void LevelLogic::Reset()
 	waveNum = 1;
 	curEnemiesPerWave = 0;
 	livingEnemies = 0;
+	// a restarted game replays the same waves for the same seed
+	playerRespawnPending = false;
+	batchesPending = false;
+	SeedRandomStreams();
 
 	SpawnPlayer();
 	SpawnWave();
 }
 
+void LevelLogic::SaveState(SnapshotWriter& _writer) const
+{
+	_writer.Write(playerRespawnPending);
+	_writer.Write(playerRespawnTime);
+	_writer.Write(batchesPending);
+	_writer.Write(nextBatchTime);
+	_writer.Write(batchWaveSettingsIdx);
+	_writer.Write(waveNum);
+	_writer.Write(curEnemiesPerWave);
+	_writer.Write(livingEnemies);
+	_writer.Write(waveRandom);
+	_writer.Write(batchRandom);
+	_writer.Write(batchPositionRandom);
+}
+
+bool LevelLogic::LoadState(SnapshotReader& _reader)
+{
+	_reader.Read(playerRespawnPending);
+	_reader.Read(playerRespawnTime);
+	_reader.Read(batchesPending);
+	_reader.Read(nextBatchTime);
+	_reader.Read(batchWaveSettingsIdx);
+	_reader.Read(waveNum);
+	_reader.Read(curEnemiesPerWave);
+	_reader.Read(livingEnemies);
+	_reader.Read(waveRandom);
+	_reader.Read(batchRandom);
+	return _reader.Read(batchPositionRandom);
+}
+
 // Free any resources used to run this system
 bool LevelLogic::Shutdown()
 {
-	batchSpawner.Pause(0, false);
-	batchSpawner = nullptr; // stop adding enemies
-	flecsWorldAsync.merge(); // get rid of any remaining commands
+	spawnSystem.destruct(); // stop adding enemies
+	gameCommands->Merge(); // get rid of any remaining commands
 	flecsWorld->entity("Level System").destruct();
 	// invalidate the shared pointers
 	flecsWorld.reset();
@@ -558,28 +570,13 @@ bool LevelLogic::Shutdown()
 // Toggle if a system's Logic is actively running
 bool LevelLogic::Activate(bool runSystem)
 {
-	if (runSystem)
-	{
-		flecsWorld->entity("MergeAsyncStages").enable();
+	// Spawns recorded while paused are held back until play resumes
+	gameCommands->Activate(runSystem);
+	if (spawnSystem.is_alive()) {
+		(runSystem) ?
+			spawnSystem.enable()
+			: spawnSystem.disable();
+		return true;
 	}
-	else
-	{
-		flecsWorld->entity("MergeAsyncStages").disable();
-	}
-
 	return false;
 }
-
-// **** SAMPLE OF MULTI_THREADED USE ****
-//world world; // main world
-//world async_stage = world.async_stage();
-//
-//// From thread
-//lock(async_stage_lock);
-//entity e = async_stage.entity().child_of(parent)...
-//unlock(async_stage_lock);
-//
-//// From main thread, periodic
-//lock(async_stage_lock);
-//async_stage.merge(); // merge all commands to main world
-//unlock(async_stage_lock);
\ No newline at end of file
@@ -13,11 +13,28 @@
 #include "../Components/Gameplay.h"
 #include "../Components/Physics.h"
 
+#include "../Events/EventBus.h"
+
 #include "../Utils/AudioData.h"
+#include "../Utils/Random.h"
+#include "../Utils/CommandBuffers.h"
+#include "../Utils/FrameArena.h"
+#include "../Utils/WorldSnapshot.h"
 
 // example space game (avoid name collisions)
 namespace GOG
 {
+	// Where the current wave stands, for checks outside the game
+	struct WaveProgress
+	{
+		unsigned int wave;
+		// enemies spawned so far this wave, the ones lost to the player's death are taken back off
+		unsigned int spawned;
+		unsigned int living;
+		// more batches are still to come this wave
+		bool batchesPending;
+	};
+
 	class LevelLogic
 	{
 
@@ -25,12 +42,10 @@ namespace GOG
 
 		// shared connection to the main ECS engine
 		std::shared_ptr<flecs::world> flecsWorld;
-		// async version of above for threaded operations
-		flecs::world flecsWorldAsync;
-		// you must ensure the async_stage is thread safe as it has no built-in synchronization
-		// be sure to unlock when done so the main thread can safely merge the changes
-		GW::CORE::GThreadShared flecsWorldLock;
-		flecs::query<const Player, const Transform> playerQuery;
+		// deferred command buffers for threaded operations, each recording gets its own buffer
+		// so nothing has to be locked, they are merged at the start of the next frame
+		CommandBuffers* gameCommands;
+		flecs::query<const Player, const Pose2D> playerQuery;
 		flecs::query<const Civilian, const Score> civilianQuery;
 		flecs::query<const SmartBomb> smartBombQuery;
 		flecs::query<const Projectile> projectileQuery;
@@ -41,13 +56,19 @@ namespace GOG
 		// Level system will also load and switch music
 		GW::AUDIO::GMusic currentTrack;
 
-		GW::CORE::GEventResponder eventHandler;
-		GW::CORE::GEventGenerator eventPusher;
+		EventBus* eventBus;
 
 #pragma region Spawning / Wave Management
 
-		GW::SYSTEM::GDaemon playerSpawner{};
-		GW::SYSTEM::GDaemon batchSpawner{};
+		// Respawns and enemy batches are timed in simulation time by this system, so they pause with
+		// the game and land on the same tick every time a session is replayed.
+		flecs::system spawnSystem;
+		bool playerRespawnPending = false;
+		SimTicks playerRespawnTime = 0;
+		bool batchesPending = false;
+		SimTicks nextBatchTime = 0;
+		// wave settings the pending batches are drawn from
+		unsigned int batchWaveSettingsIdx = 1;
 		// How many unique waves there are
 		unsigned int maxWaves = 0;
 		// Which wave of enemies the game is on.
@@ -56,6 +77,11 @@ namespace GOG
 		unsigned int curEnemiesPerWave = 0;
 		// How many enemies are alive currently.
 		unsigned int livingEnemies = 0;
+		// Wave setup and batches each get their own stream so one can't shift the other.
+		Pcg32 waveRandom;
+		Pcg32 batchRandom;
+		// Spawn positions for a whole batch are generated up front in one pass.
+		Pcg32x4 batchPositionRandom;
 
 #pragma endregion
 
@@ -81,15 +107,18 @@ namespace GOG
 #pragma endregion
 
 		void SpawnPlayer();
-		// Recursive and delayed. Allows indefinite and time intervaled enemy spawning.
+		// Spawns the wave's pickups and schedules its enemy batches.
 		void SpawnWave();
+		// Spawns one batch of one type of enemy, called by the spawn system every spawnBatchRate.
+		void SpawnBatch();
 		// Update wave stat trackers.
 		void UpdateWaveCounts();
 		// Generate a random size for thr group of enemies to spawn within their type's batch size range.
 		unsigned int GenerateBatchSize(flecs::entity _enemyType);
 		// Spawn an enemy into the game after its info and stats have been decided.
 		void SpawnEnemy(flecs::entity _newEnemy);
-		void PuaseWave();
+		// Restart every level stream from the world seed.
+		void SeedRandomStreams();
 		GW::MATH::GVECTORF GenerateBaiterPos(float _distFromPlayer);
 		GW::MATH::GVECTORF GenerateBomberPos(float _distFromPlayer);
 		// If we are about to spawn on the player, then move out of the way.
@@ -101,8 +130,15 @@ namespace GOG
 		bool Init(	std::shared_ptr<flecs::world> _game,
 					std::weak_ptr<const GameConfig> _gameConfig,
 					AudioData& _audioData,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus,
+					CommandBuffers* _gameCommands);
+		// starts a session: reseeds the level streams, spawns the player and the first wave
 		void Reset();
+		// wave progress, pending spawns and random streams, stored alongside the world in snapshots
+		void SaveState(SnapshotWriter& _writer) const;
+		bool LoadState(SnapshotReader& _reader);
+		unsigned int GetWave() const { return waveNum; }
+		WaveProgress GetWaveProgress() const { return { waveNum, curEnemiesPerWave, livingEnemies, batchesPending }; }
 		// control if the system is actively running
 		bool Activate(bool runSystem);
 		// release any resources allocated by the system
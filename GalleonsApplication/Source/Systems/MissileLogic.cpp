@@ -3,6 +3,9 @@
 #include "../Components/Identification.h"
 #include "../Components/Physics.h"
 
+#include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
+
 using namespace GOG;
 using namespace GW;
 using namespace MATH;
@@ -14,11 +17,12 @@ bool MissileLogic::Init(std::shared_ptr<flecs::world> _game,
 	flecsWorld = _game;
 	gameConfig = _gameConfig;
 
-	missileSystem = flecsWorld->system<const Cannonball, Transform, const Speed>("MissileSystem")
-		.each([](flecs::entity _entity, const Cannonball&, Transform& _transform, const Speed& _speed)
+	missileSystem = flecsWorld->system<const Cannonball, Pose2D, const Speed>("MissileSystem")
+		.each([](flecs::entity _entity, const Cannonball&, Pose2D& _pose, const Speed& _speed)
 		{
+			PROFILE_SYSTEM("MissileSystem");
 			GVECTORF translate{ _speed.value * _entity.delta_time(), 0,   0, 0 };
-			GMatrix::TranslateLocalF(_transform.value, translate, _transform.value);
+			SharedActorMethods::TranslatePoseLocal(translate, _pose);
 		});
 
 	return true;
@@ -5,6 +5,8 @@
 #include "../Components/AudioSource.h"
 
 #include "../Utils/Macros.h"
+#include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
 
 using namespace flecs;
 using namespace GOG;
@@ -14,11 +16,11 @@ using namespace CORE;
 
 bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game, 
 								std::weak_ptr<const GameConfig> _gameConfig,
-								GEventGenerator _eventPusher)
+								EventBus* _eventBus)
 {
 	flecsWorld = _game;
 	gameConfig = _gameConfig;
-	eventPusher = _eventPusher;
+	eventBus = _eventBus;
 
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
 	float projectileCullDist = readCfg->at("Game").at("projectileCullDist").as<float>();
@@ -28,10 +30,10 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 
 #pragma region Shared Queries
 
-	playerTransformQuery = flecsWorld->query<const Player, Transform>();
-	enemyTransformQuery = flecsWorld->query<const Enemy, Transform>();
-	projectileTransformQuery = flecsWorld->query<const Projectile, const Transform>();
-	pickupTransformQuery = flecsWorld->query<const Pickup, Transform>();
+	playerPoseQuery = flecsWorld->query<const Player, Pose2D>();
+	enemyPoseQuery = flecsWorld->query<const Enemy, Pose2D>();
+	projectilePoseQuery = flecsWorld->query<const Projectile, const Pose2D>();
+	pickupPoseQuery = flecsWorld->query<const Pickup, Pose2D>();
 	persistentStatsQuery = flecsWorld->query<const PersistentStats, Lives>();
 
 #pragma endregion
@@ -41,28 +43,40 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 	flecsWorld->system<Velocity, const Acceleration>("Acceleration System")
 		.each([](entity e, Velocity& v, const Acceleration &a) 
 		{
+			PROFILE_SYSTEM("Acceleration System");
 			GW::MATH::GVECTORF accel;
 			GW::MATH::GVector::ScaleF(a.value, e.delta_time(), accel);
 			GW::MATH::GVector::AddVectorF(accel, v.value, v.value);
 		});
 	// update position by velocity
-	flecsWorld->system<Transform, BoundBox, const Velocity>("Translation System")
-		.each([](entity _entity, Transform& _transform, BoundBox& _box, const Velocity& _velocity) 
+	flecsWorld->system<Pose2D, const Velocity>("Translation System")
+		.each([](entity _entity, Pose2D& _pose, const Velocity& _velocity) 
 		{
-			GW::MATH::GVECTORF speed;
-			GW::MATH::GVector::ScaleF(_velocity.value, _entity.delta_time(), speed);
+			PROFILE_SYSTEM("Translation System");
 			// adding is simple but doesn't account for orientation
-			GW::MATH::GVector::AddVectorF(speed, _transform.value.row4, _transform.value.row4);
-			// Update box collider positions to match transform positions.
-			_box.collider.center = _transform.value.row4;
+			// actors at rest keep their matrix as it is
+			if (_velocity.value.x == 0 && _velocity.value.y == 0 && _velocity.value.z == 0)
+				return;
+			float dt = _entity.delta_time();
+			_pose.x += _velocity.value.x * dt;
+			_pose.y += _velocity.value.y * dt;
+			_pose.z += _velocity.value.z * dt;
+			_pose.dirty = true;
 		});
 
-#pragma region Update Collider Positions
+#pragma region Transform Sync
 
-	updateColliderPos = flecsWorld->system<const Transform, BoundBox>().each(
-		[](entity _entity, const Transform& _transform, BoundBox& _box)
+	// Runs in OnValidate, after every gameplay system moved its actors this frame and before the
+	// renderer gathers instances in PostUpdate, so actors are drawn where the camera sees them now.
+	transformSync = flecsWorld->system<Pose2D, WorldMatrix>("TransformSyncSystem").kind(flecs::OnValidate).each(
+		[](entity _entity, Pose2D& _pose, WorldMatrix& _matrix)
 		{
-			_box.collider.center = _transform.value.row4;
+			PROFILE_SYSTEM("TransformSyncSystem");
+			if (!_pose.dirty)
+				return;
+
+			SharedActorMethods::PoseMatrix(_pose, _matrix.value);
+			_pose.dirty = false;
 		});
 
 #pragma endregion
@@ -71,34 +85,38 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 
 	struct OutBoundsCulling {};
 	flecsWorld->entity("OutBoundsCulling").add<OutBoundsCulling>();
-	flecsWorld->system<OutBoundsCulling>().each([this, projectileCullDist, worldTopBoundry](OutBoundsCulling& _s)
+	flecsWorld->system<OutBoundsCulling>("OutBoundsCulling System").each([this, projectileCullDist, worldTopBoundry](OutBoundsCulling& _s)
 	{
+		PROFILE_SYSTEM("OutBoundsCulling");
 		// Will crash if player is not alive. Protect against this.
-		if (playerTransformQuery.first().is_alive())
-			playerPos = playerTransformQuery.first().get<Transform>()->value.row4;
+		if (playerPoseQuery.first().is_alive())
+		{
+			const Pose2D* pose = playerPoseQuery.first().get<Pose2D>();
+			playerPos = { pose->x, pose->y, pose->z, 1 };
+		}
 		else
 			return;
 
-		projectileTransformQuery.each(
-			[this, projectileCullDist](entity _projectile, const Projectile&, const Transform& _transform)
+		projectilePoseQuery.each(
+			[this, projectileCullDist](entity _projectile, const Projectile&, const Pose2D& _pose)
 			{
-				float projectile_x = _transform.value.row4.x, projectile_y = _transform.value.row4.y;
+				float projectile_x = _pose.x, projectile_y = _pose.y;
 				float distanceFromPlayer = DISTANCE_2D(playerPos.x, playerPos.y, projectile_x, projectile_y);
 				if (distanceFromPlayer > projectileCullDist)
 					_projectile.destruct();
 			});
 
-		enemyTransformQuery.each([this, worldTopBoundry](entity _enemy, const Enemy&, const Transform& _transform)
+		enemyPoseQuery.each([this, worldTopBoundry](entity _enemy, const Enemy&, const Pose2D& _pose)
 		{
-			if (_transform.value.row4.y > worldTopBoundry + 10)
+			if (_pose.y > worldTopBoundry + 10)
 			{
 				EnemyOutBounds(_enemy);
 			}
 		});
 
-		pickupTransformQuery.each([this, worldTopBoundry](entity _pickup, const Pickup&, const Transform& _transform)
+		pickupPoseQuery.each([this, worldTopBoundry](entity _pickup, const Pickup&, const Pose2D& _pose)
 		{
-			if (_transform.value.row4.y > worldTopBoundry + 5)
+			if (_pose.y > worldTopBoundry + 5)
 			{
 				_pickup.destruct();
 			}
@@ -111,38 +129,63 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 
 	struct WorldBoundrySystem{};
 	flecsWorld->entity("WorldBoundrySystem").add<WorldBoundrySystem>();
-	flecsWorld->system<WorldBoundrySystem>().each(
+	flecsWorld->system<WorldBoundrySystem>("WorldBoundry System").each(
 		[this, worldBottomBoundry, worldTopBoundry, worldWidth](WorldBoundrySystem& _s)  
 		{
-			playerTransformQuery.each(
-				[this, worldBottomBoundry, worldTopBoundry, worldWidth](const Player&, Transform& _transform)
+			PROFILE_SYSTEM("WorldBoundrySystem");
+			playerPoseQuery.each(
+				[this, worldBottomBoundry, worldTopBoundry, worldWidth](const Player&, Pose2D& _pose)
 				{
-					if (_transform.value.row4.y < worldBottomBoundry)
-						_transform.value.row4.y = worldBottomBoundry;
-					else if (_transform.value.row4.y > worldTopBoundry)
-						_transform.value.row4.y = worldTopBoundry;
+					if (_pose.y < worldBottomBoundry)
+					{
+						_pose.y = worldBottomBoundry;
+						_pose.dirty = true;
+					}
+					else if (_pose.y > worldTopBoundry)
+					{
+						_pose.y = worldTopBoundry;
+						_pose.dirty = true;
+					}
 				});
-			enemyTransformQuery.each(
-				[this, worldBottomBoundry, worldTopBoundry, worldWidth](const Enemy&, Transform& _transform)
+			enemyPoseQuery.each(
+				[this, worldBottomBoundry, worldTopBoundry, worldWidth](const Enemy&, Pose2D& _pose)
 				{
-					if (_transform.value.row4.y < worldBottomBoundry)
-						_transform.value.row4.y = worldBottomBoundry;
+					if (_pose.y < worldBottomBoundry)
+					{
+						_pose.y = worldBottomBoundry;
+						_pose.dirty = true;
+					}
 
-					if (_transform.value.row4.x < playerPos.x - worldWidth)
-						_transform.value.row4.x = playerPos.x + worldWidth;
-					else if (_transform.value.row4.x > playerPos.x + worldWidth)
-						_transform.value.row4.x = playerPos.x - worldWidth;
+					if (_pose.x < playerPos.x - worldWidth)
+					{
+						_pose.x = playerPos.x + worldWidth;
+						_pose.dirty = true;
+					}
+					else if (_pose.x > playerPos.x + worldWidth)
+					{
+						_pose.x = playerPos.x - worldWidth;
+						_pose.dirty = true;
+					}
 				});
-			pickupTransformQuery.each(
-				[this, worldBottomBoundry, worldWidth](const Pickup&, Transform& _transform)
+			pickupPoseQuery.each(
+				[this, worldBottomBoundry, worldWidth](const Pickup&, Pose2D& _pose)
 				{
-					if (_transform.value.row4.y < worldBottomBoundry)
-						_transform.value.row4.y = worldBottomBoundry;
+					if (_pose.y < worldBottomBoundry)
+					{
+						_pose.y = worldBottomBoundry;
+						_pose.dirty = true;
+					}
 
-					if (_transform.value.row4.x < playerPos.x - worldWidth)
-						_transform.value.row4.x = playerPos.x + worldWidth;
-					else if (_transform.value.row4.x > playerPos.x + worldWidth)
-						_transform.value.row4.x = playerPos.x - worldWidth;
+					if (_pose.x < playerPos.x - worldWidth)
+					{
+						_pose.x = playerPos.x + worldWidth;
+						_pose.dirty = true;
+					}
+					else if (_pose.x > playerPos.x + worldWidth)
+					{
+						_pose.x = playerPos.x - worldWidth;
+						_pose.dirty = true;
+					}
 				});
 		});
 
@@ -150,19 +193,27 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 
 #pragma region Collision Detection
 
-	collidersQuery = flecsWorld->query<Collidable, const BoundBox>();
+	collidersQuery = flecsWorld->query<Collidable, const BoundBox, const Pose2D>();
 	struct CollisionSystem {};
 	flecsWorld->entity("CollisionSystem").add<CollisionSystem>();
-	flecsWorld->system<CollisionSystem>().each([this](CollisionSystem& _s)
+	flecsWorld->system<CollisionSystem>("Collision System").each([this](CollisionSystem& _s)
 	{
-		collidersQuery.each([this](entity _entity, Collidable& _collidable, const BoundBox& _box)
+		PROFILE_SYSTEM("CollisionSystem");
+		// All the current colliders in the world, gone with the frame.
+		std::pmr::vector<Collider> colliders(flecsWorld->get<FrameScratch>()->arena);
+		colliders.reserve(collidersQuery.count());
+		collidersQuery.each([&colliders](entity _entity, Collidable& _collidable, const BoundBox& _box, const Pose2D& _pose)
 		{
+			PROFILE_SYSTEM("CollisionGather");
 			Collider curCollider;
 			curCollider.owner = _entity;
 			curCollider.box = _box;
+			// Box centers follow the pose directly, there is no per-entity copy pass
+			curCollider.box.collider.center = { _pose.x, _pose.y, _pose.z, 1 };
 			colliders.push_back(curCollider);
 		});
 
+		unsigned int pairsHit = 0;
 		for (int i = 0; i < colliders.size(); i += 1)
 		{
 			for (int j = i + 1; j < colliders.size(); j += 1)
@@ -172,6 +223,7 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 				returnCode = GCollision::TestOBBToOBBF(colliders[i].box.collider, colliders[j].box.collider, collisionCheck);
 				if (collisionCheck == GCollision::GCollisionCheck::COLLISION)
 				{
+					pairsHit += 1;
 					// Projectiles hit enemies
 					if (colliders[i].owner.has<Projectile>() && colliders[j].owner.has<Enemy>())
 					{
@@ -216,13 +268,13 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 					if (colliders[i].owner.has<Player>() && colliders[j].owner.has<Enemy>())
 					{
 						PlayerDestroyed(colliders[i].owner);
-						EnemyDestroyed(colliders[j].owner);
+						EnemyDestroyed(colliders[j].owner, true);
 						continue;
 					}
 					else if (colliders[i].owner.has<Enemy>() && colliders[j].owner.has<Player>())
 					{
 						PlayerDestroyed(colliders[j].owner);
-						EnemyDestroyed(colliders[i].owner);
+						EnemyDestroyed(colliders[i].owner, true);
 						continue;
 					}
 
@@ -282,7 +334,9 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 			}
 		}
 
-		colliders.clear();
+		unsigned int colliderCount = static_cast<unsigned int>(colliders.size());
+		unsigned int pairsTested = colliderCount > 0 ? colliderCount * (colliderCount - 1) / 2 : 0;
+		flecsWorld->set<CollisionStats>({ colliderCount, pairsTested, pairsHit });
 	});
 
 #pragma endregion
@@ -292,59 +346,47 @@ bool GOG::PhysicsLogic::Init(	std::shared_ptr<world> _game,
 
 void PhysicsLogic::PlayerDestroyed(entity& _entity)
 {
-	LoopingClips loopingClips = *_entity.get<LoopingClips>();
-	loopingClips.sounds["Accel"].clip->SetVolume(0);
-	loopingClips.sounds["Accel"].clip->Stop();
-	SoundClips clips = *_entity.get<SoundClips>();
-	clips.sounds["Death"]->Play();
+	SharedActorMethods::StopLoop(*flecsWorld, *_entity.get<LoopingClips>(), LOOP_SLOT::ACCEL_FX);
+	SharedActorMethods::PlaySound(*flecsWorld, *_entity.get<SoundClips>(), SOUND_SLOT::DEATH_FX);
 
 	_entity.destruct();
 
-	GEvent playerDestroyed;
 	PLAY_EVENT_DATA livesData;
 	livesData.value = persistentStatsQuery.first().get<Lives>()->count - 1;
 	persistentStatsQuery.first().set<Lives>({ livesData.value });
-	playerDestroyed.Write(PLAY_EVENT::PLAYER_DESTROYED, livesData);
-	eventPusher.Push(playerDestroyed);
+	eventBus->Push(PLAY_EVENT::PLAYER_DESTROYED, livesData);
 }
 
-void PhysicsLogic::EnemyDestroyed(entity& _entity)
+void PhysicsLogic::EnemyDestroyed(entity& _entity, bool _rammedPlayer)
 {
-	SoundClips clips = *_entity.get<SoundClips>();
-	clips.sounds["Death"]->Play();
+	SharedActorMethods::PlaySound(*flecsWorld, *_entity.get<SoundClips>(), SOUND_SLOT::DEATH_FX);
 
-	GW::GEvent enemyDestroyed;
 	PLAY_EVENT_DATA scoreData;
 	scoreData.value = _entity.get<Score>()->value;
 	scoreData.directive = DIRECTIVES::UPDATE_SCORE_OK;
-	enemyDestroyed.Write(PLAY_EVENT::ENEMY_DESTROYED, scoreData);
-	eventPusher.Push(enemyDestroyed);
+	if (_rammedPlayer)
+		scoreData.directive |= DIRECTIVES::ENEMY_RAMMED_PLAYER;
+	eventBus->Push(PLAY_EVENT::ENEMY_DESTROYED, scoreData);
 	_entity.destruct();
 }
 
 void PhysicsLogic::EnemyOutBounds(entity& _entity)
 {
-	SoundClips clips = *_entity.get<SoundClips>();
-	clips.sounds["Death"]->Play();
+	SharedActorMethods::PlaySound(*flecsWorld, *_entity.get<SoundClips>(), SOUND_SLOT::DEATH_FX);
 
-	GW::GEvent onEnemyOutBounds;
-	PLAY_EVENT_DATA nullData;
-	onEnemyOutBounds.Write(PLAY_EVENT::ENEMY_DESTROYED, nullData);
-	eventPusher.Push(onEnemyOutBounds);
+	PLAY_EVENT_DATA nullData{};
+	eventBus->Push(PLAY_EVENT::ENEMY_DESTROYED, nullData);
 	_entity.destruct();
 }
 
 void PhysicsLogic::GetPickup(flecs::entity _entity)
 {
-	SoundClips clips = *_entity.get<SoundClips>();
-	clips.sounds["Pickup"]->Play();
+	SharedActorMethods::PlaySound(*flecsWorld, *_entity.get<SoundClips>(), SOUND_SLOT::PICKUP_FX);
 	persistentStatsQuery.first().get_mut<NukeDispenser>()->bombs += 1;
 
-	GW::GEvent onPickup;
 	PLAY_EVENT_DATA pickupData;
 	pickupData.value = persistentStatsQuery.first().get<NukeDispenser>()->bombs;
-	onPickup.Write(GOG::PLAY_EVENT::SMART_BOMB_GRABBED, pickupData);
-	eventPusher.Push(onPickup);
+	eventBus->Push(GOG::PLAY_EVENT::SMART_BOMB_GRABBED, pickupData);
 	_entity.destruct();
 }
 
@@ -354,13 +396,13 @@ bool GOG::PhysicsLogic::Activate(bool _runSystem)
 	{
 		flecsWorld->entity("Acceleration System").enable();
 		flecsWorld->entity("Translation System").enable();
-		updateColliderPos.enable();
+		transformSync.enable();
 	}
 	else 
 	{
 		flecsWorld->entity("Acceleration System").disable();
 		flecsWorld->entity("Translation System").disable();
-		updateColliderPos.disable();
+		transformSync.disable();
 	}
 
 	return true;
@@ -373,11 +415,12 @@ bool GOG::PhysicsLogic::Shutdown()
 	flecsWorld->entity("OutBoundsCulling").destruct();
 	flecsWorld->entity("WorldBoundrySystem").destruct();
 	flecsWorld->entity("CollisionSystem").destruct();
-	updateColliderPos.destruct();
+	transformSync.destruct();
 	collidersQuery.destruct();
-	enemyTransformQuery.destruct();
-	projectileTransformQuery.destruct();
-	pickupTransformQuery.destruct();
+	playerPoseQuery.destruct();
+	enemyPoseQuery.destruct();
+	projectilePoseQuery.destruct();
+	pickupPoseQuery.destruct();
 	persistentStatsQuery.destruct();
 
 	return true;
@@ -5,10 +5,14 @@
 // Contains our global game settings
 #include "../GameConfig.h"
 
+#include "../Events/EventBus.h"
+
 #include "../Components/Identification.h"
 #include "../Components/Gameplay.h"
 #include "../Components/Physics.h"
 
+#include "../Utils/FrameArena.h"
+
 // example space game (avoid name collisions)
 namespace GOG
 {
@@ -20,32 +24,30 @@ namespace GOG
 		// non-ownership handle to configuration settings
 		std::weak_ptr<const GameConfig> gameConfig;
 
-		flecs::query<const Player, Transform> playerTransformQuery;
-		flecs::query<const Camera, Transform> cameraTransformQuery;
-		flecs::query<const Enemy, Transform> enemyTransformQuery;
-		flecs::query<const Pickup, Transform> pickupTransformQuery;
-		flecs::query<const Projectile, const Transform> projectileTransformQuery;
+		flecs::query<const Player, Pose2D> playerPoseQuery;
+		flecs::query<const Enemy, Pose2D> enemyPoseQuery;
+		flecs::query<const Pickup, Pose2D> pickupPoseQuery;
+		flecs::query<const Projectile, const Pose2D> projectilePoseQuery;
 		flecs::query<const PersistentStats, Lives> persistentStatsQuery;
 
 		GW::MATH::GVECTORF playerPos;
 
 		// Find all the colliders in the world.
-		flecs::query<Collidable, const BoundBox> collidersQuery;
+		flecs::query<Collidable, const BoundBox, const Pose2D> collidersQuery;
 		// Local storage for collider information.
 		struct Collider
 		{
 			flecs::entity owner;
 			BoundBox box;
 		};
-		// All the current colliders in the world.
-		std::vector<Collider> colliders;
-
-		flecs::system updateColliderPos;
+		// Rebuilds the world matrices of dirty poses before the renderer gathers them
+		flecs::system transformSync;
 
-		GW::CORE::GEventGenerator eventPusher;
+		EventBus* eventBus;
 
 		void PlayerDestroyed(flecs::entity& _entity);
-		void EnemyDestroyed(flecs::entity& _entity);
+		// _rammedPlayer marks an enemy that died taking the player with it
+		void EnemyDestroyed(flecs::entity& _entity, bool _rammedPlayer = false);
 		void EnemyOutBounds(flecs::entity& _entity);
 		void PickupOutBounds(flecs::entity& _entity);
 		void GetPickup(flecs::entity _entity);
@@ -54,7 +56,7 @@ namespace GOG
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game, 
 					std::weak_ptr<const GameConfig> _gameConfig,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus);
 		// control if the system is actively running
 		bool Activate(bool _runSystem);
 		// release any resources allocated by the system
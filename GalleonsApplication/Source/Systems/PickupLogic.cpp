@@ -5,8 +5,7 @@
 #include "../Components/Physics.h"
 
 #include "../Utils/SharedActorMethods.h"
-
-#include <random>
+#include "../Utils/Profiler.h"
 
 using namespace GOG;
 using namespace flecs;
@@ -16,35 +15,37 @@ using namespace MATH;
 
 bool PickupLogic::Init(	std::shared_ptr<world> _flecsWorld, 
 						std::weak_ptr<const GameConfig> _gameConfig, 
-						GEventGenerator _eventPusher)
+						EventBus* _eventBus)
 {
 	flecsWorld = _flecsWorld;
 	gameConfig = _gameConfig;
-	eventPusher = _eventPusher;
+	eventBus = _eventBus;
 
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
 	float worldBottom = readCfg->at("Game").at("worldBottomBoundry").as<float>();
+	civiRandom.Seed(flecsWorld->get<WorldSeed>()->value, RANDOM_STREAM::CIVILIAN_MOVEMENT);
 
-	civiSystem = flecsWorld->system<const Civilian, CaptureInfo, Transform, FlipInfo, CiviMovementStats, const Offset>().each(
-		[worldBottom](entity _civilian, const Civilian&, CaptureInfo& _captureInfo, Transform& _transform, 
+	civiSystem = flecsWorld->system<const Civilian, CaptureInfo, Pose2D, FlipInfo, CiviMovementStats, const Offset>("CiviSystem").each(
+		[this, worldBottom](entity _civilian, const Civilian&, CaptureInfo& _captureInfo, Pose2D& _pose, 
 			FlipInfo& _flipInfo, CiviMovementStats& _movement, const Offset& _offset)
 		{
+			PROFILE_SYSTEM("CiviSystem");
 			switch (_captureInfo.captured)
 			{
 				case false:
 				{
 					// Gravity
-					_transform.value.row4.y -= _civilian.delta_time() * _movement.speed;
+					_pose.y -= _civilian.delta_time() * _movement.speed;
+					_pose.dirty = true;
 
 					// Walk on the ground
-					if (_transform.value.row4.y <= worldBottom)
+					if (_pose.y <= worldBottom)
 					{
 						// Check if we need to change directions, otherwise keep walking.
-						auto timeDifNano = std::chrono::high_resolution_clock::now() - _movement.lastDirChange;
-						auto timeDifMilli = std::chrono::duration_cast<std::chrono::milliseconds>(timeDifNano);
-						if (timeDifMilli >= _movement.curDirChangeInterval)
+						SimTicks now = _civilian.world().get<SimClock>()->now;
+						if (now - _movement.lastDirChange >= _movement.curDirChangeInterval.count())
 						{
-							_movement.lastDirChange = std::chrono::high_resolution_clock::now();
+							_movement.lastDirChange = now;
 							switch (_movement.isWalkingRight)
 							{
 								case false:
@@ -59,12 +60,9 @@ bool PickupLogic::Init(	std::shared_ptr<world> _flecsWorld,
 								}
 							}
 
-							std::random_device civiSeed;
-							std::mt19937 civiGen(civiSeed());
 							unsigned int intervalMin = _movement.dirChangIntervalMin;
 							unsigned int intervalMax = _movement.dirChangIntervalMax;
-							std::uniform_int_distribution<unsigned int> intervalDist(intervalMin, intervalMax);
-							std::chrono::milliseconds curInterval(intervalDist(civiGen));
+							std::chrono::milliseconds curInterval(civiRandom.NextRange(intervalMin, intervalMax));
 							_movement.curDirChangeInterval = curInterval;
 						}
 						else
@@ -74,19 +72,19 @@ bool PickupLogic::Init(	std::shared_ptr<world> _flecsWorld,
 							{
 								case false:
 								{
-									_transform.value.row4.x -= _civilian.delta_time() * _movement.speed;
+									_pose.x -= _civilian.delta_time() * _movement.speed;
 									SharedActorMethods::FlipEntity(_civilian.delta_time(),
 										1,
-										_transform,
+										_pose,
 										_flipInfo);
 									break;
 								}
 								case true:
 								{
-									_transform.value.row4.x += _civilian.delta_time() * _movement.speed;
+									_pose.x += _civilian.delta_time() * _movement.speed;
 									SharedActorMethods::FlipEntity(_civilian.delta_time(),
 										-1,
-										_transform,
+										_pose,
 										_flipInfo);
 									break;
 								}
@@ -106,9 +104,11 @@ bool PickupLogic::Init(	std::shared_ptr<world> _flecsWorld,
 					}
 
 					// Otherwise, make the civilain hang off its captor's ship.
-					GVECTORF hangPos = _captureInfo.captor.get<Transform>()->value.row4;
-					hangPos.y -= _offset.value;
-					_transform.value.row4 = hangPos;
+					const Pose2D* hangPos = _captureInfo.captor.get<Pose2D>();
+					_pose.x = hangPos->x;
+					_pose.y = hangPos->y - _offset.value;
+					_pose.z = hangPos->z;
+					_pose.dirty = true;
 
 					break;
 				}
@@ -118,6 +118,11 @@ bool PickupLogic::Init(	std::shared_ptr<world> _flecsWorld,
 	return true;
 }
 
+void PickupLogic::Reset()
+{
+	civiRandom.Seed(flecsWorld->get<WorldSeed>()->value, RANDOM_STREAM::CIVILIAN_MOVEMENT);
+}
+
 bool PickupLogic::Activate(bool _runSystem)
 {
 	if (_runSystem)
@@ -3,6 +3,11 @@
 
 #include "../GameConfig.h"
 
+#include "../Events/EventBus.h"
+
+#include "../Utils/Random.h"
+#include "../Utils/WorldSnapshot.h"
+
 namespace GOG
 {
 	class PickupLogic
@@ -10,17 +15,24 @@ namespace GOG
 		// non-ownership handle to configuration settings
 		std::weak_ptr<const GameConfig> gameConfig;
 		// handle to events
-		GW::CORE::GEventGenerator eventPusher;
+		EventBus* eventBus;
 		// shared connection to the main ECS engine
 		std::shared_ptr<flecs::world> flecsWorld;
 		flecs::system civiSystem;
+		// civilian walk direction intervals
+		Pcg32 civiRandom;
 
 	public:
 
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _flecsWorld,
 					std::weak_ptr<const GameConfig> _gameConfig,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus);
+		// restart the walk stream so a new session plays out the same for the same seed
+		void Reset();
+		// the walk stream, stored alongside the world in snapshots
+		void SaveState(SnapshotWriter& _writer) const { _writer.Write(civiRandom); }
+		bool LoadState(SnapshotReader& _reader) { return _reader.Read(civiRandom); }
 		// control if the system is actively running
 		bool Activate(bool _runSystem);
 		// release any resources allocated by the system
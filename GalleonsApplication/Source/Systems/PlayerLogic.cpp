@@ -8,6 +8,7 @@
 
 #include "../Utils/Macros.h"
 #include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
 
 using namespace GOG;
 using namespace flecs;
@@ -21,74 +22,51 @@ using namespace MATH2D;
 // Connects logic to traverse any players and allow a controller to manipulate them
 bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 	std::weak_ptr<const GameConfig> _gameConfig,
-	GInput _keyboardMouseInput,
 	GController _gamePadInput,
 	GAudio _audioEngine,
-	GEventGenerator _eventPusher)
+	EventBus* _eventBus)
 {
 	// Save handles to the ECS & game settings.
 
 	flecsWorld = _flecsWorld;
 	gameConfig = _gameConfig;
-	keyboardMouseInput = _keyboardMouseInput;
 	gamePadInput = _gamePadInput;
 	audioEngine = _audioEngine;
-	eventPusher = _eventPusher;
+	eventBus = _eventBus;
 
 #pragma region Shared Queries
 
-	playerQuery = flecsWorld->query<const Player, const Transform>();
+	playerQuery = flecsWorld->query<const Player, const Pose2D>();
 	persistentStatsQuery = flecsWorld->query<const Player, const PersistentStats, Lives, Score, NukeDispenser>();
-	enemyQuery = flecsWorld->query<const Enemy, const Transform, const Score, SoundClips>();
-	projectileQuery = flecsWorld->query<const Projectile, const Transform>();
+	enemyQuery = flecsWorld->query<const Enemy, const Pose2D, const Score, SoundClips>();
+	projectileQuery = flecsWorld->query<const Projectile, const Pose2D>();
 
 #pragma endregion
 
 #pragma region Player Controller System
 
-	playerControllerSystem = flecsWorld->system<Player, ControllerID, Transform, Acceleration, Velocity,
-												PlayerMoveInfo, FlipInfo>().each(
-			[this](entity _player, Player&, ControllerID& _controller, Transform& _transform, Acceleration& _accel,
+	playerControllerSystem = flecsWorld->system<Player, ControllerID, Pose2D, Acceleration, Velocity,
+												PlayerMoveInfo, FlipInfo>("PlayerControllerSystem").each(
+			[this](entity _player, Player&, ControllerID& _controller, Pose2D& _pose, Acceleration& _accel,
 			Velocity& _velocity, PlayerMoveInfo& _moveInfo, FlipInfo& _flipInfo)
 			{
-				// Received inputs
-				float inputX = 0, inputY = 0, inputProjectile = 0, inputSmartBomb = 0;
+				PROFILE_SYSTEM("PlayerControllerSystem");
 				// Calculated input values.
 				float xAxis = 0, yAxis = 0, inputProjectileAdditive = 0, inputSmartBombAdditive = 0;
 
-				// Use the controller/keyboard to move the player around the screen
-				if (_controller.index == 0)
+				// Use the controller/keyboard to move the player around the screen. The devices are
+				// sampled once per frame into the InputFrame singleton so a replay can stand in for them.
+				const InputFrame* input = _player.world().get<InputFrame>();
+				if (_controller.index == 0 && input != nullptr)
 				{
-					bool isControllerConnected;
-					gamePadInput.IsConnected(_controller.index, isControllerConnected);
-
-					// Movement controls.
-					if (isControllerConnected)
-					{
-						gamePadInput.GetState(_controller.index, G_LX_AXIS, inputX); xAxis += inputX;
-						gamePadInput.GetState(_controller.index, G_LY_AXIS, inputY); yAxis += inputY;
-					}
-					keyboardMouseInput.GetState(G_KEY_LEFT, inputX); xAxis -= inputX;
-					keyboardMouseInput.GetState(G_KEY_RIGHT, inputX); xAxis += inputX;
-					keyboardMouseInput.GetState(G_KEY_UP, inputY); yAxis += inputY;
-					keyboardMouseInput.GetState(G_KEY_DOWN, inputY); yAxis -= inputY;
-
-					// Attack controls.
-					if (isControllerConnected)
-					{
-						gamePadInput.GetState(_controller.index, G_RIGHT_TRIGGER_AXIS, inputProjectile);
-						gamePadInput.GetState(_controller.index, G_LEFT_TRIGGER_AXIS, inputSmartBomb);
-					}
-					inputProjectileAdditive += inputProjectile;
-					inputSmartBombAdditive += inputSmartBomb;
-					keyboardMouseInput.GetState(G_KEY_SPACE, inputProjectile);
-					keyboardMouseInput.GetState(G_KEY_B, inputSmartBomb);
-					inputProjectileAdditive += inputProjectile;
-					inputSmartBombAdditive += inputSmartBomb;
+					xAxis = input->moveX;
+					yAxis = input->moveY;
+					inputProjectileAdditive = input->fire;
+					inputSmartBombAdditive = input->smartBomb;
 				}
 
-				HandleMovementInput(xAxis, yAxis, _player, _accel, _velocity, _transform, _moveInfo, _flipInfo);
-				HandleAttackInput(_player, _transform, _flipInfo, inputProjectileAdditive, inputSmartBombAdditive,
+				HandleMovementInput(xAxis, yAxis, _player, _accel, _velocity, _pose, _moveInfo, _flipInfo);
+				HandleAttackInput(_player, _pose, _flipInfo, inputProjectileAdditive, inputSmartBombAdditive,
 					_controller.index);
 			});
 
@@ -98,31 +76,31 @@ bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 
 	scoreQuery = flecsWorld->query<const PersistentStats, Score>();
 
-	eventResponder.Create([this](const GEvent& _event)
-	{
-		PLAY_EVENT event;
-		PLAY_EVENT_DATA data;
+	// HUD only needs the newest score total of a frame
+	eventBus->SetCoalescing(PLAY_EVENT::UPDATE_SCORE, true);
 
-		if (-_event.Read(event, data))
-			return;
-
-		switch (event)
+	eventBus->Subscribe({	PLAY_EVENT::PLAYER_DESTROYED,
+							PLAY_EVENT::ENEMY_DESTROYED,
+							PLAY_EVENT::CIVILIAN_DESTROYED,
+							PLAY_EVENT::SMART_BOMB_ACTIVATED,
+							PLAY_EVENT::HAPTICS_ACTIVATED },
+		[this](PLAY_EVENT _event, PLAY_EVENT_DATA data)
+	{
+		switch (_event)
 		{
 		case PLAY_EVENT::PLAYER_DESTROYED:
 			{
 				// Play lazer haptics.
-				GEvent activatedPlayerDeathHaptic;
 				PLAY_EVENT_DATA hapticData;
 				hapticData.value = HAPTIC_TYPE::PLAYER_DEATH;
 				hapticData.directive = 0;
-				activatedPlayerDeathHaptic.Write(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
-				eventPusher.Push(activatedPlayerDeathHaptic);
+				eventBus->Push(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
 
 				break;
 			}
 			case PLAY_EVENT::ENEMY_DESTROYED:
 			{
-				if (data.directive == UPDATE_SCORE_OK)
+				if (data.directive & UPDATE_SCORE_OK)
 				{
 					if (scoreQuery.count() > 0)
 					{
@@ -130,9 +108,7 @@ bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 						data.value += curScore;
 						scoreQuery.first().set<Score>({ data.value });
 
-						GEvent updateScore;
-						updateScore.Write(PLAY_EVENT::UPDATE_SCORE, data);
-						eventPusher.Push(updateScore);
+						eventBus->Push(PLAY_EVENT::UPDATE_SCORE, data);
 					}
 				}
 
@@ -146,9 +122,7 @@ bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 					data.value += curScore;
 					scoreQuery.first().set<Score>({ data.value });
 
-					GEvent updateScore;
-					updateScore.Write(PLAY_EVENT::UPDATE_SCORE, data);
-					eventPusher.Push(updateScore);
+					eventBus->Push(PLAY_EVENT::UPDATE_SCORE, data);
 				}
 
 				break;
@@ -161,8 +135,8 @@ bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 					persistentStatsQuery.first().get_mut<NukeDispenser>()->bombs = data.value;
 				}
 
-				SoundClips clips = *playerQuery.first().get<SoundClips>();
-				clips.sounds["SmartBomb"]->Play();
+				SharedActorMethods::PlaySound(*flecsWorld, *playerQuery.first().get<SoundClips>(),
+					SOUND_SLOT::SMART_BOMB_FX);
 				break;
 			}
 			case PLAY_EVENT::HAPTICS_ACTIVATED:
@@ -216,7 +190,6 @@ bool PlayerLogic::Init(std::shared_ptr<world> _flecsWorld,
 			}
 		}
 	});
-	eventPusher.Register(eventResponder);
 
 #pragma endregion
 
@@ -230,7 +203,7 @@ void PlayerLogic::HandleMovementInput(	float _xAxis,
 										entity _player,
 										Acceleration& _acceleration,
 										Velocity& _velocity,
-										Transform& _transform,
+										Pose2D& _pose,
 										PlayerMoveInfo& _movementStats,
 										FlipInfo& _flipInfo)
 {
@@ -272,23 +245,16 @@ void PlayerLogic::HandleMovementInput(	float _xAxis,
 	// Play acceleration sound
 	if (_xAxis != 0 || _yAxis != 0)
 	{
-		LoopingClips clips = *_player.get<LoopingClips>();
-		clips.sounds["Accel"].clip->SetVolume(clips.sounds["Accel"].volume);
-		bool isPlaying; 
-		clips.sounds["Accel"].clip->isPlaying(isPlaying);
-		if (!isPlaying)
-			clips.sounds["Accel"].clip->Play(true);
+		SharedActorMethods::PlayLoop(_player.world(), *_player.get<LoopingClips>(), LOOP_SLOT::ACCEL_FX);
 	}
 	else {
-		LoopingClips clips = *_player.get<LoopingClips>();
-		clips.sounds["Accel"].clip->SetVolume(0);
-		clips.sounds["Accel"].clip->Stop();
+		SharedActorMethods::StopLoop(_player.world(), *_player.get<LoopingClips>(), LOOP_SLOT::ACCEL_FX);
 	}
 
 	// Flip the ship
 	SharedActorMethods::FlipEntity(	_player.delta_time(),
 									_xAxis,
-									_transform,
+									_pose,
 									_flipInfo);
 }
 
@@ -297,7 +263,7 @@ void PlayerLogic::HandleMovementInput(	float _xAxis,
 #pragma region Attacking
 
 void PlayerLogic::HandleAttackInput(	entity _player,
-										Transform& _playerTransform,
+										const Pose2D& _playerPose,
 										FlipInfo& _flipInfo,
 										const float _projectileInput,
 										const float _smartBombInput,
@@ -309,7 +275,7 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 	{
 		// Start charging shot.
 		_player.add<Charging>();
-		chargeInfo->chargeStart = std::chrono::high_resolution_clock::now();
+		chargeInfo->chargeStart = _player.world().get<SimClock>()->now;
 		//std::cout << "Charging shot!\n\n";
 	}
 	else if (_projectileInput == 0 && _player.has<Charging>())
@@ -331,15 +297,13 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 		//	std::cout << "Firing regular shot!\n\n";
 		//}
 
-		std::string prefabName = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::LAZER);
+		static const std::string prefabName = "ProjectilePrefab_" + std::to_string(PROJECTILE_TYPE::LAZER);
 		entity lazer{};
 		if (RetreivePrefab(prefabName.c_str(), lazer))
 		{
-			GMATRIXF t = lazer.get<Transform>()->value;
-			GVECTORF v = _playerTransform.value.row4;
-			GMATRIXF transform = OrientProjectile(_flipInfo.isFacingRight,
-				_playerTransform.value.row4,
-				lazer.get<Transform>()->value,
+			Pose2D pose = OrientProjectile(_flipInfo.isFacingRight,
+				{ _playerPose.x, _playerPose.y, _playerPose.z, 1 },
+				*lazer.get<Pose2D>(),
 				lazer.get<Offset>()->value);
 
 			// Spawn the lazer.
@@ -348,19 +312,16 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 				.add<Alive>()
 				.add<Collidable>()
 				.set<Sender>({ SENDER::PLAYER })
-				.set<Transform>({ transform });
+				.set<Pose2D>(pose);
 
 			// Play lazer sounds.
-			SoundClips clips = *lazer.get<SoundClips>();
-			clips.sounds["Shoot"]->Play();
+			SharedActorMethods::PlaySound(*flecsWorld, *lazer.get<SoundClips>(), SOUND_SLOT::SHOOT_FX);
 
 			// Play lazer haptics.
-			GEvent activatedLazerHaptic;
 			PLAY_EVENT_DATA hapticData;
 			hapticData.value = HAPTIC_TYPE::FIRE_LAZER;
 			hapticData.directive = _controller;
-			activatedLazerHaptic.Write(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
-			eventPusher.Push(activatedLazerHaptic);
+			eventBus->Push(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
 		}
 	}
 	// Check if we are pressing or releasing the smart bomb button.
@@ -377,8 +338,8 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 		unsigned int smartBombRange = 0;
 		if (playerQuery.first().is_alive())
 		{
-			playerPos = {	playerQuery.first().get<Transform>()->value.row4.x,
-							playerQuery.first().get<Transform>()->value.row4.y };
+			playerPos = {	playerQuery.first().get<Pose2D>()->x,
+							playerQuery.first().get<Pose2D>()->y };
 			smartBombCount = persistentStatsQuery.first().get<NukeDispenser>()->bombs;
 			smartBombRange = persistentStatsQuery.first().get<NukeDispenser>()->range;
 		}
@@ -387,29 +348,27 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 		// Destruct every enemy in smart bomb range.
 		enemyQuery.each(
 			[this, playerPos, smartBombRange]
-			(entity _entity, const Enemy&, const Transform& _transform, const Score& _score,
+			(entity _entity, const Enemy&, const Pose2D& _pose, const Score& _score,
 				SoundClips& _sounds)
 			{
-				GVECTOR2F pos{ _transform.value.row4.x, _transform.value.row4.y };
+				GVECTOR2F pos{ _pose.x, _pose.y };
 				float distFromPlayer = DISTANCE_2D(pos.x, pos.y, playerPos.x, playerPos.y);
 				if (distFromPlayer < smartBombRange)
 				{
-					GEvent enemyDestroyed;
 					PLAY_EVENT_DATA data;
 					data.value = _score.value;
 					data.directive = DIRECTIVES::UPDATE_SCORE_OK;
-					enemyDestroyed.Write(PLAY_EVENT::ENEMY_DESTROYED, data);
-					eventPusher.Push(enemyDestroyed);
-					_sounds.sounds["Death"]->Play();
+					eventBus->Push(PLAY_EVENT::ENEMY_DESTROYED, data);
+					SharedActorMethods::PlaySound(_entity.world(), _sounds, SOUND_SLOT::DEATH_FX);
 					_entity.destruct();
 				}
 			});
 
 		projectileQuery.each(
 			[this, playerPos, smartBombRange]
-			(entity& _entity, const Projectile&, const Transform& _transform)
+			(entity& _entity, const Projectile&, const Pose2D& _pose)
 			{
-				GVECTOR2F pos{ _transform.value.row4.x, _transform.value.row4.y };
+				GVECTOR2F pos{ _pose.x, _pose.y };
 				float distFromPlayer = DISTANCE_2D(pos.x, pos.y, playerPos.x, playerPos.y);
 				if (distFromPlayer < smartBombRange)
 				{
@@ -417,45 +376,41 @@ void PlayerLogic::HandleAttackInput(	entity _player,
 				}
 			});
 
-			GEvent activateSmartBomb;
 			PLAY_EVENT_DATA data;
 			data.value = smartBombCount - 1;
-			activateSmartBomb.Write(PLAY_EVENT::SMART_BOMB_ACTIVATED, data);
-			eventPusher.Push(activateSmartBomb);
+			eventBus->Push(PLAY_EVENT::SMART_BOMB_ACTIVATED, data);
 
 			// Play smart bomb haptics.
-			GEvent activatedSmartBombHaptic;
 			PLAY_EVENT_DATA hapticData;
 			hapticData.value = HAPTIC_TYPE::DETONATE_SMART_BOMB;
 			hapticData.directive = _controller;
-			activatedSmartBombHaptic.Write(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
-			eventPusher.Push(activatedSmartBombHaptic);
+			eventBus->Push(PLAY_EVENT::HAPTICS_ACTIVATED, hapticData);
 	}
 }
 
-GMATRIXF PlayerLogic::OrientProjectile(	bool _playerIsFacingRight, 
+Pose2D PlayerLogic::OrientProjectile(	bool _playerIsFacingRight, 
 										GVECTORF _playerPos,
-										GMATRIXF _projectileTransform,
+										Pose2D _projectilePose,
 										float _projectileOffset)
 {
-	_projectileTransform.row4 = _playerPos;
+	_projectilePose = SharedActorMethods::PoseAt(_projectilePose, _playerPos);
 	float rotDegree;
 	float rotRadian;
 	GVECTORF offset{ _projectileOffset, 0, 0, 0 };
 
 	if (_playerIsFacingRight)
 	{
-		GMatrix::TranslateLocalF(_projectileTransform, offset, _projectileTransform);
+		SharedActorMethods::TranslatePoseLocal(offset, _projectilePose);
 	}
 	else
 	{
 		rotDegree = 180;
 		rotRadian = DEGREE_TO_RADIAN(rotDegree);
-		GMatrix::RotateYGlobalF(_projectileTransform, rotRadian, _projectileTransform);
-		GMatrix::TranslateLocalF(_projectileTransform, offset, _projectileTransform);
+		_projectilePose.yaw += rotRadian;
+		SharedActorMethods::TranslatePoseLocal(offset, _projectilePose);
 	}
 
-	return _projectileTransform;
+	return _projectilePose;
 }
 #pragma endregion
 
@@ -5,6 +5,8 @@
 // Contains our global game settings
 #include "../GameConfig.h"
 
+#include "../Events/EventBus.h"
+
 #include "../Components/AudioSource.h"
 #include "../Components/Gameplay.h"
 #include "../Components/Identification.h"
@@ -21,8 +23,7 @@ namespace GOG
 		// handle to our running ECS system
 		flecs::system playerControllerSystem;
 		//flecs::system healthSystem;
-		// permananent handles input systems
-		GW::INPUT::GInput keyboardMouseInput;
+		// only used for haptics, input is read from the InputFrame singleton
 		GW::INPUT::GController gamePadInput;
 		//GW::INPUT::GBufferedInput bufferedInput;
 
@@ -31,14 +32,13 @@ namespace GOG
 		// we choose cache over responder here for better ECS compatibility
 		//GW::CORE::GEventCache pressEvents;
 
-		GW::CORE::GEventGenerator eventPusher;
-		GW::CORE::GEventResponder eventResponder;
+		EventBus* eventBus;
 
 		flecs::query<const PersistentStats, Score> scoreQuery;
-		flecs::query<const Player, const Transform> playerQuery;
+		flecs::query<const Player, const Pose2D> playerQuery;
 		flecs::query<const Player, const PersistentStats, Lives, Score, NukeDispenser> persistentStatsQuery;
-		flecs::query<const Enemy, const Transform, const Score, SoundClips> enemyQuery;
-		flecs::query<const Projectile, const Transform> projectileQuery;
+		flecs::query<const Enemy, const Pose2D, const Score, SoundClips> enemyQuery;
+		flecs::query<const Projectile, const Pose2D> projectileQuery;
 
 
 		void HandleMovementInput(	float _xAxis,
@@ -46,30 +46,29 @@ namespace GOG
 									flecs::entity _entity,
 									Acceleration& _acceleration,
 									Velocity& _velocity,
-									Transform& _transform,
+									Pose2D& _pose,
 									PlayerMoveInfo& _movementStats,
 									FlipInfo& _flipInfo);
 		void HandleAttackInput(	flecs::entity _entity,
-								Transform& _playerTransform,
+								const Pose2D& _playerPose,
 								FlipInfo& _flipInfo,
 								const float _fireInput,
 								const float _smartBombInput,
 								unsigned int _controller);
-		GW::MATH::GMATRIXF OrientProjectile(bool _playerIsFacingRight, 
-											GW::MATH::GVECTORF _playerPos,
-											GW::MATH::GMATRIXF _projectileTransform,
-											float _projectileOffset);
+		Pose2D OrientProjectile(bool _playerIsFacingRight, 
+								GW::MATH::GVECTORF _playerPos,
+								Pose2D _projectilePose,
+								float _projectileOffset);
 
 	public:
 
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game,
 					std::weak_ptr<const GameConfig> _gameConfig,
-					GW::INPUT::GInput _keyboardMouseInput,
 					GW::INPUT::GController _gamePadInput,
 					//GW::INPUT::GBufferedInput _bufferedInput,
 					GW::AUDIO::GAudio _audioEngine,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus);
 		// control if the system is actively running
 		bool Activate(bool runSystem);
 		// release any resources allocated by the system
@@ -1,5 +1,6 @@
 #include "Renderer.h"
 #include "../Utils/TextStorage.h"
+#include "../Utils/Profiler.h"
 
 
 using namespace GOG;
@@ -14,19 +15,18 @@ bool GOG::DirectX11Renderer::Init(GW::SYSTEM::GWindow _win,
 	std::weak_ptr<const GameConfig> _gameConfig,
 	LevelData* _lvl,
 	ActorData* _actors,
-	GW::CORE::GEventGenerator _eventPusher)
+	EventBus* _eventBus)
 {
 	window = _win;
 	d3d = _renderingSurface;
 	flecsWorld = _flecsWorld;
 	uiWorld = _uiWorld;
-	uiWorldAsync = _uiWorld->async_stage();
 	uiWorldLock.Create();
 	gameConfig = _gameConfig;
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
 	levelData = _lvl;
 	actorData = _actors;
-	eventPusherUI = _eventPusher;
+	eventBus = _eventBus;
 
 	currState = GAME_STATES::LOGO_SCREEN;
 	input.Create(_win);
@@ -55,16 +55,34 @@ bool GOG::DirectX11Renderer::Init(GW::SYSTEM::GWindow _win,
 
 	//Level
 	levelSegmentWidth = readCfg->at("Game").at("levelSegmentWidth").as<float>();
+	perfHud.Init(flecsWorld, readCfg->at("PerfHud").at("refreshFrames").as<unsigned int>(),
+		readCfg->at("PerfHud").at("showOnStart").as<int>() != 0);
 	H2B::Attributes levelAttrib = levelData->materials[levelData->levelInstances.front().modelIndex].attrib;
 	levelAttribute = levelAttrib;
 
 	//Actors
 	H2B::Attributes actorAttrib = actorData->materials[actorData->meshes.begin()->materialIndex].attrib;
 	actorAttribute = actorAttrib;
-	for (int i = 0; i < instanceMax; i++)
+	actorInstances.Create(readCfg->at("Memory").at("actorInstances").as<unsigned int>(),
+		readCfg->at("Memory").at("actorInstancesMax").as<unsigned int>());
+	actorQueue.Create(static_cast<unsigned int>(actorData->models.size()), actorInstances.Capacity());
+	queuedTransforms.resize(actorInstances.Capacity());
+	queuedMapTransforms.resize(actorInstances.Capacity());
+	levelRanges.resize(levelData->instanceBvh.InstanceCount());
+	frameDraws.Create(readCfg->at("Memory").at("uploadRingKB").as<size_t>() * 1024, FRAME_DRAWS_EXPECTED);
+	levelStream.Bake(*levelData, { readCfg->at("Renderer").at("mergeStaticMeshes").as<int>() != 0,
+		readCfg->at("Renderer").at("mergeMaxIndices").as<unsigned int>(), readCfg->at("Renderer").at("mergeCellWidth").as<float>() });
+	const LevelStreamStats& streamStats = levelStream.GetStats();
+	std::string streamReport = std::to_string(streamStats.draws) + " draws, " + std::to_string(streamStats.materials) + " materials, " +
+		std::to_string(streamStats.mergedInstances) + " instances merged into " + std::to_string(streamStats.mergedBatches) + " batches";
+	PrintLabeledDebugString("Level stream: ", streamReport.c_str());
+	passThreads = readCfg->at("Renderer").at("passThreads").as<unsigned int>();
+	lightBins.Create(readCfg->at("Renderer").at("lightTileSize").as<unsigned int>());
+	lightBins.SetLights(static_cast<unsigned int>(levelData->sceneLights.size()));
+	for (unsigned int i = 0; i < levelData->sceneLights.size(); i++)
 	{
-		instanceTransforms.transforms[i] = world;
-		instanceTransforms.modelNdxs[i] = 0;
+		const H2B::Light& light = levelData->sceneLights[i];
+		lightBins.SetLight(i, &light.worldPos.x, light.worldPos.w, light.radius);
 	}
 
 	//UI
@@ -114,21 +132,11 @@ bool GOG::DirectX11Renderer::Init(GW::SYSTEM::GWindow _win,
 	texId = levelData->levelModels[levelData->levelInstances.front().modelIndex].texId;
 	modelType = 0;
 
-	struct UIMergeAsyncStages {};
-	_uiWorld->entity("UIMergeAsyncStages").add<UIMergeAsyncStages>();
-
-	uiWorld->system<UIMergeAsyncStages>()
-		.kind(flecs::OnLoad)
-		.each([this](flecs::entity _entity, UIMergeAsyncStages& _uiMergeAsync)
-			{
-				uiWorldLock.LockSyncWrite();
-				uiWorldAsync.merge();
-				uiWorldLock.UnlockSyncWrite();
-			});
+	uiCommands.Create(_uiWorld, "UIMergeCommandBuffers");
 
 	//Buffer Data
 	mapModelData = { modelType };
-	instanceData = { 0, 0, texId };
+	instanceData = { 0, 0, 0.0f, texId };
 
 	sceneData = currentLevelSceneData;
 	sceneData.viewMatrix = viewMatrix;
@@ -137,6 +145,8 @@ bool GOG::DirectX11Renderer::Init(GW::SYSTEM::GWindow _win,
 
 	meshData = { worldMatrix, levelAttribute };
 	actorMeshData = { worldMatrix, actorAttribute };
+	// the level's materials never change, every frame binds the same records
+	PinLevelMaterials(frameDraws, levelStream, meshData);
 
 	InitCredits();
 	if (LoadEventResponders() == false)
@@ -155,6 +165,7 @@ bool GOG::DirectX11Renderer::Init(GW::SYSTEM::GWindow _win,
 		return false;
 	if (SetupPipeline() == false)
 		return false;
+	SetupRenderBackend();
 	InitRendererSystems();
 
 	return true;
@@ -219,112 +230,111 @@ bool GOG::DirectX11Renderer::LoadSceneData()
 
 bool GOG::DirectX11Renderer::LoadEventResponders()
 {
-	onEvent.Create([this](const GW::GEvent& _event)
+	eventBus->Subscribe({	PLAY_EVENT::PLAYER_DESTROYED,
+							PLAY_EVENT::UPDATE_SCORE,
+							PLAY_EVENT::SMART_BOMB_ACTIVATED,
+							PLAY_EVENT::SMART_BOMB_GRABBED,
+							PLAY_EVENT::WAVE_CLEARED,
+							PLAY_EVENT::STATE_CHANGED },
+		[this](PLAY_EVENT _event, PLAY_EVENT_DATA data)
 		{
-			PLAY_EVENT eventTag;
-			PLAY_EVENT_DATA data;
-
-			if (+_event.Read(eventTag, data))
+			switch (_event)
 			{
-				switch (eventTag)
+				case PLAY_EVENT::PLAYER_DESTROYED:
 				{
-					case PLAY_EVENT::PLAYER_DESTROYED:
-					{
-						UpdateLives(data.value);
-						if (data.value <= 0)
-						{
-							currState = GAME_STATES::GAME_OVER_SCREEN;
-						}
-						break;
-					}
-
-					case PLAY_EVENT::UPDATE_SCORE:
+					UpdateLives(data.value);
+					if (data.value <= 0)
 					{
-						UpdateScore(data.value);
-						break;
+						currState = GAME_STATES::GAME_OVER_SCREEN;
 					}
+					break;
+				}
 
-					case PLAY_EVENT::SMART_BOMB_ACTIVATED:
-					{
-						UpdateSmartBombs(data.value);
+				case PLAY_EVENT::UPDATE_SCORE:
+				{
+					UpdateScore(data.value);
+					break;
+				}
 
-						auto now = std::chrono::system_clock::now().time_since_epoch();
-						bombEffectStartTime = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+				case PLAY_EVENT::SMART_BOMB_ACTIVATED:
+				{
+					UpdateSmartBombs(data.value);
 
-						if (bombEffect == nullptr)
-						{
-							bombEffect.Create(updateBombEffectTime, [this]() {
-								auto curTime = std::chrono::system_clock::now().time_since_epoch();
-								unsigned now = std::chrono::duration_cast<std::chrono::milliseconds>(curTime).count();
-								float ratio = (now - bombEffectStartTime) / (float)bombEffectTime;
-								bool isDone = false;
-
-								if (ratio > 1)
-								{
-									isDone = true;
-									ratio = 1;
-								}
-
-								GW::MATH::GVector::LerpF(actorSceneData[1].fogColor, actorSceneData[0].fogColor,
-									ratio, currentActorSceneData.fogColor);
-								currentActorSceneData.fogDensity =
-									G_LERP(actorSceneData[1].fogDensity, actorSceneData[0].fogDensity, ratio);
-								currentActorSceneData.fogStartDistance =
-									G_LERP(actorSceneData[1].fogStartDistance, actorSceneData[0].fogStartDistance, ratio);
-
-								GW::MATH::GVector::LerpF(levelSceneData[1].fogColor, levelSceneData[0].fogColor,
-									ratio, currentLevelSceneData.fogColor);
-								currentLevelSceneData.fogDensity =
-									G_LERP(levelSceneData[1].fogDensity, levelSceneData[0].fogDensity, ratio);
-								currentLevelSceneData.fogStartDistance =
-									G_LERP(levelSceneData[1].fogStartDistance, levelSceneData[0].fogStartDistance, ratio);
-
-								GW::MATH::GVector::LerpF(bgColorData[1], bgColorData[0], ratio, currentBgColorData);
-
-								if (isDone)
-								{
-									bombEffect.Pause(0, false);
-								}
-								}, 1);
-						}
-						else 
-						{
-							bombEffect.Resume();
-						}
-						break;
-					}
+					auto now = std::chrono::system_clock::now().time_since_epoch();
+					bombEffectStartTime = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
 
-					case PLAY_EVENT::SMART_BOMB_GRABBED:
+					if (bombEffect == nullptr)
 					{
-						UpdateSmartBombs(data.value);
+						bombEffect.Create(updateBombEffectTime, [this]() {
+							PROFILE_ZONE("BombEffectDaemon");
+							auto curTime = std::chrono::system_clock::now().time_since_epoch();
+							unsigned now = std::chrono::duration_cast<std::chrono::milliseconds>(curTime).count();
+							float ratio = (now - bombEffectStartTime) / (float)bombEffectTime;
+							bool isDone = false;
+
+							if (ratio > 1)
+							{
+								isDone = true;
+								ratio = 1;
+							}
 
-						break;
-					}
+							GW::MATH::GVector::LerpF(actorSceneData[1].fogColor, actorSceneData[0].fogColor,
+								ratio, currentActorSceneData.fogColor);
+							currentActorSceneData.fogDensity =
+								G_LERP(actorSceneData[1].fogDensity, actorSceneData[0].fogDensity, ratio);
+							currentActorSceneData.fogStartDistance =
+								G_LERP(actorSceneData[1].fogStartDistance, actorSceneData[0].fogStartDistance, ratio);
 
-					case PLAY_EVENT::WAVE_CLEARED:
-					{
-						UpdateWaves(data.value);
+							GW::MATH::GVector::LerpF(levelSceneData[1].fogColor, levelSceneData[0].fogColor,
+								ratio, currentLevelSceneData.fogColor);
+							currentLevelSceneData.fogDensity =
+								G_LERP(levelSceneData[1].fogDensity, levelSceneData[0].fogDensity, ratio);
+							currentLevelSceneData.fogStartDistance =
+								G_LERP(levelSceneData[1].fogStartDistance, levelSceneData[0].fogStartDistance, ratio);
 
-						break;
-					}
-					case PLAY_EVENT::STATE_CHANGED:
-					{
-						uiWorldLock.LockSyncWrite();
-						splashAlpha = data.value;
-						creditsOffset = (float)newHeight * 2.9f;
-						uiWorldLock.UnlockSyncWrite();
-						break;
+							GW::MATH::GVector::LerpF(bgColorData[1], bgColorData[0], ratio, currentBgColorData);
+
+							if (isDone)
+							{
+								bombEffect.Pause(0, false);
+							}
+							}, 1);
 					}
-					default:
+					else 
 					{
-						break;
+						bombEffect.Resume();
 					}
-						
-				}			
-			}
+					break;
+				}
+
+				case PLAY_EVENT::SMART_BOMB_GRABBED:
+				{
+					UpdateSmartBombs(data.value);
+
+					break;
+				}
 
+				case PLAY_EVENT::WAVE_CLEARED:
+				{
+					UpdateWaves(data.value);
+
+					break;
+				}
+				case PLAY_EVENT::STATE_CHANGED:
+				{
+					uiWorldLock.LockSyncWrite();
+					splashAlpha = data.value;
+					creditsOffset = (float)newHeight * 2.9f;
+					uiWorldLock.UnlockSyncWrite();
+					break;
+				}
+				default:
+				{
+					break;
+				}
+					
+			}			
 		});
-	eventPusherUI.Register(onEvent);
 
 	onWindowResize.Create([&](const GW::GEvent& event)
 		{
@@ -376,177 +386,97 @@ bool GOG::DirectX11Renderer::LoadShaders()
 	d3d.GetDevice((void**)&device);
 
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
-
-	std::string vertexShaderSource = ReadFileIntoString("../Shaders/VertexShader.hlsl");
-	std::string pixelShaderSource = ReadFileIntoString("../Shaders/PixelShader.hlsl");
-	std::string mapVSSource = ReadFileIntoString("../Shaders/VSMap.hlsl");
-	std::string mapPSSource = ReadFileIntoString("../Shaders/PSMap.hlsl");
-	std::string mapModelsPSSource = ReadFileIntoString("../Shaders/PSColorMapModels.hlsl");
-	std::string levelVSSource = ReadFileIntoString("../Shaders/VSLevelShader.hlsl");
+	// filled at build time by Utils/CompileShaders.py, and by any run that had to compile
+	if (shaderCache.Create(readCfg->at("Shaders").at("cacheDirectory").as<std::string>()) == false)
+		PrintLabeledDebugString("Shader cache: ", "can't create the cache directory, compiled shaders won't be kept");
+	auto start = std::chrono::steady_clock::now();
 
 	UINT compilerFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #if _DEBUG
 	compilerFlags |= D3DCOMPILE_DEBUG;
 #endif
 
-	HRESULT vsCompilationResult = D3DCompile(vertexShaderSource.c_str(),
-		vertexShaderSource.length(),
-		nullptr,
-		nullptr,
-		nullptr,
-		"main",
-		"vs_5_0",
-		compilerFlags,
-		0,
-		vsBlob.GetAddressOf(),
-		errors.GetAddressOf());
+	if (LoadShaderBlob("VertexShader", "vs_5_0", compilerFlags, vsBlob) == false ||
+		LoadShaderBlob("VSMap", "vs_5_0", compilerFlags, vsMapBlob) == false ||
+		LoadShaderBlob("VSLevelShader", "vs_5_0", compilerFlags, vsLevelBlob) == false ||
+		LoadShaderBlob("PixelShader", "ps_5_0", compilerFlags, psBlob) == false ||
+		LoadShaderBlob("PSMap", "ps_5_0", compilerFlags, psMapBlob) == false ||
+		LoadShaderBlob("PSColorMapModels", "ps_5_0", compilerFlags, psMapModelsBlob) == false)
+	{
+		abort();
+		return false;
+	}
 
-	HRESULT vsMapCompResult = D3DCompile(mapVSSource.c_str(),
-		mapVSSource.length(),
+	device->CreateVertexShader(vsBlob->GetBufferPointer(),
+		vsBlob->GetBufferSize(),
+		nullptr, vertexShader.GetAddressOf());
+	device->CreateVertexShader(vsMapBlob->GetBufferPointer(),
+		vsMapBlob->GetBufferSize(),
+		nullptr, mapVertexShader.GetAddressOf());
+	device->CreateVertexShader(vsLevelBlob->GetBufferPointer(),
+		vsLevelBlob->GetBufferSize(),
+		nullptr, levelVertexShader.GetAddressOf());
+
+	device->CreatePixelShader(psBlob->GetBufferPointer(),
+		psBlob->GetBufferSize(),
 		nullptr,
+		pixelShader.GetAddressOf());
+	device->CreatePixelShader(psMapBlob->GetBufferPointer(),
+		psMapBlob->GetBufferSize(),
 		nullptr,
+		mapPixelShader.GetAddressOf());
+	device->CreatePixelShader(psMapModelsBlob->GetBufferPointer(),
+		psMapModelsBlob->GetBufferSize(),
 		nullptr,
-		"main",
-		"vs_5_0",
-		compilerFlags,
-		0,
-		vsMapBlob.GetAddressOf(),
-		errors.GetAddressOf());
+		mapModelsPixelShader.GetAddressOf());
 
-	HRESULT vsLevelCompResult = D3DCompile(levelVSSource.c_str(),
-		levelVSSource.length(),
-		nullptr,
-		nullptr,
-		nullptr,
-		"main",
-		"vs_5_0",
-		compilerFlags,
-		0,
-		vsLevelBlob.GetAddressOf(),
-		errors.GetAddressOf());
+	device->Release();
 
-	if (SUCCEEDED(vsCompilationResult))
-	{
-		device->CreateVertexShader(vsBlob->GetBufferPointer(),
-			vsBlob->GetBufferSize(),
-			nullptr, vertexShader.GetAddressOf());
-	}
-	else
-	{
-		PrintLabeledDebugString("Vertex Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
-		return false;
-	}
+	const ShaderCacheStats& cacheStats = shaderCache.GetStats();
+	std::string report = std::to_string(cacheStats.hits) + " from the cache, " + std::to_string(cacheStats.misses) + " compiled in " +
+		std::to_string(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
+	PrintLabeledDebugString("Shaders: ", report.c_str());
+	return true;
+}
 
-	if (SUCCEEDED(vsMapCompResult))
-	{
-		device->CreateVertexShader(vsMapBlob->GetBufferPointer(),
-			vsMapBlob->GetBufferSize(),
-			nullptr, mapVertexShader.GetAddressOf());
-	}
-	else
-	{
-		PrintLabeledDebugString("Vertex Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
-		return false;
-	}
+bool GOG::DirectX11Renderer::LoadShaderBlob(const char* _name, const char* _target, UINT _flags, Microsoft::WRL::ComPtr<ID3DBlob>& _blob)
+{
+	std::string path = std::string("../Shaders/") + _name + ".hlsl";
+	std::string source = ReadFileIntoString(path.c_str());
+	unsigned long long key = ShaderCacheKey(source, _target, "main", _flags);
 
-	if (SUCCEEDED(vsLevelCompResult))
+	std::vector<unsigned char> bytecode;
+	if (shaderCache.Load(_name, key, bytecode))
 	{
-		device->CreateVertexShader(vsLevelBlob->GetBufferPointer(),
-			vsLevelBlob->GetBufferSize(),
-			nullptr, levelVertexShader.GetAddressOf());
-	}
-	else
-	{
-		PrintLabeledDebugString("Vertex Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
-		return false;
+		_blob.Reset();
+		if (SUCCEEDED(D3DCreateBlob(bytecode.size(), _blob.GetAddressOf())))
+		{
+			memcpy(_blob->GetBufferPointer(), bytecode.data(), bytecode.size());
+			return true;
+		}
 	}
 
-	HRESULT psCompilationResult = D3DCompile(pixelShaderSource.c_str(),
-		pixelShaderSource.length(),
-		nullptr,
-		nullptr,
-		nullptr,
-		"main",
-		"ps_5_0",
-		compilerFlags,
-		0,
-		psBlob.GetAddressOf(),
-		errors.GetAddressOf());
-
-	HRESULT psMapCompResult = D3DCompile(mapPSSource.c_str(),
-		mapPSSource.length(),
+	_blob.Reset();
+	errors.Reset();
+	HRESULT compileResult = D3DCompile(source.c_str(),
+		source.length(),
 		nullptr,
 		nullptr,
 		nullptr,
 		"main",
-		"ps_5_0",
-		compilerFlags,
+		_target,
+		_flags,
 		0,
-		psMapBlob.GetAddressOf(),
+		_blob.GetAddressOf(),
 		errors.GetAddressOf());
 
-	HRESULT psMapModelsCompResult = D3DCompile(mapModelsPSSource.c_str(),
-		mapModelsPSSource.length(),
-		nullptr,
-		nullptr,
-		nullptr,
-		"main",
-		"ps_5_0",
-		compilerFlags,
-		0,
-		psMapModelsBlob.GetAddressOf(),
-		errors.GetAddressOf());
-
-	if (SUCCEEDED(psCompilationResult))
-	{
-		device->CreatePixelShader(psBlob->GetBufferPointer(),
-			psBlob->GetBufferSize(),
-			nullptr,
-			pixelShader.GetAddressOf());
-
-	}
-	else
+	if (FAILED(compileResult))
 	{
-		PrintLabeledDebugString("Pixel Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
+		std::string label = std::string(_name) + " Errors:\n";
+		PrintLabeledDebugString(label.c_str(), errors ? (char*)errors->GetBufferPointer() : "can't compile\n");
 		return false;
 	}
-
-	if (SUCCEEDED(psMapCompResult))
-	{
-		device->CreatePixelShader(psMapBlob->GetBufferPointer(),
-			psMapBlob->GetBufferSize(),
-			nullptr,
-			mapPixelShader.GetAddressOf());
-
-	}
-	else
-	{
-		PrintLabeledDebugString("Pixel Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
-		return false;
-	}
-
-	if (SUCCEEDED(psMapModelsCompResult))
-	{
-		device->CreatePixelShader(psMapModelsBlob->GetBufferPointer(),
-			psMapModelsBlob->GetBufferSize(),
-			nullptr,
-			mapModelsPixelShader.GetAddressOf());
-
-	}
-	else
-	{
-		PrintLabeledDebugString("Pixel Shader Errors:\n", (char*)errors->GetBufferPointer());
-		abort();
-		return false;
-	}
-
-	device->Release();
-
+	shaderCache.Store(_name, key, _blob->GetBufferPointer(), _blob->GetBufferSize());
 	return true;
 }
 
@@ -624,7 +554,7 @@ bool GOG::DirectX11Renderer::LoadBuffers()
 	mapModelSubData.SysMemSlicePitch = 0;
 
 	D3D11_BUFFER_DESC sbTransformDesc = {};
-	sbTransformDesc.ByteWidth = sizeof(TransformData) * levelData->transforms.size();
+	sbTransformDesc.ByteWidth = sizeof(TransformData) * levelStream.Transforms().size();
 	sbTransformDesc.Usage = D3D11_USAGE_DYNAMIC;
 	sbTransformDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 	sbTransformDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
@@ -632,23 +562,10 @@ bool GOG::DirectX11Renderer::LoadBuffers()
 	sbTransformDesc.StructureByteStride = sizeof(TransformData);
 
 	D3D11_SUBRESOURCE_DATA transformSubData = {};
-	transformSubData.pSysMem = levelData->transforms.data();
+	transformSubData.pSysMem = levelStream.Transforms().data();
 	transformSubData.SysMemPitch = 0;
 	transformSubData.SysMemSlicePitch = 0;
 
-	D3D11_BUFFER_DESC sbActorTransformDesc{};
-	sbActorTransformDesc.ByteWidth = sizeof(TransformData) * instanceMax;
-	sbActorTransformDesc.Usage = D3D11_USAGE_DYNAMIC;
-	sbActorTransformDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	sbActorTransformDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	sbActorTransformDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-	sbActorTransformDesc.StructureByteStride = sizeof(TransformData);
-
-	D3D11_SUBRESOURCE_DATA actorTransformSubData{};
-	actorTransformSubData.pSysMem = &instanceTransforms.transforms;
-	actorTransformSubData.SysMemPitch = 0;
-	actorTransformSubData.SysMemSlicePitch = 0;
-
 	D3D11_BUFFER_DESC sbLightDesc{};
 	sbLightDesc.ByteWidth = sizeof(LightData) * levelData->sceneLights.size();
 	sbLightDesc.Usage = D3D11_USAGE_DYNAMIC;
@@ -697,7 +614,16 @@ bool GOG::DirectX11Renderer::LoadBuffers()
 	device->CreateBuffer(&cbSceneDesc, &sceneSubData, cSceneBuffer.GetAddressOf());
 	device->CreateBuffer(&cbMapModelDesc, &mapModelSubData, cMapModelBuffer.GetAddressOf());
 	device->CreateBuffer(&sbTransformDesc, &transformSubData, sTransformBuffer.GetAddressOf());
-	device->CreateBuffer(&sbActorTransformDesc, &actorTransformSubData, sActorTransformBuffer.GetAddressOf());
+
+	// draws bind windows of one upload buffer where the driver can, otherwise each record is
+	// copied to the small constant buffers above right before its draw
+	for (D3D11RenderBackend& backend : passBackends)
+		backend.Create(device);
+	CreateActorTransformBuffer(device, actorInstances.Capacity());
+	// the tile ranges of the window and a few lights per tile, grows with the bins
+	unsigned int lightTilesX, lightTilesY;
+	CreateLightBinBuffer(device, LightTileCount(screenWidth, screenHeight, lightBins.TileSize(), lightTilesX, lightTilesY) * 4);
+	CreatePassContexts(device);
 
 	device->Release();
 	return true;
@@ -776,13 +702,7 @@ bool GOG::DirectX11Renderer::LoadShaderResources()
 	transViewDesc.Format = DXGI_FORMAT_UNKNOWN;
 	transViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
 	transViewDesc.BufferEx.FirstElement = 0;
-	transViewDesc.BufferEx.NumElements = levelData->transforms.size();
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC actorTransViewDesc{};
-	actorTransViewDesc.Format = DXGI_FORMAT_UNKNOWN;
-	actorTransViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
-	actorTransViewDesc.BufferEx.FirstElement = 0;
-	actorTransViewDesc.BufferEx.NumElements = instanceMax;
+	transViewDesc.BufferEx.NumElements = levelStream.Transforms().size();
 
 	D3D11_RENDER_TARGET_BLEND_DESC targetBlendDesc = {};
 	targetBlendDesc.BlendEnable = TRUE;
@@ -805,9 +725,6 @@ bool GOG::DirectX11Renderer::LoadShaderResources()
 	device->CreateShaderResourceView(sTransformBuffer.Get(),
 		&transViewDesc,
 		transformView.GetAddressOf());
-	device->CreateShaderResourceView(sActorTransformBuffer.Get(),
-		&actorTransViewDesc,
-		actorTransformView.GetAddressOf());
 
 	if (levelData->sceneLights.data() != nullptr)
 	{
@@ -828,8 +745,9 @@ bool GOG::DirectX11Renderer::LoadGeometry()
 	ID3D11Device* creator;
 	d3d.GetDevice((void**)&creator);
 
-	D3D11_SUBRESOURCE_DATA lvData = { levelData->vertices.data(), 0, 0 };
-	CD3D11_BUFFER_DESC lvDesc(sizeof(H2B::Vertex) * levelData->vertices.size(), D3D11_BIND_VERTEX_BUFFER);
+	// the level's own geometry with the merged batches' after it
+	D3D11_SUBRESOURCE_DATA lvData = { levelStream.Vertices().data(), 0, 0 };
+	CD3D11_BUFFER_DESC lvDesc(sizeof(H2B::Vertex) * levelStream.Vertices().size(), D3D11_BIND_VERTEX_BUFFER);
 	creator->CreateBuffer(&lvDesc, &lvData, vertexBuffer.GetAddressOf());
 
 	D3D11_SUBRESOURCE_DATA avData = { actorData->vertices.data(), 0, 0 };
@@ -840,8 +758,8 @@ bool GOG::DirectX11Renderer::LoadGeometry()
 	CD3D11_BUFFER_DESC mvDesc(sizeof(H2B::Vertex) * 4, D3D11_BIND_VERTEX_BUFFER);
 	creator->CreateBuffer(&mvDesc, &mvData, mapVertexBuffer.GetAddressOf());
 
-	D3D11_SUBRESOURCE_DATA liData = { levelData->indices.data(), 0, 0 };
-	CD3D11_BUFFER_DESC liDesc(sizeof(unsigned int) * levelData->indices.size(), D3D11_BIND_INDEX_BUFFER);
+	D3D11_SUBRESOURCE_DATA liData = { levelStream.Indices().data(), 0, 0 };
+	CD3D11_BUFFER_DESC liDesc(sizeof(unsigned int) * levelStream.Indices().size(), D3D11_BIND_INDEX_BUFFER);
 	creator->CreateBuffer(&liDesc, &liData, indexBuffer.GetAddressOf());
 
 	D3D11_SUBRESOURCE_DATA aiData = { actorData->indices.data(), 0, 0 };
@@ -1028,236 +946,247 @@ bool GOG::DirectX11Renderer::Load2D()
 	creditsOrigin.y /= 2;
 
 	//Entities
-	uiWorldLock.LockSyncWrite();
 	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
 
-	uiWorldAsync.entity("TeamLogo")
-		.add<LogoScreen>()
-		.set<Sprite>({ teamLogoView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ teamLogoOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("DirectSplash")
-		.add<DirectXScreen>()
-		.set<Sprite>({ directSplashView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ directSplashOrigin })
-		.set<Scale>({ 2.0f });
-
-	uiWorldAsync.entity("GateSplash")
-		.add<GatewareScreen>()
-		.set<Sprite>({ gateSplashView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ gateSplashOrigin })
-		.set<Scale>({ 0.75f });
-
-	uiWorldAsync.entity("FlecsSplash")
-		.add<FlecsScreen>()
-		.set<Sprite>({ flecsSplashView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ flecsSplashOrigin })
-		.set<Scale>({ 0.82f });
-
-	uiWorldAsync.entity("Title")
-		.add<TitleScreen>()
-		.set<Sprite>({ titleView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ titleSpriteOrigin })
-		.set<Scale>({ 0.8f });
-
-	uiWorldAsync.entity("MainMenu")
-		.add<MainMenu>()
-		.set<Sprite>({ mainMenuView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ mainMenuSpriteOrigin })
-		.set<Scale>({ 1.5f });
-
-	uiWorldAsync.entity("MenuTitle")
-		.add<MainMenu>()
-		.set<Text>({ L"GALLEONS\n OF THE \n GALAXY" })
-		.set<TextColor>({ DirectX::Colors::Azure })
-		.add<Top>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 0.5f) })
-		.set<Position>({})
-		.set<Origin>({ menuTitleOrigin })
-		.set<Scale>({ 2.0f });
-
-	uiWorldAsync.entity("MenuPlay")
-		.add<MainMenu>()
-		.set<Text>({ L" Play\n[Enter]" })
-		.set<TextColor>({ DirectX::Colors::Azure })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.35f, 0.9f) })
-		.set<Position>({})
-		.set<Origin>({ menuPlayOrigin })
-		.set<Scale>({ 0.5f });
-
-	uiWorldAsync.entity("MenuCredits")
-		.add<MainMenu>()
-		.set<Text>({ L"Credits\n  [C]" })
-		.set<TextColor>({ DirectX::Colors::Azure })
-		.add<Right>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.35f, 0.9f) })
-		.set<Position>({})
-		.set<Origin>({ menuCreditsOrigin })
-		.set<Scale>({ 0.5f });
-
-	/*uiWorldAsync.entity("MenuHS")
-		.add<MainMenu>()
-		.set<Text>({ L"High Scores\n    [Tab]" })
-		.set<TextColor>({ DirectX::Colors::Azure })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.9f) })
-		.set<Position>({})
-		.set<Origin>({ menuHSOrigin })
-		.set<Scale>({ 0.5f });	*/
-
-	/*uiWorldAsync.entity("MenuEsc")
-		.add<MainMenu>()
-		.set<Text>({ L" Exit\n[Esc]" })
-		.set<TextColor>({ DirectX::Colors::Azure })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.05f, 0.05f) })
-		.set<Position>({})
-		.set<Origin>({ menuExitOrigin })
-		.set<Scale>({ 0.5f });*/
-
-	uiWorldAsync.entity("Score")
-		.add<PlayGame>()
-		.set<Text>({ L"0" })
-		.set<TextColor>({DirectX::Colors::White})
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 6.0f, 1 / 12.0f) })
-		.set<Position>({})
-		.set<Origin>({scoreOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("Lives")
-		.add<PlayGame>()
-		.set<Sprite>({ spaceshipView, })
-		.set<SpriteCount>({ readCfg->at("PlayerPrefab_1").at("lives").as<unsigned int>() })
-		.set<SpriteOffsets>({ DirectX::SimpleMath::Vector2(30.0f, 0.0f) })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 30.0f, 1 / 34.0f) })
-		.set<Position>({})
-		.set<Origin>({ shipSpriteOrigin })
-		.set<Scale>({ 0.06f });
-
-	uiWorldAsync.entity("SmartBombs")
-		.add<PlayGame>()
-		.set<Sprite>({ bombSpriteView, })
-		.set<SpriteCount>({ 0 })
-		.set<SpriteOffsets>({ DirectX::SimpleMath::Vector2(0.0f, 25.0f) })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 4.5f, 1 / 36.0f) })
-		.set<Position>({})
-		.set<Origin>({ bombSpriteOrigin })
-		.set<Scale>({ 0.06f });
-
-	uiWorldAsync.entity("Waves")
-		.add<PlayGame>()
-		.set<Text>({ L"Wave " })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Right>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 4.5f, 1 / 18.0f) })
-		.set<Position>({})
-		.set<Origin>({ wavesOrigin })
-		.set<Scale>({ 0.9f });
-
-	uiWorldAsync.entity("WaveNumber")
-		.add<PlayGame>()
-		.set<Text>({ L"1" })
-		.set<TextColor>({ DirectX::Colors::Red })
-		.add<Right>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 9.0f, 1 / 18.0f) })
-		.set<Position>({})
-		.set<Origin>({ wavesOrigin })
-		.set<Scale>({ 0.9f });
-
-	uiWorldAsync.entity("Pause")
-		.add<PauseGame>()
-		.set<Text>({ L"Pause" })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Center>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 1.0f) })
-		.set<Position>({})
-		.set<Origin>({ pauseOrigin })
-		.set<Scale>({ 1.5f });
-
-	uiWorldAsync.entity("ExitGame")
-		.add<PauseGame>()
-		.set<Text>({ L" Exit\n[Esc]" })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
-		.set<Position>({})
-		.set<Origin>({ pauseOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("ResumeGame")
-		.add<PauseGame>()
-		.set<Text>({ L"Resume\n[Enter]" })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Right>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
-		.set<Position>({})
-		.set<Origin>({ pauseOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("GameOver")
-		.add<GameOverScreen>()
-		.set<Sprite>({ gameOverView })
-		.set<SpriteCount>({ 1 })
-		.add<Center>()
-		.set<Position>({})
-		.set<Origin>({ gameOverOrigin })
-		.set<Scale>({ 0.3f });
-
-	uiWorldAsync.entity("QuitGame")
-		.add<GameOverScreen>()
-		.set<Text>({ L"Quit\n[Esc]" })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Left>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
-		.set<Position>({})
-		.set<Origin>({ pauseOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("RetryGame")
-		.add<GameOverScreen>()
-		.set<Text>({ L"Retry\n[Enter]" })
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Right>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
-		.set<Position>({})
-		.set<Origin>({ pauseOrigin })
-		.set<Scale>({ 0.7f });
-
-	uiWorldAsync.entity("Credits")
-		.add<Credits>()
-		.set<Text>({ credits.text.c_str()})
-		.set<TextColor>({ DirectX::Colors::White })
-		.add<Center>()
-		.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 1.0f) })
-		.set<Position>({})
-		.set<Origin>({ creditsOrigin })
-		.set<Scale>({ 0.325f });
-
-	uiWorldAsync.merge();
-	uiWorldLock.UnlockSyncWrite();
+	uiCommands.Record([&](flecs::world& _commands)
+		{
+			_commands.entity("TeamLogo")
+				.add<LogoScreen>()
+				.set<Sprite>({ teamLogoView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ teamLogoOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("DirectSplash")
+				.add<DirectXScreen>()
+				.set<Sprite>({ directSplashView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ directSplashOrigin })
+				.set<Scale>({ 2.0f });
+
+			_commands.entity("GateSplash")
+				.add<GatewareScreen>()
+				.set<Sprite>({ gateSplashView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ gateSplashOrigin })
+				.set<Scale>({ 0.75f });
+
+			_commands.entity("FlecsSplash")
+				.add<FlecsScreen>()
+				.set<Sprite>({ flecsSplashView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ flecsSplashOrigin })
+				.set<Scale>({ 0.82f });
+
+			_commands.entity("Title")
+				.add<TitleScreen>()
+				.set<Sprite>({ titleView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ titleSpriteOrigin })
+				.set<Scale>({ 0.8f });
+
+			_commands.entity("MainMenu")
+				.add<MainMenu>()
+				.set<Sprite>({ mainMenuView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ mainMenuSpriteOrigin })
+				.set<Scale>({ 1.5f });
+
+			_commands.entity("MenuTitle")
+				.add<MainMenu>()
+				.set<Text>({ L"GALLEONS\n OF THE \n GALAXY" })
+				.set<TextColor>({ DirectX::Colors::Azure })
+				.add<Top>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 0.5f) })
+				.set<Position>({})
+				.set<Origin>({ menuTitleOrigin })
+				.set<Scale>({ 2.0f });
+
+			_commands.entity("MenuPlay")
+				.add<MainMenu>()
+				.set<Text>({ L" Play\n[Enter]" })
+				.set<TextColor>({ DirectX::Colors::Azure })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.35f, 0.9f) })
+				.set<Position>({})
+				.set<Origin>({ menuPlayOrigin })
+				.set<Scale>({ 0.5f });
+
+			_commands.entity("MenuCredits")
+				.add<MainMenu>()
+				.set<Text>({ L"Credits\n  [C]" })
+				.set<TextColor>({ DirectX::Colors::Azure })
+				.add<Right>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.35f, 0.9f) })
+				.set<Position>({})
+				.set<Origin>({ menuCreditsOrigin })
+				.set<Scale>({ 0.5f });
+
+			/*_commands.entity("MenuHS")
+				.add<MainMenu>()
+				.set<Text>({ L"High Scores\n    [Tab]" })
+				.set<TextColor>({ DirectX::Colors::Azure })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.9f) })
+				.set<Position>({})
+				.set<Origin>({ menuHSOrigin })
+				.set<Scale>({ 0.5f });	*/
+
+			/*_commands.entity("MenuEsc")
+				.add<MainMenu>()
+				.set<Text>({ L" Exit\n[Esc]" })
+				.set<TextColor>({ DirectX::Colors::Azure })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.05f, 0.05f) })
+				.set<Position>({})
+				.set<Origin>({ menuExitOrigin })
+				.set<Scale>({ 0.5f });*/
+
+			_commands.entity("Score")
+				.add<PlayGame>()
+				.set<Text>({ L"0" })
+				.set<TextColor>({DirectX::Colors::White})
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 6.0f, 1 / 12.0f) })
+				.set<Position>({})
+				.set<Origin>({scoreOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("Lives")
+				.add<PlayGame>()
+				.set<Sprite>({ spaceshipView, })
+				.set<SpriteCount>({ readCfg->at("PlayerPrefab_1").at("lives").as<unsigned int>() })
+				.set<SpriteOffsets>({ DirectX::SimpleMath::Vector2(30.0f, 0.0f) })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 30.0f, 1 / 34.0f) })
+				.set<Position>({})
+				.set<Origin>({ shipSpriteOrigin })
+				.set<Scale>({ 0.06f });
+
+			_commands.entity("SmartBombs")
+				.add<PlayGame>()
+				.set<Sprite>({ bombSpriteView, })
+				.set<SpriteCount>({ 0 })
+				.set<SpriteOffsets>({ DirectX::SimpleMath::Vector2(0.0f, 25.0f) })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 4.5f, 1 / 36.0f) })
+				.set<Position>({})
+				.set<Origin>({ bombSpriteOrigin })
+				.set<Scale>({ 0.06f });
+
+			_commands.entity("Waves")
+				.add<PlayGame>()
+				.set<Text>({ L"Wave " })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Right>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 4.5f, 1 / 18.0f) })
+				.set<Position>({})
+				.set<Origin>({ wavesOrigin })
+				.set<Scale>({ 0.9f });
+
+			_commands.entity("WaveNumber")
+				.add<PlayGame>()
+				.set<Text>({ L"1" })
+				.set<TextColor>({ DirectX::Colors::Red })
+				.add<Right>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1 / 9.0f, 1 / 18.0f) })
+				.set<Position>({})
+				.set<Origin>({ wavesOrigin })
+				.set<Scale>({ 0.9f });
+
+			_commands.entity("Pause")
+				.add<PauseGame>()
+				.set<Text>({ L"Pause" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Center>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 1.0f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 1.5f });
+
+			_commands.entity("ExitGame")
+				.add<PauseGame>()
+				.set<Text>({ L" Exit\n[Esc]" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("ResumeGame")
+				.add<PauseGame>()
+				.set<Text>({ L"Resume\n[Enter]" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Right>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("GameOver")
+				.add<GameOverScreen>()
+				.set<Sprite>({ gameOverView })
+				.set<SpriteCount>({ 1 })
+				.add<Center>()
+				.set<Position>({})
+				.set<Origin>({ gameOverOrigin })
+				.set<Scale>({ 0.3f });
+
+			_commands.entity("QuitGame")
+				.add<GameOverScreen>()
+				.set<Text>({ L"Quit\n[Esc]" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("RetryGame")
+				.add<GameOverScreen>()
+				.set<Text>({ L"Retry\n[Enter]" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Right>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.3f, 0.8f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("ContinueGame")
+				.add<GameOverScreen>()
+				.set<Text>({ L"Continue\n[C]" })
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Left>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(0.5f, 0.8f) })
+				.set<Position>({})
+				.set<Origin>({ pauseOrigin })
+				.set<Scale>({ 0.7f });
+
+			_commands.entity("Credits")
+				.add<Credits>()
+				.set<Text>({ credits.text.c_str()})
+				.set<TextColor>({ DirectX::Colors::White })
+				.add<Center>()
+				.set<ResizeOffset>({ DirectX::SimpleMath::Vector2(1.0f, 1.0f) })
+				.set<Position>({})
+				.set<Origin>({ creditsOrigin })
+				.set<Scale>({ 0.325f });
+		});
+	// the queries and first UI update below need these entities right away
+	uiCommands.Merge();
 
 	//Queries
 	leftResizeQuery = uiWorld->query<const Left, const ResizeOffset, Position, Scale>();
@@ -1355,14 +1284,15 @@ bool GOG::DirectX11Renderer::SetupPipeline()
 		lightView.Get(),
 		levelView.Get(),
 		shipsView.Get(),
-		bombView.Get()
+		bombView.Get(),
+		lightBinView.Get()
 	};
 	ID3D11SamplerState* psSamples[]{ texSampler.Get() };
 
 	handles.context->VSSetConstantBuffers(startSlot, numBuffers, cBuffs);
 	handles.context->PSSetConstantBuffers(startSlot, numBuffers, cBuffs);
 	handles.context->VSSetShaderResources(0, 1, vsViews);
-	handles.context->PSSetShaderResources(1, 4, psViews);
+	handles.context->PSSetShaderResources(1, ARRAYSIZE(psViews), psViews);
 	handles.context->PSSetSamplers(0, 1, psSamples);
 	handles.context->IASetInputLayout(vertexFormat.Get());
 	handles.context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -1375,6 +1305,180 @@ bool GOG::DirectX11Renderer::SetupPipeline()
 	return true;
 }
 
+void GOG::DirectX11Renderer::SetupRenderBackend()
+{
+	const D3D11ConstantFallback sceneFallback{ cSceneBuffer.Get(), sizeof(SceneData) };
+	const D3D11ConstantFallback instanceFallback{ cInstanceBuffer.Get(), sizeof(PerInstanceData) };
+	const D3D11ConstantFallback levelMeshFallback{ cMeshBuffer.Get(), sizeof(MeshData) };
+	const D3D11ConstantFallback actorMeshFallback{ cActorMeshBuffer.Get(), sizeof(MeshData) };
+
+	D3D11Pipeline minimapModels{};
+	minimapModels.vertexShader = vertexShader.Get();
+	minimapModels.pixelShader = mapModelsPixelShader.Get();
+	minimapModels.vertexBuffer = actorVertexBuffer.Get();
+	minimapModels.vertexStride = sizeof(H2B::Vertex);
+	minimapModels.indexBuffer = actorIndexBuffer.Get();
+	minimapModels.vertexView = actorTransformView.Get();
+	minimapModels.target = targetViewMap.Get();
+	minimapModels.depthStencil = mapDepthStencil.Get();
+	minimapModels.viewport = mapViewPort;
+	// the vertex shader keeps the actor mesh, the pixel shader's b0 is the category tint
+	minimapModels.vertexFallbacks[CONSTANTS_MESH] = actorMeshFallback;
+	minimapModels.pixelFallbacks[CONSTANTS_MESH] = { cMapModelBuffer.Get(), sizeof(MapModelTex) };
+
+	D3D11Pipeline level{};
+	level.vertexShader = levelVertexShader.Get();
+	level.pixelShader = pixelShader.Get();
+	level.vertexBuffer = vertexBuffer.Get();
+	level.vertexStride = sizeof(H2B::Vertex);
+	level.indexBuffer = indexBuffer.Get();
+	level.vertexView = transformView.Get();
+	level.pixelViews[0] = lightView.Get();
+	level.pixelViews[1] = levelView.Get();
+	level.pixelViews[2] = shipsView.Get();
+	level.pixelViews[3] = bombView.Get();
+	level.pixelViews[4] = lightBinView.Get();
+	level.pixelViewCount = 5;
+	// the minimap models were drawn with their own depth
+	level.clearDepth = true;
+	level.vertexFallbacks[CONSTANTS_MESH] = level.pixelFallbacks[CONSTANTS_MESH] = levelMeshFallback;
+
+	D3D11Pipeline actors{};
+	actors.vertexShader = vertexShader.Get();
+	actors.pixelShader = pixelShader.Get();
+	actors.vertexBuffer = actorVertexBuffer.Get();
+	actors.vertexStride = sizeof(H2B::Vertex);
+	actors.indexBuffer = actorIndexBuffer.Get();
+	actors.vertexView = actorTransformView.Get();
+	// the same lights and textures as the level, a deferred pass doesn't inherit them
+	std::copy(level.pixelViews, level.pixelViews + level.pixelViewCount, actors.pixelViews);
+	actors.pixelViewCount = level.pixelViewCount;
+	actors.vertexFallbacks[CONSTANTS_MESH] = actors.pixelFallbacks[CONSTANTS_MESH] = actorMeshFallback;
+
+	for (D3D11Pipeline* pipeline : { &minimapModels, &level, &actors })
+	{
+		pipeline->inputLayout = vertexFormat.Get();
+		pipeline->rasterizerState = cullModeState.Get();
+		pipeline->sampler = texSampler.Get();
+		pipeline->vertexFallbacks[CONSTANTS_SCENE] = pipeline->pixelFallbacks[CONSTANTS_SCENE] = sceneFallback;
+		pipeline->vertexFallbacks[CONSTANTS_INSTANCE] = pipeline->pixelFallbacks[CONSTANTS_INSTANCE] = instanceFallback;
+	}
+	for (D3D11RenderBackend& backend : passBackends)
+	{
+		backend.SetPipelineState(PIPELINE_MINIMAP_MODELS, minimapModels);
+		backend.SetPipelineState(PIPELINE_LEVEL, level);
+		backend.SetPipelineState(PIPELINE_ACTORS, actors);
+	}
+}
+
+void GOG::DirectX11Renderer::CreateActorTransformBuffer(ID3D11Device* _device, unsigned int _capacity)
+{
+	D3D11_BUFFER_DESC sbActorTransformDesc{};
+	sbActorTransformDesc.ByteWidth = sizeof(TransformData) * _capacity;
+	sbActorTransformDesc.Usage = D3D11_USAGE_DYNAMIC;
+	sbActorTransformDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	sbActorTransformDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	sbActorTransformDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	sbActorTransformDesc.StructureByteStride = sizeof(TransformData);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC actorTransViewDesc{};
+	actorTransViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	actorTransViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+	actorTransViewDesc.BufferEx.FirstElement = 0;
+	actorTransViewDesc.BufferEx.NumElements = _capacity;
+
+	actorTransformView.Reset();
+	sActorTransformBuffer.Reset();
+	_device->CreateBuffer(&sbActorTransformDesc, nullptr, sActorTransformBuffer.GetAddressOf());
+	_device->CreateShaderResourceView(sActorTransformBuffer.Get(), &actorTransViewDesc, actorTransformView.GetAddressOf());
+	actorTransformCapacity = _capacity;
+
+	for (D3D11RenderBackend& backend : passBackends)
+		backend.SetActorTransformBuffer(sActorTransformBuffer.Get());
+}
+
+void GOG::DirectX11Renderer::FitActorInstanceCapacity()
+{
+	unsigned int capacity = actorInstances.Capacity();
+	if (queuedTransforms.size() < capacity)
+	{
+		actorQueue.Reserve(capacity);
+		queuedTransforms.resize(capacity);
+		queuedMapTransforms.resize(capacity);
+	}
+	if (actorTransformCapacity >= capacity)
+		return;
+
+	ID3D11Device* device{};
+	d3d.GetDevice((void**)&device);
+	CreateActorTransformBuffer(device, capacity);
+	device->Release();
+	// the pipelines point at the old view
+	SetupRenderBackend();
+	PrintLabeledDebugString("Renderer: ", ("actor transform buffer grew to " + std::to_string(capacity) + " instances").c_str());
+}
+
+void GOG::DirectX11Renderer::CreateLightBinBuffer(ID3D11Device* _device, size_t _capacity)
+{
+	D3D11_BUFFER_DESC sbLightBinDesc{};
+	sbLightBinDesc.ByteWidth = static_cast<UINT>(sizeof(unsigned int) * _capacity);
+	sbLightBinDesc.Usage = D3D11_USAGE_DYNAMIC;
+	sbLightBinDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	sbLightBinDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	sbLightBinDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	sbLightBinDesc.StructureByteStride = sizeof(unsigned int);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC lightBinViewDesc{};
+	lightBinViewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	lightBinViewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+	lightBinViewDesc.BufferEx.FirstElement = 0;
+	lightBinViewDesc.BufferEx.NumElements = static_cast<UINT>(_capacity);
+
+	lightBinView.Reset();
+	sLightBinBuffer.Reset();
+	_device->CreateBuffer(&sbLightBinDesc, nullptr, sLightBinBuffer.GetAddressOf());
+	_device->CreateShaderResourceView(sLightBinBuffer.Get(), &lightBinViewDesc, lightBinView.GetAddressOf());
+	lightBinCapacity = _capacity;
+
+	for (D3D11RenderBackend& backend : passBackends)
+		backend.SetLightBinBuffer(sLightBinBuffer.Get());
+}
+
+void GOG::DirectX11Renderer::FitLightBinCapacity()
+{
+	size_t needed = lightBins.Bytes() / sizeof(unsigned int);
+	if (lightBinCapacity >= needed)
+		return;
+
+	ID3D11Device* device{};
+	d3d.GetDevice((void**)&device);
+	CreateLightBinBuffer(device, std::max(needed, lightBinCapacity * 2));
+	device->Release();
+	// the pipelines point at the old view
+	SetupRenderBackend();
+	PrintLabeledDebugString("Renderer: ", ("light bin buffer grew to " + std::to_string(lightBinCapacity) + " indices").c_str());
+}
+
+void GOG::DirectX11Renderer::CreatePassContexts(ID3D11Device* _device)
+{
+	for (unsigned int pass = 0; passThreads > 0 && pass < PIPELINE_COUNT; pass++)
+	{
+		// a single threaded device has no deferred contexts
+		if (FAILED(_device->CreateDeferredContext(0, passContexts[pass].GetAddressOf())))
+		{
+			PrintLabeledDebugString("Renderer: ", "no deferred contexts, passes are recorded serially");
+			passThreads = 0;
+		}
+	}
+	if (passThreads == 0)
+	{
+		for (auto& context : passContexts)
+			context.Reset();
+	}
+	// the render thread records a pass too
+	passWorkers.Start(std::min(passThreads, PIPELINE_COUNT - 1u));
+}
+
 #pragma endregion
 
 #pragma endregion
@@ -1387,6 +1491,7 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 	startDraw = flecsWorld->system<RenderingSystem>().kind(flecs::PreUpdate)
 		.each([this](flecs::entity e, RenderingSystem& s) 
 		{
+			PROFILE_SYSTEM("startDraw");
 			GOG::PipelineHandles handles{};
 			d3d.GetImmediateContext((void**)&handles.context);
 			d3d.GetRenderTargetView((void**)&handles.targetView);
@@ -1394,7 +1499,8 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 
 			handles.context->ClearRenderTargetView(handles.targetView, &bgColor.x);
 			handles.context->ClearDepthStencilView(handles.depthStencil, D3D11_CLEAR_DEPTH, 1, 0);
-			drawCounter = 0;
+			actorInstances.Reset();
+			renderCounters = {};
 
 			handles.context->Release();
 			handles.targetView->Release();
@@ -1402,28 +1508,36 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 		});
 
 
-	updateDraw = flecsWorld->system<GOG::Transform, GOG::ModelIndex>().kind(flecs::OnUpdate)
-		.each([this](GOG::Transform& pos, GOG::ModelIndex& ndx) 
+	// after the transform sync in OnValidate, declared ahead of completeDraw so it gathers first
+	updateDraw = flecsWorld->system<GOG::WorldMatrix, GOG::ModelIndex>().kind(flecs::PostUpdate)
+		.each([this](GOG::WorldMatrix& pos, GOG::ModelIndex& ndx) 
 		{
-			int i = drawCounter;
-
-			instanceTransforms.transforms[i] = pos.value;
-			instanceTransforms.modelNdxs[i] = ndx.id;
-
-			// increment the shared draw counter but don't go over (branchless) 
-			int v = static_cast<int>(instanceMax) - static_cast<int>(drawCounter + 2);
-			// if v < 0 then 0, else 1
-			int sign = 1 ^ ((unsigned int)v >> (sizeof(int) * CHAR_BIT - 1));
-			drawCounter += sign;
+			PROFILE_SYSTEM("updateDraw");
+			GW::MATH::GMATRIXF mapTransform;
+			GW::MATH::GMatrix::ScaleLocalF(pos.value, mapModelScalar, mapTransform);
+			// past actorInstancesMax the actor isn't drawn, completeDraw reports it
+			actorInstances.Add(pos.value, mapTransform, ndx.id);
+		});
 
-			scaledMapModels.modelNdxs[i] = ndx.id;
-			GW::MATH::GMatrix::ScaleLocalF(pos.value, mapModelScalar, scaledMapModels.transforms[i]);
+	// gameplay moves the camera entity, pick it up after it moved and before anything is drawn
+	followCamera = flecsWorld->system<GOG::Camera, GOG::Transform>().kind(flecs::OnValidate)
+		.each([this](GOG::Camera, GOG::Transform& _transform)
+		{
+			PROFILE_SYSTEM("followCamera");
+			UpdateCamera(_transform.value);
 		});
 
 
 	completeDraw = flecsWorld->system<RenderingSystem>().kind(flecs::PostUpdate)
 		.each([this](flecs::entity e, RenderingSystem& s) 
 		{
+			PROFILE_SYSTEM("completeDraw");
+			FitActorInstanceCapacity();
+			const ActorInstanceStats& instanceStats = actorInstances.GetStats();
+			renderCounters.transformsUsed = actorInstances.Count();
+			renderCounters.transformCapacity = instanceStats.capacity;
+			renderCounters.transformGrowths = instanceStats.growths;
+			renderCounters.transformOverflows = instanceStats.overflows;
 			//Grab Pipeline Resources
 			GOG::PipelineHandles handles{};
 			d3d.GetImmediateContext((void**)&handles.context);
@@ -1439,30 +1553,8 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 			const UINT strides[]{ sizeof(H2B::Vertex) };
 			const UINT offsets[]{ 0 };
 
-			D3D11_MAPPED_SUBRESOURCE sceneSubRes{};
-			D3D11_MAPPED_SUBRESOURCE instanceSubRes{};
-			D3D11_MAPPED_SUBRESOURCE meshSubRes{};
-			D3D11_MAPPED_SUBRESOURCE actorTransSubRes{};
-			D3D11_MAPPED_SUBRESOURCE actMeshSubRes{};
-			D3D11_MAPPED_SUBRESOURCE instSubRes{};
-			D3D11_MAPPED_SUBRESOURCE mapModelSubRes{};
-
-			ID3D11Buffer* const levelVerts[]{ vertexBuffer.Get() };
-			ID3D11Buffer* const actorVerts[]{ actorVertexBuffer.Get() };
 			ID3D11Buffer* const mapVerts[] = { mapVertexBuffer.Get() };
-			ID3D11Buffer* const cLevelBuffs[]{ cMeshBuffer.Get(), cSceneBuffer.Get(), cInstanceBuffer.Get() };
-			ID3D11Buffer* const cActorBuffs[]{ cActorMeshBuffer.Get(), cSceneBuffer.Get() };
-			ID3D11Buffer* const cMapModelBuffs[]{ cMapModelBuffer.Get() };
 
-			ID3D11ShaderResourceView* vsLevelViews[]{ transformView.Get() };
-			ID3D11ShaderResourceView* vsActorViews[]{ actorTransformView.Get() };
-			ID3D11ShaderResourceView* psLevelViews[]
-			{
-					lightView.Get(),
-					levelView.Get(),
-					shipsView.Get(),
-					bombView.Get()
-			};
 			ID3D11ShaderResourceView* psMapViews[]{ mapView.Get() };
 			ID3D11RenderTargetView* const targetViews[] = { handles.targetView };
 			D3D11_VIEWPORT prevViewport;
@@ -1484,234 +1576,140 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 				ID3D11RasterizerState* prevRasterState;
 				handles.context->RSGetState(&prevRasterState);
 
-				handles.context->OMSetRenderTargets(1, targetViewMap.GetAddressOf(), mapDepthStencil.Get());
-				handles.context->RSSetViewports(1, &mapViewPort);
 				handles.context->ClearRenderTargetView(targetViewMap.Get(), mapColor);
 				handles.context->ClearDepthStencilView(mapDepthStencil.Get(), D3D11_CLEAR_DEPTH, 1, 0);
 
-				handles.context->Map(cSceneBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &sceneSubRes);
-				sceneData.viewMatrix = mapViewMatrix;
-				sceneData.projectionMatrix = mapProjMatrix;
-				memcpy(sceneSubRes.pData, &sceneData, sizeof(sceneData));
-				handles.context->Unmap(cSceneBuffer.Get(), 0);
-
-				handles.context->Map(sActorTransformBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &actorTransSubRes);
-				memcpy(actorTransSubRes.pData, &scaledMapModels, sizeof(TransformData) * instanceMax);
-				handles.context->Unmap(sActorTransformBuffer.Get(), 0);
-
-				handles.context->PSSetShader(mapModelsPixelShader.Get(), nullptr, 0);
-				handles.context->IASetVertexBuffers(0, ARRAYSIZE(actorVerts), actorVerts, strides, offsets);
-				handles.context->VSSetConstantBuffers(0, 2, cActorBuffs);
-				handles.context->PSSetConstantBuffers(0, 1, cMapModelBuffs);
-				handles.context->VSSetShaderResources(0, 1, vsActorViews);
-				handles.context->IASetIndexBuffer(actorIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-				bool isPlayer = false;
-				std::string player = "Player";
-				std::string enemy = "Enemy";
-				std::string projectile = "Projectile";
-				std::string pickup = "Pickup";
-
-				for (int i = 0; i < drawCounter; i++)
-				{
-					auto& model = actorData->models[instanceTransforms.modelNdxs[i]];
-
-					std::string recieved = model.fileName;
-					size_t foundPlayer = recieved.find(player);
-					size_t foundEnemy = recieved.find(enemy);
-					size_t foundProjectile = recieved.find(projectile);
-					size_t foundPickup = recieved.find(pickup);
-
-					if (foundPlayer != std::string::npos)
-					{
-						mapModelData.modelType = 0;
-					}
-					else if (foundEnemy != std::string::npos)
-					{
-						mapModelData.modelType = 1;
-					}
-					else if (foundProjectile != std::string::npos)
-					{
-						mapModelData.modelType = 2;
-					}
-					else if (foundPickup != std::string::npos)
-					{
-						mapModelData.modelType = 3;
-					}
-					else
-					{
-						continue;
-					}
-
-					handles.context->Map(cMapModelBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapModelSubRes);
-					memcpy(mapModelSubRes.pData, &mapModelData, sizeof(mapModelData));
-					handles.context->Unmap(cMapModelBuffer.Get(), 0);
-
-					handles.context->Map(cInstanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instSubRes);
-					instanceData.transformStart = i;
-					memcpy(instSubRes.pData, &instanceData, sizeof(PerInstanceData));
-					handles.context->Unmap(cInstanceBuffer.Get(), 0);
-
-					for (int msh = 0; msh < model.meshCount; msh++)
-					{
-						auto& material = actorData->materials[msh + model.materialStart];
-						actorMeshData.attribute = material.attrib;
-						auto& mesh = actorData->meshes[msh + model.meshStart];
-
-						handles.context->DrawIndexedInstanced(mesh.drawInfo.indexCount, 1, mesh.drawInfo.indexOffset + model.indexStart, model.vertexStart, 0);
-					}
-				}
-
-				handles.context->Map(sActorTransformBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &actorTransSubRes);
-				memcpy(actorTransSubRes.pData, &instanceTransforms, sizeof(TransformData) * instanceMax);
-				handles.context->Unmap(sActorTransformBuffer.Get(), 0);
-
-				handles.context->RSSetViewports(numViews, &prevViewport);
-				handles.context->OMSetRenderTargets(1, targetViews, handles.depthStencil);
-				handles.context->VSSetShader(levelVertexShader.Get(), nullptr, 0);
-				handles.context->PSSetShader(pixelShader.Get(), nullptr, 0);
-				handles.context->IASetVertexBuffers(0, ARRAYSIZE(levelVerts), levelVerts, strides, offsets);
-				handles.context->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-				handles.context->VSSetConstantBuffers(0, 3, cLevelBuffs);
-				handles.context->PSSetConstantBuffers(0, 3, cLevelBuffs);
-				handles.context->VSSetShaderResources(0, 1, vsLevelViews);
-				handles.context->PSSetShaderResources(1, 4, psLevelViews);
-
-				handles.context->ClearDepthStencilView(handles.depthStencil, D3D11_CLEAR_DEPTH, 1, 0);
-
-				handles.context->Map(cSceneBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &sceneSubRes);
-
-				sceneData = currentLevelSceneData;
-				sceneData.viewMatrix = viewMatrix;
-				sceneData.projectionMatrix = projectionMatrix;
-				sceneData.camPos = cameraMatrix.row4;
-
-				memcpy(sceneSubRes.pData, &sceneData, sizeof(sceneData));
-				handles.context->Unmap(cSceneBuffer.Get(), 0);
-
-
+				// both actor passes draw each model's instances together, from one contiguous range
+				actorQueue.Build(actorInstances.ModelNdxs(), actorInstances.Count());
+				actorQueue.Gather(actorInstances.Transforms(), queuedTransforms.data());
+				actorQueue.Gather(actorInstances.MapTransforms(), queuedMapTransforms.data());
+				renderCounters.actorBatches = static_cast<unsigned int>(actorQueue.Buckets().size());
+
+				// every constant a 3D pass needs is recorded up front and uploaded with one map
+				frameDraws.Reset();
+				SceneData mapScene = sceneData;
+				mapScene.viewMatrix = mapViewMatrix;
+				mapScene.projectionMatrix = mapProjMatrix;
+
+				SceneData levelScene = currentLevelSceneData;
+				levelScene.viewMatrix = viewMatrix;
+				levelScene.projectionMatrix = projectionMatrix;
+				levelScene.camPos = cameraMatrix.row4;
 				float levelSegmentOffset = (int)((cameraMatrix.row4.x + levelSegmentWidth / 2) / levelSegmentWidth);
+				GW::MATH::GMATRIXF viewProjection;
+				GW::MATH::GMatrix::MultiplyMatrixF(viewMatrix, projectionMatrix, viewProjection);
+				CullFrustum frustum = CullFrustumFromViewProjection(viewProjection.data);
 
-				for (int j = 0; j < 3; j++)
-				{
-					meshData.offset = (levelSegmentOffset + j - 1) * levelSegmentWidth;
-					handles.context->Map(cMeshBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &meshSubRes);
-
-					memcpy(meshSubRes.pData, &meshData, sizeof(meshData));
-					handles.context->Unmap(cMeshBuffer.Get(), 0);
-
-					for (auto& i : levelData->levelInstances)
-					{
-						auto& model = levelData->levelModels[i.modelIndex];
-
-						handles.context->Map(cInstanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instanceSubRes);
-						instanceData.transformStart = i.transformStart;
-						memcpy(instanceSubRes.pData, &instanceData, sizeof(PerInstanceData));
-						handles.context->Unmap(cInstanceBuffer.Get(), 0);
-
-						for (int msh = 0; msh < model.meshCount; msh++)
-						{
-							handles.context->Map(cMeshBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &meshSubRes);
-
-							auto& material = levelData->materials[msh + model.materialStart];
-							meshData.attribute = material.attrib;
-							auto& mesh = levelData->levelMeshes[msh + model.meshStart];
-							std::string level = "Atlas_Space.dds";
-							std::string ships = "Atlas_Pirate.dds";
-							std::string bomb = "SmartBomb.dds";
-
-							if (material.mapKd != NULL)
-							{
-								std::string recieved = material.mapKd;
-								if (recieved.compare(level) == 0)
-								{
-									meshData.texID = 1;
-								}
-
-								if (recieved.compare(ships) == 0)
-								{
-									meshData.texID = 2;
-								}
-
-								if (recieved.compare(bomb) == 0)
-								{
-									meshData.texID = 3;
-								}
-
-							}
-
-							memcpy(meshSubRes.pData, &meshData, sizeof(meshData));
-							handles.context->Unmap(cMeshBuffer.Get(), 0);
-
-							handles.context->DrawIndexedInstanced(mesh.drawInfo.indexCount, i.transformCount, mesh.drawInfo.indexOffset + model.indexStart, model.vertexStart, 0);
-						}
-					}
-				}
-
-				meshData.offset = 0;
-				handles.context->Map(cMeshBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &meshSubRes);
-				memcpy(meshSubRes.pData, &meshData, sizeof(meshData));
-				handles.context->Unmap(cMeshBuffer.Get(), 0);
-
-				handles.context->Map(cSceneBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &sceneSubRes);
-				
 				sceneData = currentActorSceneData;
 				sceneData.viewMatrix = viewMatrix;
 				sceneData.projectionMatrix = projectionMatrix;
 				sceneData.camPos = cameraMatrix.row4;
 
-				memcpy(sceneSubRes.pData, &sceneData, sizeof(sceneData));
-				handles.context->Unmap(cSceneBuffer.Get(), 0);
-
-				handles.context->VSSetShader(vertexShader.Get(), nullptr, 0);
-				handles.context->IASetVertexBuffers(0, ARRAYSIZE(actorVerts), actorVerts, strides, offsets);
-				handles.context->VSSetConstantBuffers(0, 2, cActorBuffs);
-				handles.context->PSSetConstantBuffers(0, 2, cActorBuffs);
-				handles.context->VSSetShaderResources(0, 1, vsActorViews);
-				handles.context->IASetIndexBuffer(actorIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-				for (int i = 0; i < drawCounter; i++)
+				// the level and actor passes only shade with the lights binned to a pixel's tile
 				{
-					auto& model = actorData->models[instanceTransforms.modelNdxs[i]];
-
-					handles.context->Map(cInstanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instSubRes);
-					instanceData.transformStart = i;
-					memcpy(instSubRes.pData, &instanceData, sizeof(PerInstanceData));
-					handles.context->Unmap(cInstanceBuffer.Get(), 0);
-
-					for (int msh = 0; msh < model.meshCount; msh++)
+					PROFILE_ZONE("binLights");
+					auto binStart = std::chrono::steady_clock::now();
+					LightBinCamera lightCamera{};
+					std::copy(viewMatrix.data, viewMatrix.data + 16, lightCamera.view);
+					lightCamera.scaleX = projectionMatrix.data[0];
+					lightCamera.scaleY = projectionMatrix.data[5];
+					lightCamera.nearZ = nearPlane;
+					lightCamera.width = prevViewport.Width;
+					lightCamera.height = prevViewport.Height;
+					lightBins.Bin(lightCamera);
+					FitLightBinCapacity();
+					frameDraws.lightBins = lightBins.Data();
+					frameDraws.lightBinBytes = lightBins.Bytes();
+					for (SceneData* scene : { &levelScene, &sceneData })
 					{
-						handles.context->Map(cActorMeshBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &actMeshSubRes);
-						auto& material = actorData->materials[msh + model.materialStart];
-						actorMeshData.attribute = material.attrib;
-						auto& mesh = actorData->meshes[msh + model.meshStart];
-						std::string level = "Atlas_Space.dds";
-						std::string ships = "Atlas_Pirate.dds";
-						std::string bomb = "SmartBomb.dds";
+						scene->lightTileSize = lightBins.TileSize();
+						scene->lightTilesX = lightBins.TilesX();
+						scene->lightTilesY = lightBins.TilesY();
+					}
 
+					const LightBinStats& binStats = lightBins.GetStats();
+					renderCounters.lightsVisible = binStats.visible;
+					renderCounters.lightsTotal = binStats.lights;
+					renderCounters.lightBinIndices = binStats.indices;
+					renderCounters.lightsPerTileMax = binStats.maxPerTile;
+					renderCounters.lightBinMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - binStart).count();
+				}
 
-						if (material.mapKd != NULL)
+				// the passes only share what is read here, each records its own draws and its own
+				// command list, on whichever thread picks it up
+				float passMs[PIPELINE_COUNT]{};
+				auto recordPass = [&](unsigned int _pass)
+					{
+						auto passStart = std::chrono::steady_clock::now();
+						RENDER_PIPELINE pipeline = static_cast<RENDER_PIPELINE>(_pass);
+						switch (pipeline)
 						{
-							std::string recieved = material.mapKd;
-							if (recieved.compare(level) == 0)
-							{
-								actorMeshData.texID = 1;
-							}
-							else if (recieved.compare(ships) == 0)
-							{
-								actorMeshData.texID = 2;
-							}
-							else if (recieved.compare(bomb) == 0)
-							{
-								actorMeshData.texID = 3;
-							}
+						case PIPELINE_MINIMAP_MODELS:
+						{
+							PROFILE_ZONE("recordMinimapPass");
+							RecordMinimapDraws(frameDraws, *actorData, actorQueue, mapScene, actorMeshData);
+							break;
+						}
+						case PIPELINE_LEVEL:
+						{
+							PROFILE_ZONE("recordLevelPass");
+							RecordLevelDraws(frameDraws, levelStream, levelData->instanceBvh, frustum,
+								(levelSegmentOffset - 1) * levelSegmentWidth, levelSegmentWidth, levelScene, levelRanges.data());
+							break;
+						}
+						default:
+						{
+							PROFILE_ZONE("recordActorPass");
+							RecordActorDraws(frameDraws, *actorData, actorQueue, sceneData, actorMeshData);
+							break;
+						}
 						}
 
-						memcpy(actMeshSubRes.pData, &actorMeshData, sizeof(actorMeshData));
-						handles.context->Unmap(cActorMeshBuffer.Get(), 0);
-
-						handles.context->DrawIndexedInstanced(mesh.drawInfo.indexCount, 1, mesh.drawInfo.indexOffset + model.indexStart, model.vertexStart, 0);
+						PROFILE_ZONE("submitPass");
+						ID3D11DeviceContext* passContext = passContexts[pipeline] ? passContexts[pipeline].Get() : handles.context;
+						passBackends[pipeline].BeginFrame(passContext, handles.targetView, handles.depthStencil, prevViewport);
+						SubmitPassDraws(passBackends[pipeline], frameDraws, pipeline,
+							PassTransforms(pipeline, queuedMapTransforms.data(), queuedTransforms.data()), sizeof(TransformData) * actorQueue.InstanceCount());
+						if (passContexts[pipeline])
+							passContexts[pipeline]->FinishCommandList(FALSE, passLists[pipeline].ReleaseAndGetAddressOf());
+						passMs[pipeline] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+					};
+				passWorkers.Run(PIPELINE_COUNT, recordPass);
+
+				// the lists always run in pipeline order, however the threads finished
+				auto executeStart = std::chrono::steady_clock::now();
+				for (unsigned int pass = 0; pass < PIPELINE_COUNT; pass++)
+				{
+					if (passLists[pass])
+					{
+						handles.context->ExecuteCommandList(passLists[pass].Get(), FALSE);
+						passLists[pass].Reset();
 					}
+					passBackends[pass].FlushCounters(renderCounters);
+				}
+				if (passThreads > 0)
+				{
+					// executing a list leaves the immediate context in its default state
+					Restore3DStates(handles);
+					handles.context->OMSetRenderTargets(1, targetViews, handles.depthStencil);
+					handles.context->RSSetViewports(numViews, &prevViewport);
+				}
+				renderCounters.passExecuteMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - executeStart).count();
+				renderCounters.minimapPassMs = passMs[PIPELINE_MINIMAP_MODELS];
+				renderCounters.levelPassMs = passMs[PIPELINE_LEVEL];
+				renderCounters.actorPassMs = passMs[PIPELINE_ACTORS];
+
+				renderCounters.levelInstancesDrawn = frameDraws.levelInstancesDrawn;
+				renderCounters.levelInstancesTotal = 3 * levelData->instanceBvh.InstanceCount();
+				renderCounters.uploadBytes = 0;
+				renderCounters.uploadCapacity = 0;
+				renderCounters.uploadRecords = 0;
+				for (const PassDraws& pass : frameDraws.passes)
+				{
+					const UploadStats& uploadStats = pass.uploads.GetStats();
+					renderCounters.uploadBytes += static_cast<unsigned int>(uploadStats.usedBytes);
+					renderCounters.uploadCapacity += static_cast<unsigned int>(uploadStats.capacity);
+					renderCounters.uploadRecords += uploadStats.records;
 				}
 
 				handles.context->VSSetShader(mapVertexShader.Get(), nullptr, 0);
@@ -1721,6 +1719,7 @@ void GOG::DirectX11Renderer::InitRendererSystems()
 				handles.context->PSSetShaderResources(2, 1, psMapViews);
 				handles.context->RSSetState(cullModeState.Get());
 				handles.context->DrawIndexed(6, 0, 0);
+				renderCounters.drawCalls += 1;
 
 				handles.context->ClearRenderTargetView(targetViewMap.Get(), &bgColor.x);
 
@@ -2017,6 +2016,13 @@ void GOG::DirectX11Renderer::RenderGameUI()
 			});
 	}
 
+	if (perfHud.Visible())
+	{
+		const DirectX::SimpleMath::Vector2 hudPos = { 8.0f, 8.0f };
+		courierNew->DrawString(m_spriteBatch.get(), perfHud.Text().c_str(), hudPos + DirectX::SimpleMath::Vector2(1.0f, 1.0f), DirectX::Colors::Black, 0.0f, DirectX::SimpleMath::Vector2::Zero, 0.5f * uiScalar);
+		courierNew->DrawString(m_spriteBatch.get(), perfHud.Text().c_str(), hudPos, DirectX::Colors::Yellow, 0.0f, DirectX::SimpleMath::Vector2::Zero, 0.5f * uiScalar);
+	}
+
 	m_spriteBatch->End();
 
 	// Restore the previous state
@@ -2054,7 +2060,8 @@ void GOG::DirectX11Renderer::Restore3DStates(PipelineHandles& handles)
 			lightView.Get(),
 			levelView.Get(),
 			shipsView.Get(),
-			bombView.Get()
+			bombView.Get(),
+			lightBinView.Get()
 	};
 
 	ID3D11SamplerState* psSamples[]{ texSampler.Get() };
@@ -2069,7 +2076,7 @@ void GOG::DirectX11Renderer::Restore3DStates(PipelineHandles& handles)
 	handles.context->VSSetConstantBuffers(startSlot, numBuffers, cBuffs);
 	handles.context->PSSetConstantBuffers(startSlot, numBuffers, cBuffs);
 	handles.context->VSSetShaderResources(0, 1, vsViews);
-	handles.context->PSSetShaderResources(1, 4, psViews);
+	handles.context->PSSetShaderResources(1, ARRAYSIZE(psViews), psViews);
 
 }
 
@@ -2104,7 +2111,10 @@ bool GOG::DirectX11Renderer::Shutdown()
 	startDraw.destruct();
 	updateDraw.destruct();
 	completeDraw.destruct();
+	followCamera.destruct();
 	bombEffect = nullptr;
+	perfHud.Shutdown();
+	passWorkers.Stop();
 
 	leftResizeQuery.destruct();
 	rightResizeQuery.destruct();
@@ -2232,10 +2242,11 @@ void GOG::DirectX11Renderer::UpdateStats(unsigned int _lives, unsigned int _scor
 
 void GOG::DirectX11Renderer::UpdateLives(unsigned int _lives)
 {
-	uiWorldLock.LockSyncWrite();
-	uiWorldAsync.entity("Lives")
-		.set<SpriteCount>({ _lives });
-	uiWorldLock.UnlockSyncWrite();
+	uiCommands.Record([_lives](flecs::world& _commands)
+		{
+			_commands.entity("Lives")
+				.set<SpriteCount>({ _lives });
+		});
 }
 
 void GOG::DirectX11Renderer::UpdateScore(unsigned int _score)
@@ -2245,19 +2256,21 @@ void GOG::DirectX11Renderer::UpdateScore(unsigned int _score)
 
 	scoreOrigin.y /= 2;
 
-	uiWorldLock.LockSyncWrite();
-	uiWorldAsync.entity("Score")
-		.set<Text>({ newScore })
-		.set<Origin>({ scoreOrigin });
-	uiWorldLock.UnlockSyncWrite();
+	uiCommands.Record([&newScore, &scoreOrigin](flecs::world& _commands)
+		{
+			_commands.entity("Score")
+				.set<Text>({ newScore })
+				.set<Origin>({ scoreOrigin });
+		});
 }
 
 void GOG::DirectX11Renderer::UpdateSmartBombs(unsigned int _smartBombs)
 {
-	uiWorldLock.LockSyncWrite();
-	uiWorldAsync.entity("SmartBombs")
-		.set<SpriteCount>({ _smartBombs });
-	uiWorldLock.UnlockSyncWrite();
+	uiCommands.Record([_smartBombs](flecs::world& _commands)
+		{
+			_commands.entity("SmartBombs")
+				.set<SpriteCount>({ _smartBombs });
+		});
 }
 
 void GOG::DirectX11Renderer::UpdateWaves(unsigned int _waves)
@@ -2267,15 +2280,17 @@ void GOG::DirectX11Renderer::UpdateWaves(unsigned int _waves)
 	waveOrigin.x -= waveOrigin.x;
 	waveOrigin.y /= 2;
 
-	uiWorldLock.LockSyncWrite();
-	uiWorldAsync.entity("WaveNumber")
-		.set<Text>({ newWave })
-		.set<Origin>({ waveOrigin });
-	uiWorldLock.UnlockSyncWrite();
+	uiCommands.Record([&newWave, &waveOrigin](flecs::world& _commands)
+		{
+			_commands.entity("WaveNumber")
+				.set<Text>({ newWave })
+				.set<Origin>({ waveOrigin });
+		});
 }
 
 void GOG::DirectX11Renderer::UpdateMiniMap()
 {
+	PROFILE_ZONE("UpdateMiniMap");
 	mapViewMatrix = viewMatrix;
 }
 
@@ -1,12 +1,22 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
-#include <d3dcompiler.h> // required for compiling shaders on the fly, consider pre-compiling instead
+#include <d3dcompiler.h> // compiles shaders the shader cache doesn't have yet
 #pragma comment(lib, "d3dcompiler.lib")
 #include "../GameConfig.h"
 #include "../Events/Playevents.h"
+#include "../Events/EventBus.h"
 #include "../Utils/ActorData.h"
 #include "../Utils/LevelData.h"
+#include "../Utils/CommandBuffers.h"
+#include "../Utils/PerfHud.h"
+#include "../Utils/FrameDraws.h"
+#include "../Utils/LevelDrawStream.h"
+#include "../Utils/ActorInstances.h"
+#include "../Utils/LightBinning.h"
+#include "../Utils/ShaderCache.h"
+#include "../Utils/WorkerPool.h"
+#include "D3D11RenderBackend.h"
 #include <DDSTextureLoader.h>
 #include <SpriteFont.h>
 #include <SimpleMath.h>
@@ -20,12 +30,6 @@
 
 namespace GOG
 {
-	struct MapModelTex
-	{
-		unsigned int modelType;
-		unsigned int pad[3];
-	};
-
 	struct Quad
 	{
 		std::vector<H2B::Vertex> face;
@@ -54,38 +58,6 @@ namespace GOG
 		GW::MATH::GMATRIXF transform;
 	};
 
-	struct alignas(16) PerInstanceData
-	{
-		unsigned int transformStart;
-		unsigned int materialStart;
-		unsigned int pad[2];
-		
-	};
-
-	struct alignas(16) SceneData
-	{
-		GW::MATH::GMATRIXF viewMatrix;
-		GW::MATH::GMATRIXF projectionMatrix;
-		GW::MATH::GVECTORF camPos;
-		GW::MATH::GVECTORF dirLightDir, dirLightColor;
-		GW::MATH::GVECTORF ambientTerm;
-		GW::MATH::GVECTORF fogColor;
-		float fogDensity;
-		float fogStartDistance;
-		float contrast;
-		float saturation;
-	};
-
-	struct alignas(16) MeshData
-	{
-		GW::MATH::GMATRIXF worldMatrix;
-		H2B::Attributes attribute;
-		unsigned int texID;
-		float offset;
-		unsigned int padding[2];
-		
-	};
-
 	struct RenderingSystem {};
 
 	class DirectX11Renderer
@@ -97,15 +69,16 @@ namespace GOG
 		//---------- Flecs ----------
 		std::shared_ptr<flecs::world> flecsWorld;
 		std::shared_ptr<flecs::world> uiWorld;
-		flecs::world uiWorldAsync;
+		CommandBuffers uiCommands;
 
 		flecs::system startDraw;
 		flecs::system updateDraw;
 		flecs::system completeDraw;
+		flecs::system followCamera;
 
 		std::weak_ptr<const GameConfig> gameConfig;
 
-		flecs::query<Player, Transform> playerTransformsQuery;
+		flecs::query<Player, WorldMatrix> playerTransformsQuery;
 
 		flecs::query<const Left, const ResizeOffset, Position, Scale> leftResizeQuery;
 		flecs::query<const Right, const ResizeOffset, Position, Scale> rightResizeQuery;
@@ -140,9 +113,8 @@ namespace GOG
 		GW::GRAPHICS::GDirectX11Surface d3d;
 		GW::MATH::GVECTORF bgColor;
 
-		GW::CORE::GEventResponder onEvent;
 		GW::CORE::GEventResponder onWindowResize;
-		GW::CORE::GEventGenerator eventPusherUI;
+		EventBus* eventBus;
 
 		GW::INPUT::GInput input;
 
@@ -166,6 +138,7 @@ namespace GOG
 		Microsoft::WRL::ComPtr<ID3DBlob> psMapModelsBlob;
 
 		Microsoft::WRL::ComPtr<ID3DBlob> errors;
+		ShaderCache shaderCache;
 
 	
 		//----------Input Layouts----------
@@ -198,6 +171,8 @@ namespace GOG
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> actorTransformView;
 		Microsoft::WRL::ComPtr<ID3D11Buffer> sLightBuffer;
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lightView;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> sLightBinBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lightBinView;
 
 
 		//----------Textures----------
@@ -292,6 +267,10 @@ namespace GOG
 		float creditsOffset;
 
 		unsigned int playerCurrScore;
+
+		//----------Performance HUD----------
+		PerfHud perfHud;
+		RenderCounters renderCounters = {};
 		
 		float pauseAlpha;
 		bool maxReached;
@@ -357,7 +336,7 @@ namespace GOG
 					std::shared_ptr<flecs::world> _uiWorld,
 					std::weak_ptr<const GameConfig> _gameConfig, LevelData* _lvl, 
 					ActorData* _actors,
-					GW::CORE::GEventGenerator _eventPusher);
+					EventBus* _eventBus);
 		void RenderGameUI();
 		void Resize(unsigned int height, unsigned int width);
 		void UpdateCamera();
@@ -370,6 +349,8 @@ namespace GOG
 		void UpdateSmartBombs(unsigned int _smartBombs);
 		void UpdateWaves(unsigned int _waves);
 		void InitRendererSystems();
+		PerfHud& GetPerfHud() { return perfHud; }
+		const RenderCounters& GetRenderCounters() const { return renderCounters; }
 		bool Activate(bool runSystem);
 		bool Shutdown();
 
@@ -387,21 +368,59 @@ namespace GOG
 		Quad CreateQuad();
 		void InitCredits();
 		
+		// Points the backends' pipelines at the shaders, buffers and views they draw with
+		void SetupRenderBackend();
+		// Deferred contexts for the passes and the threads recording them, serial if either fails
+		void CreatePassContexts(ID3D11Device* _device);
+		// (Re)creates the actor transform buffer and its view for _capacity instances
+		void CreateActorTransformBuffer(ID3D11Device* _device, unsigned int _capacity);
+		// Grows the sorted copies and the GPU buffer to what the gathered instances grew to
+		void FitActorInstanceCapacity();
+		// (Re)creates the light bin buffer and its view for _capacity uints
+		void CreateLightBinBuffer(ID3D11Device* _device, size_t _capacity);
+		// Grows the light bin buffer to fit this frame's bins
+		void FitLightBinCapacity();
+
+		// _name's bytecode from the shader cache, compiled from ../Shaders/<_name>.hlsl and stored
+		// on a miss. Prints the errors and returns false if it doesn't compile.
+		bool LoadShaderBlob(const char* _name, const char* _target, UINT _flags, Microsoft::WRL::ComPtr<ID3DBlob>& _blob);
 		std::string ReadFileIntoString(const char* _filePath);
 		void PrintLabeledDebugString(const char* _label, const char* _toPrint);
 		
 	private:
-		static constexpr unsigned int instanceMax = 1024;
-		struct INSTANCE_TRANSFORMS
-		{
-			GW::MATH::GMATRIXF transforms[instanceMax];
-			unsigned int modelNdxs[instanceMax];
-
-		}instanceTransforms;
-
-		int drawCounter = 0;
-
-		INSTANCE_TRANSFORMS scaledMapModels;
+		// draws reserved up front for the 3D passes, more only cost a reallocation
+		static constexpr unsigned int FRAME_DRAWS_EXPECTED = 4096;
+
+		// this frame's actors in the order updateDraw met them, sized by [Memory] actorInstances
+		// and actorInstancesMax
+		ActorInstances actorInstances;
+		// instances sActorTransformBuffer holds, grows with actorInstances
+		unsigned int actorTransformCapacity = 0;
+
+		// this frame's instances sorted by model, the actor passes upload and draw these
+		ActorRenderQueue actorQueue;
+		std::vector<GW::MATH::GMATRIXF> queuedTransforms;
+		std::vector<GW::MATH::GMATRIXF> queuedMapTransforms;
+
+		// the level's lights binned into [Renderer] lightTileSize pixel tiles every frame
+		LightBins lightBins;
+		// uints sLightBinBuffer holds, grows with the bins
+		size_t lightBinCapacity = 0;
+
+		// the level's draws, materials and (merged) geometry, baked once when the renderer loads
+		LevelDrawStream levelStream;
+		// the level instances one segment copy has in view, refilled for each copy
+		std::vector<CullRange> levelRanges;
+		// the 3D passes of the current frame, each submitted through its own backend
+		FrameDraws frameDraws;
+		D3D11RenderBackend passBackends[PIPELINE_COUNT];
+		// With [Renderer] passThreads above 0 every pass is recorded into a command list on a
+		// deferred context, in parallel, and the lists run in pipeline order. Without threads or
+		// deferred contexts the passes are submitted to the immediate context one after another.
+		WorkerPool passWorkers;
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> passContexts[PIPELINE_COUNT];
+		Microsoft::WRL::ComPtr<ID3D11CommandList> passLists[PIPELINE_COUNT];
+		unsigned int passThreads = 0;
 
 		struct CreditsText
 		{
@@ -0,0 +1,88 @@
+#include "SessionRecorder.h"
+
+#include "../Utils/Profiler.h"
+
+bool GOG::SessionRecorder::Init(Simulation* _simulation, EventBus* _eventBus, std::weak_ptr<const GameConfig> _gameConfig)
+{
+	simulation = _simulation;
+
+	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
+	recordInput = readCfg->at("Replay").at("record").as<int>() != 0;
+	recordFile = readCfg->at("Replay").at("recordFile").as<std::string>();
+	reserveTicks = readCfg->at("Replay").at("reserveTicks").as<unsigned int>();
+	recentFrames.Create(readCfg->at("Snapshots").at("ringSize").as<unsigned int>());
+	spikeMs = readCfg->at("Snapshots").at("spikeMs").as<float>();
+	spikeFile = readCfg->at("Snapshots").at("spikeFile").as<std::string>();
+
+	// the next wave's spawns are recorded by now, the checkpoint is taken once they are merged
+	_eventBus->Subscribe(PLAY_EVENT::WAVE_CLEARED, [this](PLAY_EVENT _event, PLAY_EVENT_DATA _data)
+		{
+			checkpointPending = true;
+		});
+
+	return true;
+}
+
+void GOG::SessionRecorder::RecordEverything(unsigned int _ringSize, unsigned int _reserveTicks)
+{
+	recordInput = true;
+	reserveTicks = _reserveTicks;
+	recentFrames.Create(_ringSize);
+}
+
+void GOG::SessionRecorder::Begin(unsigned long long _seed, SimTicks _now)
+{
+	sessionRecorded = recordInput;
+	if (sessionRecorded)
+	{
+		inputLog.Begin(_seed, _now);
+		inputLog.Reserve(reserveTicks);
+	}
+
+	// the first checkpoint is the fresh session once its spawns are merged
+	checkpoint.bytes.clear();
+	checkpointPending = true;
+	recentFrames.Clear();
+	spikeSaved = false;
+}
+
+void GOG::SessionRecorder::Tick(const InputFrame& _input, float _deltaTime, SimTicks _now)
+{
+	PROFILE_ZONE("RecordTick");
+	// the checksum is taken after events, the same point a replay checks it
+	if (sessionRecorded)
+		inputLog.Append(_input, _deltaTime, _now, simulation->Checksum());
+
+	if (checkpointPending)
+	{
+		checkpointPending = false;
+		simulation->Capture(checkpoint);
+	}
+
+	if (recentFrames.Enabled())
+	{
+		WorldSnapshot* frame = recentFrames.Next();
+		simulation->Capture(*frame);
+		// this frame's delta is how long the previous frame took, the ring holds the frames leading up to it
+		frame->frameMs = _deltaTime * 1000.0f;
+		if (!spikeSaved && frame->frameMs > spikeMs)
+			spikeSaved = recentFrames.Save(spikeFile);
+	}
+}
+
+bool GOG::SessionRecorder::Continue()
+{
+	if (checkpoint.Empty() || simulation->Restore(checkpoint) == false)
+		return false;
+
+	// a continued session can't be replayed from the seed, keep what was recorded up to here
+	End();
+	return true;
+}
+
+void GOG::SessionRecorder::End()
+{
+	if (sessionRecorded && !inputLog.Empty())
+		inputLog.Save(recordFile);
+	sessionRecorded = false;
+}
@@ -0,0 +1,54 @@
+// Keeps what the game records about the session being played: the input log, the checkpoint a
+// game over continues from and the last few frames. The headless allocation check ticks the
+// same recorder, so the per-frame captures are part of what it measures.
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include "../Systems/Simulation.h"
+
+#include "../Utils/InputLog.h"
+#include "../Utils/WorldSnapshot.h"
+
+namespace GOG
+{
+	class SessionRecorder
+	{
+		Simulation* simulation = nullptr;
+
+		// each session's input is written to recordFile when it ends, if enabled in [Replay]
+		bool recordInput = false;
+		bool sessionRecorded = false;
+		std::string recordFile;
+		// room made in the log up front, so appending doesn't allocate in a session of normal length
+		unsigned int reserveTicks = 0;
+		InputLog inputLog;
+
+		// taken when a session or wave starts, the game over screen can continue from it
+		WorldSnapshot checkpoint;
+		bool checkpointPending = false;
+		// the last few simulated frames, written to spikeFile the first time a frame in a
+		// session takes longer than spikeMs
+		SnapshotRing recentFrames;
+		float spikeMs = 0;
+		std::string spikeFile;
+		bool spikeSaved = false;
+
+	public:
+		bool Init(Simulation* _simulation, EventBus* _eventBus, std::weak_ptr<const GameConfig> _gameConfig);
+		// Records input with room for _reserveTicks and keeps _ringSize frames whatever the config
+		// says, for the allocation check
+		void RecordEverything(unsigned int _ringSize, unsigned int _reserveTicks);
+
+		// Starts a session on simulation time _now, before the systems first run
+		void Begin(unsigned long long _seed, SimTicks _now);
+		// Call once a simulated frame's events were dispatched, logs the tick if the session is
+		// recorded and snapshots the frame
+		void Tick(const InputFrame& _input, float _deltaTime, SimTicks _now);
+		// Restores the last checkpoint, false if there is none or it didn't read back
+		bool Continue();
+		// Writes the input log of a recorded session, call when it ends or the game closes
+		void End();
+	};
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "Simulation.h"
+
+#include "../Utils/Profiler.h"
+
+bool GOG::Simulation::Init(
+	std::shared_ptr<flecs::world> _game,
+	std::weak_ptr<GameConfig> _gameConfig,
+	GW::INPUT::GController _gamePads,
+	GW::AUDIO::GAudio _audioEngine,
+	AudioData* _audioData,
+	EventBus* _eventBus,
+	CommandBuffers* _gameCommands,
+	FrameClock* _frameClock)
+{
+	flecsWorld = _game;
+	gameConfig = _gameConfig;
+	gamePads = _gamePads;
+	audioEngine = _audioEngine;
+	audioData = _audioData;
+	eventBus = _eventBus;
+	gameCommands = _gameCommands;
+	frameClock = _frameClock;
+
+	// nothing pressed until the first frame is sampled
+	flecsWorld->set<InputFrame>({});
+	poseQuery = flecsWorld->query<const Pose2D>();
+	snapshotEntities.Create(*flecsWorld);
+
+	return true;
+}
+
+bool GOG::Simulation::Start()
+{
+	if (systemsInitialized)
+		Play();
+	else if (InitSystems() == false)
+		return false;
+
+	// Every session starts from the same state for the same seed, whether it's the first one or
+	// a restart, so a recorded session replays from a fresh headless world. The camera goes
+	// first because the player spawns where the camera is.
+	cameraLogic.Reset();
+	enemyLogic.Reset();
+	pickupLogic.Reset();
+	levelLogic.Reset();
+
+	return true;
+}
+
+bool GOG::Simulation::InitSystems()
+{
+	if (playerLogic.Init(flecsWorld,
+		gameConfig,
+		gamePads,
+		audioEngine,
+		eventBus) == false)
+		return false;
+	if (levelLogic.Init(flecsWorld, gameConfig, *audioData, eventBus, gameCommands) == false)
+		return false;
+	if (physicsLogic.Init(flecsWorld, gameConfig, eventBus) == false)
+		return false;
+	if (lazerLogic.Init(flecsWorld, gameConfig) == false)
+		return false;
+	if (missileLogic.Init(flecsWorld, gameConfig) == false)
+		return false;
+	if (trapLogic.Init(flecsWorld, gameConfig) == false)
+		return false;
+	if (enemyLogic.Init(flecsWorld, gameConfig, eventBus) == false)
+		return false;
+	if (pickupLogic.Init(flecsWorld, gameConfig, eventBus) == false)
+		return false;
+	if (cameraLogic.Init(flecsWorld, gameConfig) == false)
+		return false;
+
+	systemsInitialized = true;
+	running = true;
+
+	return true;
+}
+
+void GOG::Simulation::Stop()
+{
+	Pause();
+
+	std::shared_ptr<const GameConfig> readCfg = gameConfig.lock();
+
+	unsigned int defaultLives = readCfg->at("PlayerPrefab_1").at("lives").as<unsigned int>();
+
+	gameCommands->Record([&readCfg, defaultLives](flecs::world& _commands)
+		{
+			_commands.entity("Persistent Player Stats")
+				.set<Lives>({ defaultLives })
+				.set<Score>({ 0 })
+				.set<NukeDispenser>(
+					{
+						0,
+						readCfg->at("NukeDispenser").at("range").as<float>(),
+						readCfg->at("NukeDispenser").at("maxCapacity").as<unsigned int>()
+					});
+
+			_commands.each([](flecs::entity _entity, Pose2D&)
+				{
+					_entity.destruct();
+				});
+		});
+}
+
+void GOG::Simulation::Pause()
+{
+	running = false;
+	frameClock->Pause(true);
+	playerLogic.Activate(false);
+	levelLogic.Activate(false);
+	physicsLogic.Activate(false);
+	lazerLogic.Activate(false);
+	missileLogic.Activate(false);
+	trapLogic.Activate(false);
+	enemyLogic.Activate(false);
+	pickupLogic.Activate(false);
+	cameraLogic.Activate(false);
+}
+
+void GOG::Simulation::Play()
+{
+	running = true;
+	frameClock->Pause(false);
+	playerLogic.Activate(true);
+	levelLogic.Activate(true);
+	physicsLogic.Activate(true);
+	lazerLogic.Activate(true);
+	missileLogic.Activate(true);
+	trapLogic.Activate(true);
+	enemyLogic.Activate(true);
+	pickupLogic.Activate(true);
+	cameraLogic.Activate(true);
+}
+
+unsigned int GOG::Simulation::Checksum()
+{
+	// FNV-1a, cheap enough to run every tick
+	unsigned int hash = 2166136261u;
+	auto mix = [&hash](const void* _data, size_t _size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+			for (size_t i = 0; i < _size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 16777619u;
+			}
+		};
+
+	poseQuery.each([&mix](const Pose2D& _pose)
+		{
+			mix(&_pose.x, sizeof(float) * 3);
+		});
+
+	flecs::entity stats = flecsWorld->lookup("Persistent Player Stats");
+	if (stats.is_alive())
+	{
+		mix(stats.get<Lives>(), sizeof(Lives));
+		mix(stats.get<Score>(), sizeof(Score));
+	}
+
+	return hash;
+}
+
+void GOG::Simulation::Capture(WorldSnapshot& _snapshot)
+{
+	PROFILE_ZONE("CaptureSnapshot");
+	// spawns recorded this frame belong to it, apply them now rather than at the next merge
+	if (gameCommands->Pending())
+		gameCommands->Merge();
+
+	SnapshotWriter writer(_snapshot.bytes);
+	writer.Write(frameClock->SimNow());
+	snapshotEntities.Write(writer);
+	levelLogic.SaveState(writer);
+	enemyLogic.SaveState(writer);
+	pickupLogic.SaveState(writer);
+	cameraLogic.SaveState(writer);
+	_snapshot.frame = frameClock->Frame();
+}
+
+bool GOG::Simulation::Restore(const WorldSnapshot& _snapshot)
+{
+	PROFILE_ZONE("RestoreSnapshot");
+	// nothing recorded against the old world may land on the restored one
+	gameCommands->Merge();
+
+	// the actors are checked before anything is loaded and only replace the world's once
+	// every part of the snapshot has read back
+	SnapshotReader reader(_snapshot.bytes);
+	SimTicks simNow = 0;
+	if (reader.Read(simNow) == false)
+		return false;
+	if (snapshotEntities.Stage(*flecsWorld, reader) == false)
+		return false;
+	if (levelLogic.LoadState(reader) == false)
+		return false;
+	if (enemyLogic.LoadState(reader) == false)
+		return false;
+	if (pickupLogic.LoadState(reader) == false)
+		return false;
+	if (cameraLogic.LoadState(reader) == false)
+		return false;
+	snapshotEntities.Apply(*flecsWorld, _snapshot.bytes);
+
+	// every timer in the snapshot was stamped on this timeline
+	frameClock->SetSimNow(simNow);
+	flecsWorld->set<SimClock>(frameClock->GetSimClock());
+
+	return true;
+}
+
+bool GOG::Simulation::Shutdown()
+{
+	poseQuery.destruct();
+	snapshotEntities.Destroy();
+
+	if (playerLogic.Shutdown() == false)
+		return false;
+	if (levelLogic.Shutdown() == false)
+		return false;
+	if (physicsLogic.Shutdown() == false)
+		return false;
+	if (lazerLogic.Shutdown() == false)
+		return false;
+	if (missileLogic.Shutdown() == false)
+		return false;
+	if (trapLogic.Shutdown() == false)
+		return false;
+	if (enemyLogic.Shutdown() == false)
+		return false;
+	if (pickupLogic.Shutdown() == false)
+		return false;
+	if (cameraLogic.Shutdown() == false)
+		return false;
+
+	return true;
+}
@@ -0,0 +1,92 @@
+// The simulation owns every gameplay system and nothing that needs a window, GPU or sound device,
+// so the same gameplay runs inside the game and in the headless runner
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "../Systems/PlayerLogic.h"
+#include "../Systems/EnemyLogic.h"
+#include "../Systems/LazerLogic.h"
+#include "../Systems/LevelLogic.h"
+#include "../Systems/PhysicsLogic.h"
+#include "../Systems/CameraLogic.h"
+#include "../Systems/PickupLogic.h"
+#include "../Systems/MissileLogic.h"
+#include "../Systems/TrapLogic.h"
+
+#include "../Utils/AudioData.h"
+#include "../Utils/FrameClock.h"
+#include "../Utils/CommandBuffers.h"
+#include "../Utils/WorldSnapshot.h"
+
+namespace GOG
+{
+	class Simulation
+	{
+		std::shared_ptr<flecs::world> flecsWorld;
+		std::weak_ptr<GameConfig> gameConfig;
+
+		// input comes in through the InputFrame singleton, the pad proxy is only used for haptics.
+		// Empty proxies vibrate and play nothing.
+		GW::INPUT::GController gamePads;
+		GW::AUDIO::GAudio audioEngine;
+		AudioData* audioData;
+
+		EventBus* eventBus;
+		// deferred world changes, owned by the application
+		CommandBuffers* gameCommands;
+		// owned by the application, paused alongside the gameplay systems
+		FrameClock* frameClock;
+
+		GOG::EnemyLogic enemyLogic;
+		GOG::LazerLogic lazerLogic;
+		GOG::MissileLogic missileLogic;
+		GOG::TrapLogic trapLogic;
+		GOG::PickupLogic pickupLogic;
+		GOG::LevelLogic levelLogic;
+		GOG::PhysicsLogic physicsLogic;
+		GOG::PlayerLogic playerLogic;
+		GOG::CameraLogic cameraLogic;
+
+		// every pose in the world, the bulk of what the checksum covers
+		flecs::query<const Pose2D> poseQuery;
+		// writes and reads the actors of snapshots, reused by every capture
+		SnapshotEntities snapshotEntities;
+
+		bool systemsInitialized = false;
+		bool running = false;
+
+		bool InitSystems();
+
+	public:
+
+		bool Init(std::shared_ptr<flecs::world> _game,
+			std::weak_ptr<GameConfig> _gameConfig,
+			GW::INPUT::GController _gamePads,
+			GW::AUDIO::GAudio _audioEngine,
+			AudioData* _audioData,
+			EventBus* _eventBus,
+			CommandBuffers* _gameCommands,
+			FrameClock* _frameClock);
+
+		// Starts a session, the gameplay systems are created the first time round
+		bool Start();
+		// Ends the session, the world is cleared when the command buffers next merge
+		void Stop();
+		void Pause();
+		void Play();
+		// true while the gameplay systems are running (not paused or stopped)
+		bool IsRunning() const { return running; }
+		// Hash of the gameplay state, compared tick by tick to detect a replay diverging
+		unsigned int Checksum();
+		// Writes every actor, the persistent stats, simulation time and the systems' own state
+		// (wave progress, spawn timers, random streams) into _snapshot. Call between frames.
+		void Capture(WorldSnapshot& _snapshot);
+		// Puts the world and systems back to how _snapshot left them, call between frames
+		bool Restore(const WorldSnapshot& _snapshot);
+		unsigned int GetWave() const { return levelLogic.GetWave(); }
+		WaveProgress GetWaveProgress() const { return levelLogic.GetWaveProgress(); }
+		bool Shutdown();
+	};
+};
+
+#endif
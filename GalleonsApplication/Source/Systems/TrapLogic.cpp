@@ -3,6 +3,9 @@
 #include "../Components/Identification.h"
 #include "../Components/Physics.h"
 
+#include "../Utils/SharedActorMethods.h"
+#include "../Utils/Profiler.h"
+
 using namespace GOG;
 using namespace GW;
 using namespace MATH;
@@ -14,11 +17,12 @@ bool TrapLogic::Init(std::shared_ptr<flecs::world> _game,
 	flecsWorld = _game;
 	gameConfig = _gameConfig;
 
-	TrapSystem = flecsWorld->system<const Trap, Transform>("TrapSystem")
-		.each([](flecs::entity _entity, const Trap&, Transform& _transform)
+	TrapSystem = flecsWorld->system<const Trap, Pose2D>("TrapSystem")
+		.each([](flecs::entity _entity, const Trap&, Pose2D& _pose)
 			{
+				PROFILE_SYSTEM("TrapSystem");
 				GVECTORF translate{ 0, _entity.delta_time(),  0, 0 };
-				GMatrix::TranslateLocalF(_transform.value, translate, _transform.value);
+				SharedActorMethods::TranslatePoseLocal(translate, _pose);
 			});
 
 	return true;
@@ -0,0 +1,87 @@
+#include "UnitTest.h"
+#include "../Utils/FrameUploads.h"
+
+namespace
+{
+	struct SmallRecord
+	{
+		float value[4];
+	};
+
+	// more than one alignment step, takes two
+	struct LargeRecord
+	{
+		float value[80];
+	};
+}
+
+UNIT_TEST(WindowsAreAlignedAndCoverTheirRecord)
+{
+	GOG::UploadRing ring;
+	ring.Create(1024);
+	GOG::UploadWindow first = ring.Push(SmallRecord{ { 1, 2, 3, 4 } });
+	GOG::UploadWindow second = ring.Push(LargeRecord{});
+	CHECK(first.firstConstant == 0 && first.constantCount == 16);
+	CHECK(second.firstConstant == 16 && second.constantCount == 32);
+	CHECK(ring.Used() == 768);
+	CHECK(ring.Contains(first) && ring.Contains(second));
+	CHECK(ring.Read<SmallRecord>(first).value[3] == 4);
+}
+
+UNIT_TEST(GrowingKeepsEarlierWindows)
+{
+	GOG::UploadRing ring;
+	ring.Create(256);
+	CHECK(ring.Capacity() == 256);
+
+	GOG::UploadWindow windows[8];
+	for (int i = 0; i < 8; i++)
+		windows[i] = ring.Push(SmallRecord{ { static_cast<float>(i), 0, 0, 0 } });
+	// 256 bytes doubled to 512, 1024 and then 2048 to fit eight records
+	CHECK(ring.GetStats().growths == 3);
+	CHECK(ring.Capacity() == 2048);
+	for (int i = 0; i < 8; i++)
+		CHECK(ring.Contains(windows[i]) && ring.Read<SmallRecord>(windows[i]).value[0] == i);
+
+	// a record bigger than double the capacity grows straight to fit it
+	GOG::UploadRing small;
+	small.Create(0);
+	small.Push(LargeRecord{});
+	CHECK(small.Capacity() == 512 && small.GetStats().growths == 1);
+}
+
+UNIT_TEST(ResetKeepsPinnedRecords)
+{
+	GOG::UploadRing ring;
+	ring.Create(4096);
+	GOG::UploadWindow pinned = ring.Push(SmallRecord{ { 7, 0, 0, 0 } });
+	ring.Pin();
+	CHECK(ring.GetStats().pinnedBytes == 256);
+
+	GOG::UploadWindow frame = ring.Push(SmallRecord{ { 1, 0, 0, 0 } });
+	CHECK(frame.firstConstant == 16);
+	ring.Reset();
+	// the next frame starts after the pinned record, which still reads back
+	CHECK(ring.Used() == 256 && ring.GetStats().records == 0);
+	CHECK(ring.Contains(pinned) && ring.Contains(frame) == false);
+	CHECK(ring.Read<SmallRecord>(pinned).value[0] == 7);
+	CHECK(ring.Push(SmallRecord{}).firstConstant == 16);
+
+	// Create drops the pinned records too
+	ring.Create(4096);
+	CHECK(ring.Used() == 0 && ring.GetStats().pinnedBytes == 0);
+	ring.Reset();
+	CHECK(ring.Used() == 0);
+}
+
+UNIT_TEST(PeakOutlivesReset)
+{
+	GOG::UploadRing ring;
+	ring.Create(4096);
+	for (int i = 0; i < 4; i++)
+		ring.Push(SmallRecord{});
+	ring.Reset();
+	ring.Push(SmallRecord{});
+	CHECK(ring.GetStats().peakBytes == 1024);
+	CHECK(ring.GetStats().usedBytes == 256);
+}
@@ -0,0 +1,100 @@
+#include "UnitTest.h"
+#include "../Utils/LevelCulling.h"
+
+namespace
+{
+	// clip space is world space: x and y from -1 to 1, depth from 0 to 1
+	const float IDENTITY[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	GOG::CullBox Box(float _x, float _y, float _z, float _extent)
+	{
+		return { { _x, _y, _z }, { _extent, _extent, _extent } };
+	}
+}
+
+UNIT_TEST(CullBoxesAgainstEveryFrustumPlane)
+{
+	GOG::CullFrustum frustum = GOG::CullFrustumFromViewProjection(IDENTITY);
+	CHECK(GOG::ClassifyCullBox(frustum, Box(0, 0, 0.5f, 0.25f)) == GOG::CULL_INSIDE);
+
+	// centers half an extent past each plane straddle it, a full extent past only touch it
+	const float centers[6][3] = { { -1, 0, 0.5f }, { 1, 0, 0.5f }, { 0, -1, 0.5f }, { 0, 1, 0.5f }, { 0, 0, 0 }, { 0, 0, 1 } };
+	const float outward[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	for (int plane = 0; plane < 6; plane++)
+	{
+		const float* c = centers[plane];
+		const float* o = outward[plane];
+		CHECK(GOG::ClassifyCullBox(frustum, Box(c[0], c[1], c[2], 0.25f)) == GOG::CULL_INTERSECTS);
+		CHECK(GOG::ClassifyCullBox(frustum, Box(c[0] + o[0] * 0.25f, c[1] + o[1] * 0.25f, c[2] + o[2] * 0.25f, 0.25f)) == GOG::CULL_INTERSECTS);
+		CHECK(GOG::ClassifyCullBox(frustum, Box(c[0] + o[0] * 0.375f, c[1] + o[1] * 0.375f, c[2] + o[2] * 0.375f, 0.25f)) == GOG::CULL_OUTSIDE);
+	}
+}
+
+UNIT_TEST(OffsetFrustumSeesTheShiftedBox)
+{
+	GOG::CullFrustum frustum = GOG::CullFrustumFromViewProjection(IDENTITY);
+	GOG::CullFrustum offset = GOG::OffsetCullFrustum(frustum, 10.0f);
+	// a box drawn 10 along x lands where the unshifted frustum sees it
+	CHECK(GOG::ClassifyCullBox(offset, Box(-10, 0, 0.5f, 0.25f)) == GOG::CULL_INSIDE);
+	CHECK(GOG::ClassifyCullBox(offset, Box(0, 0, 0.5f, 0.25f)) == GOG::CULL_OUTSIDE);
+	CHECK(GOG::ClassifyCullBox(offset, Box(-11, 0, 0.5f, 0.25f)) == GOG::CULL_INTERSECTS);
+}
+
+UNIT_TEST(RangesNeverCrossAGroup)
+{
+	const unsigned int groups[6] = { 0, 0, 0, 1, 1, 2 };
+	const unsigned int visible[5] = { 0, 1, 2, 3, 5 };
+	GOG::CullRange ranges[6];
+	unsigned int count = GOG::CoalesceCullRanges(visible, 5, groups, ranges);
+	CHECK(count == 3);
+	CHECK(ranges[0].group == 0 && ranges[0].transformStart == 0 && ranges[0].count == 3);
+	CHECK(ranges[1].group == 1 && ranges[1].transformStart == 3 && ranges[1].count == 1);
+	CHECK(ranges[2].group == 2 && ranges[2].transformStart == 5 && ranges[2].count == 1);
+}
+
+UNIT_TEST(BvhMatchesBruteForceAtTheFrustumEdges)
+{
+	// a row of overlapping boxes along x in groups of three, every coordinate exact in binary
+	// so boxes 11 and 29 touch the side planes exactly
+	std::vector<GOG::CullBox> bounds;
+	std::vector<unsigned int> groups;
+	for (int i = 0; i < 40; i++)
+	{
+		bounds.push_back(Box(-2.5f + i * 0.125f, 0, 0.5f, 0.125f));
+		groups.push_back(i / 3);
+	}
+	GOG::InstanceBvh bvh;
+	bvh.Build(bounds.data(), groups.data(), static_cast<unsigned int>(bounds.size()));
+
+	std::vector<GOG::CullRange> fromBvh(bounds.size()), reference(bounds.size());
+	std::vector<unsigned int> scratch(bounds.size());
+	for (float offsetX : { 0.0f, 0.0625f, -0.5f, 1.5f, 4.0f })
+	{
+		GOG::CullFrustum frustum = GOG::OffsetCullFrustum(GOG::CullFrustumFromViewProjection(IDENTITY), offsetX);
+		unsigned int bvhCount = bvh.Cull(frustum, fromBvh.data());
+		unsigned int referenceCount = GOG::CullInstancesBruteForce(frustum, bounds.data(), groups.data(),
+			static_cast<unsigned int>(bounds.size()), scratch.data(), reference.data());
+		CHECK(bvhCount == referenceCount);
+		for (unsigned int i = 0; i < bvhCount && i < referenceCount; i++)
+			CHECK(fromBvh[i].group == reference[i].group && fromBvh[i].transformStart == reference[i].transformStart &&
+				fromBvh[i].count == reference[i].count);
+	}
+
+	// unshifted, touching counts as visible: boxes 11 to 29
+	GOG::CullRange ranges[40];
+	unsigned int count = bvh.Cull(GOG::CullFrustumFromViewProjection(IDENTITY), ranges);
+	unsigned int visible = 0;
+	for (unsigned int i = 0; i < count; i++)
+		visible += ranges[i].count;
+	CHECK(count > 0 && ranges[0].transformStart == 11);
+	CHECK(visible == 19);
+}
+
+UNIT_TEST(EmptyBvhCullsNothing)
+{
+	GOG::InstanceBvh bvh;
+	bvh.Build(nullptr, nullptr, 0);
+	GOG::CullRange range;
+	CHECK(bvh.Cull(GOG::CullFrustumFromViewProjection(IDENTITY), &range) == 0);
+	CHECK(bvh.NodeCount() == 0);
+}
@@ -0,0 +1,139 @@
+#include "UnitTest.h"
+#include "../Utils/LightBinning.h"
+
+namespace
+{
+	// looking down +z from the origin with a 90 degree field of view onto 4x4 tiles of 16 pixels,
+	// view x / z of -1 is the left edge of the screen and 1 the right one
+	GOG::LightBinCamera Camera(float _width = 64, float _height = 64)
+	{
+		GOG::LightBinCamera camera = {};
+		for (int i = 0; i < 16; i++)
+			camera.view[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		camera.scaleX = 1;
+		camera.scaleY = 1;
+		camera.nearZ = 1;
+		camera.width = _width;
+		camera.height = _height;
+		return camera;
+	}
+
+	// one point light reaching _reach around (_x, _y, _z), binned
+	void BinOne(GOG::LightBins& _bins, float _x, float _y, float _z, float _reach, const GOG::LightBinCamera& _camera)
+	{
+		_bins.Create(16);
+		_bins.SetLights(1);
+		float position[3] = { _x, _y, _z };
+		// the shader lights points within radius + 1
+		_bins.SetLight(0, position, GOG::LIGHT_BIN_POINT, _reach - 1);
+		_bins.Bin(_camera);
+	}
+
+	unsigned int TilesListing(const GOG::LightBins& _bins)
+	{
+		const unsigned int* data = _bins.Data();
+		unsigned int tiles = 0;
+		for (unsigned int tile = 0; tile < _bins.TilesX() * _bins.TilesY(); tile++)
+			tiles += data[tile * 2 + 1] > 0 ? 1 : 0;
+		return tiles;
+	}
+
+	bool Lists(const GOG::LightBins& _bins, unsigned int _tileX, unsigned int _tileY)
+	{
+		return _bins.Data()[(_tileY * _bins.TilesX() + _tileX) * 2 + 1] > 0;
+	}
+}
+
+UNIT_TEST(LightsCrossingTheNearPlaneReachEveryTile)
+{
+	GOG::LightBins bins;
+	BinOne(bins, 0, 0, 1.25f, 0.5f, Camera());
+	CHECK(TilesListing(bins) == 16);
+	// far off to the side, but still crossing the near plane
+	BinOne(bins, 50, 0, 1.25f, 0.5f, Camera());
+	CHECK(TilesListing(bins) == 16);
+}
+
+UNIT_TEST(LightsBehindTheNearPlaneReachNothing)
+{
+	GOG::LightBins bins;
+	BinOne(bins, 0, 0, 0.25f, 0.5f, Camera());
+	CHECK(TilesListing(bins) == 0);
+	// its far side exactly on the near plane
+	BinOne(bins, 0, 0, 0.5f, 0.5f, Camera());
+	CHECK(TilesListing(bins) == 0);
+	CHECK(bins.GetStats().visible == 0);
+}
+
+UNIT_TEST(LightsAtTheScreenEdgesLandInTheEdgeTiles)
+{
+	GOG::LightBins bins;
+	// its box spans view x / z from 10 / 11 to past the right edge and y / z of 1 / 9 either
+	// side of the middle: the last column, middle two rows
+	BinOne(bins, 11, 0, 10, 1, Camera());
+	CHECK(TilesListing(bins) == 2);
+	CHECK(Lists(bins, 3, 1) && Lists(bins, 3, 2));
+	// the same at the top edge, y is up in view space and tile rows go down
+	BinOne(bins, 0, 11, 10, 1, Camera());
+	CHECK(TilesListing(bins) == 2);
+	CHECK(Lists(bins, 1, 0) && Lists(bins, 2, 0));
+
+	// entirely past the right and bottom edges
+	BinOne(bins, 12.5f, 0, 10, 1, Camera());
+	CHECK(TilesListing(bins) == 0);
+	BinOne(bins, 0, -12.5f, 10, 1, Camera());
+	CHECK(TilesListing(bins) == 0);
+}
+
+UNIT_TEST(PartialTilesAtTheEdgeAreBinned)
+{
+	// 70 pixels is four full tiles and one of six pixels
+	GOG::LightBins bins;
+	BinOne(bins, 11, 0, 10, 1, Camera(70, 64));
+	CHECK(bins.TilesX() == 5 && bins.TilesY() == 4);
+	CHECK(Lists(bins, 4, 1) && Lists(bins, 3, 1) == false);
+}
+
+UNIT_TEST(SpotLightsReachEverywhereAndOtherTypesAreLeftOut)
+{
+	GOG::LightBins bins;
+	bins.Create(16);
+	bins.SetLights(2);
+	float position[3] = { 0, 0, -100 };
+	CHECK(bins.SetLight(0, position, 0, 5) == false);
+	CHECK(bins.SetLight(1, position, GOG::LIGHT_BIN_SPOT, 5));
+	bins.Bin(Camera());
+	CHECK(bins.LightCount() == 1);
+	CHECK(TilesListing(bins) == 16);
+	// the index the shader reads is the one the light was set with
+	CHECK(bins.Data()[bins.Data()[0]] == 1);
+}
+
+UNIT_TEST(BinnedTilesCoverTheFrustumReference)
+{
+	// a sweep of lights across every edge and through the near plane, more than four so the
+	// SIMD path and its scalar tail both run
+	GOG::LightBins bins;
+	bins.Create(16);
+	bins.SetLights(9 * 9 * 5);
+	unsigned int index = 0;
+	for (int x = -4; x <= 4; x++)
+		for (int y = -4; y <= 4; y++)
+			for (float z : { 0.5f, 1.0f, 1.5f, 4.0f, 9.0f })
+			{
+				float position[3] = { x * 2.5f, y * 2.5f, z };
+				bins.SetLight(index++, position, GOG::LIGHT_BIN_POINT, 0.5f);
+			}
+	GOG::LightBinCamera camera = Camera(70, 50);
+	bins.Bin(camera);
+	std::vector<unsigned int> reference;
+	bins.BinBruteForce(camera, reference);
+
+	const unsigned int* data = bins.Data();
+	for (unsigned int tile = 0; tile < bins.TilesX() * bins.TilesY(); tile++)
+	{
+		const unsigned int* binned = data + data[tile * 2];
+		const unsigned int* expected = reference.data() + reference[tile * 2];
+		CHECK(std::includes(binned, binned + data[tile * 2 + 1], expected, expected + reference[tile * 2 + 1]));
+	}
+}
@@ -0,0 +1,86 @@
+#include "UnitTest.h"
+#include "../Utils/ShaderCache.h"
+
+namespace
+{
+	const char* SOURCE = "float4 main() : SV_TARGET { return 1; }";
+	// D3DCOMPILE_ENABLE_STRICTNESS, what a release build compiles with
+	const unsigned int STRICTNESS = 1 << 11;
+
+	// an empty directory of its own under the system's temp directory
+	std::filesystem::path ScratchDirectory(const char* _name)
+	{
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / _name;
+		std::error_code error;
+		std::filesystem::remove_all(directory, error);
+		return directory;
+	}
+}
+
+UNIT_TEST(KeyMatchesTheBuildScript)
+{
+	// Utils/CompileShaders.py cache_key of the same source, target, entry and flags
+	CHECK(GOG::ShaderCacheKey(SOURCE, "ps_5_0", "main", STRICTNESS) == 0xa322a443d799a47bull);
+	CHECK(GOG::HashShaderBytes("", 0) == 0xcbf29ce484222325ull);
+}
+
+UNIT_TEST(KeyChangesWithEveryInput)
+{
+	unsigned long long key = GOG::ShaderCacheKey(SOURCE, "ps_5_0", "main", STRICTNESS);
+	CHECK(GOG::ShaderCacheKey(SOURCE, "ps_5_0", "main", STRICTNESS) == key);
+	CHECK(GOG::ShaderCacheKey(std::string(SOURCE) + " ", "ps_5_0", "main", STRICTNESS) != key);
+	CHECK(GOG::ShaderCacheKey(SOURCE, "vs_5_0", "main", STRICTNESS) != key);
+	CHECK(GOG::ShaderCacheKey(SOURCE, "ps_5_0", "main2", STRICTNESS) != key);
+	CHECK(GOG::ShaderCacheKey(SOURCE, "ps_5_0", "main", STRICTNESS | 1) != key);
+	// each input is hashed on its own, moving a character between them is a different key
+	CHECK(GOG::ShaderCacheKey(SOURCE, "ps_5_", "0main", STRICTNESS) != key);
+}
+
+UNIT_TEST(StoredBlobsLoadBack)
+{
+	std::filesystem::path directory = ScratchDirectory("GalleonsShaderCacheLoad");
+	GOG::ShaderCache cache;
+	CHECK(cache.Create(directory.string()));
+
+	const unsigned char blob[5] = { 1, 2, 3, 4, 5 };
+	std::vector<unsigned char> loaded;
+	CHECK(cache.Load("PixelShader", 1, loaded) == false);
+	CHECK(cache.Store("PixelShader", 1, blob, sizeof(blob)));
+	CHECK(cache.Load("PixelShader", 1, loaded) && loaded == std::vector<unsigned char>(blob, blob + 5));
+	CHECK(cache.Load("PixelShader", 2, loaded) == false);
+	CHECK(cache.GetStats().hits == 1 && cache.GetStats().misses == 2 && cache.GetStats().stores == 1);
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
+
+UNIT_TEST(StorePrunesOnlyTheSameShadersBlobs)
+{
+	std::filesystem::path directory = ScratchDirectory("GalleonsShaderCachePrune");
+	GOG::ShaderCache cache;
+	CHECK(cache.Create(directory.string()));
+
+	const unsigned char blob[1] = { 9 };
+	CHECK(cache.Store("PixelShader", 1, blob, sizeof(blob)));
+	CHECK(cache.Store("PSMap", 1, blob, sizeof(blob)));
+	// a name that starts like the shader's, and files that aren't blobs
+	CHECK(cache.Store("PixelShaderExtra", 1, blob, sizeof(blob)));
+	std::ofstream(directory / "PixelShader_notes.cso") << "kept";
+	std::ofstream(directory / "PixelShader_0000000000000001.txt") << "kept";
+
+	CHECK(cache.Store("PixelShader", 2, blob, sizeof(blob)));
+	CHECK(cache.GetStats().pruned == 1);
+	CHECK(std::filesystem::exists(cache.BlobPath("PixelShader", 1)) == false);
+	CHECK(std::filesystem::exists(cache.BlobPath("PixelShader", 2)));
+	CHECK(std::filesystem::exists(cache.BlobPath("PSMap", 1)));
+	CHECK(std::filesystem::exists(cache.BlobPath("PixelShaderExtra", 1)));
+	CHECK(std::filesystem::exists(directory / "PixelShader_notes.cso"));
+	CHECK(std::filesystem::exists(directory / "PixelShader_0000000000000001.txt"));
+
+	// storing the same key again keeps its own blob
+	CHECK(cache.Store("PixelShader", 2, blob, sizeof(blob)));
+	CHECK(std::filesystem::exists(cache.BlobPath("PixelShader", 2)) && cache.GetStats().pruned == 1);
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,61 @@
+#ifndef UNIT_TEST_H
+#define UNIT_TEST_H
+
+// Unit tests of the engine pieces that need no window, GPU, gateware or flecs. Each
+// Tests/<Piece>Tests.cpp registers its cases with UNIT_TEST and UnitTestMain.cpp runs them all.
+// Tests/ is its own program, left out of the game and headless builds. It builds from the
+// standard library alone, from Source/:
+//   g++ -std=c++17 -O2 Tests/*.cpp -o GalleonsTests
+//   cl /std:c++17 /EHsc /O2 Tests\*.cpp /Fe:GalleonsTests.exe
+// and exit with 0 when every case passes, 1 when one fails. The headless runner's checks cover
+// the same pieces against the game's real level and settings.
+
+#include <iostream>
+#include <vector>
+
+namespace GOG
+{
+	namespace Tests
+	{
+		typedef void (*TestFunction)();
+
+		struct TestCase
+		{
+			const char* name;
+			TestFunction run;
+		};
+
+		inline std::vector<TestCase>& Registry()
+		{
+			static std::vector<TestCase> cases;
+			return cases;
+		}
+
+		// failed CHECKs of the case being run
+		inline unsigned int& Failures()
+		{
+			static unsigned int failures = 0;
+			return failures;
+		}
+
+		struct Registrar
+		{
+			Registrar(const char* _name, TestFunction _run) { Registry().push_back({ _name, _run }); }
+		};
+
+		inline void ReportFailure(const char* _file, int _line, const char* _expression)
+		{
+			std::cout << "    " << _file << ":" << _line << ": CHECK(" << _expression << ") failed" << std::endl;
+			Failures() += 1;
+		}
+	}
+}
+
+#define UNIT_TEST(_name) static void _name(); \
+	static GOG::Tests::Registrar _name##Registrar(#_name, _name); \
+	static void _name()
+
+// keeps going after a failure, so one run lists every broken expectation of a case
+#define CHECK(_expression) ((_expression) ? (void)0 : GOG::Tests::ReportFailure(__FILE__, __LINE__, #_expression))
+
+#endif
@@ -0,0 +1,18 @@
+// Runs every registered unit test, see UnitTest.h for how to build them
+#include "UnitTest.h"
+
+int main()
+{
+	unsigned int failed = 0;
+	for (const GOG::Tests::TestCase& test : GOG::Tests::Registry())
+	{
+		GOG::Tests::Failures() = 0;
+		test.run();
+		bool passed = GOG::Tests::Failures() == 0;
+		std::cout << (passed ? "passed  " : "FAILED  ") << test.name << std::endl;
+		failed += passed ? 0 : 1;
+	}
+
+	std::cout << GOG::Tests::Registry().size() - failed << " of " << GOG::Tests::Registry().size() << " tests passed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
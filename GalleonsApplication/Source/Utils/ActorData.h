@@ -4,8 +4,11 @@
 #pragma once
 
 #include "h2bParser.h"
+#include "Profiler.h"
+#include "RenderMetadata.h"
 #include <string>
 #include <filesystem>
+#include <algorithm>
 
 // This reads .h2b files (which are optimized binary .obj+.mtl files) for actor game objects.
 class ActorData 
@@ -20,6 +23,8 @@ public:
 		unsigned vertexStart, indexStart, materialStart, meshStart, batchStart;
 		unsigned colliderIndex;
 		unsigned int texId;
+		// GOG::MINIMAP_CATEGORY, from the file name
+		unsigned int minimapCategory;
 		unsigned int transformStart;
 		// Object aligned bounding box data: LBN, LTN, LTF, LBF, RBN, RTN, RTF, RBF
 		// F,N = front, back	L,R = left, right	T,B = top, bottom
@@ -45,7 +50,7 @@ public:
 		}
 	};
 
-	// swaps string pointers for loaded texture offsets
+	// swaps string pointers for loaded texture offsets, albedoIndex is the GOG::TEXTURE_ID of map_Kd
 	struct MaterialTextures 
 	{
 		unsigned int albedoIndex, roughnessIndex, metalIndex, normalIndex;
@@ -63,6 +68,7 @@ public:
 	std::vector<unsigned> indices;
 
 	std::vector<H2B::Material> materials;
+	// one per material
 	std::vector<MaterialTextures> textures;
 
 	// All level boundry data used by the models
@@ -81,6 +87,7 @@ public:
 	// Imports the default level txt format and collects all .h2b data
 	bool LoadActors(const char* _actorH2bFolderPath, GW::SYSTEM::GLog _log)
 	{
+		PROFILE_ZONE("LoadActors");
 		_log.LogCategorized("EVENT", "LOADING GAME LEVEL [DATA ORIENTED]");
 
 		UnloadActors();// clear previous level data if there is any
@@ -121,35 +128,25 @@ private:
 	// loads all file names in the pathed folder into h2bNames
 	bool FindH2BNames(const char* _h2bFolderPath, GW::SYSTEM::GLog log)
 	{
-		std::string folderPath = _h2bFolderPath;
-
-		WIN32_FIND_DATAA findFileData;
-		//finds the first .h2b file in the directory and stores it in @findHandle
-		// the /*.h2b means any .h2b file
-		HANDLE findHandle = FindFirstFileA((folderPath + "/*.h2b").c_str(), &findFileData);
-
-		//if the handle is valid, loop through every file in directory and add their path
-		//to textureFilePaths
-		if (findHandle != INVALID_HANDLE_VALUE)
-		{
-			do
-			{
-				if (!(findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-				{
-					h2bNames.push_back(findFileData.cFileName);
-				}
-			} while (FindNextFileA(findHandle, &findFileData) != 0);
-
-			FindClose(findHandle);
-
-			log.LogCategorized("MESSAGE", "Actor Filepaths Found.");
-		}
-		else
+		std::error_code error;
+		std::filesystem::directory_iterator folder(_h2bFolderPath, error);
+		if (error)
 		{
 			log.LogCategorized("MESSAGE", "Error opening directory.");
 			return false;
 		}
 
+		// loop through every .h2b file in the directory and add its name
+		for (const std::filesystem::directory_entry& file : folder)
+		{
+			if (file.is_regular_file() && file.path().extension() == ".h2b")
+				h2bNames.push_back(file.path().filename().string());
+		}
+		// prefab numbering follows this order, so don't leave it up to the file system
+		std::sort(h2bNames.begin(), h2bNames.end());
+
+		log.LogCategorized("MESSAGE", "Actor Filepaths Found.");
+
 		return true;
 	}
 
@@ -200,12 +197,15 @@ private:
 				currModel.meshStart = meshes.size();
 				currModel.colliderIndex = colliders.size();
 				currModel.transformStart = i;
+				currModel.minimapCategory = GOG::MinimapCategoryFromFileName(currModel.fileName);
 				models.push_back(currModel);
 
 				// append/move all data
 				vertices.insert(vertices.end(), parser.vertices.begin(), parser.vertices.end());
 				indices.insert(indices.end(), parser.indices.begin(), parser.indices.end());
 				materials.insert(materials.end(), parser.materials.begin(), parser.materials.end());
+				for (const H2B::Material& material : parser.materials)
+					textures.push_back({ GOG::TextureIdFromMap(material.mapKd, textures.empty() ? GOG::TEXTURE_NONE : textures.back().albedoIndex), 0, 0, 0 });
 				batches.insert(batches.end(), parser.batches.begin(), parser.batches.end());
 				meshes.insert(meshes.end(), parser.meshes.begin(), parser.meshes.end());
 				colliders.push_back(models[i].ComputeOBB());
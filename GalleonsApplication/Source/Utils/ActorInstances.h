@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace GOG
+{
+	struct ActorInstanceStats
+	{
+		unsigned int capacity;
+		// times the store doubled since startup
+		unsigned int growths;
+		// actors this frame that didn't fit under the hard limit and weren't drawn
+		unsigned int overflows;
+	};
+
+	// The actor instances gathered for a frame: each one's transform, its minimap transform and
+	// model. Grows by doubling when a frame has more actors than it holds, so the renderer only
+	// allocates when a frame draws more actors than any frame before. Past _maxCapacity actors
+	// are dropped and counted rather than overwriting one another.
+	class ActorInstances
+	{
+		std::vector<GW::MATH::GMATRIXF> transforms;
+		std::vector<GW::MATH::GMATRIXF> mapTransforms;
+		std::vector<unsigned int> modelNdxs;
+		unsigned int count = 0;
+		unsigned int maxCapacity = 0;
+		ActorInstanceStats stats = {};
+
+		void Grow()
+		{
+			unsigned int capacity = std::min(std::max(stats.capacity * 2, 1u), maxCapacity);
+			transforms.resize(capacity);
+			mapTransforms.resize(capacity);
+			modelNdxs.resize(capacity);
+			stats.capacity = capacity;
+			stats.growths += 1;
+		}
+
+	public:
+		void Create(unsigned int _capacity, unsigned int _maxCapacity)
+		{
+			maxCapacity = std::max(_maxCapacity, 1u);
+			stats = {};
+			stats.capacity = std::min(std::max(_capacity, 1u), maxCapacity);
+			transforms.assign(stats.capacity, GW::MATH::GIdentityMatrixF);
+			mapTransforms.assign(stats.capacity, GW::MATH::GIdentityMatrixF);
+			modelNdxs.assign(stats.capacity, 0);
+			count = 0;
+		}
+
+		// Call before gathering a frame
+		void Reset()
+		{
+			count = 0;
+			stats.overflows = 0;
+		}
+
+		// Returns false if the store is at its hard limit
+		bool Add(const GW::MATH::GMATRIXF& _transform, const GW::MATH::GMATRIXF& _mapTransform, unsigned int _modelNdx)
+		{
+			if (count == stats.capacity)
+			{
+				if (stats.capacity == maxCapacity)
+				{
+					stats.overflows += 1;
+					return false;
+				}
+				Grow();
+			}
+			transforms[count] = _transform;
+			mapTransforms[count] = _mapTransform;
+			modelNdxs[count] = _modelNdx;
+			count += 1;
+			return true;
+		}
+
+		const GW::MATH::GMATRIXF* Transforms() const { return transforms.data(); }
+		const GW::MATH::GMATRIXF* MapTransforms() const { return mapTransforms.data(); }
+		const unsigned int* ModelNdxs() const { return modelNdxs.data(); }
+		unsigned int Count() const { return count; }
+		unsigned int Capacity() const { return stats.capacity; }
+		const ActorInstanceStats& GetStats() const { return stats; }
+	};
+}
@@ -1,17 +1,25 @@
 #pragma once
 
+#include <filesystem>
+
+#include "../Components/AudioSource.h"
+#include "Profiler.h"
 
 class AudioData
 {
 	std::string soundFXFolderPath;
 	std::string musicFolderPath;
 
-	GW::AUDIO::GAudio* audioListener;
+	// nullptr when running without a sound device, nothing is loaded and commands are discarded
+	GW::AUDIO::GAudio* audioListener = nullptr;
 
 	std::vector<GW::AUDIO::GSound> soundInstances;
 	int maxSoundInstances = 100;
 	std::vector<GW::AUDIO::GMusic> loopingInstances;
 	int maxLoopingInstances = 100;
+
+	// play/stop requests from gameplay, applied once per frame by ProcessCommands
+	GOG::AudioCommandQueue commands;
 public:
 	std::map<std::string, GW::AUDIO::GMusic> music;
 
@@ -19,6 +27,7 @@ public:
 		const char* _musicFolderPath,
 		GW::AUDIO::GAudio* _audioListener)
 	{
+		PROFILE_ZONE("LoadAudio");
 		UnloadAudio();
 
 		soundFXFolderPath = _soundFXFolderPath;
@@ -28,7 +37,8 @@ public:
 		soundInstances.reserve(maxSoundInstances);
 		loopingInstances.reserve(maxLoopingInstances);
 
-		ReadMusicFolder();
+		if (audioListener != nullptr)
+			ReadMusicFolder();
 	}
 
 	void UnloadAudio() {
@@ -38,57 +48,104 @@ public:
 
 	bool ReadMusicFolder()
 	{
-		std::string folderPath = musicFolderPath;
-
-		WIN32_FIND_DATAA findFileData;
-		//finds the first dds file in the directory and stores it in @findHandle
-		// the /*wav means that the path ends with '*' which means any text .wav
-		HANDLE findHandle = FindFirstFileA((folderPath + "/*.wav").c_str(), &findFileData);
+		std::error_code error;
+		std::filesystem::directory_iterator folder(musicFolderPath, error);
+		if (error)
+			return false;
 
-		//if the handle is valid, loop through every file in directory and add their path
-		//to musicFolderPath
-		if (findHandle != INVALID_HANDLE_VALUE)
-		{
-			do
-			{
-				if (!(findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-				{
-					music.insert({ findFileData.cFileName, GW::AUDIO::GMusic() });
-					music[findFileData.cFileName].Create((folderPath + "/" + findFileData.cFileName).c_str(), *audioListener, 1);
-				}
-			} while (FindNextFileA(findHandle, &findFileData) != 0);
-
-			FindClose(findHandle);
-		}
-		else
+		// loop through every .wav file in the directory and load it as a music track
+		for (const std::filesystem::directory_entry& file : folder)
 		{
-			return false;
+			if (!file.is_regular_file() || file.path().extension() != ".wav")
+				continue;
+
+			std::string fileName = file.path().filename().string();
+			music.insert({ fileName, GW::AUDIO::GMusic() });
+			music[fileName].Create((musicFolderPath + "/" + fileName).c_str(), *audioListener, 1);
 		}
 
 		return true;
 	}
 
-	GW::AUDIO::GSound* CreateSound(std::string name, float volume)
+	// Loads a one-shot clip into the bank and returns its id, INVALID_SOUND when the bank is full or silent
+	GOG::SoundId CreateSound(std::string name, float volume)
 	{
-		if (soundInstances.size() == maxSoundInstances)
-			return nullptr;
+		if (audioListener == nullptr || soundInstances.size() == maxSoundInstances)
+			return GOG::INVALID_SOUND;
 
 		int index = soundInstances.size();
 		soundInstances.push_back(GW::AUDIO::GSound());
 		soundInstances[index].Create((soundFXFolderPath + "/" + name).c_str(), *audioListener, volume);
 
-		return &soundInstances[index];
+		return static_cast<GOG::SoundId>(index);
 	}
 
-	GW::AUDIO::GMusic* CreateSoundLooping(std::string name, float volume)
+	GOG::SoundId CreateSoundLooping(std::string name, float volume)
 	{
-		if (loopingInstances.size() == maxLoopingInstances)
-			return nullptr;
+		if (audioListener == nullptr || loopingInstances.size() == maxLoopingInstances)
+			return GOG::INVALID_SOUND;
 
 		int index = loopingInstances.size();
 		loopingInstances.push_back(GW::AUDIO::GMusic());
 		loopingInstances[index].Create((soundFXFolderPath + "/" + name).c_str(), *audioListener, volume);
 
-		return &loopingInstances[index];
+		return static_cast<GOG::SoundId>(index);
+	}
+
+	GOG::AudioCommandQueue* GetCommandQueue() { return &commands; }
+
+	// Safe to call from any thread
+	void QueueCommand(GOG::AUDIO_COMMAND _type, GOG::SoundId _sound, float _volume = 0)
+	{
+		if (_sound == GOG::INVALID_SOUND)
+			return;
+		commands.Push({ _type, _sound, _volume });
+	}
+
+	// Applies every queued command, call once per frame from the main thread
+	void ProcessCommands()
+	{
+		PROFILE_ZONE("ProcessAudio");
+		GOG::AudioCommand command;
+		while (commands.Pop(command))
+		{
+			switch (command.type)
+			{
+			case GOG::AUDIO_COMMAND::PLAY_SOUND:
+			{
+				if (command.sound < soundInstances.size())
+					soundInstances[command.sound].Play();
+				break;
+			}
+			case GOG::AUDIO_COMMAND::PLAY_LOOP:
+			{
+				if (command.sound >= loopingInstances.size())
+					break;
+				GW::AUDIO::GMusic& loop = loopingInstances[command.sound];
+				loop.SetVolume(command.volume);
+				bool isPlaying = false;
+				loop.isPlaying(isPlaying);
+				if (!isPlaying)
+					loop.Play(true);
+				break;
+			}
+			case GOG::AUDIO_COMMAND::STOP_LOOP:
+			{
+				if (command.sound >= loopingInstances.size())
+					break;
+				loopingInstances[command.sound].SetVolume(0);
+				loopingInstances[command.sound].Stop();
+				break;
+			}
+			case GOG::AUDIO_COMMAND::SET_LOOP_VOLUME:
+			{
+				if (command.sound < loopingInstances.size())
+					loopingInstances[command.sound].SetVolume(command.volume);
+				break;
+			}
+			default:
+				break;
+			}
+		}
 	}
 };
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandQueue.h"
+#include "Profiler.h"
+
+namespace GOG
+{
+	// Cost of the last merge phase, for profiling
+	struct CommandMergeStats
+	{
+		unsigned int buffersMerged;
+		// main thread recordings since the last merge that found no free stage
+		unsigned int directRecords;
+		float mergeMs;
+	};
+
+	// Deferred ECS command buffers for code running off the ECS schedule (spawner daemons,
+	// event handlers, UI setup). A recording owns one flecs async stage from start to submit,
+	// so nothing is locked while commands are written. Submitted buffers are handed over
+	// through a lock-free queue and merged together by a single OnLoad system per world.
+	class CommandBuffers
+	{
+		static const unsigned int MAX_BUFFERS = 16;
+		static const unsigned int NO_STAGE = ~0u;
+		static_assert(MAX_BUFFERS < 32, "free stages are tracked in a 32 bit mask");
+
+		std::shared_ptr<flecs::world> flecsWorld;
+		std::vector<flecs::world> stages;
+		// bit i set while stage i is free to record into
+		std::atomic<unsigned int> freeStages{ 0 };
+		// submitted stages waiting for the merge phase
+		CommandQueue<unsigned int, MAX_BUFFERS> readyStages;
+		// disabling this entity holds submitted buffers back until merging is re-enabled
+		flecs::entity mergeEntity;
+		CommandMergeStats lastMerge = {};
+		// the thread that created the buffers and merges them
+		std::thread::id mainThread;
+		// main thread recordings written straight to the world because every stage was taken
+		std::atomic<unsigned int> directRecords{ 0 };
+
+		// NO_STAGE when every stage is taken and the caller is the main thread. Only the main
+		// thread frees stages, so it must not wait for one; other threads wait for its merge.
+		unsigned int AcquireStage()
+		{
+			unsigned int mask = freeStages.load(std::memory_order_acquire);
+			for (;;)
+			{
+				if (mask == 0)
+				{
+					if (std::this_thread::get_id() == mainThread)
+						return NO_STAGE;
+					std::this_thread::yield();
+					mask = freeStages.load(std::memory_order_acquire);
+					continue;
+				}
+
+				unsigned int lowestBit = mask & (~mask + 1);
+				if (freeStages.compare_exchange_weak(mask, mask & ~lowestBit, std::memory_order_acquire))
+				{
+					unsigned int index = 0;
+					while ((lowestBit >> index) != 1)
+						index += 1;
+					return index;
+				}
+			}
+		}
+
+	public:
+		// Creates the stages and the merge system, call from the main thread
+		void Create(std::shared_ptr<flecs::world> _flecsWorld, const char* _mergeSystemName)
+		{
+			flecsWorld = _flecsWorld;
+			mainThread = std::this_thread::get_id();
+			stages.reserve(MAX_BUFFERS);
+			for (unsigned int i = 0; i < MAX_BUFFERS; i++)
+				stages.emplace_back(flecsWorld->async_stage());
+			freeStages.store((1u << MAX_BUFFERS) - 1, std::memory_order_release);
+
+			struct MergeCommandBuffers {}; // local definition so we control iteration counts
+			mergeEntity = flecsWorld->entity(_mergeSystemName).add<MergeCommandBuffers>();
+			// only happens once per frame at the very start of the frame
+			flecsWorld->system<MergeCommandBuffers>((std::string(_mergeSystemName) + " System").c_str())
+				.kind(flecs::OnLoad) // first defined phase
+				.each([this](flecs::entity _entity, MergeCommandBuffers&)
+					{
+						PROFILE_SYSTEM("MergeCommandBuffers");
+						Merge();
+					});
+		}
+
+		// Records a batch of commands from any thread. _record receives a flecs::world& to write
+		// into; it must only add, set or destruct, reads see the world as of the last merge.
+		template <typename Recorder>
+		void Record(Recorder&& _record)
+		{
+			unsigned int index = AcquireStage();
+			if (index == NO_STAGE)
+			{
+				// the world defers these itself while it progresses and applies them at once
+				// otherwise, so they skip the merge phase (and a merge held back by Activate)
+				directRecords.fetch_add(1, std::memory_order_relaxed);
+				_record(*flecsWorld);
+				return;
+			}
+			_record(stages[index]);
+			readyStages.Push(index); // can't fail, there are never more ready stages than slots
+		}
+
+		// Applies every submitted buffer to the world. Called by the merge system, or directly
+		// from the main thread when the world isn't progressing (shutdown).
+		void Merge()
+		{
+			auto start = std::chrono::steady_clock::now();
+			unsigned int merged = 0;
+			unsigned int index;
+			while (readyStages.Pop(index))
+			{
+				stages[index].merge();
+				freeStages.fetch_or(1u << index, std::memory_order_release);
+				merged += 1;
+			}
+			lastMerge.buffersMerged = merged;
+			lastMerge.directRecords = directRecords.exchange(0, std::memory_order_relaxed);
+			lastMerge.mergeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// True while a submitted buffer is waiting for the merge, main thread only
+		bool Pending() const
+		{
+			return !readyStages.Empty();
+		}
+
+		// Toggle the per-frame merge, used to hold spawns back while gameplay is paused
+		void Activate(bool _merge)
+		{
+			if (_merge)
+				mergeEntity.enable();
+			else
+				mergeEntity.disable();
+		}
+
+		const CommandMergeStats& GetMergeStats() const { return lastMerge; }
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+
+namespace GOG
+{
+	// Fixed capacity lock-free queue. Any thread may Push, one thread drains with Pop.
+	// Every slot carries a sequence number so producers claim slots with a single
+	// compare-exchange and the consumer never has to take a lock. Push fails when full
+	// rather than allocating, so the capacity must be sized for a frame's worth of work.
+	template <typename T, unsigned int CAPACITY>
+	class CommandQueue
+	{
+		static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CommandQueue capacity must be a power of two");
+
+		struct Slot
+		{
+			std::atomic<unsigned int> sequence;
+			T value;
+		};
+
+		Slot slots[CAPACITY];
+		std::atomic<unsigned int> writeIndex{ 0 };
+		unsigned int readIndex = 0;
+
+	public:
+		CommandQueue()
+		{
+			for (unsigned int i = 0; i < CAPACITY; i++)
+				slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		CommandQueue(const CommandQueue&) = delete;
+		CommandQueue& operator=(const CommandQueue&) = delete;
+
+		bool Push(const T& _value)
+		{
+			unsigned int index = writeIndex.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Slot& slot = slots[index & (CAPACITY - 1)];
+				unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+				int diff = static_cast<int>(sequence - index);
+				if (diff == 0)
+				{
+					if (writeIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+					{
+						slot.value = _value;
+						slot.sequence.store(index + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false; // full
+				else
+					index = writeIndex.load(std::memory_order_relaxed);
+			}
+		}
+
+		// Consumer thread only
+		bool Empty() const
+		{
+			const Slot& slot = slots[readIndex & (CAPACITY - 1)];
+			return static_cast<int>(slot.sequence.load(std::memory_order_acquire) - (readIndex + 1)) < 0;
+		}
+
+		// Consumer thread only
+		bool Pop(T& _value)
+		{
+			Slot& slot = slots[readIndex & (CAPACITY - 1)];
+			unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+			if (static_cast<int>(sequence - (readIndex + 1)) < 0)
+				return false; // empty, or the producer hasn't finished writing yet
+
+			_value = slot.value;
+			slot.sequence.store(readIndex + CAPACITY, std::memory_order_release);
+			readIndex += 1;
+			return true;
+		}
+	};
+}
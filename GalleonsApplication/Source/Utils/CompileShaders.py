@@ -0,0 +1,81 @@
+# Build step compiling the game's shaders into the runtime shader cache
+# run it before (or as a pre-build event of) the game, from anywhere:
+#   python CompileShaders.py [--debug] [--fxc <path to fxc.exe>]
+# every shader is compiled with fxc to Shaders/Cache/<name>_<key>.cso, the key is the same
+# FNV-1a hash Utils/ShaderCache.h computes, so the renderer finds the blobs instead of compiling.
+# blobs that are already there are skipped, older blobs of a changed shader are removed.
+
+import argparse
+import os
+import subprocess
+import sys
+
+# keep in step with DirectX11Renderer::LoadShaders
+SHADERS = [
+    ("VertexShader", "vs_5_0"),
+    ("VSMap", "vs_5_0"),
+    ("VSLevelShader", "vs_5_0"),
+    ("PixelShader", "ps_5_0"),
+    ("PSMap", "ps_5_0"),
+    ("PSColorMapModels", "ps_5_0"),
+]
+ENTRY = "main"
+# D3DCOMPILE_ENABLE_STRICTNESS, D3DCOMPILE_DEBUG
+STRICTNESS = 1 << 11
+DEBUG = 1 << 0
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+SHADER_DIR = os.path.join(ROOT, "Shaders")
+CACHE_DIR = os.path.join(SHADER_DIR, "Cache")
+
+
+def fnv1a(data, hash=0xcbf29ce484222325):
+    for byte in data:
+        hash ^= byte
+        hash = (hash * 0x100000001b3) & 0xffffffffffffffff
+    return hash
+
+
+# every string is hashed with a terminating zero, like ShaderCacheKey does
+def cache_key(source, target, entry, flags):
+    key = fnv1a(source + b"\0")
+    key = fnv1a(target.encode("ascii") + b"\0", key)
+    key = fnv1a(entry.encode("ascii") + b"\0", key)
+    return fnv1a(flags.to_bytes(4, "little"), key)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile the game's shaders into the shader cache")
+    parser.add_argument("--debug", action="store_true", help="match a debug build of the game")
+    parser.add_argument("--fxc", default="fxc", help="path to fxc.exe, from the Windows SDK")
+    args = parser.parse_args()
+
+    flags = STRICTNESS | (DEBUG if args.debug else 0)
+    os.makedirs(CACHE_DIR, exist_ok=True)
+    failed = 0
+    for name, target in SHADERS:
+        with open(os.path.join(SHADER_DIR, name + ".hlsl"), "rb") as source:
+            key = cache_key(source.read(), target, ENTRY, flags)
+        blob = "%s_%016x.cso" % (name, key)
+        if os.path.exists(os.path.join(CACHE_DIR, blob)):
+            print("up to date  " + blob)
+            continue
+
+        command = [args.fxc, "/nologo", "/T", target, "/E", ENTRY, "/Ges",
+                   "/Fo", os.path.join(CACHE_DIR, blob), os.path.join(SHADER_DIR, name + ".hlsl")]
+        if args.debug:
+            command.insert(2, "/Zi")
+        if subprocess.call(command) != 0:
+            failed += 1
+            continue
+        print("compiled    " + blob)
+
+        for old in os.listdir(CACHE_DIR):
+            if old != blob and old.startswith(name + "_") and len(old) == len(name) + 1 + 16 + 4 and old.endswith(".cso"):
+                os.remove(os.path.join(CACHE_DIR, old))
+
+    return 1 if failed > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
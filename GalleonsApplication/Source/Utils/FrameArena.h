@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace GOG
+{
+	struct FrameArenaStats
+	{
+		// bytes the buffer in use holds, the other one may still be smaller or bigger
+		size_t capacity;
+		// what the frame that just ended allocated, overflow included
+		size_t lastFrameBytes;
+		// the most a single frame has allocated since startup
+		size_t highWaterBytes;
+		// allocations since startup that didn't fit and went to the heap
+		unsigned int overflows;
+	};
+
+	// Scratch memory for data that only lives for a frame. Allocating bumps a pointer and nothing
+	// is freed on its own, EndFrame switches to the other buffer and wipes it. What a frame
+	// allocates stays valid until the end of the next frame, so it can be handed to work that
+	// runs a frame later (command buffers are merged at the start of the next frame).
+	// A frame that outgrows its buffer falls back to the heap, and the buffer grows to the high
+	// water mark the next time it is wiped. Main thread only.
+	//
+	// Use it directly, through FrameAllocator for STL containers, or as a std::pmr resource.
+	// Containers should reserve up front, every time one grows the old block is left behind.
+	class FrameArena : public std::pmr::memory_resource
+	{
+		struct Buffer
+		{
+			std::unique_ptr<unsigned char[]> memory;
+			size_t capacity = 0;
+			size_t used = 0;
+			// allocations that didn't fit, released when the buffer is wiped
+			std::vector<std::unique_ptr<unsigned char[]>> overflow;
+			size_t overflowBytes = 0;
+		};
+
+		Buffer buffers[2];
+		unsigned int current = 0;
+		FrameArenaStats stats = {};
+
+		void Wipe(Buffer& _buffer)
+		{
+			if (_buffer.overflow.empty() == false)
+			{
+				_buffer.capacity = stats.highWaterBytes;
+				_buffer.memory.reset(new unsigned char[_buffer.capacity]);
+				_buffer.overflow.clear();
+			}
+			_buffer.used = 0;
+			_buffer.overflowBytes = 0;
+		}
+
+		void* AllocateOverflow(Buffer& _buffer, size_t _bytes, size_t _alignment)
+		{
+			// over-allocated so the block can be aligned inside itself
+			_buffer.overflow.emplace_back(new unsigned char[_bytes + _alignment]);
+			_buffer.overflowBytes += _bytes;
+			stats.overflows += 1;
+			std::uintptr_t address = reinterpret_cast<std::uintptr_t>(_buffer.overflow.back().get());
+			return reinterpret_cast<void*>((address + _alignment - 1) & ~(static_cast<std::uintptr_t>(_alignment) - 1));
+		}
+
+	protected:
+		void* do_allocate(size_t _bytes, size_t _alignment) override { return Allocate(_bytes, _alignment); }
+		// memory only comes back all at once, in EndFrame
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& _other) const noexcept override { return this == &_other; }
+
+	public:
+		FrameArena() = default;
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		void Create(size_t _bytesPerFrame)
+		{
+			for (Buffer& buffer : buffers)
+			{
+				buffer.capacity = _bytesPerFrame;
+				buffer.memory.reset(new unsigned char[_bytesPerFrame]);
+				buffer.used = 0;
+				buffer.overflow.clear();
+				buffer.overflowBytes = 0;
+			}
+			current = 0;
+			stats = { _bytesPerFrame, 0, 0, 0 };
+		}
+
+		// _alignment must be a power of two
+		void* Allocate(size_t _bytes, size_t _alignment = alignof(std::max_align_t))
+		{
+			Buffer& buffer = buffers[current];
+			std::uintptr_t base = reinterpret_cast<std::uintptr_t>(buffer.memory.get());
+			std::uintptr_t start = (base + buffer.used + _alignment - 1) & ~(static_cast<std::uintptr_t>(_alignment) - 1);
+			size_t end = static_cast<size_t>(start - base) + _bytes;
+			if (buffer.memory == nullptr || end > buffer.capacity)
+				return AllocateOverflow(buffer, _bytes, _alignment);
+			buffer.used = end;
+			return reinterpret_cast<void*>(start);
+		}
+
+		// Uninitialized storage for _count T, for types that need no constructor or destructor
+		template<typename T>
+		T* AllocateArray(size_t _count)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "nothing in the arena is ever destroyed");
+			return static_cast<T*>(Allocate(sizeof(T) * _count, alignof(T)));
+		}
+
+		// Call once at the very end of every frame
+		void EndFrame()
+		{
+			Buffer& ended = buffers[current];
+			stats.lastFrameBytes = ended.used + ended.overflowBytes;
+			stats.highWaterBytes = std::max(stats.highWaterBytes, stats.lastFrameBytes);
+			// the frame before last is done with the other buffer
+			current ^= 1;
+			Wipe(buffers[current]);
+			stats.capacity = buffers[current].capacity;
+		}
+
+		const FrameArenaStats& GetStats() const { return stats; }
+	};
+
+	// STL allocator handing out frame arena memory, deallocate does nothing
+	template<typename T>
+	class FrameAllocator
+	{
+		template<typename U> friend class FrameAllocator;
+		FrameArena* arena;
+
+	public:
+		using value_type = T;
+
+		explicit FrameAllocator(FrameArena* _arena) : arena(_arena) {}
+		template<typename U>
+		FrameAllocator(const FrameAllocator<U>& _other) : arena(_other.arena) {}
+
+		T* allocate(size_t _count) { return static_cast<T*>(arena->Allocate(sizeof(T) * _count, alignof(T))); }
+		void deallocate(T*, size_t) {}
+
+		template<typename U>
+		bool operator==(const FrameAllocator<U>& _other) const { return arena == _other.arena; }
+		template<typename U>
+		bool operator!=(const FrameAllocator<U>& _other) const { return arena != _other.arena; }
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+	// Singleton on the gameplay world, the arena is owned by the application
+	struct FrameScratch { FrameArena* arena; };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+
+#include "../Components/Gameplay.h"
+
+namespace GOG
+{
+	// Samples the OS clock exactly once per frame and derives two timelines from it:
+	// real time (menus, splash screens) and simulation time, which stops while paused.
+	// Gameplay systems only ever see simulation time through the SimClock singleton.
+	class FrameClock
+	{
+		std::chrono::steady_clock::time_point lastSample;
+		bool started = false;
+		bool paused = false;
+
+		unsigned long long frame = 0;
+		SimTicks realNow = 0;
+		SimTicks simNow = 0;
+		// sub-millisecond leftovers so simulation time doesn't drift from rounding
+		double realRemainder = 0;
+		double simRemainder = 0;
+
+		float deltaTime = 0;
+		float simDeltaTime = 0;
+
+		// Moves both timelines forward by one frame
+		float Advance(double _elapsedMs)
+		{
+			frame += 1;
+
+			deltaTime = static_cast<float>(_elapsedMs / 1000.0);
+			realRemainder += _elapsedMs;
+			SimTicks wholeMs = static_cast<SimTicks>(realRemainder);
+			realRemainder -= wholeMs;
+			realNow += wholeMs;
+
+			if (paused)
+			{
+				simDeltaTime = 0;
+				return deltaTime;
+			}
+
+			simDeltaTime = deltaTime;
+			simRemainder += _elapsedMs;
+			wholeMs = static_cast<SimTicks>(simRemainder);
+			simRemainder -= wholeMs;
+			simNow += wholeMs;
+
+			return deltaTime;
+		}
+
+	public:
+		// Call once at the top of the frame; returns the real delta in seconds
+		float Tick()
+		{
+			auto sample = std::chrono::steady_clock::now();
+			if (!started)
+			{
+				lastSample = sample;
+				started = true;
+			}
+
+			double elapsedMs = std::chrono::duration<double, std::milli>(sample - lastSample).count();
+			lastSample = sample;
+			return Advance(elapsedMs);
+		}
+
+		// Steps both timelines by a fixed amount without looking at the OS clock, for runs
+		// that should behave the same however fast the machine is
+		float TickFixed(float _stepSeconds)
+		{
+			return Advance(_stepSeconds * 1000.0);
+		}
+
+		// Freezes simulation time; real time keeps running
+		void Pause(bool _pause) { paused = _pause; }
+		bool IsPaused() const { return paused; }
+		// Moves simulation time to where a restored snapshot left it, so its timers line up again
+		void SetSimNow(SimTicks _simNow)
+		{
+			simNow = _simNow;
+			simRemainder = 0;
+		}
+
+		float DeltaTime() const { return deltaTime; }
+		SimTicks RealNow() const { return realNow; }
+		SimTicks SimNow() const { return simNow; }
+		unsigned long long Frame() const { return frame; }
+
+		// Snapshot published to the ECS as a singleton each frame
+		SimClock GetSimClock() const { return { frame, simNow, simDeltaTime }; }
+	};
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "ActorData.h"
+#include "LevelData.h"
+#include "LevelDrawStream.h"
+#include "FrameUploads.h"
+#include "LevelCulling.h"
+#include "RenderCommands.h"
+#include "RenderQueue.h"
+#include "ShaderData.h"
+
+namespace GOG
+{
+	// One indexed instanced draw and the records it reads. mesh goes to b0 (the pixel shader's
+	// b0 only in the minimap pass), instance to b2.
+	struct DrawRecord
+	{
+		UploadWindow mesh;
+		UploadWindow instance;
+		unsigned int indexCount;
+		unsigned int instanceCount;
+		unsigned int startIndex;
+		int baseVertex;
+	};
+
+	// A run of draws sharing shaders and scene constants, with the records they read. Passes
+	// don't share anything, so each one can be recorded and submitted on its own thread.
+	struct PassDraws
+	{
+		UploadRing uploads;
+		std::vector<DrawRecord> draws;
+		// b1
+		UploadWindow scene = {};
+		// b0 of the vertex shader while the pixel shader's b0 changes per draw (minimap)
+		UploadWindow vertexMesh = {};
+		// the stages a draw's mesh record is bound to, the vertex shader keeps vertexMesh otherwise
+		unsigned int meshStages = STAGE_BOTH;
+
+		void Create(size_t _uploadBytes, unsigned int _expectedDraws)
+		{
+			uploads.Create(_uploadBytes);
+			draws.clear();
+			draws.reserve(_expectedDraws);
+		}
+
+		void Reset()
+		{
+			uploads.Reset();
+			draws.clear();
+			scene = vertexMesh = {};
+			meshStages = STAGE_BOTH;
+		}
+	};
+
+	// Everything the 3D passes draw in a frame, recorded on the CPU before anything is submitted,
+	// one PassDraws per RENDER_PIPELINE. The renderer uploads each pass's records once and replays
+	// it; the headless runner fills it the same way to check and time it without a GPU.
+	struct FrameDraws
+	{
+		PassDraws passes[PIPELINE_COUNT];
+		// level instances drawn over all segment copies
+		unsigned int levelInstancesDrawn = 0;
+		// the frame's light bins, uploaded by every pass that reads them; null leaves them alone
+		const void* lightBins = nullptr;
+		size_t lightBinBytes = 0;
+		// one per LevelDrawStream material, pinned in the level pass's uploads by PinLevelMaterials
+		std::vector<UploadWindow> levelMaterials;
+
+		// _uploadBytes and _expectedDraws are split between the passes
+		void Create(size_t _uploadBytes, unsigned int _expectedDraws)
+		{
+			for (PassDraws& pass : passes)
+				pass.Create(_uploadBytes / PIPELINE_COUNT, _expectedDraws / PIPELINE_COUNT);
+			levelMaterials.clear();
+		}
+
+		void Reset()
+		{
+			for (PassDraws& pass : passes)
+				pass.Reset();
+			levelInstancesDrawn = 0;
+			lightBins = nullptr;
+			lightBinBytes = 0;
+		}
+
+		size_t DrawCount() const
+		{
+			size_t count = 0;
+			for (const PassDraws& pass : passes)
+				count += pass.draws.size();
+			return count;
+		}
+	};
+
+	// Every queued actor model tinted by its minimap category, skipping the ones the minimap hides
+	inline void RecordMinimapDraws(FrameDraws& _frame, const ActorData& _actors, const ActorRenderQueue& _queue,
+		const SceneData& _scene, const MeshData& _actorMesh)
+	{
+		PassDraws& pass = _frame.passes[PIPELINE_MINIMAP_MODELS];
+		pass.scene = pass.uploads.Push(_scene);
+		pass.vertexMesh = pass.uploads.Push(_actorMesh);
+		pass.meshStages = STAGE_PIXEL;
+
+		for (const RenderBucket& bucket : _queue.Buckets())
+		{
+			const ActorData::Model& model = _actors.models[bucket.modelIndex];
+			if (model.minimapCategory == MINIMAP_HIDDEN)
+				continue;
+			MapModelTex modelTex = { model.minimapCategory, { 0, 0, 0 } };
+			UploadWindow tint = pass.uploads.Push(modelTex);
+			UploadWindow instance = pass.uploads.Push(PerInstanceData{ bucket.transformStart, 0, 0.0f, 0 });
+
+			for (unsigned int msh = 0; msh < model.meshCount; msh++)
+			{
+				const H2B::Mesh& mesh = _actors.meshes[msh + model.meshStart];
+				pass.draws.push_back({ tint, instance, mesh.drawInfo.indexCount, bucket.count,
+					mesh.drawInfo.indexOffset + model.indexStart, static_cast<int>(model.vertexStart) });
+			}
+		}
+	}
+
+	// Pushes one mesh record per material of _stream into the level pass and pins them, so frames
+	// replaying the stream bind them without pushing them again. _mesh fills everything but the
+	// material. Call once after Create, before the first frame.
+	inline void PinLevelMaterials(FrameDraws& _frame, const LevelDrawStream& _stream, MeshData _mesh)
+	{
+		PassDraws& pass = _frame.passes[PIPELINE_LEVEL];
+		pass.Reset();
+		_frame.levelMaterials.clear();
+		for (const LevelDrawStream::Material& material : _stream.Materials())
+		{
+			_mesh.attribute = material.attribute;
+			_mesh.texID = material.texID;
+			_frame.levelMaterials.push_back(pass.uploads.Push(_mesh));
+		}
+		pass.uploads.Pin();
+	}
+
+	// The three level segment copies starting at _firstSegmentOffset, each culled against _frustum
+	// and replayed from _stream. The frame only pushes the scene and one instance record per
+	// visible range, which carries the segment's offset; the draws bind the pinned materials.
+	// _ranges needs room for every level instance.
+	inline void RecordLevelDraws(FrameDraws& _frame, const LevelDrawStream& _stream, InstanceBvh& _bvh, const CullFrustum& _frustum,
+		float _firstSegmentOffset, float _segmentWidth, const SceneData& _scene, CullRange* _ranges)
+	{
+		PassDraws& pass = _frame.passes[PIPELINE_LEVEL];
+		pass.scene = pass.uploads.Push(_scene);
+		const std::vector<LevelDrawStream::DrawSpan>& groups = _stream.Groups();
+		const std::vector<LevelDrawStream::Draw>& draws = _stream.Draws();
+
+		for (int segment = 0; segment < 3; segment++)
+		{
+			float offset = _firstSegmentOffset + segment * _segmentWidth;
+			CullFrustum frustum = OffsetCullFrustum(_frustum, offset);
+			unsigned int rangeCount = _bvh.Cull(frustum, _ranges);
+
+			for (unsigned int r = 0; r < rangeCount; r++)
+			{
+				const CullRange& range = _ranges[r];
+				const LevelDrawStream::DrawSpan& span = groups[range.group];
+				// merged into the batches below
+				if (span.drawCount == 0)
+					continue;
+				UploadWindow instance = pass.uploads.Push(PerInstanceData{ range.transformStart, 0, offset, 0 });
+				_frame.levelInstancesDrawn += range.count;
+
+				for (unsigned int d = span.firstDraw; d < span.firstDraw + span.drawCount; d++)
+				{
+					const LevelDrawStream::Draw& draw = draws[d];
+					pass.draws.push_back({ _frame.levelMaterials[draw.material], instance, draw.indexCount, range.count,
+						draw.startIndex, draw.baseVertex });
+				}
+			}
+
+			// the batches share the identity transform, so one instance record per segment
+			UploadWindow merged = {};
+			bool mergedPushed = false;
+			for (const LevelDrawStream::Batch& batch : _stream.Batches())
+			{
+				if (ClassifyCullBox(frustum, batch.bounds) == CULL_OUTSIDE)
+					continue;
+				if (mergedPushed == false)
+				{
+					merged = pass.uploads.Push(PerInstanceData{ _stream.IdentityTransform(), 0, offset, 0 });
+					mergedPushed = true;
+				}
+				_frame.levelInstancesDrawn += batch.instanceCount;
+				const LevelDrawStream::Draw& draw = draws[batch.draw];
+				pass.draws.push_back({ _frame.levelMaterials[draw.material], merged, draw.indexCount, 1,
+					draw.startIndex, draw.baseVertex });
+			}
+		}
+	}
+
+	// Every queued actor model, one draw per mesh for all of its instances
+	inline void RecordActorDraws(FrameDraws& _frame, const ActorData& _actors, const ActorRenderQueue& _queue,
+		const SceneData& _scene, MeshData _mesh)
+	{
+		PassDraws& pass = _frame.passes[PIPELINE_ACTORS];
+		pass.scene = pass.uploads.Push(_scene);
+
+		for (const RenderBucket& bucket : _queue.Buckets())
+		{
+			const ActorData::Model& model = _actors.models[bucket.modelIndex];
+			UploadWindow instance = pass.uploads.Push(PerInstanceData{ bucket.transformStart, 0, 0.0f, 0 });
+
+			for (unsigned int msh = 0; msh < model.meshCount; msh++)
+			{
+				_mesh.attribute = _actors.materials[msh + model.materialStart].attrib;
+				_mesh.texID = _actors.textures[msh + model.materialStart].albedoIndex;
+				const H2B::Mesh& mesh = _actors.meshes[msh + model.meshStart];
+				pass.draws.push_back({ pass.uploads.Push(_mesh), instance, mesh.drawInfo.indexCount, bucket.count,
+					mesh.drawInfo.indexOffset + model.indexStart, static_cast<int>(model.vertexStart) });
+			}
+		}
+	}
+
+	// The passes drawn with the scene pixel shader, which reads the light bins
+	inline bool PassReadsLightBins(RENDER_PIPELINE _pipeline)
+	{
+		return _pipeline == PIPELINE_LEVEL || _pipeline == PIPELINE_ACTORS;
+	}
+
+	// Submits one recorded pass: its constants, _transforms (when it reads actor transforms) and
+	// the light bins (when it shades with them), then the pipeline and its draws. Records shared by consecutive draws are only bound once.
+	inline void SubmitPassDraws(RenderBackend& _backend, const FrameDraws& _frame, RENDER_PIPELINE _pipeline,
+		const void* _transforms, size_t _transformBytes)
+	{
+		const PassDraws& pass = _frame.passes[_pipeline];
+		_backend.Upload(UPLOAD_CONSTANTS, pass.uploads.Data(), pass.uploads.Used());
+		if (_transforms != nullptr)
+			_backend.Upload(UPLOAD_ACTOR_TRANSFORMS, _transforms, _transformBytes);
+		if (_frame.lightBins != nullptr && PassReadsLightBins(_pipeline))
+			_backend.Upload(UPLOAD_LIGHT_BINS, _frame.lightBins, _frame.lightBinBytes);
+		_backend.SetPipeline(_pipeline);
+		_backend.BindConstants(CONSTANTS_SCENE, STAGE_BOTH, pass.scene);
+		if ((pass.meshStages & STAGE_VERTEX) == 0)
+			_backend.BindConstants(CONSTANTS_MESH, STAGE_VERTEX, pass.vertexMesh);
+
+		const unsigned int NOTHING_BOUND = ~0u;
+		unsigned int boundMesh = NOTHING_BOUND;
+		unsigned int boundInstance = NOTHING_BOUND;
+		for (const DrawRecord& draw : pass.draws)
+		{
+			if (draw.instance.firstConstant != boundInstance)
+			{
+				_backend.BindConstants(CONSTANTS_INSTANCE, STAGE_BOTH, draw.instance);
+				boundInstance = draw.instance.firstConstant;
+			}
+			if (draw.mesh.firstConstant != boundMesh)
+			{
+				_backend.BindConstants(CONSTANTS_MESH, pass.meshStages, draw.mesh);
+				boundMesh = draw.mesh.firstConstant;
+			}
+			_backend.DrawIndexedInstanced(draw.indexCount, draw.instanceCount, draw.startIndex, draw.baseVertex);
+		}
+	}
+
+	// The actor transforms a pass reads, the level reads its own
+	inline const void* PassTransforms(RENDER_PIPELINE _pipeline, const void* _mapTransforms, const void* _transforms)
+	{
+		switch (_pipeline)
+		{
+		case PIPELINE_MINIMAP_MODELS:
+			return _mapTransforms;
+		case PIPELINE_ACTORS:
+			return _transforms;
+		default:
+			return nullptr;
+		}
+	}
+
+	// Submits a recorded frame in pipeline order: the minimap models, then the level and the
+	// actors. Both actor passes read _transformBytes of actor transforms, the minimap from
+	// _mapTransforms.
+	inline void SubmitFrameDraws(RenderBackend& _backend, const FrameDraws& _frame, const void* _mapTransforms,
+		const void* _transforms, size_t _transformBytes)
+	{
+		for (unsigned int pipeline = 0; pipeline < PIPELINE_COUNT; pipeline++)
+		{
+			RENDER_PIPELINE pass = static_cast<RENDER_PIPELINE>(pipeline);
+			SubmitPassDraws(_backend, _frame, pass, PassTransforms(pass, _mapTransforms, _transforms), _transformBytes);
+		}
+	}
+}
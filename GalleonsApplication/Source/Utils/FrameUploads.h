@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace GOG
+{
+	// Part of the frame's upload buffer, in the 16 byte constants D3D11.1 binds constant buffer
+	// ranges by (VSSetConstantBuffers1 and friends)
+	struct UploadWindow
+	{
+		unsigned int firstConstant;
+		unsigned int constantCount;
+	};
+
+	struct UploadStats
+	{
+		size_t capacity;
+		// what the frame being filled has pushed so far
+		size_t usedBytes;
+		size_t peakBytes;
+		unsigned int records;
+		// records pinned in front of every frame's, part of usedBytes
+		size_t pinnedBytes;
+		// times a frame didn't fit and the staging memory grew
+		unsigned int growths;
+	};
+
+	// CPU staging for every constant buffer record a frame draws with. Records are pushed while the
+	// frame is recorded and the whole thing is copied to one GPU buffer with a single discard map,
+	// the driver renames that buffer every frame so it works as a ring. Draws then bind windows of
+	// it instead of mapping small constant buffers one draw at a time. Records that never change
+	// can be pushed once and pinned, every frame then starts after them and binds their windows
+	// without pushing them again. Nothing here knows about D3D.
+	class UploadRing
+	{
+	public:
+		// D3D11.1 windows start on 16 constant boundaries and cover a multiple of 16 constants
+		static constexpr size_t RECORD_ALIGNMENT = 256;
+		static constexpr size_t CONSTANT_BYTES = 16;
+
+	private:
+		std::vector<unsigned char> staging;
+		size_t used = 0;
+		size_t pinned = 0;
+		UploadStats stats = {};
+
+		static size_t AlignUp(size_t _bytes) { return (_bytes + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1); }
+
+	public:
+		void Create(size_t _bytes)
+		{
+			staging.assign(AlignUp(std::max<size_t>(_bytes, RECORD_ALIGNMENT)), 0);
+			used = 0;
+			pinned = 0;
+			stats = { staging.size(), 0, 0, 0, 0, 0 };
+		}
+
+		// Call before recording a frame, the pinned records stay where they are
+		void Reset()
+		{
+			used = pinned;
+			stats.usedBytes = used;
+			stats.records = 0;
+		}
+
+		// Keeps everything pushed so far across Reset, their windows stay valid until Create
+		void Pin()
+		{
+			pinned = used;
+			stats.pinnedBytes = pinned;
+			stats.records = 0;
+		}
+
+		template<typename T>
+		UploadWindow Push(const T& _record)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "records are copied to the GPU as bytes");
+			size_t size = AlignUp(sizeof(T));
+			if (used + size > staging.size())
+			{
+				// windows are offsets, so the frame's earlier records stay valid
+				staging.resize(AlignUp(std::max(staging.size() * 2, used + size)));
+				stats.capacity = staging.size();
+				stats.growths += 1;
+			}
+			std::memcpy(staging.data() + used, &_record, sizeof(T));
+			UploadWindow window = { static_cast<unsigned int>(used / CONSTANT_BYTES), static_cast<unsigned int>(size / CONSTANT_BYTES) };
+			used += size;
+			stats.usedBytes = used;
+			stats.peakBytes = std::max(stats.peakBytes, used);
+			stats.records += 1;
+			return window;
+		}
+
+		// The record behind _window, for backends that copy records into their own buffers
+		template<typename T>
+		const T& Read(const UploadWindow& _window) const
+		{
+			return *reinterpret_cast<const T*>(staging.data() + _window.firstConstant * CONSTANT_BYTES);
+		}
+
+		bool Contains(const UploadWindow& _window) const
+		{
+			return (_window.firstConstant + _window.constantCount) * CONSTANT_BYTES <= used;
+		}
+
+		const unsigned char* Data() const { return staging.data(); }
+		size_t Used() const { return used; }
+		size_t Capacity() const { return staging.size(); }
+		const UploadStats& GetStats() const { return stats; }
+	};
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Components/Gameplay.h"
+
+namespace GOG
+{
+	// Everything needed to replay one simulation tick and to check the replay still matches
+	struct InputLogTick
+	{
+		InputFrame input;
+		// the delta the world was progressed with
+		float deltaTime;
+		// simulation milliseconds since the previous tick
+		unsigned int simStep;
+		// Simulation::Checksum after the tick, events included
+		unsigned int checksum;
+	};
+	static_assert(sizeof(InputLogTick) == 32, "the log is written as raw fixed size records");
+
+	// Per-tick input of one gameplay session, from GameplayStart to GameplayStop. The file is a
+	// small header followed by one raw InputLogTick per simulated tick. The header is written field
+	// by field with fixed widths (32 bytes, little endian), so every compiler reads the same file.
+	class InputLog
+	{
+		struct Header
+		{
+			char magic[4];
+			unsigned int version;
+			unsigned long long seed;
+			SimTicks startNow;
+			unsigned long long tickCount;
+		};
+		static const unsigned int VERSION = 1;
+		static const size_t HEADER_BYTES = 4 + 4 + 8 + 8 + 8;
+
+		template<typename Fixed, typename T>
+		static void WriteField(std::ofstream& _file, T _value)
+		{
+			Fixed fixed = static_cast<Fixed>(_value);
+			_file.write(reinterpret_cast<const char*>(&fixed), sizeof(Fixed));
+		}
+
+		template<typename Fixed, typename T>
+		static void ReadField(std::ifstream& _file, T& _value)
+		{
+			Fixed fixed = 0;
+			_file.read(reinterpret_cast<char*>(&fixed), sizeof(Fixed));
+			_value = static_cast<T>(fixed);
+		}
+
+		Header header = {};
+		std::vector<InputLogTick> ticks;
+		SimTicks lastNow = 0;
+
+	public:
+		// Starts a new session, _startNow is the simulation time the session starts on
+		void Begin(unsigned long long _seed, SimTicks _startNow)
+		{
+			header = { { 'G', 'O', 'G', 'I' }, VERSION, _seed, _startNow, 0 };
+			ticks.clear();
+			lastNow = _startNow;
+		}
+
+		// Makes room for _ticks so appending that many doesn't allocate
+		void Reserve(size_t _ticks)
+		{
+			ticks.reserve(_ticks);
+		}
+
+		void Append(const InputFrame& _input, float _deltaTime, SimTicks _now, unsigned int _checksum)
+		{
+			ticks.push_back({ _input, _deltaTime, static_cast<unsigned int>(_now - lastNow), _checksum });
+			lastNow = _now;
+		}
+
+		bool Save(const std::string& _path)
+		{
+			std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			header.tickCount = ticks.size();
+			file.write(header.magic, sizeof(header.magic));
+			WriteField<uint32_t>(file, header.version);
+			WriteField<uint64_t>(file, header.seed);
+			WriteField<int64_t>(file, header.startNow);
+			WriteField<uint64_t>(file, header.tickCount);
+			file.write(reinterpret_cast<const char*>(ticks.data()), ticks.size() * sizeof(InputLogTick));
+			return file.good();
+		}
+
+		bool Load(const std::string& _path)
+		{
+			std::ifstream file(_path, std::ios::binary | std::ios::ate);
+			if (!file.is_open())
+				return false;
+			std::streamoff fileBytes = file.tellg();
+			file.seekg(0);
+
+			file.read(header.magic, sizeof(header.magic));
+			ReadField<uint32_t>(file, header.version);
+			ReadField<uint64_t>(file, header.seed);
+			ReadField<int64_t>(file, header.startNow);
+			ReadField<uint64_t>(file, header.tickCount);
+			if (!file || std::string(header.magic, 4) != "GOGI" || header.version != VERSION)
+				return false;
+			// a truncated or corrupt file can't claim more ticks than it holds
+			if (fileBytes < static_cast<std::streamoff>(HEADER_BYTES) ||
+				header.tickCount > static_cast<unsigned long long>(fileBytes - HEADER_BYTES) / sizeof(InputLogTick))
+				return false;
+
+			ticks.resize(header.tickCount);
+			file.read(reinterpret_cast<char*>(ticks.data()), ticks.size() * sizeof(InputLogTick));
+			return !file.fail();
+		}
+
+		unsigned long long Seed() const { return header.seed; }
+		SimTicks StartNow() const { return header.startNow; }
+		const std::vector<InputLogTick>& Ticks() const { return ticks; }
+		bool Empty() const { return ticks.empty(); }
+	};
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Frustum culling of the static level instances. Nothing here touches the GPU or gateware
+// types: matrices are 16 floats, row major with row vectors (position * matrix), the layout
+// of GW::MATH::GMATRIXF, so the headless runner can check it against brute force.
+namespace GOG
+{
+	struct CullBox
+	{
+		float center[3];
+		float extent[3];
+	};
+
+	// inside when x * px + y * py + z * pz + d >= 0
+	struct CullPlane
+	{
+		float x, y, z, d;
+	};
+
+	struct CullFrustum
+	{
+		CullPlane planes[6];
+	};
+
+	// A run of consecutive visible transforms of one instance group (a LevelData::levelInstances
+	// entry), drawn with a single instanced draw per mesh
+	struct CullRange
+	{
+		unsigned int group;
+		unsigned int transformStart;
+		unsigned int count;
+	};
+
+	enum CULL_RESULT
+	{
+		CULL_OUTSIDE = 0,
+		CULL_INTERSECTS,
+		CULL_INSIDE
+	};
+
+	inline CullBox CullBoxFromMinMax(const float* _min, const float* _max)
+	{
+		CullBox box;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			box.center[axis] = (_min[axis] + _max[axis]) * 0.5f;
+			box.extent[axis] = (_max[axis] - _min[axis]) * 0.5f;
+		}
+		return box;
+	}
+
+	// Bounds of _local once moved by _matrix, loose for rotated boxes but never too small
+	inline CullBox TransformCullBox(const CullBox& _local, const float* _matrix)
+	{
+		CullBox box;
+		for (int column = 0; column < 3; column++)
+		{
+			box.center[column] = _matrix[12 + column];
+			box.extent[column] = 0;
+			for (int row = 0; row < 3; row++)
+			{
+				box.center[column] += _local.center[row] * _matrix[row * 4 + column];
+				box.extent[column] += _local.extent[row] * std::fabs(_matrix[row * 4 + column]);
+			}
+		}
+		return box;
+	}
+
+	inline CullBox MergeCullBoxes(const CullBox& _a, const CullBox& _b)
+	{
+		float low[3], high[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			low[axis] = std::min(_a.center[axis] - _a.extent[axis], _b.center[axis] - _b.extent[axis]);
+			high[axis] = std::max(_a.center[axis] + _a.extent[axis], _b.center[axis] + _b.extent[axis]);
+		}
+		return CullBoxFromMinMax(low, high);
+	}
+
+	// The planes of a Direct3D view * projection matrix (depth from 0 to w)
+	inline CullFrustum CullFrustumFromViewProjection(const float* _viewProjection)
+	{
+		const float* m = _viewProjection;
+		// _wWeight * the w column + _sign * the _axis column
+		auto plane = [m](int _axis, float _sign, float _wWeight)
+			{
+				return CullPlane{
+					_wWeight * m[3] + _sign * m[_axis],
+					_wWeight * m[7] + _sign * m[4 + _axis],
+					_wWeight * m[11] + _sign * m[8 + _axis],
+					_wWeight * m[15] + _sign * m[12 + _axis] };
+			};
+
+		CullFrustum frustum;
+		frustum.planes[0] = plane(0, 1.0f, 1.0f);	// left, w + x
+		frustum.planes[1] = plane(0, -1.0f, 1.0f);	// right, w - x
+		frustum.planes[2] = plane(1, 1.0f, 1.0f);	// bottom, w + y
+		frustum.planes[3] = plane(1, -1.0f, 1.0f);	// top, w - y
+		frustum.planes[4] = plane(2, 1.0f, 0.0f);	// near, z
+		frustum.planes[5] = plane(2, -1.0f, 1.0f);	// far, w - z
+		return frustum;
+	}
+
+	// The frustum as seen by geometry drawn _offsetX along x, like the level segments are
+	inline CullFrustum OffsetCullFrustum(const CullFrustum& _frustum, float _offsetX)
+	{
+		CullFrustum offset = _frustum;
+		for (CullPlane& plane : offset.planes)
+			plane.d += plane.x * _offsetX;
+		return offset;
+	}
+
+	inline CULL_RESULT ClassifyCullBox(const CullFrustum& _frustum, const CullBox& _box)
+	{
+		CULL_RESULT result = CULL_INSIDE;
+		for (const CullPlane& plane : _frustum.planes)
+		{
+			float distance = plane.x * _box.center[0] + plane.y * _box.center[1] + plane.z * _box.center[2] + plane.d;
+			float radius = std::fabs(plane.x) * _box.extent[0] + std::fabs(plane.y) * _box.extent[1] + std::fabs(plane.z) * _box.extent[2];
+			if (distance + radius < 0)
+				return CULL_OUTSIDE;
+			if (distance - radius < 0)
+				result = CULL_INTERSECTS;
+		}
+		return result;
+	}
+
+	// Turns visible transform indices, ascending, into runs that don't cross an instance group.
+	// Returns how many ranges were written.
+	inline unsigned int CoalesceCullRanges(const unsigned int* _visible, unsigned int _visibleCount,
+		const unsigned int* _groups, CullRange* _outRanges)
+	{
+		unsigned int rangeCount = 0;
+		for (unsigned int i = 0; i < _visibleCount; i++)
+		{
+			unsigned int transform = _visible[i];
+			if (rangeCount > 0)
+			{
+				CullRange& last = _outRanges[rangeCount - 1];
+				if (last.group == _groups[transform] && last.transformStart + last.count == transform)
+				{
+					last.count += 1;
+					continue;
+				}
+			}
+			_outRanges[rangeCount++] = { _groups[transform], transform, 1 };
+		}
+		return rangeCount;
+	}
+
+	// Tests every instance on its own, the reference the BVH is checked against
+	inline unsigned int CullInstancesBruteForce(const CullFrustum& _frustum, const CullBox* _bounds,
+		const unsigned int* _groups, unsigned int _count, unsigned int* _scratch, CullRange* _outRanges)
+	{
+		unsigned int visibleCount = 0;
+		for (unsigned int i = 0; i < _count; i++)
+		{
+			if (ClassifyCullBox(_frustum, _bounds[i]) != CULL_OUTSIDE)
+				_scratch[visibleCount++] = i;
+		}
+		return CoalesceCullRanges(_scratch, visibleCount, _groups, _outRanges);
+	}
+
+	// Bounding volume hierarchy over instances that never move, built once when the level loads.
+	// Nodes are laid out depth first, so the left child of a node is the next node and every
+	// subtree covers a contiguous run of the instance order; a node entirely inside the frustum
+	// is taken whole without visiting its children. Culling doesn't allocate.
+	class InstanceBvh
+	{
+		static constexpr unsigned int LEAF_SIZE = 4;
+		static constexpr unsigned int MAX_DEPTH = 64;
+
+		struct Node
+		{
+			CullBox bounds;
+			// range of the instance order under this node
+			unsigned int first, count;
+			// 0 for leaves
+			unsigned int rightChild;
+		};
+
+		std::vector<Node> nodes;
+		// instance indices, grouped by node
+		std::vector<unsigned int> order;
+		std::vector<CullBox> instanceBounds;
+		std::vector<unsigned int> groups;
+		// visible instances of the last cull
+		std::vector<unsigned int> visible;
+
+		unsigned int BuildNode(unsigned int _first, unsigned int _count, unsigned int _depth)
+		{
+			unsigned int index = static_cast<unsigned int>(nodes.size());
+			nodes.push_back({ instanceBounds[order[_first]], _first, _count, 0 });
+
+			float centerLow[3], centerHigh[3];
+			for (int axis = 0; axis < 3; axis++)
+				centerLow[axis] = centerHigh[axis] = instanceBounds[order[_first]].center[axis];
+			for (unsigned int i = _first + 1; i < _first + _count; i++)
+			{
+				const CullBox& box = instanceBounds[order[i]];
+				nodes[index].bounds = MergeCullBoxes(nodes[index].bounds, box);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					centerLow[axis] = std::min(centerLow[axis], box.center[axis]);
+					centerHigh[axis] = std::max(centerHigh[axis], box.center[axis]);
+				}
+			}
+			if (_count <= LEAF_SIZE || _depth + 1 >= MAX_DEPTH)
+				return index;
+
+			// median split on the axis the centers spread furthest along
+			int axis = 0;
+			for (int i = 1; i < 3; i++)
+			{
+				if (centerHigh[i] - centerLow[i] > centerHigh[axis] - centerLow[axis])
+					axis = i;
+			}
+			unsigned int half = _count / 2;
+			std::nth_element(order.begin() + _first, order.begin() + _first + half, order.begin() + _first + _count,
+				[this, axis](unsigned int _a, unsigned int _b)
+				{
+					return instanceBounds[_a].center[axis] < instanceBounds[_b].center[axis];
+				});
+
+			BuildNode(_first, half, _depth + 1);
+			unsigned int right = BuildNode(_first + half, _count - half, _depth + 1);
+			nodes[index].rightChild = right;
+			return index;
+		}
+
+		void TakeAll(const Node& _node, unsigned int& _visibleCount)
+		{
+			for (unsigned int i = _node.first; i < _node.first + _node.count; i++)
+				visible[_visibleCount++] = order[i];
+		}
+
+	public:
+		// _groups holds the instance group of every instance, instances of a group must be consecutive
+		void Build(const CullBox* _bounds, const unsigned int* _groups, unsigned int _count)
+		{
+			instanceBounds.assign(_bounds, _bounds + _count);
+			groups.assign(_groups, _groups + _count);
+			order.resize(_count);
+			for (unsigned int i = 0; i < _count; i++)
+				order[i] = i;
+			visible.assign(_count, 0);
+			nodes.clear();
+			nodes.reserve(_count > 0 ? 2 * _count : 0);
+			if (_count > 0)
+				BuildNode(0, _count, 0);
+		}
+
+		void Clear()
+		{
+			nodes.clear();
+			order.clear();
+			instanceBounds.clear();
+			groups.clear();
+			visible.clear();
+		}
+
+		// Writes the visible instances as ranges in ascending order to _outRanges, which needs room
+		// for InstanceCount() ranges. Returns how many ranges were written.
+		unsigned int Cull(const CullFrustum& _frustum, CullRange* _outRanges)
+		{
+			if (nodes.empty())
+				return 0;
+
+			unsigned int visibleCount = 0;
+			// a right child waits on the stack for every level above the node being visited
+			unsigned int stack[MAX_DEPTH + 1];
+			unsigned int stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0)
+			{
+				const Node& node = nodes[stack[--stackSize]];
+				CULL_RESULT result = ClassifyCullBox(_frustum, node.bounds);
+				if (result == CULL_OUTSIDE)
+					continue;
+				if (result == CULL_INSIDE)
+				{
+					TakeAll(node, visibleCount);
+					continue;
+				}
+				if (node.rightChild == 0)
+				{
+					for (unsigned int i = node.first; i < node.first + node.count; i++)
+					{
+						if (ClassifyCullBox(_frustum, instanceBounds[order[i]]) != CULL_OUTSIDE)
+							visible[visibleCount++] = order[i];
+					}
+					continue;
+				}
+				unsigned int self = static_cast<unsigned int>(&node - nodes.data());
+				stack[stackSize++] = node.rightChild;
+				stack[stackSize++] = self + 1;
+			}
+
+			std::sort(visible.begin(), visible.begin() + visibleCount);
+			return CoalesceCullRanges(visible.data(), visibleCount, groups.data(), _outRanges);
+		}
+
+		unsigned int InstanceCount() const { return static_cast<unsigned int>(order.size()); }
+		unsigned int NodeCount() const { return static_cast<unsigned int>(nodes.size()); }
+		const CullBox* InstanceBounds() const { return instanceBounds.data(); }
+		const unsigned int* Groups() const { return groups.data(); }
+	};
+}
@@ -5,6 +5,9 @@
 
 // This reads .h2b files which are optimized binary .obj+.mtl files
 #include "h2bParser.h"
+#include "Profiler.h"
+#include "RenderMetadata.h"
+#include "LevelCulling.h"
 #include <string>
 
 // * NOTE: *
@@ -47,6 +50,7 @@ public:
 	{
 		unsigned modelIndex, transformStart, transformCount, flags;
 	};
+	// albedoIndex is the GOG::TEXTURE_ID of map_Kd
 	struct MaterialTextures
 	{
 		unsigned int albedoIndex, roughnessIndex, metalIndex, normalIndex;
@@ -62,6 +66,7 @@ public:
 	std::vector<unsigned> indices;
 
 	std::vector<H2B::Material> materials;
+	// one per material
 	std::vector<MaterialTextures> textures;
 
 	// All level boundry data used by the models
@@ -74,6 +79,10 @@ public:
 	std::vector<LevelModel> levelModels;
 	std::vector<ModelInstances> levelInstances;
 	std::vector<GW::MATH::GMATRIXF> transforms;
+	// one per model, the bounds of its vertices
+	std::vector<GOG::CullBox> modelBounds;
+	// every transform in the world, grouped by levelInstances entry
+	GOG::InstanceBvh instanceBvh;
 	
 	// each item from the blender scene graph
 	std::vector<BlenderObject> blenderObjects;
@@ -86,6 +95,7 @@ public:
 					const char* _h2bFolderPath, 
 					GW::SYSTEM::GLog _log) 
 	{
+		PROFILE_ZONE("LoadLevel");
 		// What this does:
 		// Parse GameLevel.txt 
 		// For each model found in the file...
@@ -110,6 +120,8 @@ public:
 			return false;
 		}
 
+		BuildInstanceBvh();
+
 		// level loaded into CPU ram
 		_log.LogCategorized("EVENT", "GAME LEVEL WAS LOADED TO CPU [DATA ORIENTED]");
 		return true;
@@ -142,6 +154,8 @@ public:
 		transforms.clear();
 		levelInstances.clear();
 		blenderObjects.clear();
+		modelBounds.clear();
+		instanceBvh.Clear();
 	}
 
 private:
@@ -343,6 +357,24 @@ private:
 		_log.LogCategorized("MESSAGE", "Game Level File Reading Complete.");
 		return true;
 	}
+	// the level never moves, so its instances are only sorted into a hierarchy once
+	void BuildInstanceBvh()
+	{
+		PROFILE_ZONE("BuildInstanceBvh");
+		std::vector<GOG::CullBox> instanceBounds(transforms.size());
+		std::vector<unsigned int> groups(transforms.size());
+		for (unsigned int group = 0; group < levelInstances.size(); group++)
+		{
+			const ModelInstances& instances = levelInstances[group];
+			for (unsigned int i = instances.transformStart; i < instances.transformStart + instances.transformCount; i++)
+			{
+				instanceBounds[i] = GOG::TransformCullBox(modelBounds[instances.modelIndex], transforms[i].data);
+				groups[i] = group;
+			}
+		}
+		instanceBvh.Build(instanceBounds.data(), groups.data(), static_cast<unsigned int>(transforms.size()));
+	}
+
 	// internal helper for collecting all .h2b data into unified arrays
 	bool ReadAndCombineH2Bs(const char* _h2bFolderPath, 
 							const std::set<TempModelEntry>& _modelSet,
@@ -406,10 +438,27 @@ private:
 					model.texId = 0;
 				}
 
+				float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+				float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+				for (const H2B::Vertex& vertex : parser.vertices)
+				{
+					const float position[3] = { vertex.pos.x, vertex.pos.y, vertex.pos.z };
+					for (int axis = 0; axis < 3; axis++)
+					{
+						low[axis] = std::min(low[axis], position[axis]);
+						high[axis] = std::max(high[axis], position[axis]);
+					}
+				}
+				if (parser.vertices.empty())
+					low[0] = low[1] = low[2] = high[0] = high[1] = high[2] = 0;
+				modelBounds.push_back(GOG::CullBoxFromMinMax(low, high));
+
 				// append/move all data
 				vertices.insert(vertices.end(), parser.vertices.begin(), parser.vertices.end());
 				indices.insert(indices.end(), parser.indices.begin(), parser.indices.end());
 				materials.insert(materials.end(), parser.materials.begin(), parser.materials.end());
+				for (const H2B::Material& material : parser.materials)
+					textures.push_back({ GOG::TextureIdFromMap(material.mapKd, textures.empty() ? GOG::TEXTURE_NONE : textures.back().albedoIndex), 0, 0, 0 });
 				levelBatches.insert(levelBatches.end(), parser.batches.begin(), parser.batches.end());
 				levelMeshes.insert(levelMeshes.end(), parser.meshes.begin(), parser.meshes.end());
 				// *NEW* add overall collision volume(OBB) for this model and it's submeshes 
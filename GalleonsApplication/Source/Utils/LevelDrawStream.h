@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "LevelData.h"
+#include "LevelCulling.h"
+
+namespace GOG
+{
+	struct LevelStreamSettings
+	{
+		// pre-transform small meshes into combined batches, one per material and cell
+		bool merge;
+		// models with at most this many indices are small enough to merge
+		unsigned int mergeMaxIndices;
+		// the batches' width along x, so the segment copies can still cull them
+		float mergeCellWidth;
+	};
+
+	struct LevelStreamStats
+	{
+		unsigned int groups;
+		unsigned int draws;
+		unsigned int materials;
+		// level instances drawn from batches instead of their own draws
+		unsigned int mergedInstances;
+		unsigned int mergedBatches;
+		size_t vertices;
+		size_t mergedVertices;
+	};
+
+	// The level's draws worked out once when it loads: every model's index ranges and vertex bases
+	// with the material each one shades with, and the materials themselves with duplicates folded
+	// together. A frame only culls the instances and replays the draws of the visible ones (see
+	// RecordLevelDraws in FrameDraws.h), it never walks the level's models, meshes and materials.
+	// The stream owns the level's vertices, indices and transforms the renderer uploads, those of
+	// the merged batches appended, and draws the batches with an identity transform at the end.
+	class LevelDrawStream
+	{
+	public:
+		struct Draw
+		{
+			unsigned int indexCount;
+			unsigned int startIndex;
+			int baseVertex;
+			// into Materials()
+			unsigned int material;
+		};
+
+		// the draws of one LevelData::levelInstances entry, none when its model was merged
+		struct DrawSpan
+		{
+			unsigned int firstDraw;
+			unsigned int drawCount;
+		};
+
+		// merged meshes of one material in one cell, one draw of a single instance
+		struct Batch
+		{
+			CullBox bounds;
+			unsigned int draw;
+			// the level instances it stands in for
+			unsigned int instanceCount;
+		};
+
+		struct Material
+		{
+			H2B::Attributes attribute;
+			unsigned int texID;
+		};
+
+	private:
+		std::vector<DrawSpan> groups;
+		std::vector<Draw> draws;
+		std::vector<Material> materials;
+		std::vector<Batch> batches;
+		std::vector<H2B::Vertex> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<GW::MATH::GMATRIXF> transforms;
+		unsigned int identityTransform = 0;
+		LevelStreamStats stats = {};
+
+		unsigned int FindMaterial(const H2B::Attributes& _attribute, unsigned int _texID)
+		{
+			for (unsigned int i = 0; i < materials.size(); i++)
+			{
+				if (materials[i].texID == _texID && std::memcmp(&materials[i].attribute, &_attribute, sizeof(H2B::Attributes)) == 0)
+					return i;
+			}
+			materials.push_back({ _attribute, _texID });
+			return static_cast<unsigned int>(materials.size() - 1);
+		}
+
+		// _vertex moved by the row major _matrix the way VSLevelShader moves it
+		static H2B::Vertex TransformVertex(const H2B::Vertex& _vertex, const float* _matrix)
+		{
+			const float* pos = &_vertex.pos.x;
+			const float* nrm = &_vertex.nrm.x;
+			H2B::Vertex moved = _vertex;
+			float* outPos = &moved.pos.x;
+			float* outNrm = &moved.nrm.x;
+			for (int column = 0; column < 3; column++)
+			{
+				outPos[column] = _matrix[12 + column];
+				outNrm[column] = 0;
+				for (int row = 0; row < 3; row++)
+				{
+					outPos[column] += pos[row] * _matrix[row * 4 + column];
+					outNrm[column] += nrm[row] * _matrix[row * 4 + column];
+				}
+			}
+			float length = std::sqrt(outNrm[0] * outNrm[0] + outNrm[1] * outNrm[1] + outNrm[2] * outNrm[2]);
+			if (length > 0)
+			{
+				for (int axis = 0; axis < 3; axis++)
+					outNrm[axis] /= length;
+			}
+			return moved;
+		}
+
+	public:
+		void Bake(const LevelData& _level, const LevelStreamSettings& _settings)
+		{
+			PROFILE_ZONE("BakeLevelStream");
+			groups.assign(_level.levelInstances.size(), DrawSpan{ 0, 0 });
+			draws.clear();
+			materials.clear();
+			batches.clear();
+			vertices = _level.vertices;
+			indices = _level.indices;
+			transforms = _level.transforms;
+			identityTransform = static_cast<unsigned int>(transforms.size());
+			transforms.push_back(GW::MATH::GIdentityMatrixF);
+			stats = {};
+
+			// every model's draws once, however many instance groups use it
+			std::vector<DrawSpan> modelDraws(_level.levelModels.size());
+			std::vector<bool> modelMerged(_level.levelModels.size());
+			for (unsigned int m = 0; m < _level.levelModels.size(); m++)
+			{
+				const LevelData::LevelModel& model = _level.levelModels[m];
+				modelMerged[m] = _settings.merge && _settings.mergeCellWidth > 0 && model.indexCount <= _settings.mergeMaxIndices;
+				modelDraws[m] = { static_cast<unsigned int>(draws.size()), modelMerged[m] ? 0 : model.meshCount };
+				if (modelMerged[m])
+					continue;
+				for (unsigned int msh = 0; msh < model.meshCount; msh++)
+				{
+					const H2B::Mesh& mesh = _level.levelMeshes[msh + model.meshStart];
+					unsigned int material = FindMaterial(_level.materials[msh + model.materialStart].attrib,
+						_level.textures[msh + model.materialStart].albedoIndex);
+					draws.push_back({ mesh.drawInfo.indexCount, mesh.drawInfo.indexOffset + model.indexStart,
+						static_cast<int>(model.vertexStart), material });
+				}
+			}
+
+			// the merged models' meshes by material and cell, in that order so batches sharing a
+			// material are drawn one after another
+			struct MergedMesh
+			{
+				unsigned int transform;
+				unsigned int model;
+				unsigned int mesh;
+			};
+			std::map<std::pair<unsigned int, int>, std::vector<MergedMesh>> cells;
+			for (unsigned int group = 0; group < _level.levelInstances.size(); group++)
+			{
+				const LevelData::ModelInstances& instances = _level.levelInstances[group];
+				groups[group] = modelDraws[instances.modelIndex];
+				if (modelMerged[instances.modelIndex] == false)
+					continue;
+				const LevelData::LevelModel& model = _level.levelModels[instances.modelIndex];
+				for (unsigned int t = instances.transformStart; t < instances.transformStart + instances.transformCount; t++)
+				{
+					CullBox bounds = TransformCullBox(_level.modelBounds[instances.modelIndex], _level.transforms[t].data);
+					int cell = static_cast<int>(std::floor(bounds.center[0] / _settings.mergeCellWidth));
+					for (unsigned int msh = 0; msh < model.meshCount; msh++)
+					{
+						unsigned int material = FindMaterial(_level.materials[msh + model.materialStart].attrib,
+							_level.textures[msh + model.materialStart].albedoIndex);
+						cells[{ material, cell }].push_back({ t, instances.modelIndex, msh });
+					}
+					stats.mergedInstances += 1;
+				}
+			}
+
+			for (const auto& cell : cells)
+			{
+				Batch batch = { {}, static_cast<unsigned int>(draws.size()), 0 };
+				unsigned int vertexStart = static_cast<unsigned int>(vertices.size());
+				unsigned int indexStart = static_cast<unsigned int>(indices.size());
+				unsigned int lastTransform = ~0u;
+				unsigned int instanceBase = 0;
+				for (const MergedMesh& merged : cell.second)
+				{
+					const LevelData::LevelModel& model = _level.levelModels[merged.model];
+					const float* matrix = _level.transforms[merged.transform].data;
+					// meshes of one instance share its vertices
+					if (merged.transform != lastTransform)
+					{
+						CullBox bounds = TransformCullBox(_level.modelBounds[merged.model], matrix);
+						batch.bounds = batch.instanceCount == 0 ? bounds : MergeCullBoxes(batch.bounds, bounds);
+						batch.instanceCount += 1;
+						lastTransform = merged.transform;
+						instanceBase = static_cast<unsigned int>(vertices.size()) - vertexStart;
+						for (unsigned int v = 0; v < model.vertexCount; v++)
+							vertices.push_back(TransformVertex(_level.vertices[v + model.vertexStart], matrix));
+					}
+					const H2B::Mesh& mesh = _level.levelMeshes[merged.mesh + model.meshStart];
+					for (unsigned int i = 0; i < mesh.drawInfo.indexCount; i++)
+						indices.push_back(_level.indices[i + mesh.drawInfo.indexOffset + model.indexStart] + instanceBase);
+				}
+				draws.push_back({ static_cast<unsigned int>(indices.size()) - indexStart, indexStart,
+					static_cast<int>(vertexStart), cell.first.first });
+				batches.push_back(batch);
+			}
+
+			stats.groups = static_cast<unsigned int>(groups.size());
+			stats.draws = static_cast<unsigned int>(draws.size());
+			stats.materials = static_cast<unsigned int>(materials.size());
+			stats.mergedBatches = static_cast<unsigned int>(batches.size());
+			stats.vertices = vertices.size();
+			stats.mergedVertices = vertices.size() - _level.vertices.size();
+		}
+
+		// one per LevelData::levelInstances entry, the BVH's range groups
+		const std::vector<DrawSpan>& Groups() const { return groups; }
+		const std::vector<Draw>& Draws() const { return draws; }
+		const std::vector<Material>& Materials() const { return materials; }
+		const std::vector<Batch>& Batches() const { return batches; }
+		const std::vector<H2B::Vertex>& Vertices() const { return vertices; }
+		const std::vector<unsigned int>& Indices() const { return indices; }
+		const std::vector<GW::MATH::GMATRIXF>& Transforms() const { return transforms; }
+		unsigned int IdentityTransform() const { return identityTransform; }
+		const LevelStreamStats& GetStats() const { return stats; }
+	};
+}
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// SSE2 is always there on x64, GALLEONS_NO_SIMD builds the scalar path to compare against
+#if !defined(GALLEONS_NO_SIMD) && (defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__))
+#define LIGHT_BINNING_SSE2
+#include <emmintrin.h>
+#endif
+
+// Screen tile binning of the level's lights, so the scene pixel shader only loops over the
+// lights that can reach its tile. Like LevelCulling.h nothing here touches the GPU or gateware
+// types: matrices are 16 floats, row major with row vectors, the layout of GW::MATH::GMATRIXF.
+namespace GOG
+{
+	// lightPos.w of the shader's LIGHT
+	enum LIGHT_BIN_TYPE
+	{
+		LIGHT_BIN_POINT = 1,
+		LIGHT_BIN_SPOT = 2
+	};
+
+	// The camera the bins are built for
+	struct LightBinCamera
+	{
+		// world to view
+		float view[16];
+		// projection[0][0] and [1][1]; a Direct3D left handed projection, view z is w
+		float scaleX, scaleY;
+		float nearZ;
+		// of the render target, in pixels
+		float width, height;
+	};
+
+	// A light's tiles, inclusive. Empty when min > max.
+	struct LightTileRect
+	{
+		int minX, maxX, minY, maxY;
+	};
+
+	struct LightBinStats
+	{
+		unsigned int lights;
+		// lights in at least one tile
+		unsigned int visible;
+		unsigned int tiles;
+		unsigned int indices;
+		unsigned int maxPerTile;
+	};
+
+	// Tiles of _tileSize pixels covering a _width by _height target, row by row
+	inline unsigned int LightTileCount(unsigned int _width, unsigned int _height, unsigned int _tileSize, unsigned int& _tilesX, unsigned int& _tilesY)
+	{
+		_tilesX = std::max((_width + _tileSize - 1) / _tileSize, 1u);
+		_tilesY = std::max((_height + _tileSize - 1) / _tileSize, 1u);
+		return _tilesX * _tilesY;
+	}
+
+	// The tiles a view space sphere can cover, from the projection of its view space box; x / z
+	// is largest at a corner of the box, so the rect is never too small. Spheres crossing the near
+	// plane cover the screen, _radius below 0 reaches everywhere (spot lights, which the shader
+	// doesn't limit by distance). The SIMD path does the same operations in the same order.
+	inline LightTileRect ViewSphereTileRect(float _x, float _y, float _z, float _radius, const LightBinCamera& _camera,
+		float _tileScale, int _tilesX, int _tilesY)
+	{
+		const LightTileRect empty = { _tilesX, -1, _tilesY, -1 };
+		const LightTileRect everywhere = { 0, _tilesX - 1, 0, _tilesY - 1 };
+		if (_radius < 0)
+			return everywhere;
+		float nearZ = _z - _radius;
+		float farZ = _z + _radius;
+		if (farZ <= _camera.nearZ)
+			return empty;
+		if (nearZ <= _camera.nearZ)
+			return everywhere;
+
+		float right = _x + _radius;
+		float left = _x - _radius;
+		float top = _y + _radius;
+		float bottom = _y - _radius;
+		float ndcRight = _camera.scaleX * right / (right > 0 ? nearZ : farZ);
+		float ndcLeft = _camera.scaleX * left / (left < 0 ? nearZ : farZ);
+		float ndcTop = _camera.scaleY * top / (top > 0 ? nearZ : farZ);
+		float ndcBottom = _camera.scaleY * bottom / (bottom < 0 ? nearZ : farZ);
+		if (ndcRight < -1 || ndcLeft > 1 || ndcTop < -1 || ndcBottom > 1)
+			return empty;
+
+		// pixels, y down
+		float halfWidth = _camera.width * 0.5f;
+		float halfHeight = _camera.height * 0.5f;
+		float lastX = static_cast<float>(_tilesX - 1);
+		float lastY = static_cast<float>(_tilesY - 1);
+		LightTileRect rect;
+		rect.minX = static_cast<int>(std::min(std::max((ndcLeft * halfWidth + halfWidth) * _tileScale, 0.0f), lastX));
+		rect.maxX = static_cast<int>(std::min(std::max((ndcRight * halfWidth + halfWidth) * _tileScale, 0.0f), lastX));
+		rect.minY = static_cast<int>(std::min(std::max((halfHeight - ndcTop * halfHeight) * _tileScale, 0.0f), lastY));
+		rect.maxY = static_cast<int>(std::min(std::max((halfHeight - ndcBottom * halfHeight) * _tileScale, 0.0f), lastY));
+		return rect;
+	}
+
+	// The lights of a level binned into square screen tiles every frame. Lights don't move, their
+	// world positions are kept once and moved to view space per frame four at a time, then every
+	// tile row picks the lights overlapping it and every tile of the row the ones overlapping it,
+	// again four at a time. The tile ranges and the light indices are one array, uploaded as is.
+	// Binning only allocates when a frame needs more indices than any frame before.
+	class LightBins
+	{
+		// world position and reach (below 0 for everywhere) of every light the shader lights with
+		std::vector<float> worldX, worldY, worldZ, reach;
+		// each one's index in the level's lights, what the shader reads
+		std::vector<unsigned int> lightIndices;
+		unsigned int lightCount = 0;
+
+		// the last frame's tiles of every light
+		std::vector<int> minTileX, maxTileX, minTileY, maxTileY;
+		// lights overlapping the current row and their columns, padded to a multiple of four
+		std::vector<unsigned int> rowLights;
+		std::vector<int> rowMinX, rowMaxX;
+
+		std::vector<unsigned int> data;
+		unsigned int tileSize = 16;
+		unsigned int tilesX = 1, tilesY = 1;
+		LightBinStats stats = {};
+
+		static unsigned int Padded(unsigned int _count) { return (_count + 3) & ~3u; }
+
+		void ComputeRects(const LightBinCamera& _camera)
+		{
+			const float* v = _camera.view;
+			float tileScale = 1.0f / static_cast<float>(tileSize);
+			int lastX = static_cast<int>(tilesX), lastY = static_cast<int>(tilesY);
+			unsigned int i = 0;
+#ifdef LIGHT_BINNING_SSE2
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 minusOne = _mm_set1_ps(-1.0f);
+			const __m128 nearPlane = _mm_set1_ps(_camera.nearZ);
+			const __m128 scaleX = _mm_set1_ps(_camera.scaleX);
+			const __m128 scaleY = _mm_set1_ps(_camera.scaleY);
+			const __m128 halfWidth = _mm_set1_ps(_camera.width * 0.5f);
+			const __m128 halfHeight = _mm_set1_ps(_camera.height * 0.5f);
+			const __m128 scale = _mm_set1_ps(tileScale);
+			const __m128 lastTileX = _mm_set1_ps(static_cast<float>(lastX - 1));
+			const __m128 lastTileY = _mm_set1_ps(static_cast<float>(lastY - 1));
+			const __m128i emptyMinX = _mm_set1_epi32(lastX), emptyMinY = _mm_set1_epi32(lastY);
+			const __m128i emptyMax = _mm_set1_epi32(-1);
+			const __m128i fullMaxX = _mm_set1_epi32(lastX - 1), fullMaxY = _mm_set1_epi32(lastY - 1);
+			// picks _a where _mask is set
+			auto select = [](__m128 _mask, __m128 _a, __m128 _b) { return _mm_or_ps(_mm_and_ps(_mask, _a), _mm_andnot_ps(_mask, _b)); };
+			auto selectInt = [](__m128i _mask, __m128i _a, __m128i _b) { return _mm_or_si128(_mm_and_si128(_mask, _a), _mm_andnot_si128(_mask, _b)); };
+			auto tile = [&](__m128 _pixels, __m128 _last) { return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_pixels, scale), zero), _last)); };
+			auto viewAxis = [&](__m128 _x, __m128 _y, __m128 _z, int _axis)
+				{
+					return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_x, _mm_set1_ps(v[_axis])), _mm_mul_ps(_y, _mm_set1_ps(v[4 + _axis]))),
+						_mm_mul_ps(_z, _mm_set1_ps(v[8 + _axis]))), _mm_set1_ps(v[12 + _axis]));
+				};
+
+			for (; i + 4 <= lightCount; i += 4)
+			{
+				__m128 wx = _mm_loadu_ps(&worldX[i]), wy = _mm_loadu_ps(&worldY[i]), wz = _mm_loadu_ps(&worldZ[i]);
+				__m128 radius = _mm_loadu_ps(&reach[i]);
+				__m128 x = viewAxis(wx, wy, wz, 0), y = viewAxis(wx, wy, wz, 1), z = viewAxis(wx, wy, wz, 2);
+
+				__m128 nearZ = _mm_sub_ps(z, radius);
+				__m128 farZ = _mm_add_ps(z, radius);
+				__m128 right = _mm_add_ps(x, radius), left = _mm_sub_ps(x, radius);
+				__m128 top = _mm_add_ps(y, radius), bottom = _mm_sub_ps(y, radius);
+				__m128 ndcRight = _mm_div_ps(_mm_mul_ps(scaleX, right), select(_mm_cmpgt_ps(right, zero), nearZ, farZ));
+				__m128 ndcLeft = _mm_div_ps(_mm_mul_ps(scaleX, left), select(_mm_cmplt_ps(left, zero), nearZ, farZ));
+				__m128 ndcTop = _mm_div_ps(_mm_mul_ps(scaleY, top), select(_mm_cmpgt_ps(top, zero), nearZ, farZ));
+				__m128 ndcBottom = _mm_div_ps(_mm_mul_ps(scaleY, bottom), select(_mm_cmplt_ps(bottom, zero), nearZ, farZ));
+
+				__m128i minX = tile(_mm_add_ps(_mm_mul_ps(ndcLeft, halfWidth), halfWidth), lastTileX);
+				__m128i maxX = tile(_mm_add_ps(_mm_mul_ps(ndcRight, halfWidth), halfWidth), lastTileX);
+				__m128i minY = tile(_mm_sub_ps(halfHeight, _mm_mul_ps(ndcTop, halfHeight)), lastTileY);
+				__m128i maxY = tile(_mm_sub_ps(halfHeight, _mm_mul_ps(ndcBottom, halfHeight)), lastTileY);
+
+				// the same early outs as ViewSphereTileRect, in reverse so the first one wins
+				__m128 offScreen = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(ndcRight, minusOne), _mm_cmpgt_ps(ndcLeft, one)),
+					_mm_or_ps(_mm_cmplt_ps(ndcTop, minusOne), _mm_cmpgt_ps(ndcBottom, one)));
+				__m128i empty = _mm_castps_si128(offScreen);
+				__m128i full = _mm_castps_si128(_mm_cmple_ps(nearZ, nearPlane));
+				__m128i behind = _mm_castps_si128(_mm_cmple_ps(farZ, nearPlane));
+				__m128i everywhere = _mm_castps_si128(_mm_cmplt_ps(radius, zero));
+				empty = _mm_andnot_si128(full, empty);
+				empty = _mm_or_si128(_mm_andnot_si128(everywhere, behind), empty);
+				full = _mm_or_si128(everywhere, _mm_andnot_si128(behind, full));
+
+				minX = selectInt(full, _mm_setzero_si128(), selectInt(empty, emptyMinX, minX));
+				maxX = selectInt(full, fullMaxX, selectInt(empty, emptyMax, maxX));
+				minY = selectInt(full, _mm_setzero_si128(), selectInt(empty, emptyMinY, minY));
+				maxY = selectInt(full, fullMaxY, selectInt(empty, emptyMax, maxY));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&minTileX[i]), minX);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&maxTileX[i]), maxX);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&minTileY[i]), minY);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&maxTileY[i]), maxY);
+			}
+#endif
+			for (; i < lightCount; i++)
+			{
+				float x = worldX[i] * v[0] + worldY[i] * v[4] + worldZ[i] * v[8] + v[12];
+				float y = worldX[i] * v[1] + worldY[i] * v[5] + worldZ[i] * v[9] + v[13];
+				float z = worldX[i] * v[2] + worldY[i] * v[6] + worldZ[i] * v[10] + v[14];
+				LightTileRect rect = ViewSphereTileRect(x, y, z, reach[i], _camera, tileScale, lastX, lastY);
+				minTileX[i] = rect.minX;
+				maxTileX[i] = rect.maxX;
+				minTileY[i] = rect.minY;
+				maxTileY[i] = rect.maxY;
+			}
+		}
+
+		// the lights overlapping tile row _row, with their columns
+		unsigned int GatherRow(int _row)
+		{
+			unsigned int count = 0;
+			unsigned int i = 0;
+#ifdef LIGHT_BINNING_SSE2
+			const __m128i row = _mm_set1_epi32(_row);
+			for (; i + 4 <= lightCount; i += 4)
+			{
+				__m128i below = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&minTileY[i])), row);
+				__m128i above = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&maxTileY[i])), row);
+				int hits = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(below, above))) & 0xf;
+				for (; hits != 0; hits &= hits - 1)
+				{
+					unsigned int light = i + (hits & 1 ? 0 : hits & 2 ? 1 : hits & 4 ? 2 : 3);
+					rowLights[count] = light;
+					rowMinX[count] = minTileX[light];
+					rowMaxX[count] = maxTileX[light];
+					count += 1;
+				}
+			}
+#endif
+			for (; i < lightCount; i++)
+			{
+				if (minTileY[i] <= _row && maxTileY[i] >= _row)
+				{
+					rowLights[count] = i;
+					rowMinX[count] = minTileX[i];
+					rowMaxX[count] = maxTileX[i];
+					count += 1;
+				}
+			}
+			// the padding never overlaps a column
+			for (unsigned int pad = count; pad < Padded(count); pad++)
+			{
+				rowMinX[pad] = static_cast<int>(tilesX);
+				rowMaxX[pad] = -1;
+			}
+			return count;
+		}
+
+	public:
+		// _tileSize in pixels
+		void Create(unsigned int _tileSize)
+		{
+			tileSize = std::max(_tileSize, 1u);
+			SetLights(0);
+		}
+
+		// Room for _count lights, all reaching nothing until SetLight
+		void SetLights(unsigned int _count)
+		{
+			lightCount = 0;
+			unsigned int padded = Padded(_count);
+			worldX.assign(padded, 0);
+			worldY.assign(padded, 0);
+			worldZ.assign(padded, 0);
+			reach.assign(padded, 0);
+			lightIndices.assign(padded, 0);
+			for (std::vector<int>* tiles : { &minTileX, &maxTileX, &minTileY, &maxTileY, &rowMinX, &rowMaxX })
+				tiles->assign(padded, 0);
+			rowLights.assign(padded, 0);
+		}
+
+		// _position is the light's world position, _type and _radius its lightPos.w and lightRad.
+		// Returns false for the types the shader doesn't light with, which are left out.
+		bool SetLight(unsigned int _index, const float* _position, float _type, float _radius)
+		{
+			// the shader lights points within radius + 1 and spots everywhere
+			float lightReach;
+			if (_type == LIGHT_BIN_POINT)
+				lightReach = std::max(_radius + 1, 0.0f);
+			else if (_type == LIGHT_BIN_SPOT)
+				lightReach = -1;
+			else
+				return false;
+
+			unsigned int slot = lightCount++;
+			worldX[slot] = _position[0];
+			worldY[slot] = _position[1];
+			worldZ[slot] = _position[2];
+			reach[slot] = lightReach;
+			lightIndices[slot] = _index;
+			return true;
+		}
+
+		void Bin(const LightBinCamera& _camera)
+		{
+			unsigned int width = static_cast<unsigned int>(std::max(_camera.width, 1.0f));
+			unsigned int height = static_cast<unsigned int>(std::max(_camera.height, 1.0f));
+			unsigned int tileCount = LightTileCount(width, height, tileSize, tilesX, tilesY);
+			data.resize(tileCount * 2);
+			stats = {};
+			stats.lights = lightCount;
+			stats.tiles = tileCount;
+			ComputeRects(_camera);
+			for (unsigned int i = 0; i < lightCount; i++)
+				stats.visible += minTileX[i] <= maxTileX[i] && minTileY[i] <= maxTileY[i];
+
+			for (unsigned int ty = 0; ty < tilesY; ty++)
+			{
+				unsigned int rowCount = GatherRow(static_cast<int>(ty));
+				for (unsigned int tx = 0; tx < tilesX; tx++)
+				{
+					unsigned int first = static_cast<unsigned int>(data.size());
+#ifdef LIGHT_BINNING_SSE2
+					const __m128i column = _mm_set1_epi32(static_cast<int>(tx));
+					for (unsigned int i = 0; i < rowCount; i += 4)
+					{
+						__m128i right = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&rowMinX[i])), column);
+						__m128i left = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&rowMaxX[i])), column);
+						int hits = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(right, left))) & 0xf;
+						for (; hits != 0; hits &= hits - 1)
+							data.push_back(lightIndices[rowLights[i + (hits & 1 ? 0 : hits & 2 ? 1 : hits & 4 ? 2 : 3)]]);
+					}
+#else
+					for (unsigned int i = 0; i < rowCount; i++)
+					{
+						if (rowMinX[i] <= static_cast<int>(tx) && rowMaxX[i] >= static_cast<int>(tx))
+							data.push_back(lightIndices[rowLights[i]]);
+					}
+#endif
+					unsigned int tile = ty * tilesX + tx;
+					data[tile * 2] = first;
+					data[tile * 2 + 1] = static_cast<unsigned int>(data.size()) - first;
+					stats.maxPerTile = std::max(stats.maxPerTile, data[tile * 2 + 1]);
+				}
+			}
+			stats.indices = static_cast<unsigned int>(data.size()) - tileCount * 2;
+		}
+
+		// The reference Bin is checked against, into _data in the layout Bin writes. Builds every
+		// tile's view space frustum, its four sides through the eye clipped to the screen plus the
+		// near plane, and keeps the lights whose sphere is inside or touching all five planes.
+		// Shares nothing with Bin but the view transform, so Bin has to list at least these
+		// lights; it can list more, its rects are the projection of each sphere's box.
+		void BinBruteForce(const LightBinCamera& _camera, std::vector<unsigned int>& _data) const
+		{
+			unsigned int width = static_cast<unsigned int>(std::max(_camera.width, 1.0f));
+			unsigned int height = static_cast<unsigned int>(std::max(_camera.height, 1.0f));
+			unsigned int countX, countY;
+			unsigned int tileCount = LightTileCount(width, height, tileSize, countX, countY);
+			const float* v = _camera.view;
+
+			// view x / z and y / z of a pixel edge, y down
+			auto slopeX = [&](unsigned int _pixel) { return (2.0f * std::min(_pixel, width) / width - 1.0f) / _camera.scaleX; };
+			auto slopeY = [&](unsigned int _pixel) { return (1.0f - 2.0f * std::min(_pixel, height) / height) / _camera.scaleY; };
+
+			_data.assign(tileCount * 2, 0);
+			for (unsigned int tile = 0; tile < tileCount; tile++)
+			{
+				unsigned int tx = tile % countX, ty = tile / countX;
+				float left = slopeX(tx * tileSize), right = slopeX((tx + 1) * tileSize);
+				float top = slopeY(ty * tileSize), bottom = slopeY((ty + 1) * tileSize);
+				float leftLength = std::sqrt(1 + left * left), rightLength = std::sqrt(1 + right * right);
+				float topLength = std::sqrt(1 + top * top), bottomLength = std::sqrt(1 + bottom * bottom);
+
+				_data[tile * 2] = static_cast<unsigned int>(_data.size());
+				for (unsigned int i = 0; i < lightCount; i++)
+				{
+					float x = worldX[i] * v[0] + worldY[i] * v[4] + worldZ[i] * v[8] + v[12];
+					float y = worldX[i] * v[1] + worldY[i] * v[5] + worldZ[i] * v[9] + v[13];
+					float z = worldX[i] * v[2] + worldY[i] * v[6] + worldZ[i] * v[10] + v[14];
+					float radius = reach[i];
+					// signed distances to each plane, positive inside the tile
+					bool touches = radius < 0 || (z + radius > _camera.nearZ &&
+						(x - left * z) / leftLength >= -radius && (right * z - x) / rightLength >= -radius &&
+						(top * z - y) / topLength >= -radius && (y - bottom * z) / bottomLength >= -radius);
+					if (touches)
+						_data.push_back(lightIndices[i]);
+				}
+				_data[tile * 2 + 1] = static_cast<unsigned int>(_data.size()) - _data[tile * 2];
+			}
+		}
+
+		// The tile ranges then the light indices: [tile * 2] is where the tile's indices start,
+		// [tile * 2 + 1] how many there are
+		const unsigned int* Data() const { return data.data(); }
+		size_t Bytes() const { return data.size() * sizeof(unsigned int); }
+		unsigned int TileSize() const { return tileSize; }
+		unsigned int TilesX() const { return tilesX; }
+		unsigned int TilesY() const { return tilesY; }
+		// the lights the shader lights with, others were left out by SetLight
+		unsigned int LightCount() const { return lightCount; }
+		const LightBinStats& GetStats() const { return stats; }
+	};
+}
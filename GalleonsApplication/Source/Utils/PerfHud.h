@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CommandBuffers.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "../MemoryTracking.h"
+#include "../Events/EventBus.h"
+#include "../Components/Identification.h"
+#include "../Components/Physics.h"
+
+namespace GOG
+{
+	// Counted by the renderer while it draws, reset at the start of every frame
+	struct RenderCounters
+	{
+		unsigned int drawCalls;
+		unsigned int mapCalls;
+		unsigned int instances;
+		// one per model with instances, each of its meshes is a single instanced draw
+		unsigned int actorBatches;
+		// level instances left after frustum culling, out of all three segment copies
+		unsigned int levelInstancesDrawn;
+		unsigned int levelInstancesTotal;
+		// the frame's constant buffer records, uploaded with one map
+		unsigned int uploadBytes;
+		unsigned int uploadCapacity;
+		unsigned int uploadRecords;
+		unsigned int transformsUsed;
+		unsigned int transformCapacity;
+		// times the actor instances grew since startup, actors past the limit this frame
+		unsigned int transformGrowths;
+		unsigned int transformOverflows;
+		// CPU time recording and submitting each 3D pass, on whichever thread ran it, and running
+		// their command lists on the render thread
+		float minimapPassMs;
+		float levelPassMs;
+		float actorPassMs;
+		float passExecuteMs;
+		// the level's lights binned to screen tiles: lights in view of all the shader lights with,
+		// indices over all tiles, the most lights a tile has, CPU time binning them
+		unsigned int lightsVisible;
+		unsigned int lightsTotal;
+		unsigned int lightBinIndices;
+		unsigned int lightsPerTileMax;
+		float lightBinMs;
+	};
+
+	// Toggleable text overlay of what a frame costs. Recording a frame is a float store and
+	// a struct copy; the text is only rebuilt every refreshFrames frames while it is shown,
+	// and flecs only times its systems while it is shown.
+	class PerfHud
+	{
+		static constexpr unsigned int FRAME_WINDOW = 240;
+		static constexpr unsigned int MAX_SYSTEM_LINES = 10;
+		static constexpr unsigned int MAX_ARCHETYPE_LINES = 8;
+		static constexpr unsigned int MAX_ALLOCATION_LINES = 6;
+
+		std::shared_ptr<flecs::world> flecsWorld;
+		unsigned int refreshFrames = 15;
+		bool visible = false;
+
+		float frameMs[FRAME_WINDOW] = {};
+		unsigned int frameCount = 0;
+		unsigned int framesSinceRefresh = 0;
+		// everything allocated since the last refresh, the HUD's own text shows up as "PerfHud"
+		FrameAllocations allocations;
+
+		// flecs keeps the running total per system, the HUD shows how much it grew per frame
+		struct SystemSample
+		{
+			std::string label;
+			ecs_system_stats_t stats;
+			double lastSeconds;
+		};
+		std::unordered_map<flecs::entity_t, std::unique_ptr<SystemSample>> systemSamples;
+		flecs::query<> systemQuery;
+		flecs::query<const WorldMatrix> actorQuery;
+
+		std::wstring text;
+
+		struct Line
+		{
+			std::string label;
+			double value;
+		};
+
+		static const char* ActorLabel(flecs::entity _entity)
+		{
+			if (_entity.has<Player>()) return "Player";
+			if (_entity.has<Lander>()) return "Lander";
+			if (_entity.has<Bomber>()) return "Bomber";
+			if (_entity.has<Baiter>()) return "Baiter";
+			if (_entity.has<Lazer>()) return "Lazer";
+			if (_entity.has<Cannonball>()) return "Cannonball";
+			if (_entity.has<Pea>()) return "Pea";
+			if (_entity.has<Trap>()) return "Trap";
+			if (_entity.has<SmartBomb>()) return "SmartBomb";
+			if (_entity.has<Civilian>()) return "Civilian";
+			if (_entity.has<Camera>()) return "Camera";
+			return "Other";
+		}
+
+		// Named systems use their name, the rest are labelled by what they match
+		std::string SystemLabel(flecs::entity _system)
+		{
+			if (_system.name().size() > 0)
+				return _system.name().c_str();
+
+			std::string label = "#" + std::to_string(_system.id());
+			const ecs_query_t* query = ecs_system_get_query(flecsWorld->c_ptr(), _system.id());
+			if (query == nullptr)
+				return label;
+			char* terms = ecs_filter_str(flecsWorld->c_ptr(), ecs_query_get_filter(query));
+			if (terms == nullptr)
+				return label;
+			label = terms;
+			ecs_os_free(terms);
+
+			for (size_t found = label.find("GOG."); found != std::string::npos; found = label.find("GOG."))
+				label.erase(found, 4);
+			if (label.size() > 32)
+				label.resize(32);
+			return label;
+		}
+
+		void SampleSystems(std::vector<Line>& _lines)
+		{
+			systemQuery.each([this, &_lines](flecs::entity _system)
+			{
+				std::unique_ptr<SystemSample>& sample = systemSamples[_system.id()];
+				if (sample == nullptr)
+				{
+					sample = std::make_unique<SystemSample>();
+					sample->label = SystemLabel(_system);
+					sample->stats = {};
+					sample->lastSeconds = 0;
+				}
+				if (ecs_system_stats_get(flecsWorld->c_ptr(), _system.id(), &sample->stats) == false)
+					return;
+
+				double seconds = sample->stats.time_spent.counter.value[sample->stats.query.t];
+				double msPerFrame = (seconds - sample->lastSeconds) * 1000.0 / framesSinceRefresh;
+				// the first sample since the HUD was shown holds everything measured before it
+				if (sample->lastSeconds > 0)
+					_lines.push_back({ sample->label, msPerFrame });
+				sample->lastSeconds = seconds;
+			});
+		}
+
+		void SampleArchetypes(std::vector<Line>& _lines)
+		{
+			actorQuery.iter([&_lines](flecs::iter& _it, const WorldMatrix*)
+			{
+				if (_it.count() == 0)
+					return;
+				std::string label = ActorLabel(_it.entity(0));
+				label += " [" + std::to_string(_it.type().count()) + " ids]";
+				_lines.push_back({ label, static_cast<double>(_it.count()) });
+			});
+		}
+
+		static void TopLines(std::vector<Line>& _lines, unsigned int _count)
+		{
+			std::sort(_lines.begin(), _lines.end(), [](const Line& _a, const Line& _b) { return _a.value > _b.value; });
+			if (_lines.size() > _count)
+				_lines.resize(_count);
+		}
+
+		void Rebuild(const RenderCounters& _render, const EventFrameStats& _events, const CommandMergeStats& _merge, const FrameArenaStats& _scratch)
+		{
+			unsigned int count = std::min(frameCount, FRAME_WINDOW);
+			float sorted[FRAME_WINDOW];
+			std::copy(frameMs, frameMs + count, sorted);
+			float minMs = *std::min_element(sorted, sorted + count);
+			float totalMs = 0;
+			for (unsigned int i = 0; i < count; i++)
+				totalMs += sorted[i];
+			float* p99 = sorted + (count - 1) * 99 / 100;
+			std::nth_element(sorted, p99, sorted + count);
+
+			const CollisionStats* collisions = flecsWorld->get<CollisionStats>();
+			unsigned int eventsPushed = 0;
+			for (unsigned int type = 0; type < PLAY_EVENT_COUNT; type++)
+				eventsPushed += _events.pushed[type];
+
+			char buffer[1024];
+			std::snprintf(buffer, sizeof(buffer),
+				"frame ms  min %.2f  avg %.2f  p99 %.2f  (%u frames)\n"
+				"draws %u  maps %u  instances %u  actor batches %u\n"
+				"level instances %u/%u  uploads %.1f/%.1f KB in %u records\n"
+				"pass ms  minimap %.2f  level %.2f  actors %.2f  execute %.2f\n"
+				"lights %u/%u in view  tile indices %u  max per tile %u  binning %.3f ms\n"
+				"colliders %u  pairs %u  hits %u\n"
+				"transforms %u/%u (%u growths, %u dropped)  event buffer %u/%u  events %u (%u coalesced, %u dropped)\n"
+				"command buffers %u (%u direct)  merge %.3f ms\n"
+				"frame arena %.1f/%.1f KB  high water %.1f KB  overflows %u\n",
+				minMs, totalMs / count, *p99, count,
+				_render.drawCalls, _render.mapCalls, _render.instances, _render.actorBatches,
+				_render.levelInstancesDrawn, _render.levelInstancesTotal,
+				_render.uploadBytes / 1024.0, _render.uploadCapacity / 1024.0, _render.uploadRecords,
+				_render.minimapPassMs, _render.levelPassMs, _render.actorPassMs, _render.passExecuteMs,
+				_render.lightsVisible, _render.lightsTotal, _render.lightBinIndices, _render.lightsPerTileMax, _render.lightBinMs,
+				collisions ? collisions->colliders : 0, collisions ? collisions->pairsTested : 0, collisions ? collisions->pairsHit : 0,
+				_render.transformsUsed, _render.transformCapacity, _render.transformGrowths, _render.transformOverflows, _events.bufferPeak, EventBus::BUFFER_CAPACITY,
+				eventsPushed, _events.coalesced, _events.dropped,
+				_merge.buffersMerged, _merge.directRecords, _merge.mergeMs,
+				_scratch.lastFrameBytes / 1024.0, _scratch.capacity / 1024.0, _scratch.highWaterBytes / 1024.0, _scratch.overflows);
+			std::string report = buffer;
+
+			std::vector<Line> lines;
+			SampleSystems(lines);
+			TopLines(lines, MAX_SYSTEM_LINES);
+			report += "\nsystem ms/frame\n";
+			for (const Line& line : lines)
+			{
+				std::snprintf(buffer, sizeof(buffer), "%7.3f  %s\n", line.value, line.label.c_str());
+				report += buffer;
+			}
+
+			lines.clear();
+			SampleArchetypes(lines);
+			TopLines(lines, MAX_ARCHETYPE_LINES);
+			report += "\nentities per archetype\n";
+			for (const Line& line : lines)
+			{
+				std::snprintf(buffer, sizeof(buffer), "%7.0f  %s\n", line.value, line.label.c_str());
+				report += buffer;
+			}
+
+			std::snprintf(buffer, sizeof(buffer), "\nallocations/frame %.1f (%.1f KB)\n",
+				static_cast<double>(allocations.Total().count) / framesSinceRefresh,
+				static_cast<double>(allocations.Total().bytes) / 1024.0 / framesSinceRefresh);
+			report += buffer;
+			for (unsigned int i = 0; i < allocations.ScopeCount() && i < MAX_ALLOCATION_LINES; i++)
+			{
+				const AllocationScopeCounters& scope = allocations.Scope(i);
+				std::snprintf(buffer, sizeof(buffer), "%7.1f  %s\n", static_cast<double>(scope.count) / framesSinceRefresh, scope.name);
+				report += buffer;
+			}
+
+			// the sprite fonts draw wide strings, everything above is plain ASCII
+			text.assign(report.begin(), report.end());
+		}
+
+	public:
+		void Init(std::shared_ptr<flecs::world> _game, unsigned int _refreshFrames, bool _visible)
+		{
+			flecsWorld = _game;
+			refreshFrames = std::max(_refreshFrames, 1u);
+			systemQuery = flecsWorld->query_builder<>().term(flecs::System).build();
+			actorQuery = flecsWorld->query<const WorldMatrix>();
+			Show(_visible);
+		}
+
+		void Show(bool _visible)
+		{
+			visible = _visible;
+			framesSinceRefresh = 0;
+			text.clear();
+			systemSamples.clear();
+			allocations.Reset();
+			ecs_measure_system_time(flecsWorld->c_ptr(), visible);
+		}
+
+		void Toggle() { Show(!visible); }
+		bool Visible() const { return visible; }
+		const std::wstring& Text() const { return text; }
+
+		// Call once a frame after the world has progressed, the events were delivered and the frame arena was swapped
+		void EndFrame(float _frameMs, const RenderCounters& _render, const EventFrameStats& _events, const CommandMergeStats& _merge,
+			const FrameArenaStats& _scratch)
+		{
+			frameMs[frameCount % FRAME_WINDOW] = _frameMs;
+			frameCount += 1;
+			if (!visible || ++framesSinceRefresh < refreshFrames)
+				return;
+			allocations.EndFrame();
+			ALLOCATION_SCOPE("PerfHud");
+			Rebuild(_render, _events, _merge, _scratch);
+			framesSinceRefresh = 0;
+		}
+
+		void Shutdown()
+		{
+			systemSamples.clear();
+			systemQuery.destruct();
+			actorQuery.destruct();
+			flecsWorld.reset();
+		}
+	};
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../MemoryTracking.h"
+
+#define PROFILE_CONCAT_INNER(_a, _b) _a##_b
+#define PROFILE_CONCAT(_a, _b) PROFILE_CONCAT_INNER(_a, _b)
+// Charges the heap allocations made in the enclosing scope to _name (MemoryTracking.h). The slot
+// is looked up once per call site, entering the scope is two thread-local stores.
+#define ALLOCATION_SCOPE(_name) static const unsigned int PROFILE_CONCAT(allocationSlot, __LINE__) = GOG::RegisterAllocationScope(_name); \
+	GOG::AllocationScope PROFILE_CONCAT(allocationScope, __LINE__)(PROFILE_CONCAT(allocationSlot, __LINE__))
+
+// Zones are compiled in with GALLEONS_PROFILE, otherwise they only name an allocation scope and
+// PROFILE_FRAME expands to nothing.
+#ifdef GALLEONS_PROFILE
+// Times the enclosing scope. _name must be a string literal, only the pointer is kept.
+#define PROFILE_ZONE(_name) ALLOCATION_SCOPE(_name); GOG::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(_name, false)
+// For per-entity system callbacks: back to back calls merge into one zone covering the system
+#define PROFILE_SYSTEM(_name) ALLOCATION_SCOPE(_name); GOG::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(_name, true)
+// Call once at the end of every frame, finishes a capture after its frame count
+#define PROFILE_FRAME() GOG::Profiler::Get().EndFrame()
+#else
+#define PROFILE_ZONE(_name) ALLOCATION_SCOPE(_name)
+#define PROFILE_SYSTEM(_name) ALLOCATION_SCOPE(_name)
+#define PROFILE_FRAME()
+#endif
+
+namespace GOG
+{
+	struct ProfileEvent
+	{
+		const char* name;
+		long long startNs;
+		long long endNs;
+	};
+
+	// Scoped-zone profiler writing Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+	// Every thread records into its own ring, so zones never lock or allocate. Nothing is
+	// recorded outside of a capture.
+	class Profiler
+	{
+		static constexpr unsigned int RING_SIZE = 1 << 16;
+		// zones closer together than this merge when both asked to (PROFILE_SYSTEM)
+		static constexpr long long COALESCE_GAP_NS = 100000;
+
+		struct ThreadRing
+		{
+			unsigned int threadIndex = 0;
+			std::unique_ptr<ProfileEvent[]> events{ new ProfileEvent[RING_SIZE] };
+			// events written since startup, the ring holds the last RING_SIZE of them
+			std::atomic<unsigned long long> written{ 0 };
+		};
+
+		std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+		// the lock only guards the ring list, taken the first time a thread records
+		std::mutex ringListLock;
+		std::vector<std::unique_ptr<ThreadRing>> rings;
+
+		std::atomic<bool> capturing{ false };
+		long long captureStartNs = 0;
+		unsigned int framesLeft = 0;
+		std::string captureFile;
+
+		ThreadRing* GetThreadRing()
+		{
+			thread_local ThreadRing* ring = nullptr;
+			if (ring == nullptr)
+			{
+				std::lock_guard<std::mutex> guard(ringListLock);
+				rings.push_back(std::make_unique<ThreadRing>());
+				ring = rings.back().get();
+				ring->threadIndex = static_cast<unsigned int>(rings.size() - 1);
+			}
+			return ring;
+		}
+
+		Profiler() = default;
+
+	public:
+#ifdef GALLEONS_PROFILE
+		static constexpr bool ENABLED = true;
+#else
+		static constexpr bool ENABLED = false;
+#endif
+
+		static Profiler& Get()
+		{
+			static Profiler instance;
+			return instance;
+		}
+
+		long long Now() const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+		}
+
+		bool IsCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+		// Records the next _frames frames and writes them to _file when the last one ends
+		void StartCapture(unsigned int _frames, const std::string& _file)
+		{
+			if (!ENABLED || _frames == 0 || IsCapturing())
+				return;
+			captureFile = _file;
+			framesLeft = _frames;
+			captureStartNs = Now();
+			capturing.store(true, std::memory_order_release);
+		}
+
+		void EndFrame()
+		{
+			if (!IsCapturing() || --framesLeft > 0)
+				return;
+			capturing.store(false, std::memory_order_release);
+			Save(captureFile);
+		}
+
+		void Record(const char* _name, long long _startNs, long long _endNs, bool _coalesce)
+		{
+			ThreadRing* ring = GetThreadRing();
+			unsigned long long written = ring->written.load(std::memory_order_relaxed);
+			if (_coalesce && written > 0)
+			{
+				ProfileEvent& last = ring->events[(written - 1) % RING_SIZE];
+				if (last.name == _name && _startNs - last.endNs < COALESCE_GAP_NS)
+				{
+					last.endNs = _endNs;
+					return;
+				}
+			}
+			ring->events[written % RING_SIZE] = { _name, _startNs, _endNs };
+			ring->written.store(written + 1, std::memory_order_release);
+		}
+
+		// Writes every zone recorded since the capture started that is still in a ring
+		bool Save(const std::string& _file)
+		{
+			std::ofstream file(_file, std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file << std::fixed << std::setprecision(3);
+			file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+			bool first = true;
+
+			std::lock_guard<std::mutex> guard(ringListLock);
+			for (const std::unique_ptr<ThreadRing>& ring : rings)
+			{
+				file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+					<< ring->threadIndex << ",\"args\":{\"name\":\""
+					<< (ring->threadIndex == 0 ? "main" : "worker " + std::to_string(ring->threadIndex)) << "\"}}";
+				first = false;
+
+				unsigned long long written = ring->written.load(std::memory_order_acquire);
+				unsigned long long oldest = written > RING_SIZE ? written - RING_SIZE : 0;
+				for (unsigned long long i = oldest; i < written; i++)
+				{
+					const ProfileEvent& event = ring->events[i % RING_SIZE];
+					if (event.startNs < captureStartNs)
+						continue;
+					// chrome trace timestamps are in microseconds, the fraction keeps the nanoseconds
+					file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadIndex
+						<< ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0 << "}";
+				}
+			}
+			file << "\n]}\n";
+			return file.good();
+		}
+	};
+
+	class ProfileZone
+	{
+		const char* name;
+		long long startNs = -1;
+		bool coalesce;
+
+	public:
+		ProfileZone(const char* _name, bool _coalesce) : name(_name), coalesce(_coalesce)
+		{
+			if (Profiler::Get().IsCapturing())
+				startNs = Profiler::Get().Now();
+		}
+
+		~ProfileZone()
+		{
+			if (startNs >= 0)
+				Profiler::Get().Record(name, startNs, Profiler::Get().Now(), coalesce);
+		}
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+	};
+}
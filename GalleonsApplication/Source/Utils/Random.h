@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+
+namespace GOG
+{
+	// Substream identifiers. Every system draws from its own stream of the world seed so
+	// adding random calls to one system never shifts the sequence another one sees.
+	enum RANDOM_STREAM
+	{
+		WAVE_SPAWN = 1,
+		BATCH_SPAWN,
+		BATCH_POSITION,
+		BAITER_MOVEMENT,
+		CIVILIAN_MOVEMENT,
+		BENCH_LAYOUT,
+		STREAM_COUNT
+	};
+
+	// PCG32 (XSH-RR output, 64 bit LCG state). 16 bytes of state, a handful of integer
+	// ops per number and no OS entropy, unlike the std::random_device + mt19937 pairs.
+	class Pcg32
+	{
+		uint64_t state = 0;
+		uint64_t increment = 1;
+
+	public:
+		Pcg32() = default;
+
+		// Each distinct _stream gives an independent sequence for the same _seed
+		Pcg32(uint64_t _seed, uint64_t _stream)
+		{
+			Seed(_seed, _stream);
+		}
+
+		void Seed(uint64_t _seed, uint64_t _stream)
+		{
+			state = 0;
+			increment = (_stream << 1u) | 1u;
+			Next();
+			state += _seed;
+			Next();
+		}
+
+		uint32_t Next()
+		{
+			uint64_t oldState = state;
+			state = oldState * 6364136223846793005ULL + increment;
+			uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+			uint32_t rot = static_cast<uint32_t>(oldState >> 59u);
+			return (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31u));
+		}
+
+		// Uniform integer in [_min, _max] (inclusive, like std::uniform_int_distribution)
+		uint32_t NextRange(uint32_t _min, uint32_t _max)
+		{
+			if (_max <= _min)
+				return _min;
+
+			uint32_t range = _max - _min + 1u;
+			if (range == 0) // full 32 bit range
+				return Next();
+
+			// Lemire's multiply-shift with rejection to stay unbiased
+			uint64_t m = static_cast<uint64_t>(Next()) * range;
+			uint32_t low = static_cast<uint32_t>(m);
+			if (low < range)
+			{
+				uint32_t threshold = (~range + 1u) % range;
+				while (low < threshold)
+				{
+					m = static_cast<uint64_t>(Next()) * range;
+					low = static_cast<uint32_t>(m);
+				}
+			}
+			return _min + static_cast<uint32_t>(m >> 32u);
+		}
+
+		// Uniform float in [0, 1)
+		float NextFloat()
+		{
+			return (Next() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// Uniform float in [_min, _max)
+		float NextFloat(float _min, float _max)
+		{
+			return _min + (_max - _min) * NextFloat();
+		}
+
+		bool NextBool()
+		{
+			return (Next() >> 31) != 0;
+		}
+	};
+
+	// Four interleaved PCG32 lanes for spawn bursts. The lanes share no state, so the
+	// fill loops have no cross-iteration dependency and the compiler can vectorize them.
+	class Pcg32x4
+	{
+		uint64_t state[4] = {};
+		uint64_t increment[4] = { 1, 1, 1, 1 };
+
+	public:
+		Pcg32x4() = default;
+
+		Pcg32x4(uint64_t _seed, uint64_t _stream)
+		{
+			Seed(_seed, _stream);
+		}
+
+		void Seed(uint64_t _seed, uint64_t _stream)
+		{
+			for (unsigned int lane = 0; lane < 4; lane++)
+			{
+				Pcg32 seeder(_seed, (_stream << 2u) | lane);
+				increment[lane] = (((_stream << 2u) | lane) << 1u) | 1u;
+				// two statements, so every compiler draws the high word first
+				uint64_t high = seeder.Next();
+				uint64_t low = seeder.Next();
+				state[lane] = (high << 32u) | low;
+			}
+		}
+
+		// Fills _out with uniform floats in [_min, _max)
+		void FillFloats(float* _out, unsigned int _count, float _min, float _max)
+		{
+			const float scale = (_max - _min) * (1.0f / 16777216.0f);
+			unsigned int i = 0;
+			for (; i + 4 <= _count; i += 4)
+			{
+				for (unsigned int lane = 0; lane < 4; lane++)
+					_out[i + lane] = _min + (Step(lane) >> 8) * scale;
+			}
+			for (unsigned int lane = 0; i < _count; i++, lane++)
+				_out[i] = _min + (Step(lane) >> 8) * scale;
+		}
+
+	private:
+		uint32_t Step(unsigned int _lane)
+		{
+			uint64_t oldState = state[_lane];
+			state[_lane] = oldState * 6364136223846793005ULL + increment[_lane];
+			uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+			uint32_t rot = static_cast<uint32_t>(oldState >> 59u);
+			return (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31u));
+		}
+	};
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <vector>
+#include "FrameUploads.h"
+
+// The handful of commands the 3D passes are submitted with. The frame composition code only
+// talks to a RenderBackend, so the same code drives the GPU in the game and a null or recording
+// backend in the headless runner.
+namespace GOG
+{
+	// Shaders, geometry, views and targets of one kind of pass, set up by the backend
+	enum RENDER_PIPELINE
+	{
+		PIPELINE_MINIMAP_MODELS = 0,
+		PIPELINE_LEVEL,
+		PIPELINE_ACTORS,
+		PIPELINE_COUNT
+	};
+
+	// Buffers the CPU writes every frame
+	enum UPLOAD_TARGET
+	{
+		// the frame's constant records, bound through UploadWindows
+		UPLOAD_CONSTANTS = 0,
+		// the structured buffer of actor transforms
+		UPLOAD_ACTOR_TRANSFORMS,
+		// the lights binned to each screen tile, read by the scene pixel shader
+		UPLOAD_LIGHT_BINS,
+		UPLOAD_TARGET_COUNT
+	};
+
+	// Constant buffer registers, the same in every shader
+	enum CONSTANT_SLOT
+	{
+		CONSTANTS_MESH = 0,
+		CONSTANTS_SCENE,
+		CONSTANTS_INSTANCE,
+		CONSTANT_SLOT_COUNT
+	};
+
+	enum SHADER_STAGE
+	{
+		STAGE_VERTEX = 1,
+		STAGE_PIXEL = 2,
+		STAGE_BOTH = STAGE_VERTEX | STAGE_PIXEL
+	};
+
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() = default;
+
+		virtual void SetPipeline(RENDER_PIPELINE _pipeline) = 0;
+		// _data has to stay valid until the frame is submitted
+		virtual void Upload(UPLOAD_TARGET _target, const void* _data, size_t _bytes) = 0;
+		// _stages is a mask of SHADER_STAGE
+		virtual void BindConstants(CONSTANT_SLOT _slot, unsigned int _stages, const UploadWindow& _window) = 0;
+		virtual void DrawIndexedInstanced(unsigned int _indexCount, unsigned int _instanceCount, unsigned int _startIndex, int _baseVertex) = 0;
+	};
+
+	// Drops everything, what is left is the cost of composing the frame
+	class NullRenderBackend : public RenderBackend
+	{
+	public:
+		void SetPipeline(RENDER_PIPELINE) override {}
+		void Upload(UPLOAD_TARGET, const void*, size_t) override {}
+		void BindConstants(CONSTANT_SLOT, unsigned int, const UploadWindow&) override {}
+		void DrawIndexedInstanced(unsigned int, unsigned int, unsigned int, int) override {}
+	};
+
+	enum RENDER_COMMAND
+	{
+		COMMAND_SET_PIPELINE = 0,
+		COMMAND_UPLOAD,
+		COMMAND_BIND_CONSTANTS,
+		COMMAND_DRAW
+	};
+
+	// Arguments in the order the backend call takes them
+	struct RenderCommand
+	{
+		RENDER_COMMAND type;
+		unsigned int args[4];
+	};
+
+	struct RenderCommandStats
+	{
+		unsigned int draws;
+		unsigned int instances;
+		unsigned int pipelineChanges;
+		unsigned int uploads;
+		size_t uploadedBytes;
+		// per stage, a window bound to a slot counts once
+		unsigned int binds;
+		// binds of the window that stage's slot already had
+		unsigned int redundantBinds;
+	};
+
+	// Keeps the command stream of a frame and counts what it would cost. Call Reset between frames.
+	// Bindings carry over like they do on the GPU until new constants are uploaded, windows of the
+	// old upload don't hold the same data any more.
+	class RecordingRenderBackend : public RenderBackend
+	{
+		static constexpr unsigned int STAGE_COUNT = 2;
+		static constexpr unsigned int NOTHING_BOUND = ~0u;
+
+		std::vector<RenderCommand> commands;
+		RenderCommandStats stats = {};
+		unsigned int pipeline = PIPELINE_COUNT;
+		UploadWindow bound[STAGE_COUNT][CONSTANT_SLOT_COUNT];
+
+		void ForgetBindings()
+		{
+			for (auto& stage : bound)
+			{
+				for (UploadWindow& window : stage)
+					window = { NOTHING_BOUND, 0 };
+			}
+		}
+
+	public:
+		RecordingRenderBackend() { Clear(); }
+
+		// Forgets the pipeline and bindings too, like a new device
+		void Clear()
+		{
+			Reset();
+			pipeline = PIPELINE_COUNT;
+			ForgetBindings();
+		}
+
+		void Reset()
+		{
+			commands.clear();
+			stats = {};
+		}
+
+		void SetPipeline(RENDER_PIPELINE _pipeline) override
+		{
+			commands.push_back({ COMMAND_SET_PIPELINE, { static_cast<unsigned int>(_pipeline), 0, 0, 0 } });
+			if (_pipeline != pipeline)
+				stats.pipelineChanges += 1;
+			pipeline = _pipeline;
+		}
+
+		void Upload(UPLOAD_TARGET _target, const void*, size_t _bytes) override
+		{
+			commands.push_back({ COMMAND_UPLOAD, { static_cast<unsigned int>(_target), static_cast<unsigned int>(_bytes), 0, 0 } });
+			stats.uploads += 1;
+			stats.uploadedBytes += _bytes;
+			if (_target == UPLOAD_CONSTANTS)
+				ForgetBindings();
+		}
+
+		void BindConstants(CONSTANT_SLOT _slot, unsigned int _stages, const UploadWindow& _window) override
+		{
+			commands.push_back({ COMMAND_BIND_CONSTANTS, { static_cast<unsigned int>(_slot), _stages, _window.firstConstant, _window.constantCount } });
+			for (unsigned int stage = 0; stage < STAGE_COUNT; stage++)
+			{
+				if ((_stages & (1u << stage)) == 0)
+					continue;
+				UploadWindow& slot = bound[stage][_slot];
+				stats.binds += 1;
+				if (slot.firstConstant == _window.firstConstant && slot.constantCount == _window.constantCount)
+					stats.redundantBinds += 1;
+				slot = _window;
+			}
+		}
+
+		void DrawIndexedInstanced(unsigned int _indexCount, unsigned int _instanceCount, unsigned int _startIndex, int _baseVertex) override
+		{
+			commands.push_back({ COMMAND_DRAW, { _indexCount, _instanceCount, _startIndex, static_cast<unsigned int>(_baseVertex) } });
+			stats.draws += 1;
+			stats.instances += _instanceCount;
+		}
+
+		const std::vector<RenderCommand>& Commands() const { return commands; }
+		const RenderCommandStats& GetStats() const { return stats; }
+	};
+}
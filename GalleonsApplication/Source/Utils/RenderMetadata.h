@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstring>
+
+// Draw-time facts about models and materials, worked out once while loading so the draw loops
+// only index integers.
+namespace GOG
+{
+	// Matches the texture ids PixelShader.hlsl picks its atlas by
+	enum TEXTURE_ID
+	{
+		TEXTURE_NONE = 0,
+		TEXTURE_LEVEL = 1,
+		TEXTURE_SHIPS = 2,
+		TEXTURE_BOMB = 3
+	};
+
+	// Matches the model types PSColorMapModels.hlsl colors the minimap by
+	enum MINIMAP_CATEGORY
+	{
+		MINIMAP_PLAYER = 0,
+		MINIMAP_ENEMY = 1,
+		MINIMAP_PROJECTILE = 2,
+		MINIMAP_PICKUP = 3,
+		// not drawn on the minimap
+		MINIMAP_HIDDEN = 4
+	};
+
+	// Materials without a known map_Kd get _fallback. The loaders pass the previous material's
+	// id, the texture the draw loop used to leave bound for them.
+	inline unsigned int TextureIdFromMap(const char* _mapKd, unsigned int _fallback)
+	{
+		if (_mapKd == nullptr)
+			return _fallback;
+		if (std::strcmp(_mapKd, "Atlas_Space.dds") == 0)
+			return TEXTURE_LEVEL;
+		if (std::strcmp(_mapKd, "Atlas_Pirate.dds") == 0)
+			return TEXTURE_SHIPS;
+		if (std::strcmp(_mapKd, "SmartBomb.dds") == 0)
+			return TEXTURE_BOMB;
+		return _fallback;
+	}
+
+	// Actor models are named after what they are, e.g. "Enemy_1_Lander.h2b"
+	inline unsigned int MinimapCategoryFromFileName(const char* _fileName)
+	{
+		if (std::strstr(_fileName, "Player") != nullptr)
+			return MINIMAP_PLAYER;
+		if (std::strstr(_fileName, "Enemy") != nullptr)
+			return MINIMAP_ENEMY;
+		if (std::strstr(_fileName, "Projectile") != nullptr)
+			return MINIMAP_PROJECTILE;
+		if (std::strstr(_fileName, "Pickup") != nullptr)
+			return MINIMAP_PICKUP;
+		return MINIMAP_HIDDEN;
+	}
+}
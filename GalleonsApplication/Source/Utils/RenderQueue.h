@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace GOG
+{
+	// One model's instances, a contiguous range of the sorted transforms
+	struct RenderBucket
+	{
+		unsigned int modelIndex;
+		unsigned int transformStart;
+		unsigned int count;
+	};
+
+	// Sorts a frame's actor instances by model, so every mesh of a model is drawn once for all of
+	// its instances. A counting sort keeps instances of the same model in the order they were
+	// gathered, and nothing allocates once it is created.
+	class ActorRenderQueue
+	{
+		// per model, where its next instance goes in the sorted order
+		std::vector<unsigned int> modelOffsets;
+		// sorted slot -> gathered instance
+		std::vector<unsigned int> order;
+		std::vector<RenderBucket> buckets;
+		unsigned int instanceCount = 0;
+
+	public:
+		// _modelCount bounds the model indices, _maxInstances the instances in a frame
+		void Create(unsigned int _modelCount, unsigned int _maxInstances)
+		{
+			modelOffsets.assign(_modelCount + 1, 0);
+			order.assign(_maxInstances, 0);
+			buckets.clear();
+			buckets.reserve(_modelCount);
+			instanceCount = 0;
+		}
+
+		// Makes room for _maxInstances, keeping the models
+		void Reserve(unsigned int _maxInstances)
+		{
+			if (order.size() < _maxInstances)
+				order.resize(_maxInstances);
+		}
+
+		void Build(const unsigned int* _modelNdxs, unsigned int _count)
+		{
+			instanceCount = std::min(_count, static_cast<unsigned int>(order.size()));
+			std::fill(modelOffsets.begin(), modelOffsets.end(), 0);
+			for (unsigned int i = 0; i < instanceCount; i++)
+				modelOffsets[_modelNdxs[i] + 1] += 1;
+
+			// counts become start offsets
+			buckets.clear();
+			for (unsigned int model = 0; model + 1 < modelOffsets.size(); model++)
+			{
+				unsigned int count = modelOffsets[model + 1];
+				modelOffsets[model + 1] = modelOffsets[model] + count;
+				if (count > 0)
+					buckets.push_back({ model, modelOffsets[model], count });
+			}
+
+			for (unsigned int i = 0; i < instanceCount; i++)
+				order[modelOffsets[_modelNdxs[i]]++] = i;
+		}
+
+		// Copies the gathered _source values into _sorted in bucket order
+		template<typename T>
+		void Gather(const T* _source, T* _sorted) const
+		{
+			for (unsigned int i = 0; i < instanceCount; i++)
+				_sorted[i] = _source[order[i]];
+		}
+
+		const std::vector<RenderBucket>& Buckets() const { return buckets; }
+		unsigned int InstanceCount() const { return instanceCount; }
+	};
+}
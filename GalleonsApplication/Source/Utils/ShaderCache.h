@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace GOG
+{
+	// FNV-1a, 64 bit. Utils/CompileShaders.py hashes the same way, keep the two in step.
+	inline unsigned long long HashShaderBytes(const void* _data, size_t _size, unsigned long long _hash = 0xcbf29ce484222325ull)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+		for (size_t i = 0; i < _size; i++)
+		{
+			_hash ^= bytes[i];
+			_hash *= 0x100000001b3ull;
+		}
+		return _hash;
+	}
+
+	// Everything that changes the bytecode: the source, the target profile, the entry point and
+	// the D3DCOMPILE flags (as 4 little endian bytes). Each string is hashed with its terminating
+	// zero, so text moved from one to the next is a different key. Shaders without #includes only.
+	inline unsigned long long ShaderCacheKey(const std::string& _source, const char* _target, const char* _entry, unsigned int _flags)
+	{
+		unsigned char flagBytes[4] = { static_cast<unsigned char>(_flags), static_cast<unsigned char>(_flags >> 8),
+			static_cast<unsigned char>(_flags >> 16), static_cast<unsigned char>(_flags >> 24) };
+		unsigned long long key = HashShaderBytes(_source.c_str(), _source.size() + 1);
+		key = HashShaderBytes(_target, std::char_traits<char>::length(_target) + 1, key);
+		key = HashShaderBytes(_entry, std::char_traits<char>::length(_entry) + 1, key);
+		return HashShaderBytes(flagBytes, sizeof(flagBytes), key);
+	}
+
+	struct ShaderCacheStats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int stores;
+		// older blobs of a shader removed when a new one was stored
+		unsigned int pruned;
+	};
+
+	// Compiled shader bytecode on disk, one <name>_<key>.cso per shader, the same files
+	// Utils/CompileShaders.py writes at build time. A shader whose source or flags changed has a
+	// new key, so it misses and is compiled again; storing it removes the stale blobs of that
+	// shader. Nothing here needs a device, the renderer does the compiling.
+	class ShaderCache
+	{
+		std::filesystem::path directory;
+		ShaderCacheStats stats = {};
+
+		static std::string KeyText(unsigned long long _key)
+		{
+			char text[17];
+			std::snprintf(text, sizeof(text), "%016llx", _key);
+			return text;
+		}
+
+	public:
+		// Creates _directory if it doesn't exist, returns false if it can't
+		bool Create(const std::string& _directory)
+		{
+			directory = _directory;
+			stats = {};
+			std::error_code error;
+			std::filesystem::create_directories(directory, error);
+			return std::filesystem::is_directory(directory, error);
+		}
+
+		std::string BlobPath(const char* _name, unsigned long long _key) const
+		{
+			return (directory / (std::string(_name) + "_" + KeyText(_key) + ".cso")).string();
+		}
+
+		// Fills _bytecode with the blob stored for _key, returns false on a miss
+		bool Load(const char* _name, unsigned long long _key, std::vector<unsigned char>& _bytecode)
+		{
+			std::ifstream file(BlobPath(_name, _key), std::ios::binary | std::ios::ate);
+			std::streamoff size = file.is_open() ? static_cast<std::streamoff>(file.tellg()) : 0;
+			if (size <= 0)
+			{
+				stats.misses += 1;
+				return false;
+			}
+			_bytecode.resize(static_cast<size_t>(size));
+			file.seekg(0);
+			file.read(reinterpret_cast<char*>(_bytecode.data()), size);
+			if (!file)
+			{
+				stats.misses += 1;
+				return false;
+			}
+			stats.hits += 1;
+			return true;
+		}
+
+		// Writes the blob for _key and removes the other blobs of _name
+		bool Store(const char* _name, unsigned long long _key, const void* _bytecode, size_t _size)
+		{
+			std::string path = BlobPath(_name, _key);
+			{
+				std::ofstream file(path, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+					return false;
+				file.write(static_cast<const char*>(_bytecode), _size);
+				if (!file.good())
+					return false;
+			}
+			stats.stores += 1;
+
+			// <name>_ followed by 16 hex digits, anything else in the directory is left alone
+			std::string prefix = std::string(_name) + "_";
+			std::error_code error;
+			for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+			{
+				std::string file = entry.path().filename().string();
+				if (entry.path().string() != std::filesystem::path(path).string() && entry.path().extension() == ".cso" &&
+					file.size() == prefix.size() + 16 + 4 && file.compare(0, prefix.size(), prefix) == 0 &&
+					std::filesystem::remove(entry.path(), error))
+					stats.pruned += 1;
+			}
+			return true;
+		}
+
+		const ShaderCacheStats& GetStats() const { return stats; }
+	};
+}
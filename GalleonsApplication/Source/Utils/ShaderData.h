@@ -0,0 +1,51 @@
+#pragma once
+
+#include "h2bParser.h"
+
+// CPU copies of the shaders' constant buffers, laid out to match the HLSL cbuffers
+namespace GOG
+{
+	struct MapModelTex
+	{
+		unsigned int modelType;
+		unsigned int pad[3];
+	};
+
+	struct alignas(16) PerInstanceData
+	{
+		unsigned int transformStart;
+		unsigned int materialStart;
+		// added to x, the level segment copy drawn
+		float segmentOffset;
+		unsigned int pad;
+	};
+
+	struct alignas(16) SceneData
+	{
+		GW::MATH::GMATRIXF viewMatrix;
+		GW::MATH::GMATRIXF projectionMatrix;
+		GW::MATH::GVECTORF camPos;
+		GW::MATH::GVECTORF dirLightDir, dirLightColor;
+		GW::MATH::GVECTORF ambientTerm;
+		GW::MATH::GVECTORF fogColor;
+		float fogDensity;
+		float fogStartDistance;
+		float contrast;
+		float saturation;
+		// the light bins' grid, see LightBinning.h
+		unsigned int lightTileSize;
+		unsigned int lightTilesX;
+		unsigned int lightTilesY;
+		unsigned int pad;
+	};
+
+	struct alignas(16) MeshData
+	{
+		GW::MATH::GMATRIXF worldMatrix;
+		H2B::Attributes attribute;
+		unsigned int texID;
+		float offset;
+		unsigned int padding[2];
+		
+	};
+}
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cmath>
+
+#include "../Components/AudioSource.h"
 
 namespace GOG
 {
 	class SharedActorMethods
 	{
 	public:
-		static void FlipEntity(float _deltaTime, float _dirMoving, GOG::Transform& _transform, GOG::FlipInfo& _flipInfo)
+		static void FlipEntity(float _deltaTime, float _dirMoving, GOG::Pose2D& _pose, GOG::FlipInfo& _flipInfo)
 		{
 			// If the dir we want to move (_dirMoving) is different from isFacingRight, start a flip
 			if ((_flipInfo.isFacingRight && _dirMoving < 0)
@@ -57,9 +60,85 @@ namespace GOG
 					}
 				}
 
-				GW::MATH::GMatrix::RotateYLocalF(_transform.value, G_DEGREE_TO_RADIAN(rotAmount), _transform.value);
+				_pose.yaw += G_DEGREE_TO_RADIAN_F(rotAmount);
+				_pose.dirty = true;
 			}
 		}
+
+		// A prefab's pose at the origin, _rotation in radians
+		static GOG::Pose2D PrefabPose(const GW::MATH::GVECTORF& _rotation, const GW::MATH::GVECTORF& _scale)
+		{
+			return { 0, 0, 0, _rotation.x, _rotation.y, _rotation.z, _scale.x, _scale.y, _scale.z, true };
+		}
+
+		// The prefab's pose moved to _position, for spawning
+		static GOG::Pose2D PoseAt(const GOG::Pose2D& _prefabPose, const GW::MATH::GVECTORF& _position)
+		{
+			GOG::Pose2D pose = _prefabPose;
+			pose.x = _position.x;
+			pose.y = _position.y;
+			pose.z = _position.z;
+			pose.dirty = true;
+			return pose;
+		}
+
+		// The world matrix of the pose, Rz * Ry * Rx * Scale with row vectors like the
+		// RotateLocal and ScaleLocal calls the prefabs used to be built with
+		static void PoseMatrix(const GOG::Pose2D& _pose, GW::MATH::GMATRIXF& _matrix)
+		{
+			float cx = std::cos(_pose.pitch), sx = std::sin(_pose.pitch);
+			float cy = std::cos(_pose.yaw), sy = std::sin(_pose.yaw);
+			float cz = std::cos(_pose.roll), sz = std::sin(_pose.roll);
+			// Ry * Rx
+			GW::MATH::GVECTORF a1{ cy, sy * sx, -sy * cx, 0 };
+			GW::MATH::GVECTORF a2{ 0, cx, sx, 0 };
+			GW::MATH::GVECTORF a3{ sy, -cy * sx, cy * cx, 0 };
+			// Rz on the left, the scale goes on each column
+			_matrix.row1 = { (cz * a1.x + sz * a2.x) * _pose.scaleX, (cz * a1.y + sz * a2.y) * _pose.scaleY, (cz * a1.z + sz * a2.z) * _pose.scaleZ, 0 };
+			_matrix.row2 = { (cz * a2.x - sz * a1.x) * _pose.scaleX, (cz * a2.y - sz * a1.y) * _pose.scaleY, (cz * a2.z - sz * a1.z) * _pose.scaleZ, 0 };
+			_matrix.row3 = { a3.x * _pose.scaleX, a3.y * _pose.scaleY, a3.z * _pose.scaleZ, 0 };
+			_matrix.row4 = { _pose.x, _pose.y, _pose.z, 1 };
+		}
+
+		// Moves the pose along its own axes, what TranslateLocalF does to the world matrix
+		static void TranslatePoseLocal(const GW::MATH::GVECTORF& _local, GOG::Pose2D& _pose)
+		{
+			if (_local.x == 0 && _local.y == 0 && _local.z == 0)
+				return;
+			GW::MATH::GMATRIXF m;
+			PoseMatrix(_pose, m);
+			_pose.x += _local.x * m.row1.x + _local.y * m.row2.x + _local.z * m.row3.x;
+			_pose.y += _local.x * m.row1.y + _local.y * m.row2.y + _local.z * m.row3.y;
+			_pose.z += _local.x * m.row1.z + _local.y * m.row2.z + _local.z * m.row3.z;
+			_pose.dirty = true;
+		}
+
+		// Queues one of the actor's one-shot clips, the audio device is only touched when the queue is drained
+		static void PlaySound(const flecs::world& _world, const GOG::SoundClips& _clips, GOG::SOUND_SLOT _slot)
+		{
+			QueueAudio(_world, { GOG::AUDIO_COMMAND::PLAY_SOUND, _clips.sounds[_slot], 0 });
+		}
+
+		// Starts (or keeps running) one of the actor's looping clips at its configured volume
+		static void PlayLoop(const flecs::world& _world, const GOG::LoopingClips& _clips, GOG::LOOP_SLOT _slot)
+		{
+			QueueAudio(_world, { GOG::AUDIO_COMMAND::PLAY_LOOP, _clips.sounds[_slot].clip, _clips.sounds[_slot].volume });
+		}
+
+		static void StopLoop(const flecs::world& _world, const GOG::LoopingClips& _clips, GOG::LOOP_SLOT _slot)
+		{
+			QueueAudio(_world, { GOG::AUDIO_COMMAND::STOP_LOOP, _clips.sounds[_slot].clip, 0 });
+		}
+
+	private:
+		static void QueueAudio(const flecs::world& _world, const GOG::AudioCommand& _command)
+		{
+			const GOG::AudioQueue* queue = _world.get<GOG::AudioQueue>();
+			if (queue == nullptr || _command.sound == GOG::INVALID_SOUND)
+				return;
+			// a full queue drops the sound rather than stalling gameplay
+			queue->commands->Push(_command);
+		}
 	};
 }
 
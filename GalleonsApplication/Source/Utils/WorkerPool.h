@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GOG
+{
+	// A few long-lived threads that run a batch of jobs and hand control back when all of them
+	// are done. The calling thread takes jobs too, so a pool without threads runs the batch in
+	// order on the caller. Jobs are numbered and claim work in any order, anything that has to be
+	// deterministic should write to the job's own slot and be read back in job order.
+	// Running a batch doesn't allocate. Only one thread may call Run at a time.
+	class WorkerPool
+	{
+		std::vector<std::thread> threads;
+		std::mutex lock;
+		std::condition_variable wake;
+		std::condition_variable finished;
+
+		// The current batch, written under the lock. Workers copy them when they wake, so a
+		// worker late from one batch still runs that batch's job with that batch's count.
+		struct Batch
+		{
+			void (*job)(void*, unsigned int);
+			void* context;
+			unsigned int count;
+			// bumped for every batch so a worker never runs one twice
+			unsigned int generation;
+		};
+		Batch current = {};
+		// the current batch's generation in the high 32 bits, its next unclaimed job in the low 32
+		std::atomic<unsigned long long> nextJob{ 0 };
+		// jobs of the current batch not finished yet
+		unsigned int jobsLeft = 0;
+		bool stopping = false;
+
+		// Claims jobs of _batch until there are none left. A job is only claimed while nextJob
+		// still belongs to _batch, so a late worker can't take (or skip) jobs of the next one.
+		void Work(const Batch& _batch)
+		{
+			unsigned int done = 0;
+			unsigned long long claim = nextJob.load(std::memory_order_acquire);
+			while ((claim >> 32) == _batch.generation && static_cast<unsigned int>(claim) < _batch.count)
+			{
+				if (nextJob.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel) == false)
+					continue;
+				_batch.job(_batch.context, static_cast<unsigned int>(claim));
+				done += 1;
+				claim = nextJob.load(std::memory_order_acquire);
+			}
+			if (done == 0)
+				return;
+
+			std::lock_guard<std::mutex> guard(lock);
+			jobsLeft -= done;
+			if (jobsLeft == 0)
+				finished.notify_all();
+		}
+
+		void WorkerLoop()
+		{
+			unsigned int seenGeneration = 0;
+			while (true)
+			{
+				Batch batch;
+				{
+					std::unique_lock<std::mutex> guard(lock);
+					wake.wait(guard, [this, seenGeneration]() { return stopping || current.generation != seenGeneration; });
+					if (stopping)
+						return;
+					batch = current;
+					seenGeneration = batch.generation;
+				}
+				Work(batch);
+			}
+		}
+
+	public:
+		~WorkerPool() { Stop(); }
+
+		// _threadCount threads on top of the caller, 0 runs every batch on the caller
+		void Start(unsigned int _threadCount)
+		{
+			Stop();
+			stopping = false;
+			threads.reserve(_threadCount);
+			for (unsigned int i = 0; i < _threadCount; i++)
+				threads.emplace_back(&WorkerPool::WorkerLoop, this);
+		}
+
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (std::thread& thread : threads)
+				thread.join();
+			threads.clear();
+		}
+
+		// Calls _job(i) for every i below _count and returns once all of them have returned
+		template<typename Job>
+		void Run(unsigned int _count, Job& _job)
+		{
+			if (_count == 0)
+				return;
+			Batch batch;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				current.job = [](void* _context, unsigned int _index) { (*static_cast<Job*>(_context))(_index); };
+				current.context = &_job;
+				current.count = _count;
+				current.generation += 1;
+				jobsLeft = _count;
+				nextJob.store(static_cast<unsigned long long>(current.generation) << 32, std::memory_order_release);
+				batch = current;
+			}
+			if (threads.empty() == false)
+				wake.notify_all();
+
+			Work(batch);
+			std::unique_lock<std::mutex> guard(lock);
+			finished.wait(guard, [this]() { return jobsLeft == 0; });
+		}
+
+		unsigned int ThreadCount() const { return static_cast<unsigned int>(threads.size()); }
+	};
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Components/Gameplay.h"
+#include "../Components/Identification.h"
+#include "../Components/Physics.h"
+
+namespace GOG
+{
+	// Appends raw values to a byte buffer. The buffer keeps its capacity between snapshots, so
+	// capturing every frame stops allocating once it has grown to the size of the world.
+	class SnapshotWriter
+	{
+		std::vector<unsigned char>& bytes;
+
+	public:
+		explicit SnapshotWriter(std::vector<unsigned char>& _bytes) : bytes(_bytes) { bytes.clear(); }
+
+		template <typename T>
+		void Write(const T& _value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshots only hold plain data");
+			size_t offset = bytes.size();
+			bytes.resize(offset + sizeof(T));
+			std::memcpy(bytes.data() + offset, &_value, sizeof(T));
+		}
+
+		void WriteString(const char* _text)
+		{
+			unsigned short length = static_cast<unsigned short>(_text ? std::strlen(_text) : 0);
+			Write(length);
+			size_t offset = bytes.size();
+			bytes.resize(offset + length);
+			if (length > 0)
+				std::memcpy(bytes.data() + offset, _text, length);
+		}
+
+		// Leaves room for a value only known once what follows it has been written
+		template <typename T>
+		size_t Reserve()
+		{
+			size_t offset = bytes.size();
+			Write(T());
+			return offset;
+		}
+
+		template <typename T>
+		void Patch(size_t _offset, const T& _value)
+		{
+			std::memcpy(bytes.data() + _offset, &_value, sizeof(T));
+		}
+	};
+
+	// Reads values back in the order they were written. Reading past the end fails every
+	// following read instead of touching memory outside the buffer.
+	class SnapshotReader
+	{
+		const std::vector<unsigned char>& bytes;
+		size_t offset = 0;
+		bool failed = false;
+
+	public:
+		explicit SnapshotReader(const std::vector<unsigned char>& _bytes, size_t _offset = 0) :
+			bytes(_bytes), offset(_offset), failed(_offset > _bytes.size()) {}
+
+		template <typename T>
+		bool Read(T& _value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshots only hold plain data");
+			if (failed || offset + sizeof(T) > bytes.size())
+				return !(failed = true);
+			std::memcpy(&_value, bytes.data() + offset, sizeof(T));
+			offset += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::string& _text)
+		{
+			unsigned short length = 0;
+			if (!Read(length) || offset + length > bytes.size())
+				return !(failed = true);
+			_text.assign(reinterpret_cast<const char*>(bytes.data()) + offset, length);
+			offset += length;
+			return true;
+		}
+
+		bool Skip(size_t _size)
+		{
+			if (failed || _size > bytes.size() - offset)
+				return !(failed = true);
+			offset += _size;
+			return true;
+		}
+
+		size_t Offset() const { return offset; }
+		size_t Remaining() const { return failed ? 0 : bytes.size() - offset; }
+		bool Failed() const { return failed; }
+	};
+
+	// One frame of gameplay state as a flat blob. Actors are stored by prefab name with only the
+	// components they own, so a snapshot restores into any world that loaded the same prefabs.
+	struct WorldSnapshot
+	{
+		std::vector<unsigned char> bytes;
+		// frame the snapshot was taken on and how long the frame before it took
+		unsigned long long frame = 0;
+		float frameMs = 0;
+
+		bool Empty() const { return bytes.empty(); }
+	};
+
+	// Writes and reads the entity part of snapshots for one world. The queries and scratch
+	// buffers are kept between calls, so capturing doesn't allocate once they have grown.
+	class SnapshotEntities
+	{
+		static constexpr unsigned int MAGIC = 0x53474F47; // "GOGS"
+		static constexpr unsigned int VERSION = 3;
+
+		// Tags are stored as one bit each in this order
+		template <typename... Tags>
+		struct TagList
+		{
+			static_assert(sizeof...(Tags) <= 32, "tags are stored in a 32 bit mask");
+
+			static unsigned int Mask(flecs::entity _entity)
+			{
+				unsigned int mask = 0, bit = 0;
+				((mask |= _entity.has<Tags>() ? (1u << bit) : 0u, bit += 1), ...);
+				return mask;
+			}
+
+			static void Add(flecs::entity _entity, unsigned int _mask)
+			{
+				unsigned int bit = 0;
+				(((_mask & (1u << bit)) ? (void)_entity.add<Tags>() : (void)0, bit += 1), ...);
+			}
+		};
+
+		// Data components are copied byte for byte, only when the entity owns them. Values
+		// shared from the prefab come back through the IsA relationship.
+		template <typename... Components>
+		struct ComponentList
+		{
+			static_assert(sizeof...(Components) <= 32, "components are stored in a 32 bit mask");
+
+			static unsigned int Mask(flecs::entity _entity)
+			{
+				unsigned int mask = 0, bit = 0;
+				((mask |= _entity.owns<Components>() ? (1u << bit) : 0u, bit += 1), ...);
+				return mask;
+			}
+
+			// bytes the components in _mask take up in the snapshot
+			static size_t Size(unsigned int _mask)
+			{
+				size_t size = 0;
+				unsigned int bit = 0;
+				((size += (_mask & (1u << bit)) ? sizeof(Components) : 0, bit += 1), ...);
+				return size;
+			}
+
+			static void Write(flecs::entity _entity, unsigned int _mask, SnapshotWriter& _writer)
+			{
+				unsigned int bit = 0;
+				(((_mask & (1u << bit)) ? _writer.Write(*_entity.get<Components>()) : (void)0, bit += 1), ...);
+			}
+
+			static void Read(flecs::entity _entity, unsigned int _mask, SnapshotReader& _reader)
+			{
+				unsigned int bit = 0;
+				(((_mask & (1u << bit)) ? ReadOne<Components>(_entity, _reader) : (void)0, bit += 1), ...);
+			}
+
+			template <typename T>
+			static void ReadOne(flecs::entity _entity, SnapshotReader& _reader)
+			{
+				T value;
+				if (_reader.Read(value))
+					_entity.set<T>(Restored(value));
+			}
+
+			template <typename T>
+			static const T& Restored(const T& _value) { return _value; }
+			// world matrices aren't stored, the transform sync rebuilds them from the pose
+			static Pose2D Restored(Pose2D _pose)
+			{
+				_pose.dirty = true;
+				return _pose;
+			}
+		};
+
+		typedef TagList<Player, PersistentStats, Camera, Enemy, Bomber, Baiter, Lander,
+			Projectile, Lazer, Cannonball, Pea, Trap, Pickup, SmartBomb, Civilian,
+			Alive, Collidable, Firing, Charging, ChargingSmartBomb, Capturing> SnapshotTags;
+
+		typedef ComponentList<Transform, Pose2D, BoundBox, Velocity, Acceleration, Offset, Speed,
+			FlipInfo, PlayerMoveInfo, BaiterMovementStats, CiviMovementStats, SpeedBoost, ChargeInfo,
+			Cannon, PeaShooter, BomberTrap, ControllerID, Sender, Lives, Score, NukeDispenser> SnapshotComponents;
+
+		// An entity read out of a snapshot but not yet created. The captor is stored as the
+		// id the entity had when it was captured, 0 for none.
+		struct StagedEntity
+		{
+			std::string name;
+			flecs::entity prefab;
+			unsigned long long id;
+			unsigned int tags;
+			unsigned int components;
+			// where the component values start in the snapshot
+			size_t dataOffset;
+			bool ownsCapture;
+			bool captured;
+			unsigned long long captor;
+		};
+
+		// two name lengths, id, tag and component masks, capture flags and captor
+		static constexpr size_t MIN_ENTITY_BYTES = 2 + 2 + 8 + 4 + 4 + 1 + 1 + 8;
+
+		flecs::query<const Pose2D> actors;
+		flecs::query<const Transform> cameras;
+		flecs::query<const PersistentStats> stats;
+
+		std::vector<StagedEntity> staged;
+		std::vector<flecs::entity> restored;
+		// saved id and index into staged, sorted by id to find captors
+		std::vector<std::pair<unsigned long long, unsigned int>> savedIds;
+		std::string prefabName;
+
+		void WriteEntity(flecs::entity _entity, SnapshotWriter& _writer)
+		{
+			_writer.WriteString(_entity.name().c_str());
+			flecs::entity prefab = _entity.target(flecs::IsA);
+			_writer.WriteString(prefab ? prefab.name().c_str() : nullptr);
+			_writer.Write(static_cast<unsigned long long>(_entity.id()));
+
+			unsigned int tags = SnapshotTags::Mask(_entity);
+			unsigned int components = SnapshotComponents::Mask(_entity);
+			_writer.Write(tags);
+			_writer.Write(components);
+			SnapshotComponents::Write(_entity, components, _writer);
+
+			// written a field at a time so no padding ends up in the blob
+			const CaptureInfo* info = _entity.owns<CaptureInfo>() ? _entity.get<CaptureInfo>() : nullptr;
+			_writer.Write(static_cast<unsigned char>(info ? 1 : 0));
+			_writer.Write(static_cast<unsigned char>(info && info->captured ? 1 : 0));
+			_writer.Write(static_cast<unsigned long long>(info && info->captor ? info->captor.id() : 0));
+		}
+
+	public:
+		void Create(flecs::world& _world)
+		{
+			actors = _world.query<const Pose2D>();
+			cameras = _world.query<const Transform>();
+			stats = _world.query<const PersistentStats>();
+		}
+
+		void Destroy()
+		{
+			actors.destruct();
+			cameras.destruct();
+			stats.destruct();
+		}
+
+		// Writes every actor (anything with a Pose2D), the camera and the persistent player stats
+		void Write(SnapshotWriter& _writer)
+		{
+			_writer.Write(MAGIC);
+			_writer.Write(VERSION);
+			size_t countAt = _writer.Reserve<unsigned int>();
+			unsigned int count = 0;
+
+			actors.each([&](flecs::entity _entity, const Pose2D&)
+				{
+					WriteEntity(_entity, _writer);
+					count += 1;
+				});
+			cameras.each([&](flecs::entity _entity, const Transform&)
+				{
+					WriteEntity(_entity, _writer);
+					count += 1;
+				});
+			stats.each([&](flecs::entity _entity, const PersistentStats&)
+				{
+					WriteEntity(_entity, _writer);
+					count += 1;
+				});
+
+			_writer.Patch(countAt, count);
+		}
+
+		// Reads and checks the whole entity section without touching the world. A truncated
+		// blob, a count larger than the bytes left or a prefab this world didn't load all fail.
+		bool Stage(flecs::world& _world, SnapshotReader& _reader)
+		{
+			staged.clear();
+			unsigned int magic = 0, version = 0, count = 0;
+			if (!_reader.Read(magic) || magic != MAGIC || !_reader.Read(version) || version != VERSION ||
+				!_reader.Read(count) || count > _reader.Remaining() / MIN_ENTITY_BYTES)
+				return false;
+
+			staged.resize(count);
+			for (StagedEntity& entity : staged)
+			{
+				unsigned char ownsCapture = 0, captured = 0;
+				if (!_reader.ReadString(entity.name) || !_reader.ReadString(prefabName) ||
+					!_reader.Read(entity.id) || !_reader.Read(entity.tags) || !_reader.Read(entity.components))
+					return false;
+
+				entity.prefab = flecs::entity();
+				if (!prefabName.empty())
+				{
+					entity.prefab = _world.lookup(prefabName.c_str());
+					if (!entity.prefab)
+						return false;
+				}
+
+				entity.dataOffset = _reader.Offset();
+				if (!_reader.Skip(SnapshotComponents::Size(entity.components)) ||
+					!_reader.Read(ownsCapture) || !_reader.Read(captured) || !_reader.Read(entity.captor))
+					return false;
+				entity.ownsCapture = ownsCapture != 0;
+				entity.captured = captured != 0;
+			}
+			return true;
+		}
+
+		// Destroys the current actors and rebuilds the staged ones in one deferred pass, reading
+		// the component values from the blob that was staged. Named entities (camera,
+		// persistent stats) are updated in place instead.
+		void Apply(flecs::world& _world, const std::vector<unsigned char>& _bytes)
+		{
+			_world.defer_begin(); // required when removing while iterating!
+			actors.each([](flecs::entity _entity, const Pose2D&)
+				{
+					if (_entity.name().length() == 0)
+						_entity.destruct();
+				});
+			_world.defer_end();
+
+			restored.resize(staged.size());
+			savedIds.clear();
+
+			// every add and set of an entity is batched into a single move to its final table
+			_world.defer_begin();
+			for (unsigned int i = 0; i < staged.size(); i++)
+			{
+				const StagedEntity& saved = staged[i];
+				flecs::entity entity = saved.name.empty() ? _world.entity() : _world.entity(saved.name.c_str());
+				if (saved.prefab)
+					entity.is_a(saved.prefab);
+				SnapshotTags::Add(entity, saved.tags);
+				SnapshotReader reader(_bytes, saved.dataOffset);
+				SnapshotComponents::Read(entity, saved.components, reader);
+				restored[i] = entity;
+				savedIds.push_back({ saved.id, i });
+			}
+
+			std::sort(savedIds.begin(), savedIds.end());
+			for (unsigned int i = 0; i < staged.size(); i++)
+			{
+				const StagedEntity& saved = staged[i];
+				if (!saved.ownsCapture)
+					continue;
+				flecs::entity captor;
+				auto found = std::lower_bound(savedIds.begin(), savedIds.end(),
+					std::make_pair(saved.captor, 0u));
+				if (saved.captor != 0 && found != savedIds.end() && found->first == saved.captor)
+					captor = restored[found->second];
+				restored[i].set<CaptureInfo>({ saved.captured, captor });
+			}
+			_world.defer_end();
+		}
+	};
+
+	// The last few snapshots, oldest overwritten first. Kept around so the frames leading up
+	// to a frame time spike can be written out and inspected after the fact.
+	class SnapshotRing
+	{
+		static constexpr unsigned int MAGIC = 0x52474F47; // "GOGR"
+		static constexpr unsigned int VERSION = 1;
+
+		std::vector<WorldSnapshot> slots;
+		unsigned int next = 0;
+		unsigned int count = 0;
+
+	public:
+		void Create(unsigned int _size)
+		{
+			slots.assign(_size, WorldSnapshot());
+			next = 0;
+			count = 0;
+		}
+
+		// The slot to capture the next frame into, reusing the oldest one's buffer
+		WorldSnapshot* Next()
+		{
+			if (slots.empty())
+				return nullptr;
+			WorldSnapshot* slot = &slots[next];
+			next = (next + 1) % slots.size();
+			count = count < slots.size() ? count + 1 : count;
+			return slot;
+		}
+
+		void Clear() { next = 0; count = 0; }
+		unsigned int Count() const { return count; }
+		bool Enabled() const { return !slots.empty(); }
+
+		// _index 0 is the oldest snapshot still held
+		const WorldSnapshot& At(unsigned int _index) const
+		{
+			return slots[(next + slots.size() - count + _index) % slots.size()];
+		}
+
+		// Writes the held snapshots oldest first
+		bool Save(const std::string& _path) const
+		{
+			std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+			file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+			file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			for (unsigned int i = 0; i < count; i++)
+			{
+				const WorldSnapshot& snapshot = At(i);
+				unsigned long long size = snapshot.bytes.size();
+				file.write(reinterpret_cast<const char*>(&snapshot.frame), sizeof(snapshot.frame));
+				file.write(reinterpret_cast<const char*>(&snapshot.frameMs), sizeof(snapshot.frameMs));
+				file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+				file.write(reinterpret_cast<const char*>(snapshot.bytes.data()), size);
+			}
+			return file.good();
+		}
+
+		// Replaces the held snapshots only when the whole file reads back
+		bool Load(const std::string& _path)
+		{
+			std::ifstream file(_path, std::ios::binary | std::ios::ate);
+			if (!file.is_open())
+				return false;
+			std::streamoff fileBytes = file.tellg();
+			file.seekg(0);
+
+			unsigned int magic = 0, version = 0, loaded = 0;
+			file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+			file.read(reinterpret_cast<char*>(&version), sizeof(version));
+			file.read(reinterpret_cast<char*>(&loaded), sizeof(loaded));
+			if (!file || magic != MAGIC || version != VERSION)
+				return false;
+
+			// a truncated or corrupt file can't claim more snapshots than it has headers for
+			const std::streamoff slotHeaderBytes = sizeof(unsigned long long) + sizeof(float) + sizeof(unsigned long long);
+			if (static_cast<unsigned long long>(loaded) > static_cast<unsigned long long>(fileBytes - file.tellg()) / slotHeaderBytes)
+				return false;
+
+			std::vector<WorldSnapshot> loadedSlots(loaded);
+			for (WorldSnapshot& snapshot : loadedSlots)
+			{
+				unsigned long long size = 0;
+				file.read(reinterpret_cast<char*>(&snapshot.frame), sizeof(snapshot.frame));
+				file.read(reinterpret_cast<char*>(&snapshot.frameMs), sizeof(snapshot.frameMs));
+				file.read(reinterpret_cast<char*>(&size), sizeof(size));
+				if (!file || size > static_cast<unsigned long long>(fileBytes - file.tellg()))
+					return false;
+				snapshot.bytes.resize(size);
+				file.read(reinterpret_cast<char*>(snapshot.bytes.data()), size);
+				if (!file)
+					return false;
+			}
+
+			slots.swap(loadedSlots);
+			next = 0;
+			count = loaded;
+			return true;
+		}
+	};
+}